@@ -0,0 +1,23 @@
+# - Find SQLite3
+# Find the native SQLite3 includes and library
+#
+#   SQLITE3_FOUND       - True if SQLite3 found.
+#   SQLITE3_INCLUDE_DIR - where to find sqlite3.h, etc.
+#   SQLITE3_LIBRARIES   - List of libraries when using SQLite3.
+#
+
+IF( SQLITE3_INCLUDE_DIR )
+    # Already in cache, be silent
+    SET( SQLite3_FIND_QUIETLY TRUE )
+ENDIF( SQLITE3_INCLUDE_DIR )
+
+FIND_PATH( SQLITE3_INCLUDE_DIR "sqlite3.h" )
+FIND_LIBRARY( SQLITE3_LIBRARIES
+              NAMES "sqlite3" )
+
+# handle the QUIETLY and REQUIRED arguments and set SQLITE3_FOUND to TRUE if
+# all listed variables are TRUE
+INCLUDE( "FindPackageHandleStandardArgs" )
+FIND_PACKAGE_HANDLE_STANDARD_ARGS( "SQLite3" DEFAULT_MSG SQLITE3_INCLUDE_DIR SQLITE3_LIBRARIES )
+
+MARK_AS_ADVANCED( SQLITE3_INCLUDE_DIR SQLITE3_LIBRARIES )
@@ -157,7 +157,10 @@
 #   include <netdb.h>
 #   include <netinet/in.h>
 #   include <pthread.h>
+#   include <sys/mman.h>
+#   include <sys/resource.h>
 #   include <sys/socket.h>
+#   include <sys/uio.h>
 #   include <unistd.h>
 #endif /* !WIN32 */
 
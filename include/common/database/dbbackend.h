@@ -0,0 +1,194 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __DATABASE__DBBACKEND_H__INCL__
+#define __DATABASE__DBBACKEND_H__INCL__
+
+#include "database/dbtype.h"
+
+class DBerror;
+
+/**
+ * @brief Rows of a finished query, as handed out by a DBBackend.
+ *
+ * Values are exposed the way the MySQL client library exposes them:
+ * as NUL-terminated text (NULL for SQL NULL) plus their lengths.
+ */
+class DBResultSet
+{
+public:
+    virtual ~DBResultSet() {}
+
+    virtual uint32 ColumnCount() const = 0;
+    virtual const char* ColumnName( uint32 index ) const = 0;
+    virtual DBTYPE ColumnType( uint32 index ) const = 0;
+
+    virtual bool IsUnsigned( uint32 index ) const = 0;
+    virtual bool IsBinary( uint32 index ) const = 0;
+
+    /**
+     * @brief Fetches next row.
+     *
+     * The row stays valid until the next call.
+     *
+     * @param[out] row     Column values.
+     * @param[out] lengths Lengths of the column values.
+     *
+     * @return False if there are no more rows.
+     */
+    virtual bool FetchRow( const char* const*& row, const unsigned long*& lengths ) = 0;
+    /**
+     * @return Number of rows; for a streamed result number of rows fetched so far.
+     */
+    virtual size_t RowCount() const = 0;
+    /**
+     * @brief Moves back to the first row.
+     *
+     * @return False if the result cannot be rewound.
+     */
+    virtual bool Rewind() = 0;
+};
+
+/**
+ * @brief A connection to a database server (or an embedded database).
+ *
+ * DBcore serializes all calls, so implementations need not be thread-safe.
+ * Queries are written in MySQL dialect; backends for other databases
+ * translate what they can (see DBSQLiteBackend).
+ */
+class DBBackend
+{
+public:
+    virtual ~DBBackend() {}
+
+    /**
+     * @brief Creates a backend by its name ("mysql", "sqlite").
+     *
+     * @return The new backend; NULL if the name is unknown or support for it has not been compiled in.
+     */
+    static DBBackend* Create( const char* name );
+
+    /**
+     * @return Name of the backend, as passed to Create().
+     */
+    virtual const char* GetName() const = 0;
+
+    /**
+     * @brief Connects to the database.
+     *
+     * Embedded backends treat @a database as the path of the database file.
+     */
+    virtual bool Connect( DBerror& err, const char* host, const char* user, const char* password,
+                          const char* database, int16 port, bool compress, bool ssl ) = 0;
+    /**
+     * @brief Drops the connection; Connect() may be called again.
+     */
+    virtual void Close() = 0;
+    virtual void Ping() = 0;
+
+    /**
+     * @brief Executes a single statement.
+     *
+     * If the statement returns rows, they must be picked up by StoreResult()
+     * or UseResult() before the next statement is executed.
+     */
+    virtual bool Execute( DBerror& err, const char* query, uint32 querylen ) = 0;
+    /**
+     * @return True if given error means the connection has been lost and the statement may be retried.
+     */
+    virtual bool IsConnectionLost( uint32 errNo ) const = 0;
+
+    /**
+     * @return Number of columns returned by the last statement; 0 if it returned no rows.
+     */
+    virtual uint32 FieldCount() = 0;
+    /**
+     * @brief Fetches all rows of the last statement.
+     *
+     * @return The result; NULL on error (which is stored in @a err).
+     */
+    virtual DBResultSet* StoreResult( DBerror& err ) = 0;
+    /**
+     * @brief Prepares the rows of the last statement to be fetched one by one.
+     *
+     * No other statement may be executed until the result has been freed.
+     *
+     * @return The result; NULL on error (which is stored in @a err).
+     */
+    virtual DBResultSet* UseResult( DBerror& err ) = 0;
+
+    /**
+     * @return Rows matched by the last statement.
+     */
+    virtual uint64 AffectedRows() = 0;
+    /**
+     * @return Auto-increment value generated by the last statement.
+     */
+    virtual uint64 InsertID() = 0;
+
+    /**
+     * @brief Escapes a string so it can be put inside quotes in a query.
+     *
+     * The default implementation escapes MySQL-style, which is what every query
+     * and dump expects.
+     *
+     * @param[out] to      Buffer of at least 2 * @a fromlen + 1 bytes.
+     * @param[in]  from    String to escape.
+     * @param[in]  fromlen Length of the string.
+     *
+     * @return Length of the escaped string.
+     */
+    virtual uint32 EscapeString( char* to, const char* from, uint32 fromlen );
+
+    /**
+     * @brief Runs all statements of an SQL dump.
+     *
+     * Comments, conditional comments and statements the backend cannot run
+     * (see _TranslateDumpStatement()) are skipped.
+     *
+     * @param[out] err  Error of the failed statement.
+     * @param[in]  file Path to the dump.
+     *
+     * @return True if all statements succeeded.
+     */
+    bool LoadDump( DBerror& err, const char* file );
+
+protected:
+    /**
+     * @brief Adapts a statement of a dump to the backend.
+     *
+     * @return False if the statement should be skipped.
+     */
+    virtual bool _TranslateDumpStatement( std::string& statement ) { return true; }
+
+    /// Returns next character of the file without taking it.
+    static int _Peek( FILE* f );
+
+    /// DBerror may be only set by DBcore and backends.
+    static void _SetError( DBerror& err, uint32 errNo, const char* str );
+    static void _ClearError( DBerror& err );
+};
+
+#endif /* !__DATABASE__DBBACKEND_H__INCL__ */
@@ -26,9 +26,12 @@
 #ifndef __DATABASE__DBCORE_H__INCL__
 #define __DATABASE__DBCORE_H__INCL__
 
-//this whole file could be interface-ized to support a different database
-//if you can get over the SQL incompatibilities and mysql auto increment problems.
+//the database itself is reached through a DBBackend (see dbbackend.h);
+//queries are still written in MySQL dialect.
 
+#include "database/dbbackend.h"
+#include "database/dbprofiler.h"
+#include "database/dbsnapshot.h"
 #include "database/dbtype.h"
 #include "threading/Mutex.h"
 #include "utils/Singleton.h"
@@ -46,8 +49,9 @@ public:
     const char* c_str() const { return GetError(); }
 
 protected:
-    //for DBcore:
+    //for DBcore and backends:
     friend class DBcore;
+    friend class DBBackend;
     void SetError( uint32 err, const char* str );
     void ClearError();
 
@@ -67,27 +71,43 @@ public:
     DBerror error;
 
     bool GetRow( DBResultRow& into );
-    size_t GetRowCount() { return (size_t)mResult->row_count; }
+    /**
+     * @note For a streamed result this is the number of rows fetched so far.
+     */
+    size_t GetRowCount() { return ( NULL != mResult ? mResult->RowCount() : 0 ); }
+    /**
+     * @note Not possible for a streamed result.
+     */
     void Reset();
 
+    /**
+     * @return True if the rows are fetched from the server one by one (see DBcore::RunQueryStream).
+     */
+    bool IsStreamed() const { return NULL != mStreamLock; }
+
     uint32 ColumnCount() const { return mColumnCount; }
     const char* ColumnName( uint32 index ) const;
     DBTYPE ColumnType( uint32 index ) const;
 
-    bool IsUnsigned( uint32 index ) const;
-    bool IsBinary( uint32 index ) const;
+    bool IsUnsigned( uint32 index ) const { return mResult->IsUnsigned( index ); }
+    bool IsBinary( uint32 index ) const { return mResult->IsBinary( index ); }
 
 protected:
     //for DBcore:
     friend class DBcore;
-    void SetResult( MYSQL_RES** res, uint32 colCount );
+    void SetResult( DBResultSet* res, Mutex* streamLock = NULL, DBProfiler::Entry* profile = NULL );
+    /* frees the result and releases the connection of a streamed result */
+    void _Free();
 
     uint32 mColumnCount;
-    MYSQL_RES* mResult;
-    MYSQL_FIELD** mFields;
-
-    static const DBTYPE MYSQL_DBTYPE_TABLE_SIGNED[];
-    static const DBTYPE MYSQL_DBTYPE_TABLE_UNSIGNED[];
+    DBResultSet* mResult;
+    /* connection lock held until a streamed result is exhausted or freed */
+    Mutex* mStreamLock;
+
+    /* profiler entry of the query, credited with the fetched rows when freed */
+    DBProfiler::Entry* mProfile;
+    uint64 mFetchedRows;
+    uint64 mFetchedBytes;
 };
 
 class DBResultRow
@@ -118,9 +138,9 @@ public:
 protected:
     //for DBQueryResult
     friend class DBQueryResult;
-    void SetData( DBQueryResult* res, MYSQL_ROW& row, const unsigned long* lengths );
+    void SetData( DBQueryResult* res, const char* const* row, const unsigned long* lengths );
 
-    MYSQL_ROW mRow;
+    const char* const* mRow;
     const unsigned long* mLengths;
 
     DBQueryResult* mResult;
@@ -134,9 +154,48 @@ public:
 
     DBcore(bool compress=false, bool ssl=false);
     ~DBcore();
-    eStatus GetStatus() const { return pStatus; }
+    eStatus GetStatus() const { return mConnection.status; }
+
+    /**
+     * @brief Selects the database the server runs on.
+     *
+     * Must be called before Open(); the default is "mysql". The "sqlite"
+     * backend (if compiled in, see EVEMU_SQLITE_ENABLE) runs in-process on
+     * a database file, so benchmarks need no database server.
+     *
+     * @param[in] name Name of the backend, see DBBackend::Create().
+     *
+     * @return False if the backend is unknown; the current one is kept then.
+     */
+    bool SetBackend(const char* name);
+    const char* GetBackendName() const { return mConnection.backend->GetName(); }
+
+    /**
+     * @brief Gives the calling thread a database connection of its own.
+     *
+     * Until CloseThreadConnection(), queries run by the thread go through that
+     * connection instead of the shared one, so worker threads do not queue up
+     * behind each other (and the main loop) on a single connection. The
+     * connection uses the backend and the parameters passed to Open().
+     * An in-memory SQLite database cannot be opened twice, so with one the
+     * thread keeps using the shared connection.
+     */
+    bool OpenThreadConnection(DBerror &err);
+    /**
+     * @brief Closes the connection opened by OpenThreadConnection() of the calling thread.
+     */
+    void CloseThreadConnection();
+
+    /**
+     * @brief Runs all statements of an SQL dump file.
+     *
+     * Meant for filling an embedded database from the dumps in sql/;
+     * a MySQL server should be filled with the mysql client instead.
+     */
+    bool    LoadDump(DBerror &err, const char *file);
 
     //new shorter syntax:
+    //each of these first writes the rows DBWriteQueue holds for the tables the query names.
     //query which returns a result (error is stored in the result if it occurs)
     bool    RunQuery(DBQueryResult &into, const char *query_fmt, ...);
     //query which returns no information except error status
@@ -145,30 +204,77 @@ public:
     bool    RunQuery(DBerror &err, uint32 &affected_rows, const char *query_fmt, ...);
     //query which returns last insert ID:
     bool    RunQueryLID(DBerror &err, uint32 &last_insert_id, const char *query_fmt, ...);
+    /**
+     * @brief Query whose rows are streamed from the server rather than buffered.
+     *
+     * Same as RunQuery(DBQueryResult&, ...), but uses DBBackend::UseResult, so rows
+     * are fetched one by one as the consumer (DBResultToRowset, DBResultToCRowset, ...)
+     * asks for them and the whole result never sits in client memory. The connection
+     * stays locked until the last row has been fetched or the result is destroyed:
+     *  - the rows must be consumed right away, without running any other query
+     *    meanwhile; MySQL refuses it with "commands out of sync",
+     *  - every other thread using the same connection waits until then, so
+     *    threads which must not stall behind the main loop (DBWriteQueue, the
+     *    cache primers, the system loader) use OpenThreadConnection().
+     */
+    bool    RunQueryStream(DBQueryResult &into, const char *query_fmt, ...);
 
     //old style to be used with MakeAnyLengthString
-    bool    RunQuery(const char* query, int32 querylen, char* errbuf = 0, MYSQL_RES** result = 0, int32* affected_rows = 0, int32* last_insert_id = 0, int32* errnum = 0, bool retry = true);
+    bool    RunQuery(const char* query, int32 querylen, char* errbuf = 0, DBQueryResult* result = 0, int32* affected_rows = 0, int32* last_insert_id = 0, int32* errnum = 0, bool retry = true);
 
     int32   DoEscapeString(char* tobuf, const char* frombuf, int32 fromlen);
     void    DoEscapeString(std::string &to, const std::string &from);
     static bool IsSafeString(const char *str);
     void    ping();
+    /**
+     * @return True if given error number (see RunQuery) means the connection of the calling thread has been lost.
+     */
+    bool    IsConnectionLost(uint32 errNo);
+
+    /**
+     * @return Per-statement query statistics.
+     */
+    DBProfiler& profiler() { return mProfiler; }
+    /**
+     * @return Snapshot of static data; while open, RunQuery and RunQueryStream
+     *         answer the queries it holds without touching the database.
+     */
+    DBSnapshot& snapshot() { return mSnapshot; }
 
 //  static bool ReadDBINI(char *host, char *user, char *pass, char *db, int32 &port, bool &compress, bool *items);
     bool    Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum = 0, char* errbuf = 0, bool iCompress = false, bool iSSL = false);
     bool    Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress = false, bool iSSL = false);
 
-protected:
-    MYSQL*  getMySQL(){ return &mysql; }
-
 private:
-    //MDatabase must be locked before these calls:
-    bool    Open_locked(int32* errnum = 0, char* errbuf = 0);
-    bool    DoQuery_locked(DBerror &err, const char *query, int32 querylen, bool retry = true);
-
-    MYSQL   mysql;
-    Mutex   MDatabase;
-    eStatus pStatus;
+    /// A connection to the database and its state.
+    struct Connection
+    {
+        Connection() : backend(NULL), status(Closed) {}
+
+        DBBackend* backend;
+        /// Held while a query runs (or a streamed result is consumed).
+        Mutex   lock;
+        eStatus status;
+    };
+
+    /// @return Connection of the calling thread; the shared one unless it opened its own.
+    Connection& _GetConnection();
+
+    //the connection must be locked before these calls:
+    bool    Open_locked(Connection& conn, int32* errnum = 0, char* errbuf = 0);
+    bool    DoQuery_locked(Connection& conn, DBerror &err, const char *query, int32 querylen, bool retry = true);
+
+    /// The shared connection.
+    Connection mConnection;
+    /// Thread local slot holding connections opened by OpenThreadConnection().
+#ifdef WIN32
+    DWORD   mThreadConnection;
+#else
+    pthread_key_t mThreadConnection;
+#endif /* !WIN32 */
+
+    DBProfiler mProfiler;
+    DBSnapshot mSnapshot;
 
     std::string pHost;
     std::string pUser;
@@ -0,0 +1,99 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __DATABASE__DBMYSQL_H__INCL__
+#define __DATABASE__DBMYSQL_H__INCL__
+
+#include "database/dbbackend.h"
+
+/**
+ * @brief Result of a MySQL query.
+ */
+class DBMySQLResult
+: public DBResultSet
+{
+public:
+    /**
+     * @param[in] res      The result; ownership is taken.
+     * @param[in] streamed Whether the result has been obtained by mysql_use_result.
+     */
+    DBMySQLResult( MYSQL_RES* res, bool streamed );
+    ~DBMySQLResult();
+
+    uint32 ColumnCount() const { return mColumnCount; }
+    const char* ColumnName( uint32 index ) const { return mFields[ index ].name; }
+    DBTYPE ColumnType( uint32 index ) const;
+
+    bool IsUnsigned( uint32 index ) const;
+    bool IsBinary( uint32 index ) const;
+
+    bool FetchRow( const char* const*& row, const unsigned long*& lengths );
+    size_t RowCount() const { return (size_t)mysql_num_rows( mResult ); }
+    bool Rewind();
+
+protected:
+    MYSQL_RES* mResult;
+    MYSQL_FIELD* mFields;
+    uint32 mColumnCount;
+    bool mStreamed;
+
+    static const DBTYPE MYSQL_DBTYPE_TABLE_SIGNED[];
+    static const DBTYPE MYSQL_DBTYPE_TABLE_UNSIGNED[];
+};
+
+/**
+ * @brief Connection to a MySQL server.
+ */
+class DBMySQLBackend
+: public DBBackend
+{
+public:
+    DBMySQLBackend();
+    ~DBMySQLBackend();
+
+    const char* GetName() const { return "mysql"; }
+
+    bool Connect( DBerror& err, const char* host, const char* user, const char* password,
+                  const char* database, int16 port, bool compress, bool ssl );
+    void Close();
+    void Ping();
+
+    bool Execute( DBerror& err, const char* query, uint32 querylen );
+    bool IsConnectionLost( uint32 errNo ) const;
+
+    uint32 FieldCount();
+    DBResultSet* StoreResult( DBerror& err );
+    DBResultSet* UseResult( DBerror& err );
+
+    uint64 AffectedRows();
+    uint64 InsertID();
+
+    uint32 EscapeString( char* to, const char* from, uint32 fromlen );
+
+protected:
+    MYSQL mMySQL;
+};
+
+#endif /* !__DATABASE__DBMYSQL_H__INCL__ */
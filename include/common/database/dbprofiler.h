@@ -0,0 +1,168 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+#ifndef __DATABASE__DBPROFILER_H__INCL__
+#define __DATABASE__DBPROFILER_H__INCL__
+
+#include "threading/Mutex.h"
+
+/**
+ * @brief Per-statement query statistics.
+ *
+ * Queries are grouped by a fingerprint: the format string they were
+ * built from, or, for queries passed as finished strings, the query
+ * with its literals replaced by '?'. Format strings are looked up by
+ * a hash of their text first, so a profiled query costs hashing the
+ * format, one map lookup, two clock reads and an uncontended lock.
+ * The text rather than the address is hashed because some callers
+ * build their formats on the heap, where addresses get reused.
+ *
+ * Latencies are kept in a log-scale histogram (4 buckets per power of
+ * two microseconds), so p50/p99 are accurate to about 20%.
+ */
+class DBProfiler
+{
+public:
+    /// Number of latency histogram buckets.
+    static const size_t BUCKET_COUNT = 128;
+
+    /// Statistics of a single fingerprint.
+    struct Entry
+    {
+        Entry();
+
+        /// Estimates given percentile (0 - 100) of latency, in us.
+        uint64 Percentile( double pct ) const;
+        /// Average latency in us.
+        uint64 Average() const { return ( 0 < count ? totalTime / count : 0 ); }
+
+        std::string fingerprint;
+
+        /// Number of executions.
+        uint64 count;
+        /// Sum of latencies in us.
+        uint64 totalTime;
+        /// Highest latency in us.
+        uint64 maxTime;
+        /// Rows fetched by callers or affected by the statement.
+        uint64 rows;
+        /// Bytes of fetched column data.
+        uint64 bytes;
+
+        uint32 histogram[ BUCKET_COUNT ];
+    };
+
+    /// Columns a report may be sorted by.
+    enum SortKey
+    {
+        SortCount,
+        SortTotal,
+        SortAverage,
+        SortP99,
+        SortRows,
+        SortBytes
+    };
+
+    DBProfiler();
+
+    /**
+     * @brief Enables or disables collecting of statistics.
+     */
+    void SetEnabled( bool enabled ) { mEnabled = enabled; }
+    bool IsEnabled() const { return mEnabled; }
+
+    /**
+     * @brief Sets latency above which queries are logged; 0 disables the slow-query log.
+     *
+     * @param[in] threshold Threshold in ms.
+     */
+    void SetSlowQueryThreshold( uint32 threshold ) { mSlowQueryThreshold = threshold; }
+    uint32 GetSlowQueryThreshold() const { return mSlowQueryThreshold; }
+
+    /**
+     * @return Monotonic-enough time in us, for measuring latencies.
+     */
+    static uint64 GetMicroTime();
+
+    /**
+     * @brief Records an execution of a query.
+     *
+     * @param[in] format  Format string the query was built from; NULL if the query is a literal string.
+     * @param[in] query   The query as sent to the server (for the slow-query log and literal fingerprints).
+     * @param[in] elapsed Latency in us.
+     * @param[in] rows    Rows affected by the statement.
+     *
+     * @return Entry the fetched rows should be accounted to (see AddRows()); NULL if profiling is disabled.
+     */
+    Entry* Record( const char* format, const char* query, uint64 elapsed, uint64 rows );
+    /**
+     * @brief Accounts rows fetched from the result of a query.
+     */
+    void AddRows( Entry* entry, uint64 rows, uint64 bytes );
+
+    /**
+     * @brief Copies the statistics, sorted in descending order.
+     *
+     * @param[in]  key   Column to sort by.
+     * @param[in]  limit Maximal number of entries; 0 for all.
+     * @param[out] into  Where to store the entries.
+     */
+    void GetReport( SortKey key, size_t limit, std::vector<Entry>& into ) const;
+    /**
+     * @brief Writes a report into the log.
+     */
+    void Dump( SortKey key, size_t limit ) const;
+    /**
+     * @brief Zeroes all statistics.
+     */
+    void Reset();
+
+    /**
+     * @brief Parses name of a sort column ("count", "total", "avg", "p99", "rows", "bytes").
+     *
+     * @return True if the name is known.
+     */
+    static bool ParseSortKey( const char* name, SortKey& into );
+
+protected:
+    /// Builds fingerprint of a format string.
+    static void _FingerprintFormat( const char* format, std::string& into );
+    /// Builds fingerprint of a literal query.
+    static void _FingerprintQuery( const char* query, std::string& into );
+    /// Hashes text of a format string (FNV-1a).
+    static uint64 _HashFormat( const char* format );
+    static size_t _Bucket( uint64 elapsed );
+
+    mutable Mutex mMutex;
+
+    /// Fast lookup of format strings by hash of their text; cleared when it gets too large.
+    std::map<uint64, Entry*> mByFormat;
+    /// All entries by fingerprint; never erased, so Entry pointers stay valid.
+    std::map<std::string, Entry> mEntries;
+
+    volatile bool mEnabled;
+    volatile uint32 mSlowQueryThreshold;
+};
+
+#endif /* !__DATABASE__DBPROFILER_H__INCL__ */
@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __DATABASE__DBSNAPSHOT_H__INCL__
+#define __DATABASE__DBSNAPSHOT_H__INCL__
+
+#include "database/dbbackend.h"
+#include "threading/Mutex.h"
+
+/**
+ * @brief Read-only, memory-mapped copy of the results of static queries.
+ *
+ * A snapshot holds the complete result of each query it was built from,
+ * keyed by the query's format string (the one passed to DBcore::RunQuery).
+ * A format may end with "WHERE <column>=%u"; such a query is stored for
+ * all keys at once, sorted by the key, together with an index of the
+ * rows of each key.
+ *
+ * The file consists of fixed-layout records referring to each other by
+ * their offset in the file, so opening it means mapping it and checking
+ * its header and checksum; nothing is parsed or copied. Values are kept
+ * as NUL-terminated text, exactly as DBResultSet hands them out.
+ *
+ * Layout: Header, TableHeader[tableCount], the Column, Field and Key
+ * arrays of all tables, and the string pool.
+ */
+class DBSnapshot
+{
+public:
+    /// Version of the file layout; files of other versions are refused.
+    static const uint32 VERSION = 1;
+
+    DBSnapshot();
+    ~DBSnapshot();
+
+    /**
+     * @brief Runs given queries through sDatabase and writes their results into a snapshot file.
+     *
+     * @param[out] err     Error description on failure.
+     * @param[in]  file    Path of the file to write.
+     * @param[in]  formats Format strings of the queries.
+     * @param[in]  count   Number of formats.
+     */
+    static bool Build( std::string& err, const char* file, const char* const* formats, size_t count );
+
+    /**
+     * @brief Maps a snapshot file and verifies it.
+     */
+    bool Open( std::string& err, const char* file );
+    void Close();
+    bool IsOpen() const { return NULL != mData; }
+
+    /**
+     * @brief Answers a query from the snapshot.
+     *
+     * @param[in] format Format string of the query.
+     * @param[in] args   Arguments of the format; a keyed format consumes its key.
+     *
+     * @return Result of the query; NULL if the snapshot does not hold the query.
+     */
+    DBResultSet* Find( const char* format, va_list args );
+
+    /**
+     * @brief Writes number of uses of each table into the log.
+     *
+     * Tables which are never used usually mean the query text in the
+     * server no longer matches the one the snapshot has been built from.
+     */
+    void Dump() const;
+
+protected:
+    struct Header
+    {
+        char magic[ 8 ];
+        uint32 version;
+        uint32 size;
+        uint32 checksum;
+        uint32 tableCount;
+    };
+
+    struct TableHeader
+    {
+        uint32 format;
+        uint32 columnCount;
+        uint32 columns;
+        uint32 rowCount;
+        uint32 rows;
+        /// Number of distinct keys; 0 if the table is not keyed.
+        uint32 keyCount;
+        uint32 keys;
+    };
+
+    struct Column
+    {
+        uint32 name;
+        uint8 type;
+        uint8 isUnsigned;
+        uint8 isBinary;
+        uint8 unused;
+    };
+
+    struct Field
+    {
+        /// Offset of the value; 0 for NULL.
+        uint32 offset;
+        uint32 length;
+    };
+
+    struct Key
+    {
+        uint32 key;
+        uint32 firstRow;
+        uint32 rowCount;
+    };
+
+    class Result;
+
+    /// Entry of the format index: checksum of the format text and the table.
+    typedef std::pair<uint32, uint32> FormatIndexEntry;
+
+    /// Orders the key index.
+    static bool _KeyLess( const Key& key, uint32 value ) { return key.key < value; }
+    /// Orders the format index.
+    static bool _FormatLess( const FormatIndexEntry& entry, uint32 checksum ) { return entry.first < checksum; }
+    /// Checksum of a format text, as kept in the format index.
+    static uint32 _FormatChecksum( const char* format );
+    /// Splits a keyed format into the query returning all keys and the key column.
+    static bool _ParseFormat( const char* format, std::string& query, std::string& keyColumn );
+
+    const char* _String( uint32 offset ) const { return reinterpret_cast<const char*>( mData + offset ); }
+    template<typename T>
+    const T* _Array( uint32 offset ) const { return reinterpret_cast<const T*>( mData + offset ); }
+
+    const uint8* mData;
+    size_t mSize;
+#ifdef WIN32
+    HANDLE mFile;
+    HANDLE mMapping;
+#endif /* WIN32 */
+
+    const TableHeader* mTables;
+    /// Tables by checksum of their format, sorted; built by Open() and read without locking.
+    std::vector<FormatIndexEntry> mFormatIndex;
+
+    /// Protects the counters.
+    mutable Mutex mMutex;
+    std::vector<uint64> mHits;
+};
+
+#endif /* !__DATABASE__DBSNAPSHOT_H__INCL__ */
@@ -0,0 +1,144 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __DATABASE__DBSQLITE_H__INCL__
+#define __DATABASE__DBSQLITE_H__INCL__
+
+#ifdef EVEMU_SQLITE_ENABLE
+
+#include "database/dbbackend.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/**
+ * @brief Fully fetched result of an SQLite query.
+ *
+ * SQLite hands out values by column, so the rows are copied into a single
+ * buffer as text, which is what DBResultRow expects.
+ */
+class DBSQLiteResult
+: public DBResultSet
+{
+public:
+    DBSQLiteResult();
+
+    uint32 ColumnCount() const { return (uint32)mColumns.size(); }
+    const char* ColumnName( uint32 index ) const { return mColumns[ index ].name.c_str(); }
+    DBTYPE ColumnType( uint32 index ) const { return mColumns[ index ].type; }
+
+    bool IsUnsigned( uint32 index ) const { return mColumns[ index ].isUnsigned; }
+    bool IsBinary( uint32 index ) const { return DBTYPE_BYTES == mColumns[ index ].type; }
+
+    bool FetchRow( const char* const*& row, const unsigned long*& lengths );
+    size_t RowCount() const { return mRowCount; }
+    bool Rewind() { mNextRow = 0; return true; }
+
+protected:
+    friend class DBSQLiteBackend;
+
+    /// Copies all rows of given statement; returns the SQLite result code.
+    int _Fetch( sqlite3_stmt* stmt );
+
+    struct Column
+    {
+        std::string name;
+        DBTYPE type;
+        bool isUnsigned;
+    };
+    std::vector<Column> mColumns;
+
+    /// Values of all rows, each NUL-terminated.
+    std::string mData;
+    /// Offset of every value in mData; npos for NULL.
+    std::vector<size_t> mOffsets;
+    /// Length of every value.
+    std::vector<unsigned long> mLengths;
+
+    size_t mRowCount;
+    size_t mNextRow;
+
+    /// The row last returned by FetchRow().
+    std::vector<const char*> mRow;
+};
+
+/**
+ * @brief In-process SQLite database.
+ *
+ * Stand-in for MySQL on machines without a database server, meant for
+ * benchmarks and for telling query overhead from server CPU time. The
+ * database is a file (or ":memory:") given as the database name, usually
+ * filled from the dumps in sql/ by DBcore::LoadDump().
+ *
+ * MySQL dialect is translated where it is cheap to do so: string escapes,
+ * INSERT IGNORE, ON DUPLICATE KEY UPDATE, TRUNCATE, IF(), hex literals and the
+ * mysqldump flavour of CREATE TABLE; NOW(), UNIX_TIMESTAMP(), CONCAT(),
+ * GREATEST(), LEAST() and RAND() are provided as functions. Queries
+ * using other MySQL-only syntax fail like any other bad query.
+ */
+class DBSQLiteBackend
+: public DBBackend
+{
+public:
+    DBSQLiteBackend();
+    ~DBSQLiteBackend();
+
+    const char* GetName() const { return "sqlite"; }
+
+    bool Connect( DBerror& err, const char* host, const char* user, const char* password,
+                  const char* database, int16 port, bool compress, bool ssl );
+    void Close();
+    void Ping() {}
+
+    bool Execute( DBerror& err, const char* query, uint32 querylen );
+    bool IsConnectionLost( uint32 errNo ) const { return false; }
+
+    uint32 FieldCount() { return mFieldCount; }
+    DBResultSet* StoreResult( DBerror& err );
+    /// There is nothing to stream from an in-process database; same as StoreResult().
+    DBResultSet* UseResult( DBerror& err ) { return StoreResult( err ); }
+
+    uint64 AffectedRows() { return mAffectedRows; }
+    uint64 InsertID();
+
+protected:
+    bool _TranslateDumpStatement( std::string& statement );
+    /// Rewrites a CREATE TABLE of mysqldump; appends CREATE INDEX statements for its keys.
+    static void _TranslateCreateTable( std::string& statement );
+    /// Rewrites MySQL-only syntax of a query.
+    static void _TranslateQuery( const char* query, uint32 querylen, std::string& into );
+
+    void _FinalizePending();
+
+    sqlite3* mDB;
+    /// Statement whose rows wait for StoreResult().
+    sqlite3_stmt* mPending;
+    uint32 mFieldCount;
+    uint64 mAffectedRows;
+};
+
+#endif /* EVEMU_SQLITE_ENABLE */
+
+#endif /* !__DATABASE__DBSQLITE_H__INCL__ */
@@ -0,0 +1,269 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+#ifndef __DATABASE__DBWRITEQUEUE_H__INCL__
+#define __DATABASE__DBWRITEQUEUE_H__INCL__
+
+#include "threading/Mutex.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Write-behind queue for row updates.
+ *
+ * Callers queue whole rows identified by their primary key; a row queued
+ * again before it has been written replaces the pending one. A background
+ * thread flushes the pending rows once the oldest pending row reaches the
+ * flush interval or the queue reaches the batch size. Each table is written
+ * either with multi-row "INSERT ... ON DUPLICATE KEY UPDATE" statements or,
+ * for tables whose rows must already exist, with multi-row UPDATEs.
+ *
+ * Queries reading a table with pending rows go through FlushFor() first
+ * (DBcore does that for every query returning rows), so nobody reads rows
+ * older than what has been queued.
+ *
+ * Rows which cannot be written because the connection to the database
+ * is lost stay queued and are tried again once DBWRITEQUEUE_RETRY_DELAY
+ * has passed; only rows the database refuses are dropped.
+ *
+ * When the queue is not running (or the flush interval is 0) rows are
+ * written immediately, so tools which never call Start() keep working.
+ */
+class DBWriteQueue
+: public Singleton<DBWriteQueue>
+{
+public:
+    /// Handle of a table registered by AddTable().
+    typedef uint32 TableID;
+    /// Rows of a single table keyed by their key literals, sorted by key.
+    typedef std::map<std::string, std::string> RowMap;
+
+    /// Counters exposed for monitoring.
+    struct Stats
+    {
+        /// Rows currently pending.
+        uint32 depth;
+        /// Highest number of rows pending at once.
+        uint32 maxDepth;
+        /// Rows handed to Queue().
+        uint64 rowsQueued;
+        /// Rows which replaced a pending row of the same key.
+        uint64 rowsCoalesced;
+        /// Rows written to the database.
+        uint64 rowsWritten;
+        /// Rows dropped because the database refused them.
+        uint64 rowsFailed;
+        /// Rows kept queued because the connection to the database was lost.
+        uint64 rowsRetried;
+        /// Statements sent to the database.
+        uint64 statements;
+        /// Number of flushes.
+        uint32 flushes;
+        /// Duration of the last flush in ms.
+        uint32 lastFlushTime;
+        /// Longest flush in ms.
+        uint32 maxFlushTime;
+        /// Sum of all flush durations in ms.
+        uint64 totalFlushTime;
+    };
+
+    DBWriteQueue();
+    ~DBWriteQueue();
+
+    /**
+     * @brief Registers a table to be written through the queue.
+     *
+     * @param[in] table        Name of the table.
+     * @param[in] keyColumns   Comma separated list of primary key columns.
+     * @param[in] valueColumns Comma separated list of columns to update.
+     * @param[in] update       True to write the rows with UPDATE, which never creates
+     *                         a row (nor brings back a deleted one) and leaves the
+     *                         other columns alone; needs a single key column.
+     *
+     * @return Handle to be passed to Queue() and Discard().
+     */
+    TableID AddTable( const char* table, const char* keyColumns, const char* valueColumns, bool update = false );
+
+    /**
+     * @brief Starts the background flush thread.
+     *
+     * The thread writes through a database connection of its own
+     * (DBcore::OpenThreadConnection()), so it never waits for the main
+     * loop's queries or streamed results.
+     *
+     * @param[in] flushInterval Maximal age of a pending row in ms; 0 writes rows immediately.
+     * @param[in] batchSize     Number of pending rows which triggers a flush regardless of their age.
+     */
+    void Start( uint32 flushInterval, uint32 batchSize );
+    /**
+     * @brief Stops the background thread and writes all pending rows.
+     *
+     * If the connection is down, tries a few times before giving up on the rows.
+     */
+    void Stop();
+
+    /**
+     * @brief Queues a row.
+     *
+     * @param[in] table  Table handle.
+     * @param[in] key    Comma separated SQL literals of the key columns.
+     * @param[in] values Comma separated SQL literals of the value columns.
+     *
+     * @return False if the row was written through and failed; true once queued.
+     */
+    bool Queue( TableID table, const std::string& key, const std::string& values );
+    /**
+     * @brief Queues several rows of a table at once.
+     *
+     * When written through, all rows go out in a single statement.
+     *
+     * @param[in] table Table handle.
+     * @param[in] rows  Rows to queue.
+     *
+     * @return False if the rows were written through and any of them failed; true once queued.
+     */
+    bool Queue( TableID table, const RowMap& rows );
+    /**
+     * @brief Drops pending rows of a key which is about to be deleted.
+     *
+     * Drops the row with given key and all rows whose key starts with it
+     * (i.e. passing an itemID drops all (itemID, attributeID) rows).
+     * Waits for a flush in progress so the rows cannot be resurrected
+     * after the caller deletes them.
+     *
+     * @param[in] table Table handle.
+     * @param[in] key   Key (or key prefix) to drop.
+     */
+    void Discard( TableID table, const std::string& key );
+    /**
+     * @brief Checks whether rows of a key have not reached the database yet.
+     *
+     * @param[in] table Table handle.
+     * @param[in] key   Key (or key prefix), like for Discard().
+     *
+     * @return True if such a row is queued or the table is being written right now.
+     */
+    bool IsPending( TableID table, const std::string& key ) const;
+
+    /**
+     * @brief Writes all pending rows in the calling thread.
+     */
+    void Flush();
+    /**
+     * @brief Writes the pending rows of the tables a query reads.
+     *
+     * Called before a query is run; writes (in the calling thread) the
+     * pending rows of every table named in @a query, and waits for those
+     * being written right now. Does nothing if none are.
+     *
+     * @param[in] query The query about to be run.
+     */
+    void FlushFor( const char* query );
+
+    /**
+     * @brief Fills given struct with current counters.
+     */
+    void GetStats( Stats& into ) const;
+
+protected:
+    struct Table
+    {
+        std::string name;
+        std::string keyColumns;
+        std::string valueColumns;
+        /// The value columns one by one.
+        std::vector<std::string> columns;
+        /// Written with UPDATE rather than INSERT ... ON DUPLICATE KEY UPDATE.
+        bool update;
+        /// Prebuilt "INSERT ... VALUES " prefix.
+        std::string insertPrefix;
+        /// Prebuilt " ON DUPLICATE KEY UPDATE ..." suffix.
+        std::string updateSuffix;
+
+        RowMap rows;
+        /// Set while rows taken from this table are being written.
+        bool writing;
+    };
+    typedef std::vector<const RowMap::value_type*> RowBatch;
+
+    /**
+     * @brief Writes the rows of a single table; mMFlush must be locked.
+     *
+     * @param[in]  table     Table to write into.
+     * @param[in]  rows      Rows to write.
+     * @param[out] unwritten Rows not written because the connection is lost; those the database refused are dropped.
+     *
+     * @return False if any row was not written.
+     */
+    bool _WriteRows( const Table& table, const RowMap& rows, RowMap& unwritten );
+    /// Runs a statement; @a connectionLost tells whether a failure was the connection's fault.
+    static bool _Execute( const std::string& query, bool& connectionLost );
+    /// Builds the statement writing @a batch into @a table; false if a row does not fit the table.
+    bool _BuildStatement( const Table& table, const RowBatch& batch, std::string& into ) const;
+    /**
+     * @brief Takes pending rows and writes them.
+     *
+     * @param[in] tables Tables to write; all if NULL.
+     *
+     * @return False if the connection is lost; the rows not written stay queued then.
+     */
+    bool _Flush( const std::vector<bool>* tables = NULL );
+
+    /// Splits a list of SQL literals at the commas outside of quotes.
+    static void _SplitValues( const std::string& values, std::vector<std::string>& into );
+    /// Checks whether @a query names the table @a name.
+    static bool _Mentions( const char* query, const std::string& name );
+
+    static thread_return_t _FlushLoop( void* arg );
+    thread_return_t _FlushLoop();
+
+    /// Protects the tables and their pending rows.
+    mutable Mutex mMQueue;
+    /// Held while rows are written.
+    Mutex mMFlush;
+    /// Held by the background thread while it runs.
+    Mutex mMLoopRunning;
+
+    std::vector<Table> mTables;
+    /// Number of rows pending in all tables.
+    uint32 mDepth;
+    /// Tick at which the oldest pending row was queued.
+    uint32 mOldestQueued;
+    /// Set while the last flush found the connection lost; the background thread waits before the next one.
+    bool mConnectionLost;
+    /// Tick at which the connection was found lost.
+    uint32 mConnectionLostAt;
+
+    uint32 mFlushInterval;
+    uint32 mBatchSize;
+    volatile bool mRunning;
+    /// Set by the background thread once it holds mMLoopRunning.
+    volatile bool mLoopStarted;
+
+    Stats mStats;
+};
+
+#define sDBWriteQueue \
+    ( DBWriteQueue::get() )
+
+#endif /* !__DATABASE__DBWRITEQUEUE_H__INCL__ */
@@ -26,6 +26,28 @@
 #ifndef __SOCKET_H__INCL__
 #define __SOCKET_H__INCL__
 
+#ifdef WIN32
+/** One of the buffers of a gathering send; WSABUF on Windows. */
+typedef WSABUF sendvec_t;
+#else /* !WIN32 */
+/** One of the buffers of a gathering send; iovec elsewhere. */
+typedef iovec sendvec_t;
+#endif /* !WIN32 */
+
+/**
+ * @brief Points a sendvec_t at given bytes.
+ */
+inline void SetSendVec( sendvec_t& vec, const void* buf, size_t len )
+{
+#ifdef WIN32
+    vec.buf = (char*)buf;
+    vec.len = (ULONG)len;
+#else /* !WIN32 */
+    vec.iov_base = (void*)buf;
+    vec.iov_len = len;
+#endif /* !WIN32 */
+}
+
 /**
  * @brief Simple wrapper for sockets.
  *
@@ -42,6 +64,7 @@ public:
     unsigned int recv( void* buf, unsigned int len, int flags );
     unsigned int recvfrom( void* buf, unsigned int len, int flags, sockaddr* from, unsigned int* fromlen );
     unsigned int send( const void* buf, unsigned int len, int flags );
+    unsigned int sendv( const sendvec_t* vec, unsigned int count, int flags );
     unsigned int sendto( const void* buf, unsigned int len, int flags, const sockaddr* to, unsigned int tolen );
 
     int bind( const sockaddr* name, unsigned int namelen );
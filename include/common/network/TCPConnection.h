@@ -29,9 +29,12 @@
 #include "network/Socket.h"
 #include "threading/Mutex.h"
 #include "utils/Buffer.h"
+#include "utils/MappedFile.h"
 
 /** Size of error buffer TCPConnection uses. */
 static const uint32 TCPCONN_ERRBUF_SIZE = 1024;
+/** Most chunks of the send queue handed to the socket at once. */
+static const uint32 TCPCONN_SENDVEC_SIZE = 64;
 /** Size of receive buffer TCPConnection uses. */
 extern const uint32 TCPCONN_RECVBUF_SIZE;
 /** Time (in milliseconds) between periodical process for incoming/outgoing data. */
@@ -118,8 +121,34 @@ public:
      * @return True if data has been accepted, false if not.
      */
     bool Send( Buffer** data );
+    /**
+     * @brief Enqueues data to be sent, with slices of mapped files in between.
+     *
+     * The slices are sent straight from their mappings, without copying them.
+     *
+     * @param[in]     data   Buffer with data; pointer is invalidated by the function.
+     * @param[in,out] slices Slices to be sent, ordered by offset; their references are taken over and the list is cleared.
+     *
+     * @return True if data has been accepted, false if not.
+     */
+    bool Send( Buffer** data, std::vector<MappedSlice>& slices );
 
 protected:
+    /**
+     * @brief Bytes in the send queue.
+     */
+    struct SendChunk
+    {
+        /// The bytes not sent yet.
+        const uint8* data;
+        /// Number of the bytes not sent yet.
+        size_t length;
+        /// Buffer the bytes belong to, deleted once they are sent; NULL if a later chunk owns it or they are mapped.
+        Buffer* buffer;
+        /// Mapping the bytes belong to, released once they are sent; NULL if they are not mapped.
+        const MappedFile* file;
+    };
+
     /**
      * @brief Creates connection from an existing socket.
      *
@@ -217,7 +246,7 @@ protected:
     /** Mutex protecting send queue. */
     mutable Mutex mMSendQueue;
     /** Send queue. */
-    std::deque<Buffer*> mSendQueue;
+    std::deque<SendChunk> mSendQueue;
 
     /** Receive buffer. */
     Buffer* mRecvBuf;
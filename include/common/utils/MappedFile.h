@@ -0,0 +1,105 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __UTILS__MAPPED_FILE_H__INCL__
+#define __UTILS__MAPPED_FILE_H__INCL__
+
+#include "threading/Mutex.h"
+
+/**
+ * @brief Read-only mapping of a whole file.
+ *
+ * Reference-counted like RefObject, except that the count is guarded
+ * by a mutex: slices of the mapping sit in send queues and are released
+ * by the connection threads once they are sent.
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Maps a file.
+     *
+     * @param[in] filename File to map.
+     *
+     * @return The mapping, with one reference held by the caller; NULL if the file could not be mapped.
+     */
+    static MappedFile* Open( const std::string& filename );
+
+    /** @return The mapped contents of the file. */
+    const uint8* data() const { return mData; }
+    /** @return Size of the file. */
+    size_t size() const { return mSize; }
+
+    /**
+     * @brief Increments reference count of the mapping by one.
+     */
+    void IncRef() const;
+    /**
+     * @brief Decrements reference count of the mapping by one.
+     *
+     * The file is unmapped once the reference count reaches zero.
+     */
+    void DecRef() const;
+
+protected:
+    MappedFile( const uint8* data, size_t size );
+    ~MappedFile();
+
+    /// The mapped contents.
+    const uint8* const mData;
+    /// Size of the mapping.
+    const size_t mSize;
+
+    /// Protects mRefCount.
+    mutable Mutex mMRefCount;
+    /// Reference count of the mapping.
+    mutable size_t mRefCount;
+};
+
+/**
+ * @brief Bytes of a MappedFile to be sent in between the bytes of a Buffer.
+ *
+ * Every slice holds a reference to its mapping.
+ */
+struct MappedSlice
+{
+    /// Position in the Buffer the bytes go in front of.
+    size_t offset;
+    /// The mapping the bytes belong to.
+    const MappedFile* file;
+    /// The bytes.
+    const uint8* data;
+    /// Number of the bytes.
+    size_t length;
+};
+
+/**
+ * @brief Drops the references of given slices and clears the list.
+ *
+ * @param[in,out] slices Slices to release.
+ */
+extern void ReleaseSlices( std::vector<MappedSlice>& slices );
+
+#endif /* !__UTILS__MAPPED_FILE_H__INCL__ */
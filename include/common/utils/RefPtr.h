@@ -62,6 +62,14 @@ public:
         assert( 0 == mRefCount );
     }
 
+    /**
+     * @return Number of references currently held to the object.
+     */
+    size_t GetRefCount() const
+    {
+        return mRefCount;
+    }
+
 protected:
     /**
      * @brief Increments reference count of object by one.
@@ -54,6 +54,13 @@ uint64 filesize( const char* filename );
  */
 uint64 filesize( FILE* fd );
 
+/**
+ * @brief Obtains peak resident set size of the process.
+ *
+ * @return Highest amount of physical memory the process has used so far, in bytes; 0 if unknown.
+ */
+uint64 GetPeakMemoryUsage();
+
 /**
  * @brief Calculates next (greater or equal)
  *        power-of-two number.
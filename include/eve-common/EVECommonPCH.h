@@ -53,6 +53,7 @@
 #include "utils/Buffer.h"
 #include "utils/crc32.h"
 #include "utils/Deflate.h"
+#include "utils/MappedFile.h"
 #include "utils/misc.h"
 #include "utils/RefPtr.h"
 #include "utils/Singleton.h"
@@ -55,6 +55,41 @@ struct CacheFileHeader
 
 extern const uint32 CacheFileMagic;
 
+/**
+ * @brief Layout of cache.pack, which holds all cached objects in one file.
+ *
+ * The header is followed by the index entries and then by the object IDs
+ * and contents they point to (offsets are from the start of the file).
+ * The contents are stored as sent to the client: marshaled and deflated
+ * (unless too small to be worth it; see CachePackEntry::flags).
+ */
+#pragma pack(1)
+struct CachePackHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint32 count;
+    /// CRC-32 of everything after the header
+    uint32 checksum;
+    uint64 size;
+};
+
+struct CachePackEntry
+{
+    uint64 timestamp;
+    uint32 version;
+    uint32 name;
+    uint32 nameLength;
+    uint32 data;
+    uint32 length;
+    /// CachePackEntryDeflated if the content was deflated when it was written
+    uint32 flags;
+};
+#pragma pack()
+
+extern const uint32 CachePackMagic;
+extern const uint32 CachePackEntryDeflated;
+
 class CachedObjectMgr {
 public:
     ~CachedObjectMgr();
@@ -66,6 +101,10 @@ public:
     bool HaveCached(const PyRep *objectID) const;
 
     bool IsCacheUpToDate(const PyRep *objectID, uint32 version, uint64 timestamp);
+    /**
+     * @return Timestamp of the cached object; 0 if it is not cached.
+     */
+    uint64 GetCacheTimestamp(const std::string &objectID) const;
 
     void InvalidateCache(const PyRep *objectID);
 
@@ -73,6 +112,17 @@ public:
     void UpdateCacheFromSS(const std::string &objectID, PySubStream **in_cached_data);
     void UpdateCache(const std::string &objectID, PyRep **in_cached_data);
     void UpdateCache(const PyRep *objectID, PyRep **in_cached_data);
+    /**
+     * @brief Registers an object which has already been marshaled and deflated.
+     *
+     * Meant for objects built by other threads; an object which is already
+     * cached is kept, as it may be in use.
+     *
+     * @param[in] deflated Whether MarshalDeflate has deflated the stream.
+     *
+     * @return True if the object has been added, false if it was cached already.
+     */
+    bool AddCache(const std::string &objectID, Buffer **data, uint64 timestamp, uint32 version, bool deflated);
 
     PyObject *MakeCacheHint(const PyRep *objectID);
     PyObject *MakeCacheHint(const std::string &objectID);
@@ -96,6 +146,30 @@ public:
     bool SaveCachedToFile(const std::string &cacheDir, const std::string &objectID) const;
     bool SaveCachedToFile(const std::string &cacheDir, const PyRep *objectID) const;
 
+    /**
+     * @brief Reads a .cache file; touches no state, so any thread may call it.
+     */
+    static bool ReadCacheFile(const std::string &cacheDir, const std::string &objectID, CacheFileHeader &header, Buffer **into);
+    /**
+     * @brief Writes a .cache file; touches no state, so any thread may call it.
+     */
+    static bool WriteCacheFile(const std::string &cacheDir, const std::string &objectID, const CacheFileHeader &header, const Buffer &data);
+
+    /**
+     * @brief Loads all objects of cacheDir/cache.pack which are not cached yet.
+     *
+     * The pack is mapped and checked as a whole. The records reference
+     * their contents in the mapping, which stays until the last of them
+     * (and the last packet sending one) is gone.
+     *
+     * @return Number of objects loaded; 0 if there is no valid pack.
+     */
+    size_t LoadPack(const std::string &cacheDir);
+    /**
+     * @brief Writes all objects with a plain string ID into cacheDir/cache.pack.
+     */
+    bool SavePack(const std::string &cacheDir) const;
+
 protected:
     //static bool AddCachedFileContents(const char *filename, const char *oname, PySubStream *into);
     void GetCacheFileName(PyRep *key, std::string &into);
@@ -113,6 +187,7 @@ protected:
         uint64 timestamp;
         uint32 version;
         PyBuffer *cache; //we own this.
+        bool deflated;  //the cache is a deflated stream; so is marked the cache itself.
     };
     typedef std::map<std::string, CacheRecord *>    CachedObjMap;
     typedef CachedObjMap::iterator                  CachedObjMapItr;
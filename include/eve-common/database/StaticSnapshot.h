@@ -0,0 +1,70 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __STATIC_SNAPSHOT_H__INCL__
+#define __STATIC_SNAPSHOT_H__INCL__
+
+/*
+ * Static queries, by their callers. DBSnapshot matches queries by their
+ * format string, so the callers must run these constants and not copies.
+ */
+/** dgmtypeattributemgr: all type attributes. */
+extern const char STATIC_QUERY_TYPE_ATTRIBUTES[];
+/** StaticUniverse: celestials, with the faction of their solar system. */
+extern const char STATIC_QUERY_UNIVERSE_ITEMS[];
+/** StaticUniverse: regions. */
+extern const char STATIC_QUERY_REGIONS[];
+/** StaticUniverse: constellations. */
+extern const char STATIC_QUERY_CONSTELLATIONS[];
+/** StaticUniverse: solar systems. */
+extern const char STATIC_QUERY_SOLAR_SYSTEMS[];
+/** StaticUniverse: stations. */
+extern const char STATIC_QUERY_STATIONS[];
+/** InventoryDB: category by categoryID (%u). */
+extern const char STATIC_QUERY_CATEGORY[];
+/** InventoryDB: group by groupID (%u). */
+extern const char STATIC_QUERY_GROUP[];
+/** InventoryDB: type by typeID (%u). */
+extern const char STATIC_QUERY_TYPE[];
+/** InventoryDB: blueprint type by blueprintTypeID (%u). */
+extern const char STATIC_QUERY_BLUEPRINT_TYPE[];
+/** InventoryDB: ship type by shipTypeID (%u). */
+extern const char STATIC_QUERY_SHIP_TYPE[];
+/** InventoryDB: station type by stationTypeID (%u). */
+extern const char STATIC_QUERY_STATION_TYPE[];
+
+/**
+ * @brief Format strings of the queries compiled into the static data snapshot.
+ *
+ * eve-tool's "snapshot" command builds the snapshot from these; the server
+ * answers each query whose format string matches one of them byte for byte
+ * from the mapped file (see DBSnapshot). This is the list of the constants
+ * above; a query added there must be added here too to be snapshotted.
+ */
+extern const char* const STATIC_SNAPSHOT_QUERIES[];
+/** Number of queries in STATIC_SNAPSHOT_QUERIES. */
+extern const size_t STATIC_SNAPSHOT_QUERY_COUNT;
+
+#endif /* !__STATIC_SNAPSHOT_H__INCL__ */
@@ -44,12 +44,32 @@ extern bool Marshal( const PyRep* rep, Buffer& into );
  *
  * @param[in]  rep            Python object to marshal.
  * @param[out] into           Buffer which receives deflated marshaled stream.
- * @param[in]  deflationLimit The least size of buffer which gets deflated.
+ * @param[in]  deflationLimit The least size of buffer which gets deflated;
+ *                            PyBuffers marked as deflated do not count.
+ *
+ * The stream is appended to the current contents of @a into.
  *
  * @retval true  Marshaling ran successfully.
  * @retval false Error occured during marshaling.
  */
 extern bool MarshalDeflate( const PyRep* rep, Buffer& into, const uint32 deflationLimit = 0x2000 );
+/*
+ * @brief Deflated Marshal Stream builder which leaves mapped buffers in their mapping.
+ *
+ * The content of mapped PyBuffers is not copied into @a into but listed
+ * in @a slices, so TCPConnection::Send can send it from the mapping.
+ * If the stream gets deflated, the slices are copied in after all.
+ *
+ * @param[in]  rep            Python object to marshal.
+ * @param[out] into           Buffer which receives deflated marshaled stream.
+ * @param[out] slices         Empty list which receives the slices, in order.
+ * @param[in]  deflationLimit The least size of stream which gets deflated;
+ *                            PyBuffers marked as deflated do not count.
+ *
+ * @retval true  Marshaling ran successfully.
+ * @retval false Error occured during marshaling.
+ */
+extern bool MarshalDeflate( const PyRep* rep, Buffer& into, std::vector<MappedSlice>& slices, const uint32 deflationLimit = 0x2000 );
 
 /**
  * @brief Turns Python objects into marshal bytecode.
@@ -65,6 +85,13 @@ public:
 
     /** saves given rep to given buffer */
     bool Save( const PyRep* rep, Buffer& into );
+    /** saves given rep to given buffer, leaving big mapped PyBuffers to given slices */
+    bool Save( const PyRep* rep, Buffer& into, std::vector<MappedSlice>& slices );
+
+    /** @return Bytes of the last stream taken by PyBuffers marked as deflated; see PyBuffer::deflated(). */
+    size_t GetDeflatedSize() const { return mDeflatedSize; }
+    /** @return Bytes of the last stream left to slices. */
+    size_t GetSlicedSize() const { return mSlicedSize; }
 
 protected:
     /** saves new stream with given rep. */
@@ -142,8 +169,15 @@ private:
     void SaveVarInteger( const PyLong* v );
     // zero-compresses given buffer and adds it to the stream
     bool SaveZeroCompressed( const Buffer& data );
+    // marshals given rep as a sub stream right into the stream
+    bool SaveSubStream( const PyRep* rep );
 
     Buffer* mBuffer;
+    size_t mDeflatedSize;
+
+    /// slices of mappings; NULL if all content goes into mBuffer
+    std::vector<MappedSlice>* mSlices;
+    size_t mSlicedSize;
 };
 
 #endif
@@ -330,7 +330,8 @@ public:
  *
  * Usual binary buffer.
  * This buffer has immutable content; once allocated, it cannot
- * be changed.
+ * be changed. The content may be a slice of a MappedFile, which
+ * MarshalStream passes on to the send queue without copying it.
  */
 class PyBuffer : public PyRep
 {
@@ -343,12 +344,14 @@ public:
     /** Calls Buffer::Buffer( const Buffer& ). */
     PyBuffer( const Buffer& buffer );
 
-    /** Takes ownership of a passed Buffer. */
-    PyBuffer( Buffer** buffer );
+    /** Takes ownership of a passed Buffer; @a deflated marks a deflated stream. */
+    PyBuffer( Buffer** buffer, bool deflated = false );
     /** Copy constructor. */
     PyBuffer( const PyString& str );
     /** Copy constructor. */
     PyBuffer( const PyBuffer& oth );
+    /** References given bytes of a mapping, without copying them; @a deflated marks a deflated stream. */
+    PyBuffer( const MappedFile* file, const uint8* data, size_t len, bool deflated = false );
 
     //PyRep* Clone() const;
     bool visit( PyVisitor& v ) const;
@@ -356,9 +359,26 @@ public:
     /**
      * @brief Get the const PyBuffer content
      *
+     * @note The content of a mapped buffer is copied out of the mapping
+     *       on the first call; use data() and size() where that matters.
+     *
      * @return const PyBuffer content
      */
-    const Buffer& content() const { return *mValue; }
+    const Buffer& content() const;
+    /**
+     * @brief Get the bytes of the content, without copying them out of a mapping.
+     *
+     * @return The bytes; NULL if there are none.
+     */
+    const uint8* data() const;
+    /**
+     * @return The mapping the content lies in; NULL if it is on the heap.
+     */
+    const MappedFile* mapping() const { return mMapping; }
+    /**
+     * @return True if the content is a deflated stream (a cached object), which MarshalDeflate does not deflate again.
+     */
+    bool deflated() const { return mDeflated; }
 
     int32 hash() const;
 
@@ -372,8 +392,19 @@ public:
 protected:
     virtual ~PyBuffer();
 
-    const Buffer* const mValue;
+    /// The content; NULL for a mapped buffer until content() copies it.
+    mutable const Buffer* mValue;
     mutable int32 mHashCache;
+
+    /// The mapping the content lies in; we hold a reference to it.
+    const MappedFile* const mMapping;
+    /// The content within the mapping.
+    const uint8* const mMappedData;
+    /// Length of the content within the mapping.
+    const size_t mMappedSize;
+
+    /// Set by whoever deflated the content.
+    const bool mDeflated;
 };
 
 /**
@@ -989,7 +1020,7 @@ protected:
  * all together.
  */
 template<typename Iter>
-inline PyBuffer::PyBuffer( Iter first, Iter last ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( first, last ) ), mHashCache( -1 ) {}
+inline PyBuffer::PyBuffer( Iter first, Iter last ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( first, last ) ), mHashCache( -1 ), mMapping( NULL ), mMappedData( NULL ), mMappedSize( 0 ), mDeflated( false ) {}
 template<typename Iter>
 inline PyString::PyString( Iter first, Iter last ) : PyRep( PyRep::PyTypeString ), mValue( first, last ), mHashCache( -1 ) {}
 template<typename Iter>
@@ -24,10 +24,15 @@ class PyRep;
  * This is a class that kinda mimics how python polymorph's numbers.
  * VARIANT design style number class.
  *
+ * Layout: the value union followed by a one byte type tag, 9 bytes in
+ * total (it used to be 12 because of the enum sized tag). Construction,
+ * the accessors and same-type math are inline; only the mixed int/float
+ * cases go through the out-of-line slow path. Mixed math is done in
+ * double precision and results which are whole numbers turn back into
+ * integers, like before.
+ *
  * @author Captnoord.
  * @date Juni 2010
- * @todo try to create a performance test for this.
- * @todo complete the compare operator overloads.
  */
 
 class EvilNumber
@@ -39,48 +44,161 @@ public:
         int64 iVal;
     } GenVal;
 
-    EvilNumber();
-    EvilNumber(float val);
-    EvilNumber(int val);
-    EvilNumber(double val);
-    EvilNumber(int64 val);
-    EvilNumber(uint64 val);
-    
+    EvilNumber() : mType(evil_number_nan) { mValue.iVal = 0; }
+    EvilNumber(float val) : mType(evil_number_float) { mValue.fVal = val; }
+    EvilNumber(int val) : mType(evil_number_int) { mValue.iVal = val; }
+    EvilNumber(double val) : mType(evil_number_float) { mValue.fVal = val; }
+    EvilNumber(int64 val) : mType(evil_number_int) { mValue.iVal = val; }
+    /* this is tricky, as we only handle signed calculations.
+     * so this has the potentional to go wrong.
+     */
+    EvilNumber(uint64 val) : mType(evil_number_int) { mValue.iVal = (int64)val; }
+
     /************************************************************************/
     /* EvilNumber manipulation operator handlers                            */
+    /* @note these are friends so plain numbers work on either side.        */
     /************************************************************************/
-    EvilNumber operator*(const EvilNumber& val)
+    friend EvilNumber operator*(const EvilNumber& lhs, const EvilNumber& rhs)
     {
-        Multiply((EvilNumber &)val);
-        return *this;
+        if (lhs.mType == rhs.mType) {
+            if (lhs.mType == evil_number_float)
+                return EvilNumber(lhs.mValue.fVal * rhs.mValue.fVal);
+            if (lhs.mType == evil_number_int)
+                return EvilNumber(lhs.mValue.iVal * rhs.mValue.iVal);
+        }
+        return lhs._MultiplyMixed(rhs);
     }
 
-    EvilNumber operator/(const EvilNumber& val)
+    friend EvilNumber operator/(const EvilNumber& lhs, const EvilNumber& rhs)
     {
-        Divide((EvilNumber &)val);
-        return *this;
+        if (lhs.mType == rhs.mType) {
+            if (lhs.mType == evil_number_float)
+                return EvilNumber(lhs.mValue.fVal / rhs.mValue.fVal);
+            // make sure we can do things like 2 / 4 = 0.5
+            if (lhs.mType == evil_number_int && rhs.mValue.iVal != 0 && lhs.mValue.iVal % rhs.mValue.iVal == 0)
+                return EvilNumber(lhs.mValue.iVal / rhs.mValue.iVal);
+        }
+        return lhs._DivideMixed(rhs);
     }
 
-    EvilNumber operator+(const EvilNumber& val)
+    friend EvilNumber operator+(const EvilNumber& lhs, const EvilNumber& rhs)
     {
-        Add((EvilNumber &)val);
-        return *this;
+        if (lhs.mType == rhs.mType) {
+            if (lhs.mType == evil_number_float)
+                return EvilNumber(lhs.mValue.fVal + rhs.mValue.fVal);
+            if (lhs.mType == evil_number_int)
+                return EvilNumber(lhs.mValue.iVal + rhs.mValue.iVal);
+        }
+        return lhs._AddMixed(rhs);
     }
 
-    EvilNumber operator+=(const EvilNumber& val)
+    friend EvilNumber operator-(const EvilNumber& lhs, const EvilNumber& rhs)
     {
-        Add((EvilNumber &)val);
-        return *this;
+        if (lhs.mType == rhs.mType) {
+            if (lhs.mType == evil_number_float)
+                return EvilNumber(lhs.mValue.fVal - rhs.mValue.fVal);
+            if (lhs.mType == evil_number_int)
+                return EvilNumber(lhs.mValue.iVal - rhs.mValue.iVal);
+        }
+        return lhs._SubMixed(rhs);
     }
 
-    EvilNumber operator-(const EvilNumber& val)
+    EvilNumber& operator*=(const EvilNumber& val) { return *this = *this * val; }
+    EvilNumber& operator/=(const EvilNumber& val) { return *this = *this / val; }
+    EvilNumber& operator+=(const EvilNumber& val) { return *this = *this + val; }
+    EvilNumber& operator-=(const EvilNumber& val) { return *this = *this - val; }
+
+    /************************************************************************/
+    /* End of EvilNumber manipulation operator handlers                     */
+    /************************************************************************/
+
+    /************************************************************************/
+    /* dogma helpers                                                        */
+    /* @note modifiers (multipliers, resonances, bonuses) are plain doubles */
+    /* so these skip the type dispatch on the right hand side.             */
+    /************************************************************************/
+
+    /**
+     * @brief multiplies this by @a factor in place.
+     *
+     * @param[in] factor the multiplier, e.g. a damage resonance.
+     */
+    void Multiply(double factor)
     {
-        Sub((EvilNumber &)val);
-        return *this;
+        if (this->mType == evil_number_float)
+            this->mValue.fVal *= factor;
+        else
+            _MultiplySlow(factor);
     }
 
+    /**
+     * @brief adds @a amount to this in place.
+     *
+     * @param[in] amount the value to add.
+     */
+    void Add(double amount)
+    {
+        if (this->mType == evil_number_float)
+            this->mValue.fVal += amount;
+        else
+            _AddSlow(amount);
+    }
+
+    /**
+     * @brief multiply-add in one step, this = this * factor + amount.
+     */
+    void MultiplyAdd(double factor, double amount)
+    {
+        if (this->mType == evil_number_float)
+            this->mValue.fVal = this->mValue.fVal * factor + amount;
+        else {
+            _MultiplySlow(factor);
+            Add(amount);
+        }
+    }
+
+    /**
+     * @brief applies a percentage bonus in place, this = this * (1 + percent / 100).
+     *
+     * @param[in] percent the bonus in percent; negative values are penalties.
+     */
+    void AddPercent(double percent)
+    {
+        Multiply(1.0 + percent / 100.0);
+    }
+
+    /**
+     * @brief multiplies each of @a count values by @a factor.
+     *
+     * @param[in,out] values the array of values to modify.
+     * @param[in]     count  number of values in the array.
+     * @param[in]     factor the multiplier.
+     */
+    static void MultiplyAll(EvilNumber* values, size_t count, double factor);
+
+    /**
+     * @brief adds @a amount to each of @a count values.
+     *
+     * @param[in,out] values the array of values to modify.
+     * @param[in]     count  number of values in the array.
+     * @param[in]     amount the value to add.
+     */
+    static void AddAll(EvilNumber* values, size_t count, double amount);
+
+    /**
+     * @brief multiplies each of @a count values by the matching factor.
+     *
+     * This is the shape of the resistance math: damage per type times the
+     * resonance per type.
+     *
+     * @param[in,out] values  the array of values to modify.
+     * @param[in]     factors the multipliers, one per value.
+     * @param[in]     count   number of values in the arrays.
+     */
+    static void MultiplyEach(EvilNumber* values, const double* factors, size_t count);
+
     /************************************************************************/
-    /* End of EvilNumber manipulation operator handlers                     */
+    /* end of dogma helpers                                                 */
     /************************************************************************/
 
     /************************************************************************/
@@ -94,58 +212,28 @@ public:
      * @return will return true when this and val are equal
      * @note can I create 2 floats that would be equal when doing normal float compare and not equal when doing integer compare.
      */
-    bool operator==(const EvilNumber& val)
+    bool operator==(const EvilNumber& val) const
     {
-        if (this->mType == val.mType) {
+        if (this->mType == val.mType)
             return this->mValue.iVal == val.mValue.iVal;
-        } else {
-            // if parameter 1 is int then parameter 2 is float
-            if (this->mType == evil_number_int) {
-                return double(this->mValue.iVal) == val.mValue.fVal;
-            } else {
-                return this->mValue.fVal == double(val.mValue.iVal);
-            }
-        }
+        return this->_AsDouble() == val._AsDouble();
     }
 
-    bool operator!=(const EvilNumber& val)
+    bool operator!=(const EvilNumber& val) const
     {
-        // see comments from '==' operator.
-        if (this->mType == val.mType) {
-            return this->mValue.iVal != val.mValue.iVal;
-        } else {
-            // if parameter 1 is int then parameter 2 is float
-            if (this->mType == evil_number_int) {
-                return double(this->mValue.iVal) != val.mValue.fVal;
-            } else {
-                return this->mValue.fVal != double(val.mValue.iVal);
-            }
-        }
+        return !(*this == val);
     }
 
-    bool operator>(const EvilNumber& val)
+    bool operator<(const EvilNumber& val) const
     {
         if (this->mType == evil_number_int && val.mType == evil_number_int)
-            return this->mValue.iVal > val.mValue.iVal;
-        else if (this->mType == evil_number_float && val.mType == evil_number_float)
-            return this->mValue.fVal > val.mValue.fVal;
-        else if (this->mType == evil_number_float)
-            return this->mValue.fVal > float(val.mValue.iVal);
-        else
-            return float(this->mValue.iVal) > val.mValue.fVal;
+            return this->mValue.iVal < val.mValue.iVal;
+        return this->_AsDouble() < val._AsDouble();
     }
 
-    bool operator<=(const EvilNumber& val)
-    {
-        if (this->mType == evil_number_int && val.mType == evil_number_int)
-            return this->mValue.iVal <= val.mValue.iVal;
-        else if (this->mType == evil_number_float && val.mType == evil_number_float)
-            return this->mValue.fVal <= val.mValue.fVal;
-        else if (this->mType == evil_number_float)
-            return this->mValue.fVal <= float(val.mValue.iVal);
-        else
-            return float(this->mValue.iVal) <= val.mValue.fVal;
-    }
+    bool operator>(const EvilNumber& val) const { return val < *this; }
+    bool operator<=(const EvilNumber& val) const { return !(val < *this); }
+    bool operator>=(const EvilNumber& val) const { return !(*this < val); }
 
     /************************************************************************/
     /* End of EvilNumber logic logic operator handlers                      */
@@ -155,12 +243,12 @@ public:
  * @note: we need to add a file type (lets say .xx) to generate the code
  */
 #define LOGIC_OPERATOR(a, b) \
-    bool operator a ( b val) \
+    bool operator a ( b val) const \
     { \
         if (this->mType == evil_number_int) \
-            return this->mValue.iVal < val; \
+            return this->mValue.iVal a val; \
         else \
-            return this->mValue.fVal < double(val); \
+            return this->mValue.fVal a double(val); \
     }
 
 
@@ -185,14 +273,14 @@ public:
     /* not equal */
     LOGIC_OPERATOR( != , const uint32)
 
-    
+#undef LOGIC_OPERATOR
 
     /**
      * @brief converts the EvilNumber value into a string
      *
      * @return the text representative of the value.
      */
-    std::string to_str()
+    std::string to_str() const
     {
         char buff[32]; // max uint32 will result in a 10 char string, a float will result in a ? char string.
         if (mType == evil_number_int)
@@ -209,7 +297,7 @@ public:
      *
      * @return the python object of the EvilNumber.
      */
-    PyRep* GetPyObject();
+    PyRep* GetPyObject() const;
 
     /************************************************************************/
     /* old system support                                                   */
@@ -218,25 +306,47 @@ public:
     /* the math within the variant system to make sure we don't introduce   */
     /* extra errors into the math.( see warnings on get_int and get_float ) */
     /************************************************************************/
-    EVIL_NUMBER_TYPE get_type()
+    EVIL_NUMBER_TYPE get_type() const
     {
-        return mType;
+        return (EVIL_NUMBER_TYPE)mType;
     }
 
     bool to_int();
     bool to_float();
 
-    int64 get_int();
-    double get_float();
+    int64 get_int() const
+    {
+        if (mType == evil_number_int)
+            return mValue.iVal;
+        return _GetIntSlow();
+    }
+
+    double get_float() const
+    {
+        if (mType == evil_number_float)
+            return mValue.fVal;
+        return _GetFloatSlow();
+    }
     /************************************************************************/
     /* end of old system support                                            */
     /************************************************************************/
 
 private:
     GenVal mValue;
-    EVIL_NUMBER_TYPE mType;
+    /* EVIL_NUMBER_TYPE, kept in a byte so the packed size stays at 9 */
+    uint8 mType;
 
 protected:
+    /**
+     * @brief the value as double; no warnings, nan counts as 0.
+     */
+    double _AsDouble() const
+    {
+        if (mType == evil_number_float)
+            return mValue.fVal;
+        return double(mValue.iVal);
+    }
+
     /**
      * @brief check if its possible a integer and do the conversion
      *
@@ -245,38 +355,21 @@ protected:
      */
     void CheckIntegrety();
 
-    /**
-     * @brief multiply this with @a
-     *
-     * Multiply this with @a.
-     *
-     * @param[in] val the value we are multiplying with.
-     */
-    void Multiply(EvilNumber & val);
-
-    /**
-     * @brief divide this with @a
-     *
-     * Divide this with @a.
-     *
-     * @param[in] val the value we are dividing by.
-     * @todo handle "int(2) / int(4) = float(0.5)" in a fast enough way
-     */
-    void Divide(EvilNumber & val);
+    /* the slow paths, kept out of line so the fast paths stay small enough to inline */
+    EvilNumber _MultiplyMixed(const EvilNumber& val) const;
+    EvilNumber _DivideMixed(const EvilNumber& val) const;
+    EvilNumber _AddMixed(const EvilNumber& val) const;
+    EvilNumber _SubMixed(const EvilNumber& val) const;
 
-    // todo double check this..
-    void Add(EvilNumber & val);
+    void _MultiplySlow(double factor);
+    void _AddSlow(double amount);
 
-    // todo double check this..
-    void Sub(EvilNumber & val);
+    int64 _GetIntSlow() const;
+    double _GetFloatSlow() const;
 };
 
 #pragma pack(pop)
 
-//////////////////////////////////////////////////////////////////////////
-// global operators
-EvilNumber operator*(const EvilNumber& val, const EvilNumber& val2);
-
 extern const EvilNumber EvilTime_Second;
 extern const EvilNumber EvilTime_Minute;
 extern const EvilNumber EvilTime_Hour;
@@ -250,12 +250,14 @@ protected:
 	//this whole move system is a piece of crap:
 	typedef enum {
 		msIdle,
-		msJump
+		msJump,
+		msJumpPending	//waiting for the destination to be booted
 	} _MoveState;
 	void _postMove(_MoveState type, uint32 wait_ms=500);
 	_MoveState m_moveState;
 	Timer m_moveTimer;
 	uint32 m_moveSystemID;
+	uint32 m_jumpPendingSince;	//tick count, 0 if not waiting
 	GPoint m_movePoint;
     uint32 m_dockStationID;
 	void _ExecuteJump();
@@ -60,6 +60,8 @@ public:
     // From <database/>
     struct
     {
+        /// Database backend: "mysql" or "sqlite" (if compiled in).
+        std::string backend;
         /// Hostname of database server.
         std::string host;
         /// A port at which the database server listens.
@@ -68,8 +70,30 @@ public:
         std::string username;
         /// Password for the database account.
         std::string password;
-        /// A database to be used by server.
+        /// A database to be used by server; path of the database file for sqlite.
         std::string db;
+        /// Semicolon separated SQL dumps loaded into the database at startup (meant for sqlite).
+        std::string dumps;
+        /// Maximal delay of write-behind rows in ms; 0 writes them immediately.
+        uint32 flushInterval;
+        /// Number of pending write-behind rows which triggers a flush.
+        uint32 flushBatchSize;
+        /// Whether to collect per-statement query statistics.
+        bool profileQueries;
+        /// Queries slower than this (in ms) are logged; 0 disables the slow-query log.
+        uint32 slowQueryThreshold;
+        /// Whether to keep the static universe tables (map, stations) in memory.
+        bool cacheStaticUniverse;
+        /// Number of cached items above which unreferenced items are evicted; 0 for no limit.
+        uint32 itemCacheMaxItems;
+        /// Estimated memory of cached items (in MB) above which unreferenced items are evicted; 0 for no limit.
+        uint32 itemCacheMaxMemory;
+        /// Number of threads (each with its own connection) priming cached objects at startup; 0 primes them on the main thread.
+        uint32 cachePrimeThreads;
+        /// Whether to accept logins once the objects sent at login are primed, priming the rest in background.
+        bool cachePrimeInBackground;
+        /// How often (in seconds) to look for changed tables and regenerate the cached objects built from them; 0 disables it.
+        uint32 cacheRefreshInterval;
     } database;
 
     // From <files/>
@@ -81,6 +105,8 @@ public:
         std::string logSettings;
         /// A directory at which the cache files should be stored.
         std::string cacheDir;
+        /// Static data snapshot built by eve-tool's "snapshot" command; empty to query the database.
+        std::string staticSnapshot;
 		// used as the base directory for the image server
 		std::string imageDir;
     } files;
@@ -94,6 +120,13 @@ public:
 		std::string imageServer;
     } net;
 
+    /// From <world/>
+    struct
+    {
+        /// Seconds without clients after which a solar system is torn down (booted again when needed); 0 keeps every system up.
+        uint32 systemIdleTimeout;
+    } world;
+
 protected:
     bool ProcessEveServer( const TiXmlElement* ele );
 
@@ -102,6 +135,7 @@ protected:
     bool ProcessDatabase( const TiXmlElement* ele );
     bool ProcessFiles( const TiXmlElement* ele );
     bool ProcessNet( const TiXmlElement* ele );
+    bool ProcessWorld( const TiXmlElement* ele );
 };
 
 /// A macro for easier access to the singleton.
@@ -49,6 +49,7 @@
 /* common includes                                                      */
 /************************************************************************/
 #include "database/dbcore.h"
+#include "database/dbwritequeue.h"
 
 #include "log/LogNew.h"
 #include "log/logsys.h"
@@ -63,6 +64,7 @@
 #include "utils/Deflate.h"
 #include "utils/EvilNumber.h"
 #include "utils/gpoint.h"
+#include "utils/MappedFile.h"
 #include "utils/misc.h"
 #include "utils/RefPtr.h"
 #include "utils/Seperator.h"
@@ -81,6 +83,7 @@
 #include "cache/CachedObjectMgr.h"
 
 #include "database/EVEDBUtils.h"
+#include "database/StaticSnapshot.h"
 
 #include "destiny/DestinyBinDump.h"
 #include "destiny/DestinyStructs.h"
@@ -190,6 +193,7 @@
 
 // server config stuff
 #include "config/ConfigDB.h"
+#include "config/ConfigCache.h"
 #include "config/ConfigService.h"
 #include "config/LanguageService.h"
 
@@ -219,6 +223,7 @@
 #include "inventory/ItemRef.h"
 #include "inventory/ItemType.h"
 #include "inventory/Owner.h"
+#include "inventory/StaticUniverse.h"
 
 // factory stuff
 #include "manufacturing/Blueprint.h"
@@ -270,6 +275,7 @@
 #include "system/SystemEntities.h"
 #include "system/SystemEntity.h"
 #include "system/SystemManager.h"
+#include "system/TicProfiler.h"
 
 #include "ship/ModuleManager.h"
 #include "ship/BeyonceService.h"
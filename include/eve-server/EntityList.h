@@ -58,10 +58,38 @@ class EntityList
 : public Singleton<EntityList>
 {
 public:
+	/**
+	 * Counters of the solar system managers.
+	 */
+	struct SystemStats
+	{
+		/// systems booted and not hibernated
+		uint32 live;
+		/// estimated memory held by the live systems, see SystemManager::GetMemoryUsage()
+		uint64 liveBytes;
+		/// boots, including those of systems woken up again
+		uint32 boots;
+		/// boots started ahead of a jump by PrefetchSystem()
+		uint32 prefetches;
+		/// idle systems torn down
+		uint32 hibernations;
+		/// time the main loop spent in SystemManager::BootSystem(), in us
+		uint64 totalBootTime;
+		uint64 lastBootTime;
+		uint64 maxBootTime;
+		/// time the loader spent in SystemManager::LoadSystem() for the boots above, in us; the main loop goes on meanwhile
+		uint64 totalLoadTime;
+		uint64 maxLoadTime;
+	};
+
 	EntityList();
 	virtual ~EntityList();
 
 	void UseServices(PyServiceMgr *svc) { m_services = svc; }
+	/**
+	 * @param[in] idleTimeout Seconds without clients after which a system is hibernated; 0 never hibernates.
+	 */
+	void SetSystemIdleTimeout(uint32 idleTimeout) { m_systemIdleTimeout = idleTimeout; }
 
 	typedef std::set<uint32> character_set;
 	
@@ -78,6 +106,17 @@ public:
 	uint32 GetClientCount() const { return(uint32(m_clients.size())); }
 
 	SystemManager *FindOrBootSystem(uint32 systemID);
+	//boots the system within the next passes of Process(), ahead of a client going there;
+	//its DB reads are done by the loader thread if it runs.
+	void PrefetchSystem(uint32 systemID);
+	//true while the loader reads the system for PrefetchSystem(); worth waiting for rather than calling FindOrBootSystem().
+	bool IsSystemBooting(uint32 systemID) const;
+	//starts and stops the loader thread; without it the prefetched systems are read on the main thread.
+	void StartLoader();
+	void StopLoader();
+	void GetSystemStats(SystemStats &into) const;
+	//depops the NPCs of all systems; on shutdown, while the item factory and the DB are still there.
+	void DepopNPCs();
 
 	void Broadcast(const char *notifyType, const char *idType, PyTuple **payload) const;
 	void Broadcast(const PyAddress &dest, EVENotificationStream &noti) const;
@@ -93,6 +132,30 @@ protected:
 	client_list m_clients;
 	typedef std::map<uint32, SystemManager *> system_list;
 	system_list m_systems;
+	std::set<uint32> m_prefetchSystems;	//booted one per Process().
+	
+	struct SystemLoad;	//a system being read by the loader
+	typedef std::map<uint32, SystemLoad *> load_list;
+	load_list m_loads;	//queued, being read or waiting for Process(); we own these
+	std::deque<SystemLoad *> m_loadQueue;	//not yet taken by the loader
+	mutable Mutex m_loadLock;	//guards the two above and SystemLoad::done
+	Mutex m_loaderRunning;	//held by the loader thread while it runs
+	volatile bool m_loading;
+	volatile bool m_loaderStarted;	//set by the loader once it holds m_loaderRunning
+	
+	static thread_return_t _LoaderLoop(void *arg);
+	thread_return_t _LoaderLoop();
+	//boots a system read by the loader, if any.
+	void _BootLoadedSystem();
+	
+	//load carries what the loader read, NULL to read it right here.
+	SystemManager *_BootSystem(uint32 systemID, SystemLoad *load = NULL);
+	//tears down the systems which had no clients for m_systemIdleTimeout.
+	void _HibernateIdleSystems();
+	
+	uint32 m_systemIdleTimeout;	//in seconds, 0 for never
+	Timer m_hibernateTimer;
+	SystemStats m_systemStats;
 
 	Mutex mMutex;
 
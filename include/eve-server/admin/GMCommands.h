@@ -59,6 +59,20 @@ COMMAND( unban, ROLE_ADMIN,
 		"(charName) - removes ban on player's account")
 COMMAND( kenny, ROLE_ADMIN,
         "(ON,OFF,0,1) - enable/disable the Kenny Translator for your chatting entertainment!")
+COMMAND( dbprofile, ROLE_ADMIN,
+        "([count|total|avg|p99|rows|bytes] [limit] | reset) - shows per-statement query statistics sorted by given column (total by default), or clears them." )
+COMMAND( dbqueue, ROLE_ADMIN,
+        "(flush) - shows statistics of the DB write-behind queue and attribute saves, optionally flushing the queue first." )
+COMMAND( itemcache, ROLE_ADMIN,
+        "(evict) - shows statistics of the item cache, optionally evicting every unreferenced item first." )
+COMMAND( tablechanged, ROLE_ADMIN,
+        "(table) [table ...] - records a manual edit of DB tables, so the cached objects built from them get regenerated." )
+COMMAND( configcache, ROLE_ADMIN,
+        "(flush) - shows statistics of the owner/location name cache, optionally flushing it first." )
+COMMAND( bubbles, ROLE_ADMIN,
+        "- shows statistics of the bubbles of your solar system." )
+COMMAND( systems, ROLE_ADMIN,
+        "- shows statistics of the live solar systems, their boots and hibernations." )
 /*COMMAND( entity, ROLE_ADMIN,
 		"(entityID) - unknown" )
 COMMAND( chatban, ROLE_ADMIN,
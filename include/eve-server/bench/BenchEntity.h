@@ -0,0 +1,95 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __BENCH__BENCHENTITY_H__INCL__
+#define __BENCH__BENCHENTITY_H__INCL__
+
+#include "system/SystemEntity.h"
+
+/**
+ * @brief A ship in space without an item, database or client behind it.
+ *
+ * It only moves where the benchmark puts it. Destiny updates and
+ * events sent to it are counted, not delivered.
+ */
+class BenchEntity
+: public SystemEntity
+{
+public:
+    BenchEntity( uint32 id, const GPoint& position );
+
+    void SetPosition( const GPoint& position ) { mPosition = position; }
+    void SetVelocity( const GVector& velocity ) { mVelocity = velocity; }
+
+    /** @return Number of destiny updates received. */
+    uint64 GetUpdateCount() const { return mUpdates; }
+    /** @return Number of destiny events received. */
+    uint64 GetEventCount() const { return mEvents; }
+    void ResetCounters() { mUpdates = mEvents = 0; }
+
+    /*
+     * SystemEntity interface
+     */
+    void ProcessDestiny() {}
+
+    bool IsStaticEntity() const { return false; }
+
+    void QueueDestinyUpdate( PyTuple** du );
+    void QueueDestinyEvent( PyTuple** multiEvent );
+
+    uint32 GetID() const { return mID; }
+    const GPoint& GetPosition() const { return mPosition; }
+    const GVector& GetVelocity() const { return mVelocity; }
+    const char* GetName() const { return mName.c_str(); }
+    double GetRadius() const { return 40.0; }
+
+    InventoryItemRef Item() const { return InventoryItemRef(); }
+    SystemManager* System() const { return NULL; }
+
+    void EncodeDestiny( Buffer& into ) const;
+    PyDict* MakeSlimItem() const;
+    void MakeDamageState( DoDestinyDamageState& into ) const;
+
+    void TargetAdded( SystemEntity* who ) {}
+    void TargetLost( SystemEntity* who ) {}
+    void TargetedAdd( SystemEntity* who ) {}
+    void TargetedLost( SystemEntity* who ) {}
+    void TargetsCleared() {}
+
+    void ApplyDamageModifiers( Damage& d, SystemEntity* target ) {}
+    bool ApplyDamage( Damage& d ) { return false; }
+
+protected:
+    const uint32 mID;
+    std::string mName;
+
+    GPoint mPosition;
+    GVector mVelocity;
+
+    uint64 mUpdates;
+    uint64 mEvents;
+};
+
+#endif /* !__BENCH__BENCHENTITY_H__INCL__ */
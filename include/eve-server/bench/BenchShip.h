@@ -0,0 +1,99 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __BENCH__BENCHSHIP_H__INCL__
+#define __BENCH__BENCHSHIP_H__INCL__
+
+#include "bench/BenchEntity.h"
+
+/**
+ * @brief A ship of a system, moved by its DestinyManager.
+ *
+ * It has no item or client behind it. A ship which stands in for
+ * a client queues the destiny updates it receives the way Client
+ * does; SendQueuedUpdates() then marshals them and counts the bytes
+ * instead of sending them. Other ships drop the updates like NPCs.
+ */
+class BenchShip
+: public BenchEntity
+{
+public:
+    /**
+     * @param[in] system   System the ship flies in; the ship is not added to it.
+     * @param[in] position Where the ship starts.
+     * @param[in] client   Whether the ship stands in for a client.
+     */
+    BenchShip( uint32 id, SystemManager* system, const GPoint& position, bool client );
+    ~BenchShip();
+
+    DestinyManager* Destiny() const { return mDestiny; }
+    bool HasClient() const { return mClient; }
+
+    /**
+     * @brief Marshals the updates queued since the last call, as Client does once per loop.
+     */
+    void SendQueuedUpdates();
+
+    /** @return Number of marshaled bytes. */
+    uint64 GetBytesSent() const { return mBytesSent; }
+    /** @return Number of notifications marshaled. */
+    uint64 GetPacketsSent() const { return mPacketsSent; }
+
+    /**
+     * @brief Advances the destiny stamp by one tic.
+     *
+     * The server advances it every second of wall time; benchmarks
+     * run their tics as fast as they can.
+     */
+    static void NextTic();
+
+    /*
+     * SystemEntity interface
+     */
+    void ProcessDestiny();
+
+    void QueueDestinyUpdate( PyTuple** du );
+    void QueueDestinyEvent( PyTuple** multiEvent );
+
+    const GPoint& GetPosition() const { return mDestiny->GetPosition(); }
+    const GVector& GetVelocity() const { return mDestiny->GetVelocity(); }
+
+    PyDict* MakeSlimItem() const;
+
+    SystemManager* System() const { return mSystem; }
+
+protected:
+    SystemManager* const mSystem;
+    DestinyManager* mDestiny;
+
+    const bool mClient;
+    PyList* mUpdateQueue;
+    PyList* mEventQueue;
+
+    uint64 mBytesSent;
+    uint64 mPacketsSent;
+};
+
+#endif /* !__BENCH__BENCHSHIP_H__INCL__ */
@@ -0,0 +1,152 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __BENCH__BENCHMARKS_H__INCL__
+#define __BENCH__BENCHMARKS_H__INCL__
+
+/** Struct describing one eve-bench scenario. */
+struct EVEBenchmark
+{
+    /** Name of the scenario; for invocation. */
+    const char* name;
+    /** Callback; what to run. */
+    void ( *callback )( const Seperator& cmd );
+    /** Description of the scenario. */
+    const char* description;
+};
+
+/** Array of all available scenarios. */
+extern const EVEBenchmark EVEBENCH_BENCHMARKS[];
+/** Number of available scenarios. */
+extern const size_t EVEBENCH_BENCHMARK_COUNT;
+
+/**
+ * @brief Finds a scenario.
+ *
+ * @param[in] name Name of the scenario.
+ *
+ * @return Found scenario; NULL if not found.
+ */
+const EVEBenchmark* FindBenchmark( const std::string& name );
+
+/**
+ * @brief Deterministic random numbers, so runs can be compared.
+ */
+class BenchRandom
+{
+public:
+    BenchRandom( uint32 seed = 1 ) : mState( seed ) {}
+
+    /** @return Random number in range [low, high). */
+    double Next( double low = 0.0, double high = 1.0 )
+    {
+        mState = mState * 1664525U + 1013904223U;
+        return low + ( high - low ) * ( mState >> 8 ) / double( 1 << 24 );
+    }
+
+    /** @return Random point in a cube of given half-size around origin. */
+    GPoint NextPoint( double extent )
+    {
+        const double x = Next( -extent, extent );
+        const double y = Next( -extent, extent );
+        return GPoint( x, y, Next( -extent, extent ) );
+    }
+
+protected:
+    uint32 mState;
+};
+
+/**
+ * @return Microseconds elapsed since given Win32 time.
+ */
+inline double BenchElapsed( uint64 start )
+{
+    // Win32 time is in units of 100 ns
+    return double( Win32TimeNow() - start ) / 10.0;
+}
+
+/**
+ * @return Number of allocations made with operator new so far.
+ */
+uint64 BenchAllocations();
+
+/**
+ * @return Bytes currently allocated with operator new, without the overhead of malloc.
+ */
+uint64 BenchAllocatedBytes();
+
+/**
+ * @brief Reads the resident set size of the process.
+ *
+ * @param[out] current Current RSS in KiB; 0 if unknown.
+ * @param[out] peak    Peak RSS in KiB; 0 if unknown.
+ */
+void BenchRSS( uint64& current, uint64& peak );
+
+/**
+ * @brief Reads the CPU time (user and system) used so far.
+ *
+ * @param[out] process Microseconds used by the whole process; 0 if unknown.
+ * @param[out] thread  Microseconds used by the calling thread; 0 if unknown.
+ */
+void BenchCPUTime( uint64& process, uint64& thread );
+
+/**
+ * @brief Opens a SQLite database, in memory by default, and runs given statements on it.
+ *
+ * @param[in] cmdName        Name of the scenario; for logging.
+ * @param[in] statements     Statements setting up the tables the scenario reads.
+ * @param[in] statementCount Number of the statements.
+ * @param[in] database       File of the database; ":memory:" for one in memory.
+ *
+ * @retval true  The database is open and set up.
+ * @retval false Failed; the reason has been logged.
+ */
+bool BenchOpenDatabase( const char* cmdName, const char* const statements[], size_t statementCount, const char* database = ":memory:" );
+
+/** Bubble lookup and placement in a large system. */
+void BubbleBenchmark( const Seperator& cmd );
+/** Ships warping between many points; bubble reclamation and merging. */
+void BubbleSoakBenchmark( const Seperator& cmd );
+/** Destiny integration of GOTO, STOP and ORBIT balls, one by one. */
+void DestinyBenchmark( const Seperator& cmd );
+/** Destiny tics of a whole system with scripted ships; phase timings and bytes per client. */
+void SimulationBenchmark( const Seperator& cmd );
+/** Waves of NPCs killed all at once; entity list churn within a pass. */
+void WaveBenchmark( const Seperator& cmd );
+/** Building SetState and AddBalls for ships entering a crowded bubble. */
+void SetStateBenchmark( const Seperator& cmd );
+/** Loading a large station hangar one item at a time, compared with loading it a location level at a time. */
+void HangarBenchmark( const Seperator& cmd );
+/** Items of a loaded station's hangar evicted and reloaded while their saves sit in DBWriteQueue; checks nothing is lost. */
+void EvictSoakBenchmark( const Seperator& cmd );
+/** Building the type attribute table and loading items of a few types; throughput and memory. */
+void ItemLoadBenchmark( const Seperator& cmd );
+/** Loading the static data at startup from the database and from the snapshot, cold and warm; time and RSS. */
+void StartupBenchmark( const Seperator& cmd );
+/** Replies with cached objects to many clients logging in at once, from heap buffers and from the mapped pack; CPU and RSS. */
+void LoginBenchmark( const Seperator& cmd );
+
+#endif /* !__BENCH__BENCHMARKS_H__INCL__ */
@@ -38,11 +38,37 @@ public:
 	ObjCacheDB();
 	
 	PyRep *GetCachableObject(const std::string &type);
-	
+
+	/**
+	 * @return Tables the object is generated from; NULL if it has no generator.
+	 */
+	const std::vector<std::string> *GetObjectTables(const std::string &objectID) const;
+	/**
+	 * @return Objects generated from the table; NULL if there are none.
+	 */
+	const std::vector<std::string> *GetTableObjects(const char *table) const;
+
+	/**
+	 * Reads the last change time (Win32 time) of every table recorded in cacheTableChanges.
+	 */
+	bool GetTableChanges(std::map<std::string, uint64> &into);
+	/**
+	 * Records a change of the table in cacheTableChanges, so the objects generated
+	 * from it are regenerated (right away, and on the next start if they were saved).
+	 */
+	bool MarkTableChanged(const char *table);
+
 protected:
 	typedef PyRep *(ObjCacheDB::* genFunc)();
 	std::map<std::string, genFunc> m_generators;
 
+	/// table names are kept in lower case
+	static std::string _TableKey(const char *table);
+	static std::string _TableKey(const std::string &table) { return _TableKey(table.c_str()); }
+
+	std::map<std::string, std::vector<std::string> > m_objectTables;
+	std::map<std::string, std::vector<std::string> > m_tableObjects;
+
 	//hack:
 	PyRep *DBResultToRowsetTuple(DBQueryResult &result);
 	
@@ -45,16 +45,48 @@ public:
 	ObjCacheService(PyServiceMgr *mgr, const char *cacheDir);
 	virtual ~ObjCacheService();
 
-	void PrimeCache();
+	/**
+	 * Loads or generates all cached objects.
+	 *
+	 * @param[in] threads    Number of worker threads, each with a DB connection of its own; 0 primes on the calling thread.
+	 * @param[in] background Return as soon as the objects sent at login are primed; the rest is merged by Process().
+	 */
+	void PrimeCache(uint32 threads = 0, bool background = false);
+	/**
+	 * Merges objects primed by the worker threads and polls for changed tables; called every tick.
+	 */
+	void Process();
+
+	/**
+	 * Sets how often cacheTableChanges is polled for tables changed
+	 * behind our back; 0 disables polling.
+	 */
+	void SetRefreshInterval(uint32 seconds);
+	/**
+	 * Records a change of a table, so the objects generated from it
+	 * are regenerated in background (and not loaded stale on the next start).
+	 *
+	 * @return Number of objects generated from the table.
+	 */
+	size_t TableChanged(const char *table);
 
 	//function provided to other services:
 	typedef enum {
 		hLoginCachables,
 		hCharCreateCachables,
 		hCharCreateNewExtraCachables,
-		hAppearanceCachables
+		hAppearanceCachables,
+		hSetCount
 	} hintSet;
-	void InsertCacheHints(hintSet hset, PyDict *into);
+	/**
+	 * Returns cache hints of all objects of given set, keyed by their short names.
+	 *
+	 * The dict is built once and shared by all callers until InvalidateCache()
+	 * or GiveCache() touches one of its objects, so it must not be modified.
+	 *
+	 * @return New reference to the dict.
+	 */
+	PyDict *GetCacheHints(hintSet hset);
 
     PyRep *GetCacheHint(const PyRep* objectID);
 
@@ -94,6 +126,79 @@ protected:
 
 	bool _LoadCachableObject(const PyRep *objectID);
 
+	/// lists the objects of a hint set
+	static void _GetHintSet(hintSet hset, const char *const *&objects, uint32 &object_count);
+	/// drops the prebuilt hint sets which contain given object
+	void _InvalidateHintSets(const PyRep *objectID);
+
+	/// prebuilt hint sets; NULL until first asked for
+	PyDict *m_hintSets[hSetCount];
+
+	/// An object primed by a worker thread.
+	struct PrimedObject
+	{
+		/// position in m_primeQueue
+		size_t index;
+		std::string objectID;
+		/// marshaled and deflated contents; NULL if the worker failed, the main thread retries then
+		Buffer *data;
+		uint64 timestamp;
+		uint32 version;
+		/// whether MarshalDeflate has deflated the contents
+		bool deflated;
+		bool fromFile;
+		/// time spent on the object, in ms
+		uint32 time;
+	};
+
+	static thread_return_t _PrimeLoop(void *arg);
+	thread_return_t _PrimeLoop();
+	/// loads or generates a single object; called by the worker threads
+	void _PrimeObject(const std::string &objectID, PrimedObject &into);
+	/// moves the objects primed by the workers into m_cache
+	void _MergePrimed();
+	/// logs the prime time of all objects once priming is done
+	void _ReportPrime();
+	/// writes everything primed into the cache pack, so the next start only has to read it
+	void _SavePack();
+	/// starts worker threads which prime m_primeQueue
+	void _StartPrimeWorkers(uint32 threads);
+
+	/// whether any table of the object changed after the object has been generated
+	bool _IsStale(const std::string &objectID, uint64 timestamp) const;
+	/// polls cacheTableChanges and regenerates the stale objects
+	void _CheckTableChanges();
+	/// regenerates m_refreshPending in background
+	void _StartRefresh();
+
+	/// protects m_primeNext, m_primed and m_primeWorkers
+	Mutex m_primeLock;
+	/// objects to be primed, the ones sent at login first
+	std::vector<std::string> m_primeQueue;
+	/// number of login objects at the start of m_primeQueue
+	size_t m_primeCritical;
+	/// next object a worker takes
+	size_t m_primeNext;
+	/// objects primed, but not merged yet
+	std::vector<PrimedObject> m_primed;
+	uint32 m_primeWorkers;
+	/// merged objects (all / login ones)
+	size_t m_primeMerged;
+	size_t m_primeCriticalMerged;
+	uint32 m_primeStart;
+	/// time spent on each object, for the report
+	std::vector<std::pair<uint32, std::string> > m_primeTimes;
+	/// worker threads to use, as given to PrimeCache()
+	uint32 m_primeThreads;
+	/// whether the objects primed replace the ones cached (a refresh batch)
+	bool m_primeRefresh;
+
+	/// last change (Win32 time) of each table, read by the workers while they run
+	std::map<std::string, uint64> m_tableChanges;
+	/// stale objects waiting to be regenerated
+	std::set<std::string> m_refreshPending;
+	Timer m_refreshTimer;
+
     typedef std::map<std::string, std::string>  CacheKeysMap;
     typedef CacheKeysMap::iterator              CacheKeysMapItr;
     typedef CacheKeysMap::const_iterator        CacheKeysMapConstItr;
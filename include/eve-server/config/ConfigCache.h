@@ -0,0 +1,189 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __CONFIG_CACHE_H_INCL__
+#define __CONFIG_CACHE_H_INCL__
+
+#include "config/ConfigDB.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Owner, location and name rows served by ConfigService, by ID.
+ *
+ * Clients resolve owner names, location names, corp tickers and alliance
+ * short names whenever they open the overview, chat or wallet. These rows
+ * hardly ever change, so each one is kept for an hour after it has been
+ * read; IDs which were not found are remembered for a while too (negative
+ * entries), so clients asking for them again do not hit the database.
+ * Each kind holds a bounded number of entries.
+ *
+ * All IDs of a call which are not cached are resolved by one batched
+ * query. Locations are only cached for static map items, as positions
+ * of other items change.
+ *
+ * Entries are updated when the item is renamed (Rename()), and dropped
+ * when a corporation changes (InvalidateCorporation()) and when one of
+ * the source tables is edited (TableChanged()).
+ */
+class ConfigCache
+: public Singleton<ConfigCache>
+{
+public:
+    /// Kinds of cached rows.
+    enum Kind
+    {
+        KindOwners,
+        KindLocations,
+        KindAllianceShortNames,
+        KindCorpTickerNames,
+
+        KindCount
+    };
+
+    /// Counters of one kind.
+    struct Stats
+    {
+        /// Number of cached rows.
+        uint32 entries;
+        /// Number of cached IDs known not to exist.
+        uint32 negativeEntries;
+        /// IDs answered from memory (including negative entries).
+        uint64 hits;
+        /// IDs which had to be read from the database.
+        uint64 misses;
+        /// Calls answered without any query.
+        uint64 queriesSaved;
+        /// Batched queries run for misses.
+        uint64 queries;
+    };
+
+    ConfigCache();
+    ~ConfigCache();
+
+    PyRep* GetMultiOwnersEx( const std::vector<int32>& ids );
+    PyRep* GetMultiLocationsEx( const std::vector<int32>& ids );
+    PyRep* GetMultiAllianceShortNamesEx( const std::vector<int32>& ids );
+    PyRep* GetMultiCorpTickerNamesEx( const std::vector<int32>& ids );
+
+    /**
+     * @brief Drops all rows of given item.
+     */
+    void Invalidate( uint32 itemID );
+    /**
+     * @brief Puts the new name of an item into its cached rows.
+     *
+     * The renamed row may still wait in DBWriteQueue, so the cache is
+     * updated rather than dropped.
+     */
+    void Rename( uint32 itemID, const std::string& name );
+    /**
+     * @brief Drops owner and ticker rows of a created or changed corporation.
+     */
+    void InvalidateCorporation( uint32 corpID );
+    /**
+     * @brief Drops all rows read from given table.
+     *
+     * @return Number of kinds flushed.
+     */
+    size_t TableChanged( const char* table );
+    /**
+     * @brief Drops everything.
+     */
+    void Clear();
+
+    /**
+     * @brief Fills given struct with counters of given kind.
+     */
+    void GetStats( Kind kind, Stats& into ) const;
+    /**
+     * @return Name of given kind, for reports.
+     */
+    static const char* GetKindName( Kind kind );
+
+protected:
+    /// Cached row; NULL line marks an ID which does not exist.
+    struct Entry
+    {
+        PyList* line;
+        /// Win32 time after which the entry is dropped.
+        uint64 expires;
+    };
+    typedef std::map<int32, Entry> EntryMap;
+
+    /// Reads rows of given IDs from the database.
+    typedef bool ( ConfigDB::*FetchMethod )( const std::vector<int32>& ids, std::map<int32, PyList*>& into );
+
+    /// Rows of one kind.
+    struct Table
+    {
+        /// Column names.
+        PyList* header;
+        FetchMethod fetch;
+        /// Source tables (lowercase), NULL terminated.
+        const char* tables[ 4 ];
+
+        EntryMap entries;
+        uint32 negativeEntries;
+
+        uint64 hits;
+        uint64 misses;
+        uint64 queriesSaved;
+        uint64 queries;
+    };
+
+    /**
+     * @brief Collects lines of given IDs, reading the missing ones.
+     *
+     * @param[in]  kind  Kind of rows.
+     * @param[in]  ids   Requested IDs.
+     * @param[out] lines New references to the lines found.
+     *
+     * @return False if the query failed.
+     */
+    bool _Lookup( Kind kind, const std::vector<int32>& ids, std::vector<PyList*>& lines );
+    /// Whether rows of given ID may be kept.
+    static bool _IsCachable( Kind kind, int32 id );
+    /// Drops given ID from a table.
+    void _Erase( Table& table, int32 id );
+    /// Drops expired entries of a table, then the lowest IDs while it is still too big.
+    void _Trim( Table& table, uint64 now );
+    /// Drops all entries of a table.
+    void _Clear( Table& table );
+
+    /// (header, [line, ...]), the format of DBResultToTupleSet().
+    PyTuple* _BuildTupleSet( Kind kind, const std::vector<PyList*>& lines );
+    /// (header, [util.Row, ...]), the format of DBResultToRowList().
+    PyTuple* _BuildRowList( Kind kind, const std::vector<PyList*>& lines );
+
+    ConfigDB mDB;
+
+    mutable Mutex mMutex;
+    Table mTables[ KindCount ];
+};
+
+#define sConfigCache \
+    ( ConfigCache::get() )
+
+#endif /* !__CONFIG_CACHE_H_INCL__ */
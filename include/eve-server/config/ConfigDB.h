@@ -30,15 +30,24 @@
 #include "ServiceDB.h"
 
 class PyRep;
+class PyList;
 
 class ConfigDB
 : public ServiceDB
 {
 public:
-    PyRep *GetMultiOwnersEx(const std::vector<int32> &entityIDs);
-    PyRep *GetMultiLocationsEx(const std::vector<int32> &entityIDs);
-    PyRep *GetMultiAllianceShortNamesEx(const std::vector<int32> &entityIDs);
-    PyRep *GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs);
+    /*
+     * These read the rows served by ConfigCache, one line per found ID.
+     * The lines are new references owned by the caller.
+     */
+    /// (ownerID, ownerName, typeID)
+    bool GetOwnerLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into);
+    /// (locationID, locationName, x, y, z)
+    bool GetLocationLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into);
+    /// (allianceID, shortName)
+    bool GetAllianceShortNameLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into);
+    /// (corporationID, tickerName, shape1, shape2, shape3, color1, color2, color3)
+    bool GetCorpTickerNameLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into);
     PyRep *GetMultiGraphicsEx(const std::vector<int32> &entityIDs);
     PyRep *GetMultiInvTypesEx(const std::vector<int32> &typeIDs);
     PyObject *GetUnits();
@@ -50,6 +59,10 @@ public:
     PyRep *GetTextsForGroup(const std::string & langID, uint32 textgroup);
 
 protected:
+    /// Adds a line per row, keyed by the first column.
+    static void _AddLines(DBQueryResult &res, std::map<int32, PyList *> &into);
+    /// Copies IDs which have no line yet.
+    static void _GetMissing(const std::vector<int32> &entityIDs, const std::map<int32, PyList *> &lines, std::vector<int32> &into);
 };
 
 #endif
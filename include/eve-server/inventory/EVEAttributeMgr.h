@@ -258,15 +258,97 @@ protected:
  * @note keeping track of the base value of the attribute is not implemented.
  * Besides the fact in increases memory concumption its unclear how to design it
  * at this moment.
+ *
+ * The defaults of the item type are not copied; the map refers to the shared
+ * table of dgmtypeattributemgr and only keeps the attributes which differ
+ * from it (the overrides, which are also what gets saved) in a small sorted
+ * vector. Reads check the overrides first, then the type defaults; writes
+ * always go to the overrides.
  */
 class AttributeMap
 {
 public:
+    /**
+     * @brief A value which overrides (or is missing from) the type defaults.
+     */
+    struct Override
+    {
+        Override(uint32 attrID, const EvilNumber &num, bool isDirty)
+        : attributeID(attrID), dirty(isDirty), value(num) {}
+
+        uint32 attributeID;
+        /// the value changed since it was last loaded or saved
+        bool dirty;
+        EvilNumber value;
+    };
+
+    typedef std::vector<Override>           OverrideVector;
+    typedef OverrideVector::iterator        OverrideItr;
+    typedef OverrideVector::const_iterator  OverrideConstItr;
+
+    /**
+     * @brief Iterates over the effective attributes: the type defaults merged with the overrides.
+     */
+    class AttrMapItr
+    {
+    public:
+        typedef std::pair<uint32, EvilNumber> value_type;
+
+        AttrMapItr(DgmTypeAttributeSet::AttrSetItr def, DgmTypeAttributeSet::AttrSetItr defEnd,
+                   OverrideConstItr over, OverrideConstItr overEnd);
+
+        const value_type& operator*() const { return mCurrent; }
+        const value_type* operator->() const { return &mCurrent; }
+
+        AttrMapItr& operator++();
+        AttrMapItr operator++(int) { AttrMapItr tmp(*this); ++*this; return tmp; }
+
+        bool operator==(const AttrMapItr &oth) const { return mDef == oth.mDef && mOver == oth.mOver; }
+        bool operator!=(const AttrMapItr &oth) const { return !(*this == oth); }
+
+    protected:
+        void _Update();
+
+        DgmTypeAttributeSet::AttrSetItr mDef, mDefEnd;
+        OverrideConstItr mOver, mOverEnd;
+
+        value_type mCurrent;
+    };
+
+    /**
+     * @brief Counters of attribute saves of all items.
+     */
+    struct SaveStats
+    {
+        /// number of Save() calls which wrote something
+        uint64 saves;
+        /// number of rows written by these calls
+        uint64 rowsWritten;
+        /// rows written by the last save
+        uint32 lastRows;
+        /// most rows written by a single save
+        uint32 maxRows;
+    };
+
+    /**
+     * @brief Memory held by all attribute maps.
+     */
+    struct MemoryStats
+    {
+        /// number of live attribute maps
+        uint32 maps;
+        /// overrides allocated (vector capacity) by all maps
+        uint64 overrides;
+        /// type defaults referenced by all maps; before they were shared each map held a copy of these
+        uint64 defaults;
+    };
+
     /**
      * we store our keeper so we can use it in the various functions.
      * @note capt: the way I see it this isn't really needed... ( design thingy )
      */
     AttributeMap(InventoryItem & item);
+    ~AttributeMap();
 
     /**
      * @brief set the attribute with @num
@@ -302,19 +384,12 @@ public:
     bool Delete();
 
     // load the default attributes that come with the itemID
-
-
-    typedef std::map<uint32, EvilNumber>    AttrMap;
-    typedef AttrMap::iterator               AttrMapItr;
-    typedef AttrMap::const_iterator         AttrMapConstItr;
-
     bool Load();
 
     /**
      * SaveAttributes
      *
-     * @note this function always saves everything and doesn't take into account the fact that we should only save the
-     * changes attributes.
+     * Writes the overridden attributes which changed since the last load or save, in a single statement.
      */
     bool SaveAttributes();
     bool SaveIntAttribute(uint32 attributeID, int64 value);
@@ -330,7 +405,7 @@ public:
      * @return the begin iterator of the AttributeMap
      * @note this way to solve the attribute system problems are quite hacky... but atm its needed
      */
-    AttrMapItr begin();
+    AttrMapItr begin() const;
 
     /**
      * @brief return the end iterator of the AttributeMap
@@ -340,7 +415,25 @@ public:
      * @return the end iterator of the AttributeMap
      * @note this way to solve the attribute system problems are quite hacky... but atm its needed
      */
-    AttrMapItr end();
+    AttrMapItr end() const;
+
+    /**
+     * @brief fills @a into with the save counters of all attribute maps.
+     */
+    static void GetSaveStats(SaveStats &into);
+    /**
+     * @brief fills @a into with the memory counters of all attribute maps.
+     */
+    static void GetMemoryStats(MemoryStats &into);
+
+    /**
+     * @return True if some attribute changed since the last load or save.
+     */
+    bool IsChanged() const { return mChanged; }
+    /**
+     * @return Bytes allocated by this map besides the map itself.
+     */
+    size_t GetMemoryUsage() const { return mOverrides.capacity() * sizeof(Override); }
 
 protected:
     /**
@@ -378,24 +471,34 @@ protected:
     bool SaveIntAttribute(uint32 attributeID);
     bool SaveFloatAttribute(uint32 attributeID);
 
+    /// binary search in the overrides; returns the position where @a attributeID belongs
+    OverrideItr _FindOverride(uint32 attributeID);
+    OverrideConstItr _FindOverride(uint32 attributeID) const;
+    /// looks the attribute up in the overrides, then in the type defaults
+    bool _GetAttribute(uint32 attributeID, EvilNumber &into) const;
+    static bool _OverrideLess(const Override &a, uint32 attributeID);
+    /// adds (or removes) our allocation to (from) the memory counters
+    void _AccountMemory(bool add);
+
     /** we belong to this item..
      * @note possible design flaw because only items contain AttributeMap's so
      *       we don't need to store this.
      */
     InventoryItem &mItem;
 
-    /**
-     * @note possible design flaw, stack corruption because of a enormous amount
-     *       of 'EvilNumber' objects not fitting into the stack.
-     */
-    AttrMap mAttributes;
+    /// defaults of the item type, shared with all items of the type
+    DgmTypeAttributeSet mDefaults;
+    /// values which differ from the defaults, sorted by attributeID
+    OverrideVector mOverrides;
 
     /**
-     * we set and we clear this flag when we change attributes of this item....
-     * @note we should improve this idea... and only save the changed attributes...
-     *       but that is for the future.
+     * we set this flag when any attribute got dirty and clear it on save,
+     * so saving an unchanged item does not need to walk the map.
      */
     bool mChanged;
+
+    static SaveStats sSaveStats;
+    static MemoryStats sMemoryStats;
 };
 
 #endif /* __EVE_ATTRIBUTE_MGR__H__INCL__ */
@@ -52,6 +52,11 @@ public:
 	bool ContentsLoaded() const { return mContentsLoaded; }
 	bool LoadContents(ItemFactory &factory);
 	void DeleteContents(ItemFactory &factory);
+	/**
+	 * Drops the ref held to a content, so the item cache can evict it;
+	 * the next LoadContents() reads that item again, not the rest.
+	 */
+	void ReleaseItem(uint32 itemID);
 
 	bool Contains(uint32 itemID) const { return mContents.find( itemID ) != mContents.end(); }
 	InventoryItemRef GetByID(uint32 id) const;
@@ -97,8 +102,12 @@ protected:
 
 	virtual bool GetItems(ItemFactory &factory, std::vector<uint32> &into) const { return factory.db().GetItemContents( inventoryID(), into ); }
 
+	//reads the items dropped by ReleaseItem() again.
+	void _LoadReleasedItems(ItemFactory &factory);
+
 	bool mContentsLoaded;
-	std::map<uint32, InventoryItemRef> mContents;	//maps item ID to its instance. we own a ref to all of these.
+	std::map<uint32, InventoryItemRef> mContents;	//maps item ID to its instance. we own a ref to all of these, until ReleaseItem().
+	std::set<uint32> mReleasedItems;	//contents released while mContentsLoaded, not read again yet.
 };
 
 class InventoryEx
@@ -155,10 +155,31 @@ public:
 	 * (entity)
 	 */
 	bool GetItem(uint32 itemID, ItemData &into);
+	/**
+	 * Loads entity rows of all items located in any of given locations,
+	 * using as few queries as possible.
+	 *
+	 * Rows may be limited to what Inventory::LoadContents() would load
+	 * for a client: items owned by @a characterID or @a corporationID, or
+	 * located in @a clientLocationID.
+	 *
+	 * @param[in] locationIDs IDs of locations whose contents should be loaded.
+	 * @param[out] into Loaded rows, keyed by itemID.
+	 * @param[in] characterID Owner to limit the rows to; 0 for all rows.
+	 * @param[in] corporationID Corporation of the character.
+	 * @param[in] clientLocationID Location of the character.
+	 * @return True on success, false on failure.
+	 */
+	bool GetItemsByLocation(const std::vector<uint32> &locationIDs, std::map<uint32, ItemData> &into,
+		uint32 characterID = 0, uint32 corporationID = 0, uint32 clientLocationID = 0);
 
 	uint32 NewItem(const ItemData &data);
 	bool SaveItem(uint32 itemID, const ItemData &data);
 	bool DeleteItem(uint32 itemID);
+	/**
+	 * @return True if entity or attribute rows of the item are still waiting in DBWriteQueue.
+	 */
+	bool IsSavePending(uint32 itemID);
 
 	bool GetItemContents(uint32 itemID, std::vector<uint32> &into);
 	bool GetItemContents(uint32 itemID, EVEItemFlags flag, std::vector<uint32> &into);
@@ -177,8 +198,38 @@ public:
 	 */
 	bool LoadItemAttributes(uint32 itemID, EVEAttributeMgr &into);
 
-	bool UpdateAttribute_int(uint32 itemID, uint32 attributeID, int v);
+	bool UpdateAttribute_int(uint32 itemID, uint32 attributeID, int64 v);
 	bool UpdateAttribute_double(uint32 itemID, uint32 attributeID, double v);
+	/**
+	 * Writes several attributes of an item at once.
+	 *
+	 * @param[in] itemID     ID of item the attributes belong to.
+	 * @param[in] attributes Attribute ID -> value pairs to write.
+	 * @return True if the rows have been queued.
+	 */
+	bool UpdateAttributes(uint32 itemID, const std::map<uint32, EvilNumber> &attributes);
+	/**
+	 * Loads saved attributes of many items at once.
+	 *
+	 * @param[in] itemIDs IDs of items whose attributes should be loaded.
+	 * @param[out] into Attribute ID -> value pairs, keyed by itemID; items without saved attributes are left out.
+	 * @return True on success, false on failure.
+	 */
+	bool GetItemAttributes(const std::vector<uint32> &itemIDs, std::map<uint32, std::map<uint32, EvilNumber> > &into);
+	/**
+	 * Loads saved attributes of all items located in any of given locations.
+	 *
+	 * Items are limited like by GetItemsByLocation().
+	 *
+	 * @param[in] locationIDs IDs of locations whose contents' attributes should be loaded.
+	 * @param[out] into Attribute ID -> value pairs, keyed by itemID; items without saved attributes are left out.
+	 * @param[in] characterID Owner to limit the items to; 0 for all items.
+	 * @param[in] corporationID Corporation of the character.
+	 * @param[in] clientLocationID Location of the character.
+	 * @return True on success, false on failure.
+	 */
+	bool GetItemAttributesByLocation(const std::vector<uint32> &locationIDs, std::map<uint32, std::map<uint32, EvilNumber> > &into,
+		uint32 characterID = 0, uint32 corporationID = 0, uint32 clientLocationID = 0);
 	bool EraseAttribute(uint32 itemID, uint32 attributeID);
 	bool EraseAttributes(uint32 itemID);
 
@@ -292,6 +343,15 @@ public:
 
 	static bool GetTypeID(uint32 itemID, uint32 &typeID);
 
+protected:
+	bool _GetItemAttributes(bool byLocation, const std::vector<uint32> &ids, std::map<uint32, std::map<uint32, EvilNumber> > &into,
+		const std::string &filter = std::string());
+	/// builds the " AND (...)" clause limiting entity rows as described at GetItemsByLocation()
+	static void _OwnerFilter(uint32 characterID, uint32 corporationID, uint32 clientLocationID, std::string &into);
+	// reads an entity row laid out as in GetItem(), starting at column @a first
+	static void _ReadItemData(DBResultRow &row, uint32 first, ItemData &into);
+	// builds the next "IN (...)" list of @a ids starting at @a offset; false when all IDs were consumed
+	static bool _NextINChunk(const std::vector<uint32> &ids, size_t &offset, std::string &into);
 };
 
 
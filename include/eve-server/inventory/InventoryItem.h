@@ -171,6 +171,15 @@ public:
     void DisableSaveTimer() { return m_saveTimer.Disable(); };
     bool CheckSaveTimer(bool iReset = true) { return m_saveTimer.Check( iReset ); };
 
+    /**
+     * @return True if the item has changes which have not been saved yet.
+     */
+    bool IsDirty() const { return m_saveTimer.Enabled() || mAttributeMap.IsChanged(); }
+    /**
+     * @return Estimate of memory held by the item (the common part, without subclass data).
+     */
+    size_t GetMemoryUsage() const { return sizeof(InventoryItem) + m_itemName.capacity() + m_customInfo.capacity() + mAttributeMap.GetMemoryUsage(); }
+
     /*
      * Attribute access:
      */
@@ -245,9 +254,10 @@ protected:
     template<class _Ty>
     static RefPtr<_Ty> _Load(ItemFactory &factory, uint32 itemID)
     {
-        // pull the item info
+        // pull the item info, unless it has been loaded in bulk
         ItemData data;
-        if( !factory.db().GetItem( itemID, data ) )
+        if( !factory.GetPrefetchedItem( itemID, data )
+            && !factory.db().GetItem( itemID, data ) )
             return RefPtr<_Ty>();
 
         // obtain type
@@ -44,6 +44,37 @@ class ItemFactory
 {
 	friend class InventoryItem;	//only for access to _DeleteItem
 public:
+	/**
+	 * Counters of the item cache.
+	 */
+	struct CacheStats
+	{
+		/// GetItem calls served from the cache
+		uint64 hits;
+		/// GetItem calls which had to load the item
+		uint64 misses;
+		/// items dropped from the cache by Process()
+		uint64 evictions;
+		/// items in the cache
+		uint32 resident;
+		/// estimated memory held by the cached items
+		uint64 residentBytes;
+		/// eviction sweeps run
+		uint32 sweeps;
+	};
+
+	/**
+	 * Rows read for a bulk load, as plain data; see LoadPrefetch().
+	 */
+	struct PrefetchData
+	{
+		/// locations whose contents have been read completely
+		std::set<uint32> locations;
+		std::map<uint32, ItemData> items;
+		/// saved attributes; an item listed here without any has none saved
+		std::map<uint32, std::map<uint32, EvilNumber> > attributes;
+	};
+
 	ItemFactory(EntityList& el);
 	~ItemFactory();
 	
@@ -102,6 +133,10 @@ public:
 	 * Item stuff
 	 */
 	InventoryItemRef GetItem(uint32 itemID);
+	/**
+	 * @return The item if it is in the cache; never loads it.
+	 */
+	InventoryItemRef PeekItem(uint32 itemID) const;
 
 	BlueprintRef GetBlueprint(uint32 blueprintID);
 
@@ -231,6 +266,104 @@ public:
 	 */
 	Inventory *GetInventory(uint32 inventoryID, bool load=true);
 
+	/*
+	 * Bulk loading
+	 */
+	/**
+	 * Loads entity rows and saved attributes of everything located in
+	 * @a locationID, walking nested containers breadth-first, with a couple
+	 * of set-based queries per level. Items loaded until the matching
+	 * EndPrefetch() are built from this data instead of querying one by one.
+	 * With @a characterID set, only the rows Inventory::LoadContents() loads
+	 * for that character are read; see InventoryDB::GetItemsByLocation().
+	 *
+	 * @param[in] locationID Location whose contents are about to be loaded.
+	 * @param[in] characterID Owner to limit the rows to; 0 for all rows.
+	 * @param[in] corporationID Corporation of the character.
+	 * @param[in] clientLocationID Location of the character.
+	 * @return True if the contents of @a locationID have been read now; false if
+	 *         an enclosing prefetch covers them already or the query failed.
+	 */
+	bool BeginPrefetch(uint32 locationID, uint32 characterID = 0, uint32 corporationID = 0, uint32 clientLocationID = 0);
+	/**
+	 * Like BeginPrefetch(), with the rows read by LoadPrefetch() beforehand.
+	 * Consumes a prefetch announced by QueuePrefetch(); rows of items which
+	 * left the cache since are dropped, as they may predate their last save.
+	 *
+	 * @param[in] data Rows to build the items from; emptied.
+	 */
+	void BeginPrefetch(PrefetchData &data);
+	/**
+	 * Drops the prefetched data once the outermost prefetch ends.
+	 */
+	void EndPrefetch();
+
+	/**
+	 * Announces a LoadPrefetch() about to run on another thread.
+	 * Must be followed by either BeginPrefetch(PrefetchData &) or CancelPrefetch().
+	 */
+	void QueuePrefetch();
+	/**
+	 * Forgets a prefetch announced by QueuePrefetch() whose rows are not going to be used.
+	 */
+	void CancelPrefetch();
+	/**
+	 * Reads what BeginPrefetch() would for each of @a locationIDs, without
+	 * touching the factory, so it may run on a worker thread with a
+	 * connection of its own (see DBcore::OpenThreadConnection()).
+	 *
+	 * @param[in]  locationIDs Locations whose contents are about to be loaded.
+	 * @param[out] into        Rows read.
+	 * @return False if a query failed; whatever has been read is still usable.
+	 */
+	bool LoadPrefetch(const std::vector<uint32> &locationIDs, PrefetchData &into);
+	/**
+	 * Reads the saved attributes of items whose rows do not come from the
+	 * entity table (celestials), like LoadPrefetch().
+	 */
+	bool LoadPrefetchAttributes(const std::vector<uint32> &itemIDs, PrefetchData &into);
+
+	/**
+	 * @return True if the entity row of @a itemID has been prefetched and copied into @a into.
+	 */
+	bool GetPrefetchedItem(uint32 itemID, ItemData &into) const;
+	/**
+	 * Hands over the prefetched saved attributes of @a itemID and forgets
+	 * the item, as it is being built now.
+	 *
+	 * @return True if the item has been prefetched (@a into may stay empty), false if its attributes must be queried.
+	 */
+	bool TakePrefetchedAttributes(uint32 itemID, std::map<uint32, EvilNumber> &into);
+
+	/*
+	 * Item cache
+	 */
+	/**
+	 * Sets the budget of the item cache; 0 means no limit.
+	 *
+	 * @param[in] maxItems  Number of cached items above which unreferenced items are evicted.
+	 * @param[in] maxMemory Estimated memory (in bytes) above which unreferenced items are evicted.
+	 */
+	void SetCacheLimits(uint32 maxItems, uint64 maxMemory);
+	/**
+	 * Evicts unreferenced, saved items while the cache is over its budget;
+	 * items whose saved rows DBWriteQueue has not written yet stay. An item
+	 * held only by the hangar of a loaded station counts as unreferenced.
+	 * Rate limited; meant to be called every tick of the main loop.
+	 */
+	void Process();
+	/**
+	 * Runs an eviction sweep right now.
+	 *
+	 * @param[in] all Evict every evictable item, not only down to the budget.
+	 * @return Number of evicted items.
+	 */
+	uint32 EvictItems(bool all = false);
+	/**
+	 * Fills @a into with the cache counters.
+	 */
+	void GetCacheStats(CacheStats &into) const;
+
     void SetUsingClient(Client *pClient);
 
     Client * GetUsingClient();
@@ -256,12 +389,54 @@ protected:
 	std::map<uint32, ItemType *> m_types;
 
 	// Items:
+	struct CachedItem
+	{
+		InventoryItemRef item;
+		/// estimated memory of the item when it was cached
+		size_t bytes;
+		/// CLOCK reference bit; set on access, cleared when the hand passes
+		bool referenced;
+	};
+	typedef std::map<uint32, CachedItem> ItemMap;
+
 	template<class _Ty>
 	RefPtr<_Ty> _GetItem(uint32 itemID);
 
+	/// puts a freshly loaded or spawned item into the cache
+	void _CacheItem(InventoryItemRef item);
 	void _DeleteItem(uint32 itemID);
-
-	std::map<uint32, InventoryItemRef> m_items;
+	/// @return True if the cache holds more than its budget.
+	bool _OverBudget() const;
+	/// @return Loaded station whose hangar holds the only ref to @a item besides the cache; NULL if there is none.
+	Inventory *_HangarHolding(const InventoryItem &item);
+	/// remembers an item leaving the cache while a prefetch is queued
+	void _ItemUnloaded(uint32 itemID);
+
+	ItemMap m_items;
+
+	// Item cache:
+	uint32 m_cacheMaxItems;
+	uint64 m_cacheMaxMemory;
+	/// itemID the CLOCK hand points at
+	uint32 m_clockHand;
+	Timer m_cacheTimer;
+	CacheStats m_cacheStats;
+
+	// Prefetched data:
+	uint32 m_prefetchDepth;
+	std::set<uint32> m_prefetchedLocations;
+	std::map<uint32, ItemData> m_prefetchedItems;
+	std::map<uint32, std::map<uint32, EvilNumber> > m_prefetchedAttributes;
+
+	/// reads the contents of @a parents level by level, skipping locations in @a locations
+	bool _LoadPrefetch(std::vector<uint32> parents, std::set<uint32> &locations,
+		std::map<uint32, ItemData> &items, std::map<uint32, std::map<uint32, EvilNumber> > &attributes,
+		uint32 characterID = 0, uint32 corporationID = 0, uint32 clientLocationID = 0);
+
+	/// prefetches queued by QueuePrefetch() and not yet begun or cancelled
+	uint32 m_queuedPrefetches;
+	/// items which left the cache while a prefetch was queued
+	std::set<uint32> m_unloadedItems;
 };
 
 
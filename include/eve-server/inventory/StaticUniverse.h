@@ -0,0 +1,171 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __STATIC_UNIVERSE__H__INCL__
+#define __STATIC_UNIVERSE__H__INCL__
+
+#include "station/Station.h"
+#include "system/SolarSystem.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief In-memory copy of the static universe tables.
+ *
+ * Regions, constellations, solar systems, stations and the rest of
+ * mapDenormalize never change while the server runs, yet every celestial
+ * loaded by a solar system costs InventoryDB two queries. Load() reads
+ * these tables once; InventoryDB then answers GetItem(), GetCelestialObject(),
+ * GetSolarSystem() and GetStation() for static IDs from here and only
+ * falls back to the database on a miss.
+ *
+ * All map items share a single sorted array of fixed-size entries (64 bytes)
+ * searched by binary search; their names live in a single string pool.
+ */
+class StaticUniverse
+: public Singleton<StaticUniverse>
+{
+public:
+    /// Counters exposed for monitoring.
+    struct Stats
+    {
+        /// Number of map items.
+        uint32 items;
+        /// Number of solar systems.
+        uint32 solarSystems;
+        /// Number of stations.
+        uint32 stations;
+        /// Approximate memory held, in bytes.
+        size_t memory;
+        /// Duration of Load() in ms.
+        uint32 loadTime;
+        /// Lookups answered from memory.
+        uint64 hits;
+        /// Lookups of static IDs which had to go to the database.
+        uint64 misses;
+    };
+
+    StaticUniverse();
+
+    /**
+     * @brief Reads the static tables from the database.
+     *
+     * @return True on success; on failure the cache stays empty and all lookups miss.
+     */
+    bool Load();
+    /**
+     * @brief Releases all data; subsequent lookups miss.
+     */
+    void Clear();
+
+    bool IsLoaded() const { return mLoaded; }
+
+    /**
+     * @brief Fills item data of a region, constellation, solar system, celestial, stargate or station.
+     *
+     * @return True if found; false if the ID is not a static one or is unknown.
+     */
+    bool GetItem( uint32 itemID, ItemData& into ) const;
+    /**
+     * @brief Fills celestial data of a static map item.
+     */
+    bool GetCelestialObject( uint32 celestialID, CelestialObjectData& into ) const;
+    /**
+     * @brief Fills solar system data.
+     */
+    bool GetSolarSystem( uint32 solarSystemID, SolarSystemData& into ) const;
+    /**
+     * @brief Fills station data.
+     */
+    bool GetStation( uint32 stationID, StationData& into ) const;
+
+    /**
+     * @brief Fills given struct with current counters.
+     */
+    void GetStats( Stats& into ) const;
+
+protected:
+    /// Entry has item data (from its own table or mapDenormalize).
+    static const uint8 ENTRY_ITEM = 0x01;
+    /// Entry has celestial data (from mapDenormalize).
+    static const uint8 ENTRY_CELESTIAL = 0x02;
+
+    /// A single map item.
+    struct Entry
+    {
+        uint32 itemID;
+        uint32 typeID;
+        uint32 ownerID;
+        uint32 locationID;
+        /// Offset of the name in mNames.
+        uint32 name;
+
+        uint8 celestialIndex;
+        uint8 orbitIndex;
+        uint8 flags;
+
+        double x, y, z;
+        double security;
+        double radius;
+
+        bool operator<( const Entry& oth ) const { return itemID < oth.itemID; }
+    };
+
+    typedef std::vector< std::pair<uint32, SolarSystemData> > SolarSystemVector;
+    typedef std::vector< std::pair<uint32, StationData> > StationVector;
+
+    bool _LoadDenormalize( std::vector<Entry>& into );
+    bool _LoadRegions( std::vector<Entry>& into );
+    bool _LoadConstellations( std::vector<Entry>& into );
+    bool _LoadSolarSystems( std::vector<Entry>& into );
+    bool _LoadStations( std::vector<Entry>& into );
+
+    /// Sorts the entries and merges the item and celestial halves of each map item.
+    void _Merge( std::vector<Entry>& entries );
+    /// Appends a name to the pool, returning its offset.
+    uint32 _AddName( const char* name );
+    /// Orders the (ID, data) pairs by ID.
+    template<typename T>
+    static bool _CompareFirst( const std::pair<uint32, T>& a, const std::pair<uint32, T>& b ) { return a.first < b.first; }
+    /// Binary search for an entry.
+    const Entry* _Find( uint32 itemID ) const;
+    size_t _GetMemoryUsage() const;
+
+    std::vector<Entry> mEntries;
+    /// NUL separated names of the entries.
+    std::string mNames;
+    SolarSystemVector mSolarSystems;
+    StationVector mStations;
+
+    bool mLoaded;
+    uint32 mLoadTime;
+
+    mutable uint64 mHits;
+    mutable uint64 mMisses;
+};
+
+#define sStaticUniverse \
+    ( StaticUniverse::get() )
+
+#endif /* !__STATIC_UNIVERSE__H__INCL__ */
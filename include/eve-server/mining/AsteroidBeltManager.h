@@ -71,7 +71,7 @@ public:
 	virtual void EncodeDestiny( Buffer& into ) const;
 	virtual void Process();
 	//SimpleSystemEntity:
-	virtual bool LoadExtras(SystemDB *db);
+	virtual bool LoadExtras(const SystemBootData &data);
 	
 protected:
 	AsteroidBeltManager *m_manager;	//dynamic to simplify dependancy issues.
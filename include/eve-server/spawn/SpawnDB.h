@@ -36,6 +36,8 @@ class SpawnDB
 public:
 	bool LoadSpawnGroups(uint32 solarSystemID, std::map<uint32, SpawnGroup *> &into);
 	bool LoadSpawnEntries(uint32 solarSystemID, const std::map<uint32, SpawnGroup *> &groups, std::map<uint32, SpawnEntry *> &into);
+	//stores when each spawn (by ID) pops next, see LoadSpawnEntries().
+	bool SaveSpawnTimes(const std::map<uint32, uint32> &spawnTimes);
 
 protected:
 };
@@ -95,6 +95,8 @@ public:
 	bool CheckBounds() const;
 
 	void SpawnDepoped(uint32 npcID);
+	//time (Timer::GetTimeSeconds()) the spawn pops next; now if it is up.
+	uint32 GetSpawnTime() const;
 
 	//I really dont want this to be public, but it makes loading a lot
 	//easier right now, so here it is.
@@ -125,6 +127,8 @@ public:
 	~SpawnManager();
 	
 	bool Load();
+	//saves the spawn timers, before the system is torn down.
+	bool Save();
 	bool DoInitialSpawn();
 	void Process();
 	
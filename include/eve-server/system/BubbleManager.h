@@ -33,12 +33,23 @@ class GPoint;
 //any of the optimized space searching algorithms which we
 // may develop based on bubbles.
 // 
-// Right now it is stupid and searches for a bubble using a
-// linear search. obviously a much better spacial partitioning
-// scheme could be written later (octtree or quadtree maybe?)
-// and this would be the place to put it.
+// Bubble centers are indexed in a uniform grid with cells as wide
+// as the bubble radius, so finding the bubble a point is in only
+// looks at the cells within one radius of it (up to 3x3x3 = 27), and
+// checking a new bubble for overlaps at those within two radii (up to
+// 5x5x5 = 125).
 class BubbleManager {
 public:
+	/// Statistics of the bubbles of a system.
+	struct Stats {
+		uint32 live;		//bubbles currently allocated.
+		uint32 empty;		//of those, empty ones waiting to be reclaimed.
+		uint32 peak;		//most bubbles allocated at once.
+		uint64 created;
+		uint64 reclaimed;
+		uint64 merged;		//entities moved into an older overlapping bubble.
+	};
+	
 	BubbleManager();
 	~BubbleManager();
 	
@@ -52,13 +63,66 @@ public:
 	void Remove(SystemEntity *ent, bool notify);
 	void clear();
 	
+	size_t GetBubbleCount() const { return m_bubbles.size(); }
+	void GetStats(Stats &into) const;
+	static double GetBubbleRadius();
+	//interval of the periodic work of Process(), in ms.
+	static uint32 GetWanderInterval();
+	//periodic work of Process(); public so that it may be driven by another clock.
+	void ProcessAt(int32 now);
+	
 protected:
+	/// Integer coordinates of a grid cell.
+	struct CellKey {
+		int32 x, y, z;
+		
+		bool operator==(const CellKey &oth) const { return(x == oth.x && y == oth.y && z == oth.z); }
+	};
+	struct CellKeyHash {
+		size_t operator()(const CellKey &key) const {
+			return(size_t((uint32)key.x * 73856093U ^ (uint32)key.y * 19349663U ^ (uint32)key.z * 83492791U));
+		}
+	};
+	typedef std::tr1::unordered_map<CellKey, std::vector<SystemBubble *>, CellKeyHash> CellMap;
+	
+	static CellKey _GetCell(const GPoint &pos);
+	
 	SystemBubble * _FindBubble(const GPoint &pos) const;
+	/**
+	 * Counts bubbles which would overlap a bubble centered at given point.
+	 *
+	 * @param[in]  center  Center of the new bubble.
+	 * @param[out] nearest The overlapping bubble with the closest center; NULL if there is none.
+	 */
+	uint32 _CountOverlaps(const GPoint &center, const SystemBubble **nearest) const;
+	/**
+	 * Picks center of a new bubble for an entity which is not in any bubble.
+	 *
+	 * Prefers a center ahead of the entity along its heading; if that
+	 * overlaps existing bubbles, tries to push the center away from them
+	 * while still containing the entity.
+	 */
+	GPoint _PlaceBubble(const GPoint &pos, const GVector &heading) const;
+	//creates and indexes a new bubble for an entity at pos which is not in any bubble.
+	SystemBubble * _CreateBubble(const GPoint &pos, const GVector &heading);
+	void _AddBubble(SystemBubble *b);
+	void _DeleteBubble(SystemBubble *b);
+	
+	//moves entities which are inside an older overlapping bubble into it.
+	void _MergeBubbles();
+	//deletes bubbles which have been empty for longer than the grace period.
+	void _ReclaimBubbles(int32 now);
 	
 	Timer m_wanderTimer;
 	
-	//dumb storage for now:
-	std::vector<SystemBubble *> m_bubbles;	//we own these. Dynamic only because I am afraid of copy activities.
+	std::vector<SystemBubble *> m_bubbles;	//we own these, oldest first. Dynamic only because I am afraid of copy activities.
+	CellMap m_cells;	//bubbles by the cell their center lies in.
+	std::map<SystemBubble *, int32> m_emptySince;	//empty bubbles and the time they were found empty.
+	
+	uint32 m_peak;
+	uint64 m_created;
+	uint64 m_reclaimed;
+	uint64 m_merged;
 };
 
 
@@ -49,7 +49,7 @@ public:
 	void clear();
 	bool IsEmpty() const { return(m_entities.empty()); }
 	void GetEntities(std::set<SystemEntity *> &into) const;
-    uint32 GetBubbleID() { return m_bubbleID; };
+    uint32 GetBubbleID() const { return m_bubbleID; };
 
     //void AppendBalls(DoDestiny_SetState &ss, std::vector<uint8> &setstate_buffer) const;
 
@@ -57,12 +57,21 @@ public:
     double z;
 };
 
+class DBSystemJump {
+public:
+	uint32 stargateID;
+	uint32 toCelestialID;
+	uint32 locationID;	//0 if the destination is not in mapDenormalize
+};
+
 class SystemDB
 : public ServiceDB
 {
 public:
 	bool LoadSystemEntities(uint32 systemID, std::vector<DBSystemEntity> &into);
 	bool LoadSystemDynamicEntities(uint32 systemID, std::vector<DBSystemDynamicEntity> &into);
+	//jumps of all stargates of the system, by stargateID.
+	bool LoadSystemJumps(uint32 systemID, std::map<uint32, std::vector<DBSystemJump> > &into);
 	static uint32 GetObjectLocationID( uint32 itemID );
 
 	PyObject *ListFactions();
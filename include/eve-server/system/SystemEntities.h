@@ -30,6 +30,7 @@
 #include "system/SystemDB.h"	//for DBSystemEntity
 
 class SystemManager;
+class SystemBootData;
 
 //simple intermediate base class which eliminates a lot of the SystemEntity interface
 //for inanimate entities which do not care.
@@ -71,7 +72,7 @@ public:
 
 	static SimpleSystemEntity *MakeEntity(SystemManager *system, const DBSystemEntity &entity);
 	
-	virtual bool LoadExtras(SystemDB *db);
+	virtual bool LoadExtras(const SystemBootData &data);
 
 	//some of these are generic enough..
 	virtual PyDict *MakeSlimItem() const;
@@ -83,6 +84,7 @@ public:
 	virtual double GetRadius() const { return(data.radius); }
 	virtual const GPoint &GetPosition() const { return( data.position ); }
     virtual const GVector &GetVelocity() const;
+	virtual size_t GetMemoryUsage() const { return(sizeof(SimpleSystemEntity) + data.itemName.capacity()); }
 };
 
 class SystemPlanetEntity : public SimpleSystemEntity {
@@ -108,7 +110,7 @@ public:
 	SystemStargateEntity(SystemManager *system, const DBSystemEntity &entity);
 	virtual ~SystemStargateEntity();
 	
-	virtual bool LoadExtras(SystemDB *db);
+	virtual bool LoadExtras(const SystemBootData &data);
 	virtual PyDict *MakeSlimItem() const;
 	
 protected:
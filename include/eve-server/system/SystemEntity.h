@@ -31,6 +31,7 @@
 
 class PyDict;
 class PyList;
+class PyObject;
 class PyTuple;
 class DoDestiny_AddBall;
 class DoDestinyDamageState;
@@ -64,7 +65,7 @@ public:
 	} EntityClass;
 	
 	SystemEntity();
-	virtual ~SystemEntity() {}
+	virtual ~SystemEntity();
 	
 	TargetManager targets;
 	
@@ -110,6 +111,11 @@ public:
 	virtual void EncodeDestiny( Buffer& into ) const = 0;
 	//return ownership of a new foo.SlimItem dict
 	virtual PyDict *MakeSlimItem() const = 0;
+	//return a new reference to the foo.SlimItem object made of MakeSlimItem().
+	//it is kept until InvalidateCache() if we are visible system wide, for the current destiny tic otherwise.
+	PyObject *GetSlimItem() const;
+	//drop the kept slim item; call when anything it is made of changes.
+	void InvalidateCache();
 	//fill in the supplied damage state object.
 	virtual void MakeDamageState(DoDestinyDamageState &into) const = 0;
 	//return ownership of a new damage state tuple (calls MakeDamageState)
@@ -131,9 +137,15 @@ public:
 
 	//helpers:
 	double DistanceTo2(const SystemEntity *other) const;
+	//estimated memory held by this entity, not counting its item.
+	virtual size_t GetMemoryUsage() const { return(sizeof(SystemEntity)); }
 	
 protected:
 	SystemBubble *m_bubble;	//we do not own this, may be NULL. Only changed by SystemBubble
+
+private:
+	mutable PyObject *m_slimItem;	//we own a reference, NULL until GetSlimItem()
+	mutable uint32 m_slimItemStamp;	//destiny stamp m_slimItem was made on
 };
 
 class ItemSystemEntity : public SystemEntity {
@@ -188,6 +200,7 @@ public:
 	virtual uint32 GetAllianceID() const = 0;
 
 	inline DestinyManager *Destiny() const { return(m_destiny); }
+	virtual size_t GetMemoryUsage() const;
 	
 	virtual void Killed(Damage &fatal_blow);
 	
@@ -47,6 +47,21 @@ class DoDestiny_SetState;
 class SpawnManager;
 class PyServiceMgr;
 
+/*
+ * Everything a system reads from the DB to boot, as plain data, so that
+ * it may be read on a loader thread; see SystemManager::LoadSystem().
+ */
+class SystemBootData {
+public:
+	uint32 systemID;
+	std::string systemName;
+	std::string systemSecurity;
+	std::vector<DBSystemEntity> celestials;
+	std::vector<DBSystemDynamicEntity> dynamics;
+	std::map<uint32, std::vector<DBSystemJump> > jumps;	//by stargateID
+	ItemFactory::PrefetchData items;	//rows of the items in space, in the stations and of the celestials
+};
+
 class SystemManager
 //: public Inventory,
 //  public InventoryItem
@@ -62,7 +77,17 @@ public:
 	const std::string &GetName() const { return(m_systemName); }
 	double GetWarpSpeed() const;
 	
+	//reads what we need to boot from the DB; touches nothing but the DB, so it may run on any thread.
+	//the caller must announce it to the item factory first, see ItemFactory::QueuePrefetch().
+	static bool LoadSystem(ItemFactory &factory, SystemBootData &into);
+	//builds our entities from what LoadSystem() read, on the main thread; data is used up.
+	bool BootSystem(SystemBootData &data);
+	//both of the above at once.
 	bool BootSystem();
+	//saves what is not kept in the DB by itself and depops the NPCs, before we are deleted for being idle.
+	void Hibernate();
+	//deletes the NPCs along with their items; their spawns pop new ones.
+	void DepopNPCs();
 	
 	bool Process();
 	void ProcessDestiny();	//called once for each destiny second.
@@ -78,7 +103,18 @@ public:
 	
 	SystemEntity *get(uint32 entityID) const;
 	
+	//clients registered with us, docked or in space.
+	uint32 GetClientCount() const { return(m_clientCount); }
+	//time (Timer::GetTimeSeconds()) since which we have no clients; meaningless while we have some.
+	uint32 GetIdleSince() const { return(m_idleSince); }
+	//restarts our idle time; somebody is on the way here.
+	void KeepAwake();
+	//estimated memory held by us and our entities; their items are accounted by ItemFactory.
+	size_t GetMemoryUsage() const;
+	
 	void MakeSetState(const SystemBubble *bubble, DoDestiny_SetState &into) const;
+	//drops the part of the SetState kept for the entities visible system wide; call when any of them changes.
+	void InvalidateSystemWideState();
 
 	SystemDB *GetSystemDB() { return(&m_db); }
 	const char * GetSystemSecurity() { return m_systemSecurity.c_str(); }
@@ -100,8 +136,8 @@ protected:
     // Solar System Dynamic Inventory manager:
     SolarSystemRef m_solarSystemRef;    // we do not own this
 
-    bool _LoadSystemCelestials();
-	bool _LoadSystemDynamics();
+    void _LoadSystemCelestials(const SystemBootData &data);
+	void _LoadSystemDynamics(const SystemBootData &data);
 	
 	const uint32 m_systemID;
 	std::string m_systemName;
@@ -111,9 +147,41 @@ protected:
 	PyServiceMgr &m_services;	//we do not own this
 	SpawnManager *m_spawnManager;	//we own this, never NULL, dynamic to keep the knowledge down.
 	
+	//puts an entity into m_entities; queued while passing over it.
+	void _InsertEntity(SystemEntity *who);
+	//takes an entity out of m_entities; returns false if it is not there.
+	bool _EraseEntity(SystemEntity *who);
+	//moves the last entity into given slot.
+	void _EraseSlot(size_t index);
+	//applies the changes queued during a pass over m_entities.
+	void _EndPass();
+	//gathers the entities visible system wide and encodes their balls.
+	void _BuildSystemWideState() const;
+	
+	typedef std::tr1::unordered_map<uint32, size_t> EntityIndex;
+	typedef std::tr1::unordered_map<uint32, SystemEntity *> EntityMap;
+	
 	//overall system entity lists:
-	bool m_entityChanged;
-	std::map<uint32, SystemEntity *> m_entities;	//we own these, but they are also referenced in m_bubbles
+	std::vector<SystemEntity *> m_entities;	//we own these, but they are also referenced in m_bubbles. NULL for entities removed during a pass.
+	EntityIndex m_entityIndex;	//slot of each entity in m_entities.
+	
+	uint32 m_clientCount;
+	uint32 m_idleSince;
+	
+	//entities added or removed while passing over m_entities are queued
+	//and applied after the pass, so that each entity is processed once.
+	bool m_inPass;
+	EntityMap m_pendingAdds;	//not in m_entities yet, but found by get().
+	std::vector<size_t> m_pendingRemoves;	//slots of m_entities emptied during the pass.
+	
+	//the part of the SetState which is the same in every bubble, kept by
+	//MakeSetState() until InvalidateSystemWideState().
+	mutable bool m_systemWideValid;
+	mutable std::vector<SystemEntity *> m_systemWide;	//entities visible system wide, in m_entities or m_pendingAdds.
+	mutable Buffer m_systemWideBalls;	//their destiny balls, one after another.
+	//nothing changes these while we run; NULL until queried successfully.
+	mutable PyRep *m_solItem;	//we own a reference
+	mutable PyRep *m_droneState;	//we own a reference
 };
 
 
@@ -0,0 +1,97 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#ifndef __TICPROFILER_H_INCL__
+#define __TICPROFILER_H_INCL__
+
+#include "utils/Singleton.h"
+
+//Time spent in the phases of the destiny tic of a system.
+//
+//Phases nest: time is charged to the innermost phase only, so a
+//bubblecast from within the physics of a ball counts as bubblecast.
+//Time outside of any phase is not counted at all.
+//
+//Only eve-bench collects the timings (it is built with EVEMU_BENCH);
+//in the server TIC_PHASE compiles to nothing.
+class TicProfiler
+: public Singleton<TicProfiler>
+{
+public:
+	enum Phase {
+		PHASE_PHYSICS,		//SystemManager::ProcessDestiny(), what is not below.
+		PHASE_BUBBLES,		//finding and updating bubbles of entities.
+		PHASE_BUBBLECAST,	//fan-out of destiny updates to the entities of a bubble.
+		PHASE_ENCODE,		//building and marshaling the queued updates of a client.
+		PHASE_COUNT
+	};
+	
+	TicProfiler();
+	
+	void Enter(Phase phase);
+	void Leave();
+	
+	//time spent in phase, in ns.
+	uint64 GetTime(Phase phase) const { return(m_time[phase]); }
+	//number of times phase was entered.
+	uint64 GetCount(Phase phase) const { return(m_count[phase]); }
+	void Reset();
+	
+	static const char *GetPhaseName(Phase phase);
+	//monotonic time in ns.
+	static uint64 GetNanoTime();
+	
+protected:
+	//charges the time since the last call to the current phase.
+	void _Charge(uint64 now);
+	
+	static const size_t MAX_DEPTH = 16;
+	
+	Phase m_stack[MAX_DEPTH];
+	size_t m_depth;
+	uint64 m_last;
+	
+	uint64 m_time[PHASE_COUNT];
+	uint64 m_count[PHASE_COUNT];
+};
+
+#define sTicProfiler \
+	( TicProfiler::get() )
+
+//enters a phase for the rest of the scope.
+class TicPhase {
+public:
+	TicPhase(TicProfiler::Phase phase) { sTicProfiler.Enter(phase); }
+	~TicPhase() { sTicProfiler.Leave(); }
+};
+
+#ifdef EVEMU_BENCH
+#   define TIC_PHASE( phase ) \
+	TicPhase _ticPhase( TicProfiler::phase )
+#else /* !EVEMU_BENCH */
+#   define TIC_PHASE( phase )
+#endif /* !EVEMU_BENCH */
+
+#endif /* !__TICPROFILER_H_INCL__ */
@@ -40,6 +40,7 @@
 /************************************************************************/
 /* common includes                                                      */
 /************************************************************************/
+#include "database/dbcore.h"
 #include "database/dbtype.h"
 
 #include "log/logsys.h"
@@ -63,6 +64,7 @@
 
 #include "database/RowsetReader.h"
 #include "database/RowsetToSQL.h"
+#include "database/StaticSnapshot.h"
 
 #include "destiny/DestinyBinDump.h"
 
@@ -80,6 +82,7 @@
 #include "python/classes/PyDatabase.h"
 
 #include "utils/EVEUtils.h"
+#include "utils/EvilNumber.h"
 
 #endif /* !__EVE_TOOL_PCH_H__INCL__ */
 
@@ -0,0 +1,11 @@
+/*
+ * Last change of each table cached objects are generated from.
+ * The server regenerates the objects of a table which changed after
+ * they were built; record manual edits with the /tablechanged command.
+ * changeTime is in Win32 time (100 ns since 1601-01-01).
+ */
+CREATE TABLE IF NOT EXISTS `cacheTableChanges` (
+  `tableName` varchar(64) NOT NULL,
+  `changeTime` bigint(20) unsigned NOT NULL,
+  PRIMARY KEY (`tableName`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8;
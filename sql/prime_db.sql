@@ -138,3 +138,13 @@ INSERT INTO eveStaticOwners (ownerID, ownerName, typeID)
  SELECT corporationID, corporationName, 2 AS typeID
  FROM corporationStatic;
 
+
+/*
+ * The cached objects built from the tables above are stale now.
+ */
+REPLACE INTO cacheTableChanges (tableName, changeTime) VALUES
+ ('alliance_shortnames', (UNIX_TIMESTAMP() + 11644473600) * 10000000),
+ ('cachelocations', (UNIX_TIMESTAMP() + 11644473600) * 10000000),
+ ('cacheowners', (UNIX_TIMESTAMP() + 11644473600) * 10000000),
+ ('corporation', (UNIX_TIMESTAMP() + 11644473600) * 10000000),
+ ('evestaticowners', (UNIX_TIMESTAMP() + 11644473600) * 10000000);
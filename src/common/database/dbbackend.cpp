@@ -0,0 +1,191 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "CommonPCH.h"
+
+#include "database/dbbackend.h"
+#include "database/dbcore.h"
+#include "database/dbmysql.h"
+#include "database/dbsqlite.h"
+
+#include "log/LogNew.h"
+#include "utils/utils_string.h"
+
+/************************************************************************/
+/* DBBackend                                                            */
+/************************************************************************/
+DBBackend* DBBackend::Create( const char* name )
+{
+    if( 0 == strcmp( name, "mysql" ) )
+        return new DBMySQLBackend;
+#ifdef EVEMU_SQLITE_ENABLE
+    if( 0 == strcmp( name, "sqlite" ) )
+        return new DBSQLiteBackend;
+#endif /* EVEMU_SQLITE_ENABLE */
+
+    return NULL;
+}
+
+uint32 DBBackend::EscapeString( char* to, const char* from, uint32 fromlen )
+{
+    char* const start = to;
+
+    for( uint32 i = 0; i < fromlen; ++i )
+    {
+        char esc = 0;
+        switch( from[ i ] )
+        {
+            case '\0':   esc = '0';  break;
+            case '\n':   esc = 'n';  break;
+            case '\r':   esc = 'r';  break;
+            case '\\':   esc = '\\'; break;
+            case '\'':   esc = '\''; break;
+            case '"':    esc = '"';  break;
+            case '\032': esc = 'Z';  break;
+        }
+
+        if( 0 != esc )
+        {
+            *to++ = '\\';
+            *to++ = esc;
+        }
+        else
+            *to++ = from[ i ];
+    }
+
+    *to = '\0';
+    return (uint32)( to - start );
+}
+
+bool DBBackend::LoadDump( DBerror& err, const char* file )
+{
+    FILE* f = fopen( file, "rb" );
+    if( NULL == f )
+    {
+        std::string msg;
+        sprintf( msg, "Unable to open dump %s.", file );
+
+        _SetError( err, 0xFFFF, msg.c_str() );
+        return false;
+    }
+
+    const uint32 start = GetTickCount();
+    uint32 statements = 0, skipped = 0;
+    bool success = true;
+
+    std::string statement;
+    // the quote we are in; 0 if none
+    int quote = 0;
+
+    int c;
+    while( success && EOF != ( c = getc( f ) ) )
+    {
+        if( 0 != quote )
+        {
+            statement += (char)c;
+
+            if( '\\' == c )
+            {
+                if( EOF == ( c = getc( f ) ) )
+                    break;
+
+                statement += (char)c;
+            }
+            else if( quote == c )
+                quote = 0;
+        }
+        else if( '\'' == c || '"' == c || '`' == c )
+        {
+            statement += (char)c;
+            quote = c;
+        }
+        else if( '#' == c || ( '-' == c && '-' == _Peek( f ) ) )
+        {
+            // comment till the end of line
+            while( EOF != c && '\n' != c )
+                c = getc( f );
+        }
+        else if( '/' == c && '*' == _Peek( f ) )
+        {
+            // block comment; conditional comments (/*!...*/) only carry
+            // server settings, so they are dropped as well
+            getc( f );
+
+            int prev = 0;
+            while( EOF != ( c = getc( f ) ) && !( '*' == prev && '/' == c ) )
+                prev = c;
+        }
+        else if( ';' == c )
+        {
+            if( statement.empty() )
+            {
+                // nothing left after dropping the comments
+            }
+            else if( _TranslateDumpStatement( statement ) )
+            {
+                success = Execute( err, statement.c_str(), (uint32)statement.size() );
+                if( success && 0 < FieldCount() )
+                    delete StoreResult( err );
+
+                ++statements;
+            }
+            else
+                ++skipped;
+
+            statement.clear();
+        }
+        else if( !statement.empty() || !isspace( c ) )
+            statement += (char)c;
+    }
+
+    fclose( f );
+
+    if( !success )
+    {
+        sLog.Error( "DBBackend", "Loading of dump %s failed after %u statements: %s", file, statements, err.c_str() );
+        return false;
+    }
+
+    sLog.Log( "DBBackend", "Loaded dump %s: %u statements (%u skipped) in %u ms.", file, statements, skipped, GetTickCount() - start );
+    return true;
+}
+
+int DBBackend::_Peek( FILE* f )
+{
+    const int c = getc( f );
+    ungetc( c, f );
+
+    return c;
+}
+
+void DBBackend::_SetError( DBerror& err, uint32 errNo, const char* str )
+{
+    err.SetError( errNo, str );
+}
+
+void DBBackend::_ClearError( DBerror& err )
+{
+    err.ClearError();
+}
@@ -26,6 +26,7 @@
 #include "CommonPCH.h"
 
 #include "database/dbcore.h"
+#include "database/dbwritequeue.h"
 
 #include "log/LogNew.h"
 #include "log/logsys.h"
@@ -35,50 +36,120 @@
 
 DBcore::DBcore(bool compress, bool ssl) : pCompress(compress), pSSL(ssl)
 {
-    mysql_init(&mysql);
-    pStatus = Closed;
+    mConnection.backend = DBBackend::Create("mysql");
+
+#ifdef WIN32
+    mThreadConnection = TlsAlloc();
+#else
+    pthread_key_create(&mThreadConnection, NULL);
+#endif /* !WIN32 */
 }
 
 DBcore::~DBcore()
 {
-    mysql_close(&mysql);
+    SafeDelete(mConnection.backend);
+
+#ifdef WIN32
+    TlsFree(mThreadConnection);
+#else
+    pthread_key_delete(mThreadConnection);
+#endif /* !WIN32 */
+}
+
+bool DBcore::SetBackend(const char* name)
+{
+    DBBackend* backend = DBBackend::Create(name);
+    if(backend == NULL) {
+        sLog.Error("dbcore", "Unknown database backend '%s' (or support for it has not been compiled in).", name);
+        return false;
+    }
+
+    MutexLock lock(mConnection.lock);
+
+    SafeDelete(mConnection.backend);
+    mConnection.backend = backend;
+    mConnection.status = Closed;
+
+    return true;
+}
+
+bool DBcore::LoadDump(DBerror &err, const char *file)
+{
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    if (conn.status != Connected && !Open_locked(conn)) {
+        err.SetError(0xFFFF, "DBcore::LoadDump: Not connected");
+        return false;
+    }
+
+    return conn.backend->LoadDump(err, file);
 }
 
 // Sends the MySQL server a ping
 void DBcore::ping()
 {
     // well, if it's locked, someone's using it. If someone's using it, it doesn't need a ping
-    if( MDatabase.TryLock() )
+    if( mConnection.lock.TryLock() )
     {
-        mysql_ping( &mysql );
-        MDatabase.Unlock();
+        mConnection.backend->Ping();
+        mConnection.lock.Unlock();
     }
 }
 
+bool DBcore::IsConnectionLost(uint32 errNo)
+{
+    return _GetConnection().backend->IsConnectionLost(errNo);
+}
+
 //query which returns a result (error is stored in the result if it occurs)
 bool DBcore::RunQuery(DBQueryResult &into, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
+    va_list vlist;
+
+    // static data is served from the snapshot without locking the connection
+    if(mSnapshot.IsOpen()) {
+        va_start(vlist, query_fmt);
+        DBResultSet *result = mSnapshot.Find(query_fmt, vlist);
+        va_end(vlist);
+
+        if(result != NULL) {
+            into.SetResult(result);
+            return true;
+        }
+    }
 
     char query[16384];
-    va_list vlist;
     va_start(vlist, query_fmt);
     uint32 querylen = vsnprintf(query, 16384, query_fmt, vlist);
     va_end(vlist);
 
-    if(!DoQuery_locked(into.error, query, querylen))
+    // rows still waiting in the write queue go in before anything else touches their table
+    sDBWriteQueue.FlushFor(query);
+
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    const uint64 start = DBProfiler::GetMicroTime();
+
+    if(!DoQuery_locked(conn, into.error, query, querylen))
         return false;
 
-    uint32 col_count = mysql_field_count(&mysql);
+    uint32 col_count = conn.backend->FieldCount();
     if(col_count == 0) {
         into.error.SetError(0xFFFF, "DBcore::RunQuery: No Result");
         sLog.Error("DBCore Query", "Query: %s failed because did not return a result", query);
         return false;
     }
 
-    MYSQL_RES *result = mysql_store_result(&mysql);
+    DBResultSet *result = conn.backend->StoreResult(into.error);
+    if(result == NULL) {
+        sLog.Error("DBCore Query", "Query: %s failed to fetch its result: %s", query, into.error.c_str());
+        return false;
+    }
 
     //give them the result set.
-    into.SetResult(&result, col_count);
+    into.SetResult(result, NULL,
+                   mProfiler.Record(query_fmt, query, DBProfiler::GetMicroTime() - start, 0));
 	
 	//DEBUG STUFF
 	//sLog.Debug("%s",query);
@@ -88,104 +159,181 @@ bool DBcore::RunQuery(DBQueryResult &into, const char *query_fmt, ...) {
     return true;
 }
 
+//query which streams its result
+bool DBcore::RunQueryStream(DBQueryResult &into, const char *query_fmt, ...) {
+    va_list vlist;
+
+    if(mSnapshot.IsOpen()) {
+        va_start(vlist, query_fmt);
+        DBResultSet *result = mSnapshot.Find(query_fmt, vlist);
+        va_end(vlist);
+
+        if(result != NULL) {
+            into.SetResult(result);
+            return true;
+        }
+    }
+
+    char query[16384];
+    va_start(vlist, query_fmt);
+    uint32 querylen = vsnprintf(query, 16384, query_fmt, vlist);
+    va_end(vlist);
+
+    sDBWriteQueue.FlushFor(query);
+
+    // released by the result once it has been consumed
+    Connection& conn = _GetConnection();
+    conn.lock.Lock();
+
+    const uint64 start = DBProfiler::GetMicroTime();
+
+    if(!DoQuery_locked(conn, into.error, query, querylen)) {
+        conn.lock.Unlock();
+        return false;
+    }
+
+    uint32 col_count = conn.backend->FieldCount();
+    if(col_count == 0) {
+        conn.lock.Unlock();
+        into.error.SetError(0xFFFF, "DBcore::RunQueryStream: No Result");
+        sLog.Error("DBCore Query", "Query: %s failed because did not return a result", query);
+        return false;
+    }
+
+    DBResultSet *result = conn.backend->UseResult(into.error);
+    if(result == NULL) {
+        conn.lock.Unlock();
+        sLog.Error("DBCore Query", "Query: %s failed to stream its result: %s", query, into.error.c_str());
+        return false;
+    }
+
+    //give them the result set; they unlock the connection once done.
+    //the latency covers the query only, the rows are yet to come.
+    into.SetResult(result, &conn.lock,
+                   mProfiler.Record(query_fmt, query, DBProfiler::GetMicroTime() - start, 0));
+
+    return true;
+}
+
 //query which returns no information except error status
 bool DBcore::RunQuery(DBerror &err, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
+    sDBWriteQueue.FlushFor(query);
+
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    const uint64 start = DBProfiler::GetMicroTime();
+
+    if(!DoQuery_locked(conn, err, query, querylen)) {
         free(query);
         return false;
     }
 
+    mProfiler.Record(query_fmt, query, DBProfiler::GetMicroTime() - start, conn.backend->AffectedRows());
+
     free(query);
     return true;
 }
 
 //query which returns affected rows:
 bool DBcore::RunQuery(DBerror &err, uint32 &affected_rows, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
+    sDBWriteQueue.FlushFor(query);
+
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    const uint64 start = DBProfiler::GetMicroTime();
+
+    if(!DoQuery_locked(conn, err, query, querylen)) {
         free(query);
         return false;
     }
-    free(query);
 
-    affected_rows = (uint32)mysql_affected_rows(&mysql);
+    affected_rows = (uint32)conn.backend->AffectedRows();
+
+    mProfiler.Record(query_fmt, query, DBProfiler::GetMicroTime() - start, affected_rows);
+    free(query);
 
     return true;
 }
 
 //query which returns last insert ID:
 bool DBcore::RunQueryLID(DBerror &err, uint32 &last_insert_id, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
+    sDBWriteQueue.FlushFor(query);
+
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    const uint64 start = DBProfiler::GetMicroTime();
+
+    if(!DoQuery_locked(conn, err, query, querylen)) {
         free(query);
         return false;
     }
+
+    mProfiler.Record(query_fmt, query, DBProfiler::GetMicroTime() - start, conn.backend->AffectedRows());
     free(query);
 
-    last_insert_id = (uint32)mysql_insert_id(&mysql);
+    last_insert_id = (uint32)conn.backend->InsertID();
 
     return true;
 }
 
-bool DBcore::DoQuery_locked(DBerror &err, const char *query, int32 querylen, bool retry)
+bool DBcore::DoQuery_locked(Connection& conn, DBerror &err, const char *query, int32 querylen, bool retry)
 {
-    if (pStatus != Connected)
-        Open_locked();
+    if (conn.status != Connected)
+        Open_locked(conn);
 
-    if (mysql_real_query(&mysql, query, querylen)) {
-        int num = mysql_errno(&mysql);
-
-        if (num == CR_SERVER_GONE_ERROR)
-            pStatus = Error;
-
-        if (retry && (num == CR_SERVER_LOST || num == CR_SERVER_GONE_ERROR))
+    if (!conn.backend->Execute(err, query, querylen)) {
+        if (retry && conn.backend->IsConnectionLost(err.GetErrNo()))
         {
+            conn.status = Error;
             sLog.Error("DBCore", "Lost connection, attempting to recover....");
-            return DoQuery_locked(err, query, querylen, false);
+            return DoQuery_locked(conn, err, query, querylen, false);
         }
 
-        pStatus = Error;
-        err.SetError(num, mysql_error(&mysql));
+        conn.status = Error;
         sLog.Error("DBCore Query", "#%d in '%s': %s", err.GetErrNo(), query, err.c_str());
         return false;
     }
 
-    err.ClearError();
     return true;
 }
 
 
-bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES** result, int32* affected_rows, int32* last_insert_id, int32* errnum, bool retry) {
+bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, DBQueryResult* result, int32* affected_rows, int32* last_insert_id, int32* errnum, bool retry) {
     if (errnum)
         *errnum = 0;
     if (errbuf)
         errbuf[0] = 0;
-    MutexLock lock(MDatabase);
+    // the write queue writes its rows through here
+    if (result)
+        sDBWriteQueue.FlushFor(query);
+    Connection& conn = _GetConnection();
+    MutexLock lock(conn.lock);
+
+    const uint64 start = DBProfiler::GetMicroTime();
 
     DBerror err;
-    if(!DoQuery_locked(err, query, querylen, retry))
+    if(!DoQuery_locked(conn, err, query, querylen, retry))
     {
         sLog.Error("DBCore Query", "Query: %s failed", query);
         if(errnum != NULL)
@@ -200,10 +348,9 @@ bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES
     }
 
     if (result) {
-        if(mysql_field_count(&mysql)) {
-            *result = mysql_store_result(&mysql);
+        if(conn.backend->FieldCount()) {
+            result->SetResult(conn.backend->StoreResult(result->error));
         } else {
-            *result = NULL;
             if (errnum)
                 *errnum = UINT_MAX;
  
@@ -216,23 +363,26 @@ bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES
             return false;
         }
     }
+    mProfiler.Record(NULL, query, DBProfiler::GetMicroTime() - start,
+                     result ? result->GetRowCount() : conn.backend->AffectedRows());
+
     if (affected_rows)
-        *affected_rows = (uint32)mysql_affected_rows(&mysql);
+        *affected_rows = (uint32)conn.backend->AffectedRows();
     if (last_insert_id)
-        *last_insert_id = (uint32)mysql_insert_id(&mysql);
+        *last_insert_id = (uint32)conn.backend->InsertID();
     return true;
 }
 
 int32 DBcore::DoEscapeString(char* tobuf, const char* frombuf, int32 fromlen)
 {
-    return mysql_real_escape_string(&mysql, tobuf, frombuf, fromlen);
+    return _GetConnection().backend->EscapeString(tobuf, frombuf, fromlen);
 }
 
 void DBcore::DoEscapeString(std::string &to, const std::string &from)
 {
     uint32 len = (uint32)from.length();
     to.resize(len*2 + 1);   // make enough room
-    uint32 esc_len = mysql_real_escape_string(&mysql, &to[0], from.c_str(), len);
+    uint32 esc_len = _GetConnection().backend->EscapeString(&to[0], from.c_str(), len);
     to.resize(esc_len+1); // optional.
 }
 
@@ -249,7 +399,7 @@ bool DBcore::IsSafeString(const char *str) {
 }
 
 bool DBcore::Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum, char* errbuf, bool iCompress, bool iSSL) {
-    MutexLock lock(MDatabase);
+    MutexLock lock(mConnection.lock);
 
     pHost = iHost;
     pUser = iUser;
@@ -259,11 +409,11 @@ bool DBcore::Open(const char* iHost, const char* iUser, const char* iPassword, c
     pPort = iPort;
     pSSL = iSSL;
 
-    return Open_locked(errnum, errbuf);
+    return Open_locked(mConnection, errnum, errbuf);
 }
 
 bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress, bool iSSL) {
-    MutexLock lock(MDatabase);
+    MutexLock lock(mConnection.lock);
 
     pHost = iHost;
     pUser = iUser;
@@ -276,7 +426,7 @@ bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char
     int32 errnum;
     char errbuf[1024];
 
-    if(!Open_locked(&errnum, errbuf)) {
+    if(!Open_locked(mConnection, &errnum, errbuf)) {
         err.SetError(errnum, errbuf);
         return false;
     }
@@ -285,52 +435,101 @@ bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char
 }
 
 
-bool DBcore::Open_locked(int32* errnum, char* errbuf) {
+bool DBcore::Open_locked(Connection& conn, int32* errnum, char* errbuf) {
     if (errbuf)
         errbuf[0] = 0;
-    if (GetStatus() == Connected)
+    if (conn.status == Connected)
         return true;
-    if (GetStatus() == Error)
-        mysql_close(&mysql);    //do we need to call init again?
+    if (conn.status == Error)
+        conn.backend->Close();
     if (pHost.empty())
         return false;
 
-    sLog.Log("dbcore", "Connecting to\n\tDB:\t%s\n\tserver:\t%s:%d\n\tuser:\t%s", pDatabase.c_str(), pHost.c_str(), pPort, pUser.c_str());
-
-    /*
-    Quagmire - added CLIENT_FOUND_ROWS flag to the connect
-    otherwise DB update calls would say 0 rows affected when the value already equaled
-    what the function was trying to set it to, therefore the function would think it failed
-    */
-    int32 flags = CLIENT_FOUND_ROWS;
-    if (pCompress)
-        flags |= CLIENT_COMPRESS;
-    if (pSSL)
-        flags |= CLIENT_SSL;
-    if (mysql_real_connect(&mysql, pHost.c_str(), pUser.c_str(), pPassword.c_str(), pDatabase.c_str(), pPort, 0, flags)) {
-        pStatus = Connected;
-    } else {
-        pStatus = Error;
+    sLog.Log("dbcore", "Connecting to\n\tDB:\t%s\n\tserver:\t%s:%d\n\tuser:\t%s\n\tbackend:\t%s", pDatabase.c_str(), pHost.c_str(), pPort, pUser.c_str(), conn.backend->GetName());
+
+    DBerror err;
+    if (!conn.backend->Connect(err, pHost.c_str(), pUser.c_str(), pPassword.c_str(), pDatabase.c_str(), pPort, pCompress, pSSL)) {
+        conn.status = Error;
         if (errnum)
-            *errnum = mysql_errno(&mysql);
+            *errnum = err.GetErrNo();
         if (errbuf)
-            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&mysql), mysql_error(&mysql));
+            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", err.GetErrNo(), err.c_str());
+        return false;
+    }
+
+    conn.status = Connected;
+    return true;
+}
+
+bool DBcore::OpenThreadConnection(DBerror &err)
+{
+    if (&_GetConnection() != &mConnection) {
+        err.SetError(0xFFFF, "DBcore::OpenThreadConnection: Thread already has a connection");
         return false;
     }
 
-    // Setup character set we wish to use
-    if(mysql_set_character_set(&mysql, "utf8") != 0) {
-        pStatus = Error;
-        if(errnum)
-            *errnum = mysql_errno(&mysql);
-        if(errbuf)
-            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&mysql), mysql_error(&mysql));
+    // an in-memory database exists within its connection only; a new one would be empty
+    if (pDatabase == ":memory:")
+        return true;
+
+    Connection* conn = new Connection;
+    conn->backend = DBBackend::Create(GetBackendName());
+
+    int32 errnum;
+    char errbuf[1024];
+
+    if (conn->backend == NULL || !Open_locked(*conn, &errnum, errbuf)) {
+        if (conn->backend == NULL)
+            err.SetError(0xFFFF, "DBcore::OpenThreadConnection: Unable to create backend");
+        else
+            err.SetError(errnum, errbuf);
+
+        SafeDelete(conn->backend);
+        SafeDelete(conn);
         return false;
     }
 
+#ifdef WIN32
+    TlsSetValue(mThreadConnection, conn);
+#else
+    pthread_setspecific(mThreadConnection, conn);
+#endif /* !WIN32 */
+
     return true;
 }
 
+void DBcore::CloseThreadConnection()
+{
+    Connection* conn = &_GetConnection();
+    if (conn == &mConnection)
+        return;
+
+#ifdef WIN32
+    TlsSetValue(mThreadConnection, NULL);
+#else
+    pthread_setspecific(mThreadConnection, NULL);
+#endif /* !WIN32 */
+
+    {
+        MutexLock lock(conn->lock);
+        conn->backend->Close();
+    }
+
+    SafeDelete(conn->backend);
+    SafeDelete(conn);
+}
+
+DBcore::Connection& DBcore::_GetConnection()
+{
+#ifdef WIN32
+    Connection* conn = (Connection*)TlsGetValue(mThreadConnection);
+#else
+    Connection* conn = (Connection*)pthread_getspecific(mThreadConnection);
+#endif /* !WIN32 */
+
+    return (conn != NULL ? *conn : mConnection);
+}
+
 /************************************************************************/
 /* DBerror                                                              */
 /************************************************************************/
@@ -354,84 +553,19 @@ void DBerror::ClearError()
 /************************************************************************/
 /* DBQueryResult                                                        */
 /************************************************************************/
-/* mysql to DBTYPE convention table */
-/* treating all strings as wide isn't probably the best solution but it's
-   the easiest one which preserves wide strings. */
-const DBTYPE DBQueryResult::MYSQL_DBTYPE_TABLE_SIGNED[] =
-{
-    DBTYPE_ERROR,   //[ 0]MYSQL_TYPE_DECIMAL            /* DECIMAL or NUMERIC field */
-    DBTYPE_I1,      //[ 1]MYSQL_TYPE_TINY               /* TINYINT field */
-    DBTYPE_I2,      //[ 2]MYSQL_TYPE_SHORT              /* SMALLINT field */
-    DBTYPE_I4,      //[ 3]MYSQL_TYPE_LONG               /* INTEGER field */
-    DBTYPE_R4,      //[ 4]MYSQL_TYPE_FLOAT              /* FLOAT field */
-    DBTYPE_R8,      //[ 5]MYSQL_TYPE_DOUBLE             /* DOUBLE or REAL field */
-    DBTYPE_ERROR,   //[ 6]MYSQL_TYPE_NULL               /* NULL-type field */
-    DBTYPE_FILETIME,//[ 7]MYSQL_TYPE_TIMESTAMP          /* TIMESTAMP field */
-    DBTYPE_I8,      //[ 8]MYSQL_TYPE_LONGLONG           /* BIGINT field */
-    DBTYPE_I4,      //[ 9]MYSQL_TYPE_INT24              /* MEDIUMINT field */
-    DBTYPE_ERROR,   //[10]MYSQL_TYPE_DATE               /* DATE field */
-    DBTYPE_ERROR,   //[11]MYSQL_TYPE_TIME               /* TIME field */
-    DBTYPE_ERROR,   //[12]MYSQL_TYPE_DATETIME           /* DATETIME field */
-    DBTYPE_ERROR,   //[13]MYSQL_TYPE_YEAR               /* YEAR field */
-    DBTYPE_ERROR,   //[14]MYSQL_TYPE_NEWDATE            /* ??? */
-    DBTYPE_ERROR,   //[15]MYSQL_TYPE_VARCHAR            /* ??? */
-    DBTYPE_BOOL,    //[16]MYSQL_TYPE_BIT                /* BIT field (MySQL 5.0.3 and up) */
-    DBTYPE_ERROR,   //[17]MYSQL_TYPE_NEWDECIMAL=246     /* Precision math DECIMAL or NUMERIC field (MySQL 5.0.3 and up) */
-    DBTYPE_ERROR,   //[18]MYSQL_TYPE_ENUM=247           /* ENUM field */
-    DBTYPE_ERROR,   //[19]MYSQL_TYPE_SET=248            /* SET field */
-    DBTYPE_WSTR,    //[20]MYSQL_TYPE_TINY_BLOB=249      /* TINYBLOB or TINYTEXT field */
-    DBTYPE_WSTR,    //[21]MYSQL_TYPE_MEDIUM_BLOB=250    /* MEDIUMBLOB or MEDIUMTEXT field */
-    DBTYPE_WSTR,    //[22]MYSQL_TYPE_LONG_BLOB=251      /* LONGBLOB or LONGTEXT field */
-    DBTYPE_WSTR,    //[23]MYSQL_TYPE_BLOB=252           /* BLOB or TEXT field */
-    DBTYPE_WSTR,    //[24]MYSQL_TYPE_VAR_STRING=253     /* VARCHAR or VARBINARY field */
-    DBTYPE_WSTR,    //[25]MYSQL_TYPE_STRING=254         /* CHAR or BINARY field */
-    DBTYPE_ERROR,   //[26]MYSQL_TYPE_GEOMETRY=255       /* Spatial field */
-};
-
-const DBTYPE DBQueryResult::MYSQL_DBTYPE_TABLE_UNSIGNED[] =
-{
-    DBTYPE_ERROR,   //[ 0]MYSQL_TYPE_DECIMAL            /* DECIMAL or NUMERIC field */
-    DBTYPE_UI1,     //[ 1]MYSQL_TYPE_TINY               /* TINYINT field */
-    DBTYPE_UI2,     //[ 2]MYSQL_TYPE_SHORT              /* SMALLINT field */
-    DBTYPE_UI4,     //[ 3]MYSQL_TYPE_LONG               /* INTEGER field */
-    DBTYPE_R4,      //[ 4]MYSQL_TYPE_FLOAT              /* FLOAT field */
-    DBTYPE_R8,      //[ 5]MYSQL_TYPE_DOUBLE             /* DOUBLE or REAL field */
-    DBTYPE_ERROR,   //[ 6]MYSQL_TYPE_NULL               /* NULL-type field */
-    DBTYPE_FILETIME,//[ 7]MYSQL_TYPE_TIMESTAMP          /* TIMESTAMP field */
-    DBTYPE_UI8,     //[ 8]MYSQL_TYPE_LONGLONG           /* BIGINT field */
-    DBTYPE_UI4,     //[ 9]MYSQL_TYPE_INT24              /* MEDIUMINT field */
-    DBTYPE_ERROR,   //[10]MYSQL_TYPE_DATE               /* DATE field */
-    DBTYPE_ERROR,   //[11]MYSQL_TYPE_TIME               /* TIME field */
-    DBTYPE_ERROR,   //[12]MYSQL_TYPE_DATETIME           /* DATETIME field */
-    DBTYPE_ERROR,   //[13]MYSQL_TYPE_YEAR               /* YEAR field */
-    DBTYPE_ERROR,   //[14]MYSQL_TYPE_NEWDATE            /* ??? */
-    DBTYPE_ERROR,   //[15]MYSQL_TYPE_VARCHAR            /* ??? */
-    DBTYPE_BOOL,    //[16]MYSQL_TYPE_BIT                /* BIT field (MySQL 5.0.3 and up) */
-    DBTYPE_ERROR,   //[17]MYSQL_TYPE_NEWDECIMAL=246     /* Precision math DECIMAL or NUMERIC field (MySQL 5.0.3 and up) */
-    DBTYPE_ERROR,   //[18]MYSQL_TYPE_ENUM=247           /* ENUM field */
-    DBTYPE_ERROR,   //[19]MYSQL_TYPE_SET=248            /* SET field */
-    DBTYPE_WSTR,    //[20]MYSQL_TYPE_TINY_BLOB=249      /* TINYBLOB or TINYTEXT field */
-    DBTYPE_WSTR,    //[21]MYSQL_TYPE_MEDIUM_BLOB=250    /* MEDIUMBLOB or MEDIUMTEXT field */
-    DBTYPE_WSTR,    //[22]MYSQL_TYPE_LONG_BLOB=251      /* LONGBLOB or LONGTEXT field */
-    DBTYPE_WSTR,    //[23]MYSQL_TYPE_BLOB=252           /* BLOB or TEXT field */
-    DBTYPE_WSTR,    //[24]MYSQL_TYPE_VAR_STRING=253     /* VARCHAR or VARBINARY field */
-    DBTYPE_WSTR,    //[25]MYSQL_TYPE_STRING=254         /* CHAR or BINARY field */
-    DBTYPE_ERROR,   //[26]MYSQL_TYPE_GEOMETRY=255       /* Spatial field */
-};
-
 DBQueryResult::DBQueryResult()
 : mColumnCount( 0 ),
   mResult( NULL ),
-  mFields( NULL )
+  mStreamLock( NULL ),
+  mProfile( NULL ),
+  mFetchedRows( 0 ),
+  mFetchedBytes( 0 )
 {
 }
 
 DBQueryResult::~DBQueryResult()
 {
-    SafeDeleteArray( mFields );
-
-    if( NULL != mResult )
-        mysql_free_result( mResult );
+    _Free();
 }
 
 bool DBQueryResult::GetRow( DBResultRow& into )
@@ -439,13 +573,27 @@ bool DBQueryResult::GetRow( DBResultRow& into )
     if( NULL == mResult )
         return false;
 
-    MYSQL_ROW row = mysql_fetch_row( mResult );
-    if( NULL == row )
-        return false;
+    const char* const* row;
+    const unsigned long* lengths;
+    if( !mResult->FetchRow( row, lengths ) )
+    {
+        if( NULL != mStreamLock )
+        {
+            // all rows have been read, the connection is free again;
+            // the field info stays valid until the result is freed.
+            mStreamLock->Unlock();
+            mStreamLock = NULL;
+        }
 
-    const unsigned long* lengths = mysql_fetch_lengths( mResult );
-    if( NULL == lengths )
         return false;
+    }
+
+    if( NULL != mProfile )
+    {
+        ++mFetchedRows;
+        for( uint32 i = 0; i < mColumnCount; ++i )
+            mFetchedBytes += lengths[ i ];
+    }
 
     into.SetData( this, row, lengths );
     return true;
@@ -453,8 +601,14 @@ bool DBQueryResult::GetRow( DBResultRow& into )
 
 void DBQueryResult::Reset()
 {
+    if( IsStreamed() )
+    {
+        sLog.Error( "DBCore Query Result", "Reset: Cannot rewind a streamed result." );
+        return;
+    }
+
     if( NULL != mResult )
-        mysql_data_seek( mResult, 0);
+        mResult->Rewind();
 }
 
 const char* DBQueryResult::ColumnName( uint32 index ) const
@@ -466,7 +620,7 @@ const char* DBQueryResult::ColumnName( uint32 index ) const
         return "(ERROR)";      //nothing better to do...
     }
 #endif
-    return mFields[ index ]->name;
+    return mResult->ColumnName( index );
 }
 
 DBTYPE DBQueryResult::ColumnType( uint32 index ) const
@@ -479,58 +633,38 @@ DBTYPE DBQueryResult::ColumnType( uint32 index ) const
     }
 #endif
 
-    uint32 columnType = mFields[ index ]->type;
-
-    /* tricky needs to be checked */
-    if ( columnType > MYSQL_TYPE_BIT )
-        columnType -= ( MYSQL_TYPE_NEWDECIMAL - MYSQL_TYPE_BIT - 1 );
-
-    DBTYPE result = ( IsUnsigned( index ) ? MYSQL_DBTYPE_TABLE_UNSIGNED : MYSQL_DBTYPE_TABLE_SIGNED )[ columnType ];
-
-    /* if result is (wide) binary string, set result to DBTYPE_BYTES. */
-    if( ( DBTYPE_STR == result
-          || DBTYPE_WSTR == result )
-        && IsBinary( index ) )
-    {
-        result = DBTYPE_BYTES;
-    }
-
-    /* debug check */
-    assert( DBTYPE_ERROR != result );
-    return result;
+    return mResult->ColumnType( index );
 }
 
-bool DBQueryResult::IsUnsigned( uint32 index ) const
+void DBQueryResult::SetResult( DBResultSet* res, Mutex* streamLock, DBProfiler::Entry* profile )
 {
-    return 0 != ( mFields[ index ]->flags & UNSIGNED_FLAG );
-}
+    _Free();
 
-bool DBQueryResult::IsBinary( uint32 index ) const
-{
-    // According to MySQL C API Documentation, binary string
-    // fields like BLOB or VAR_BINARY have charset "63".
-    return 63 == mFields[ index ]->charsetnr;
+    mResult = res;
+    mColumnCount = ( NULL != res ? res->ColumnCount() : 0 );
+    mStreamLock = streamLock;
+    mProfile = profile;
 }
 
-void DBQueryResult::SetResult( MYSQL_RES** res, uint32 colCount )
+void DBQueryResult::_Free()
 {
-    SafeDeleteArray( mFields );
+    // for an unfinished streamed result this also drains the remaining rows
+    SafeDelete( mResult );
 
-    if( NULL != mResult )
-        mysql_free_result( mResult );
+    if( NULL != mStreamLock )
+    {
+        mStreamLock->Unlock();
+        mStreamLock = NULL;
+    }
 
-    mResult = *res;
-    *res = NULL;
-    mColumnCount = colCount;
+    if( NULL != mProfile )
+    {
+        sDatabase.profiler().AddRows( mProfile, mFetchedRows, mFetchedBytes );
 
-    if( NULL != mResult )
-	{
-		mFields = new MYSQL_FIELD*[ ColumnCount() ];
-	    
-		// we are
-		for( uint32 i = 0; i < ColumnCount(); ++i )
-			mFields[ i ] = mysql_fetch_field( mResult );
-	}
+        mProfile = NULL;
+        mFetchedRows = 0;
+        mFetchedBytes = 0;
+    }
 }
 
 DBResultRow::DBResultRow()
@@ -650,7 +784,7 @@ double DBResultRow::GetDouble( uint32 index ) const
     return strtod( GetText( index ), NULL );
 }
 
-void DBResultRow::SetData( DBQueryResult* res, MYSQL_ROW& row, const unsigned long* lengths )
+void DBResultRow::SetData( DBQueryResult* res, const char* const* row, const unsigned long* lengths )
 {
     mRow = row;
     mResult = res;
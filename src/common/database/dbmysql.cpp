@@ -0,0 +1,285 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "CommonPCH.h"
+
+#include "database/dbcore.h"
+#include "database/dbmysql.h"
+
+/************************************************************************/
+/* DBMySQLResult                                                        */
+/************************************************************************/
+/* mysql to DBTYPE convention table */
+/* treating all strings as wide isn't probably the best solution but it's
+   the easiest one which preserves wide strings. */
+const DBTYPE DBMySQLResult::MYSQL_DBTYPE_TABLE_SIGNED[] =
+{
+    DBTYPE_ERROR,   //[ 0]MYSQL_TYPE_DECIMAL            /* DECIMAL or NUMERIC field */
+    DBTYPE_I1,      //[ 1]MYSQL_TYPE_TINY               /* TINYINT field */
+    DBTYPE_I2,      //[ 2]MYSQL_TYPE_SHORT              /* SMALLINT field */
+    DBTYPE_I4,      //[ 3]MYSQL_TYPE_LONG               /* INTEGER field */
+    DBTYPE_R4,      //[ 4]MYSQL_TYPE_FLOAT              /* FLOAT field */
+    DBTYPE_R8,      //[ 5]MYSQL_TYPE_DOUBLE             /* DOUBLE or REAL field */
+    DBTYPE_ERROR,   //[ 6]MYSQL_TYPE_NULL               /* NULL-type field */
+    DBTYPE_FILETIME,//[ 7]MYSQL_TYPE_TIMESTAMP          /* TIMESTAMP field */
+    DBTYPE_I8,      //[ 8]MYSQL_TYPE_LONGLONG           /* BIGINT field */
+    DBTYPE_I4,      //[ 9]MYSQL_TYPE_INT24              /* MEDIUMINT field */
+    DBTYPE_ERROR,   //[10]MYSQL_TYPE_DATE               /* DATE field */
+    DBTYPE_ERROR,   //[11]MYSQL_TYPE_TIME               /* TIME field */
+    DBTYPE_ERROR,   //[12]MYSQL_TYPE_DATETIME           /* DATETIME field */
+    DBTYPE_ERROR,   //[13]MYSQL_TYPE_YEAR               /* YEAR field */
+    DBTYPE_ERROR,   //[14]MYSQL_TYPE_NEWDATE            /* ??? */
+    DBTYPE_ERROR,   //[15]MYSQL_TYPE_VARCHAR            /* ??? */
+    DBTYPE_BOOL,    //[16]MYSQL_TYPE_BIT                /* BIT field (MySQL 5.0.3 and up) */
+    DBTYPE_ERROR,   //[17]MYSQL_TYPE_NEWDECIMAL=246     /* Precision math DECIMAL or NUMERIC field (MySQL 5.0.3 and up) */
+    DBTYPE_ERROR,   //[18]MYSQL_TYPE_ENUM=247           /* ENUM field */
+    DBTYPE_ERROR,   //[19]MYSQL_TYPE_SET=248            /* SET field */
+    DBTYPE_WSTR,    //[20]MYSQL_TYPE_TINY_BLOB=249      /* TINYBLOB or TINYTEXT field */
+    DBTYPE_WSTR,    //[21]MYSQL_TYPE_MEDIUM_BLOB=250    /* MEDIUMBLOB or MEDIUMTEXT field */
+    DBTYPE_WSTR,    //[22]MYSQL_TYPE_LONG_BLOB=251      /* LONGBLOB or LONGTEXT field */
+    DBTYPE_WSTR,    //[23]MYSQL_TYPE_BLOB=252           /* BLOB or TEXT field */
+    DBTYPE_WSTR,    //[24]MYSQL_TYPE_VAR_STRING=253     /* VARCHAR or VARBINARY field */
+    DBTYPE_WSTR,    //[25]MYSQL_TYPE_STRING=254         /* CHAR or BINARY field */
+    DBTYPE_ERROR,   //[26]MYSQL_TYPE_GEOMETRY=255       /* Spatial field */
+};
+
+const DBTYPE DBMySQLResult::MYSQL_DBTYPE_TABLE_UNSIGNED[] =
+{
+    DBTYPE_ERROR,   //[ 0]MYSQL_TYPE_DECIMAL            /* DECIMAL or NUMERIC field */
+    DBTYPE_UI1,     //[ 1]MYSQL_TYPE_TINY               /* TINYINT field */
+    DBTYPE_UI2,     //[ 2]MYSQL_TYPE_SHORT              /* SMALLINT field */
+    DBTYPE_UI4,     //[ 3]MYSQL_TYPE_LONG               /* INTEGER field */
+    DBTYPE_R4,      //[ 4]MYSQL_TYPE_FLOAT              /* FLOAT field */
+    DBTYPE_R8,      //[ 5]MYSQL_TYPE_DOUBLE             /* DOUBLE or REAL field */
+    DBTYPE_ERROR,   //[ 6]MYSQL_TYPE_NULL               /* NULL-type field */
+    DBTYPE_FILETIME,//[ 7]MYSQL_TYPE_TIMESTAMP          /* TIMESTAMP field */
+    DBTYPE_UI8,     //[ 8]MYSQL_TYPE_LONGLONG           /* BIGINT field */
+    DBTYPE_UI4,     //[ 9]MYSQL_TYPE_INT24              /* MEDIUMINT field */
+    DBTYPE_ERROR,   //[10]MYSQL_TYPE_DATE               /* DATE field */
+    DBTYPE_ERROR,   //[11]MYSQL_TYPE_TIME               /* TIME field */
+    DBTYPE_ERROR,   //[12]MYSQL_TYPE_DATETIME           /* DATETIME field */
+    DBTYPE_ERROR,   //[13]MYSQL_TYPE_YEAR               /* YEAR field */
+    DBTYPE_ERROR,   //[14]MYSQL_TYPE_NEWDATE            /* ??? */
+    DBTYPE_ERROR,   //[15]MYSQL_TYPE_VARCHAR            /* ??? */
+    DBTYPE_BOOL,    //[16]MYSQL_TYPE_BIT                /* BIT field (MySQL 5.0.3 and up) */
+    DBTYPE_ERROR,   //[17]MYSQL_TYPE_NEWDECIMAL=246     /* Precision math DECIMAL or NUMERIC field (MySQL 5.0.3 and up) */
+    DBTYPE_ERROR,   //[18]MYSQL_TYPE_ENUM=247           /* ENUM field */
+    DBTYPE_ERROR,   //[19]MYSQL_TYPE_SET=248            /* SET field */
+    DBTYPE_WSTR,    //[20]MYSQL_TYPE_TINY_BLOB=249      /* TINYBLOB or TINYTEXT field */
+    DBTYPE_WSTR,    //[21]MYSQL_TYPE_MEDIUM_BLOB=250    /* MEDIUMBLOB or MEDIUMTEXT field */
+    DBTYPE_WSTR,    //[22]MYSQL_TYPE_LONG_BLOB=251      /* LONGBLOB or LONGTEXT field */
+    DBTYPE_WSTR,    //[23]MYSQL_TYPE_BLOB=252           /* BLOB or TEXT field */
+    DBTYPE_WSTR,    //[24]MYSQL_TYPE_VAR_STRING=253     /* VARCHAR or VARBINARY field */
+    DBTYPE_WSTR,    //[25]MYSQL_TYPE_STRING=254         /* CHAR or BINARY field */
+    DBTYPE_ERROR,   //[26]MYSQL_TYPE_GEOMETRY=255       /* Spatial field */
+};
+
+DBMySQLResult::DBMySQLResult( MYSQL_RES* res, bool streamed )
+: mResult( res ),
+  mFields( mysql_fetch_fields( res ) ),
+  mColumnCount( mysql_num_fields( res ) ),
+  mStreamed( streamed )
+{
+}
+
+DBMySQLResult::~DBMySQLResult()
+{
+    // for an unfinished streamed result this also drains the remaining rows
+    mysql_free_result( mResult );
+}
+
+DBTYPE DBMySQLResult::ColumnType( uint32 index ) const
+{
+    uint32 columnType = mFields[ index ].type;
+
+    /* tricky needs to be checked */
+    if ( columnType > MYSQL_TYPE_BIT )
+        columnType -= ( MYSQL_TYPE_NEWDECIMAL - MYSQL_TYPE_BIT - 1 );
+
+    DBTYPE result = ( IsUnsigned( index ) ? MYSQL_DBTYPE_TABLE_UNSIGNED : MYSQL_DBTYPE_TABLE_SIGNED )[ columnType ];
+
+    /* if result is (wide) binary string, set result to DBTYPE_BYTES. */
+    if( ( DBTYPE_STR == result
+          || DBTYPE_WSTR == result )
+        && IsBinary( index ) )
+    {
+        result = DBTYPE_BYTES;
+    }
+
+    /* debug check */
+    assert( DBTYPE_ERROR != result );
+    return result;
+}
+
+bool DBMySQLResult::IsUnsigned( uint32 index ) const
+{
+    return 0 != ( mFields[ index ].flags & UNSIGNED_FLAG );
+}
+
+bool DBMySQLResult::IsBinary( uint32 index ) const
+{
+    // According to MySQL C API Documentation, binary string
+    // fields like BLOB or VAR_BINARY have charset "63".
+    return 63 == mFields[ index ].charsetnr;
+}
+
+bool DBMySQLResult::FetchRow( const char* const*& row, const unsigned long*& lengths )
+{
+    MYSQL_ROW r = mysql_fetch_row( mResult );
+    if( NULL == r )
+        return false;
+
+    lengths = mysql_fetch_lengths( mResult );
+    if( NULL == lengths )
+        return false;
+
+    row = r;
+    return true;
+}
+
+bool DBMySQLResult::Rewind()
+{
+    if( mStreamed )
+        return false;
+
+    mysql_data_seek( mResult, 0 );
+    return true;
+}
+
+/************************************************************************/
+/* DBMySQLBackend                                                       */
+/************************************************************************/
+DBMySQLBackend::DBMySQLBackend()
+{
+    mysql_init( &mMySQL );
+}
+
+DBMySQLBackend::~DBMySQLBackend()
+{
+    mysql_close( &mMySQL );
+}
+
+bool DBMySQLBackend::Connect( DBerror& err, const char* host, const char* user, const char* password,
+                              const char* database, int16 port, bool compress, bool ssl )
+{
+    /*
+    Quagmire - added CLIENT_FOUND_ROWS flag to the connect
+    otherwise DB update calls would say 0 rows affected when the value already equaled
+    what the function was trying to set it to, therefore the function would think it failed
+    */
+    int32 flags = CLIENT_FOUND_ROWS;
+    if( compress )
+        flags |= CLIENT_COMPRESS;
+    if( ssl )
+        flags |= CLIENT_SSL;
+
+    if( NULL == mysql_real_connect( &mMySQL, host, user, password, database, port, 0, flags ) )
+    {
+        _SetError( err, mysql_errno( &mMySQL ), mysql_error( &mMySQL ) );
+        return false;
+    }
+
+    // Setup character set we wish to use
+    if( 0 != mysql_set_character_set( &mMySQL, "utf8" ) )
+    {
+        _SetError( err, mysql_errno( &mMySQL ), mysql_error( &mMySQL ) );
+        return false;
+    }
+
+    _ClearError( err );
+    return true;
+}
+
+void DBMySQLBackend::Close()
+{
+    mysql_close( &mMySQL );
+    mysql_init( &mMySQL );
+}
+
+void DBMySQLBackend::Ping()
+{
+    mysql_ping( &mMySQL );
+}
+
+bool DBMySQLBackend::Execute( DBerror& err, const char* query, uint32 querylen )
+{
+    if( 0 != mysql_real_query( &mMySQL, query, querylen ) )
+    {
+        _SetError( err, mysql_errno( &mMySQL ), mysql_error( &mMySQL ) );
+        return false;
+    }
+
+    _ClearError( err );
+    return true;
+}
+
+bool DBMySQLBackend::IsConnectionLost( uint32 errNo ) const
+{
+    return CR_SERVER_LOST == errNo || CR_SERVER_GONE_ERROR == errNo;
+}
+
+uint32 DBMySQLBackend::FieldCount()
+{
+    return mysql_field_count( &mMySQL );
+}
+
+DBResultSet* DBMySQLBackend::StoreResult( DBerror& err )
+{
+    MYSQL_RES* res = mysql_store_result( &mMySQL );
+    if( NULL == res )
+    {
+        _SetError( err, mysql_errno( &mMySQL ), mysql_error( &mMySQL ) );
+        return NULL;
+    }
+
+    return new DBMySQLResult( res, false );
+}
+
+DBResultSet* DBMySQLBackend::UseResult( DBerror& err )
+{
+    MYSQL_RES* res = mysql_use_result( &mMySQL );
+    if( NULL == res )
+    {
+        _SetError( err, mysql_errno( &mMySQL ), mysql_error( &mMySQL ) );
+        return NULL;
+    }
+
+    return new DBMySQLResult( res, true );
+}
+
+uint64 DBMySQLBackend::AffectedRows()
+{
+    return mysql_affected_rows( &mMySQL );
+}
+
+uint64 DBMySQLBackend::InsertID()
+{
+    return mysql_insert_id( &mMySQL );
+}
+
+uint32 DBMySQLBackend::EscapeString( char* to, const char* from, uint32 fromlen )
+{
+    return mysql_real_escape_string( &mMySQL, to, from, fromlen );
+}
@@ -0,0 +1,384 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+#include "CommonPCH.h"
+
+#include "database/dbprofiler.h"
+
+#include "log/LogNew.h"
+
+/// Literal queries are cut to this length when fingerprinted.
+static const size_t DBPROFILER_MAX_FINGERPRINT = 256;
+/// The format lookup is dropped once it holds this many formats.
+static const size_t DBPROFILER_MAX_FORMATS = 4096;
+
+/************************************************************************/
+/* DBProfiler::Entry                                                    */
+/************************************************************************/
+DBProfiler::Entry::Entry()
+: count( 0 ),
+  totalTime( 0 ),
+  maxTime( 0 ),
+  rows( 0 ),
+  bytes( 0 )
+{
+    memset( histogram, 0, sizeof( histogram ) );
+}
+
+uint64 DBProfiler::Entry::Percentile( double pct ) const
+{
+    if( 0 == count )
+        return 0;
+
+    const uint64 rank = (uint64)( count * pct / 100.0 + 0.5 );
+
+    uint64 seen = 0;
+    for( size_t i = 0; i < BUCKET_COUNT; ++i )
+    {
+        seen += histogram[ i ];
+        if( seen >= rank && 0 < seen )
+        {
+            // upper bound of the bucket, see _Bucket()
+            if( i < 4 )
+                return i;
+
+            const uint32 msb = (uint32)( i / 4 + 1 );
+            const uint64 upper = ( ( 5 + (uint64)( i % 4 ) ) << ( msb - 2 ) ) - 1;
+
+            return std::min( upper, maxTime );
+        }
+    }
+
+    return maxTime;
+}
+
+/************************************************************************/
+/* DBProfiler                                                           */
+/************************************************************************/
+/// Orders entries by given column, descending.
+class DBProfilerEntryCompare
+{
+public:
+    DBProfilerEntryCompare( DBProfiler::SortKey key ) : mKey( key ) {}
+
+    bool operator()( const DBProfiler::Entry& a, const DBProfiler::Entry& b ) const
+    {
+        return _Value( a ) > _Value( b );
+    }
+
+protected:
+    uint64 _Value( const DBProfiler::Entry& e ) const
+    {
+        switch( mKey )
+        {
+            case DBProfiler::SortCount:   return e.count;
+            case DBProfiler::SortTotal:   return e.totalTime;
+            case DBProfiler::SortAverage: return e.Average();
+            case DBProfiler::SortP99:     return e.Percentile( 99 );
+            case DBProfiler::SortRows:    return e.rows;
+            case DBProfiler::SortBytes:   return e.bytes;
+        }
+
+        return 0;
+    }
+
+    DBProfiler::SortKey mKey;
+};
+
+DBProfiler::DBProfiler()
+: mEnabled( true ),
+  mSlowQueryThreshold( 0 )
+{
+}
+
+uint64 DBProfiler::GetMicroTime()
+{
+#ifdef WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    if( 0 == frequency.QuadPart )
+        QueryPerformanceFrequency( &frequency );
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter( &now );
+
+    return (uint64)( now.QuadPart * 1000000 / frequency.QuadPart );
+#else
+    timeval tv;
+    gettimeofday( &tv, NULL );
+
+    return (uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif /* !WIN32 */
+}
+
+DBProfiler::Entry* DBProfiler::Record( const char* format, const char* query, uint64 elapsed, uint64 rows )
+{
+    if( !mEnabled )
+        return NULL;
+
+    // hash outside the lock
+    const uint64 hash = ( NULL != format ? _HashFormat( format ) : 0 );
+
+    Entry* entry = NULL;
+    {
+        MutexLock lock( mMutex );
+
+        if( NULL != format )
+        {
+            std::map<uint64, Entry*>::iterator res = mByFormat.find( hash );
+            if( res != mByFormat.end() )
+                entry = res->second;
+        }
+
+        if( NULL == entry )
+        {
+            std::string fingerprint;
+            if( NULL != format )
+                _FingerprintFormat( format, fingerprint );
+            else
+                _FingerprintQuery( query, fingerprint );
+
+            entry = &mEntries[ fingerprint ];
+            if( entry->fingerprint.empty() )
+                entry->fingerprint = fingerprint;
+
+            if( NULL != format )
+            {
+                // formats built at runtime may carry literals; do not let them pile up
+                if( DBPROFILER_MAX_FORMATS <= mByFormat.size() )
+                    mByFormat.clear();
+
+                mByFormat[ hash ] = entry;
+            }
+        }
+
+        ++entry->count;
+        entry->totalTime += elapsed;
+        if( elapsed > entry->maxTime )
+            entry->maxTime = elapsed;
+        entry->rows += rows;
+        ++entry->histogram[ _Bucket( elapsed ) ];
+    }
+
+    if( 0 < mSlowQueryThreshold && elapsed >= (uint64)mSlowQueryThreshold * 1000 )
+        sLog.Warning( "DBCore Slow Query", "%u ms: %s", (uint32)( elapsed / 1000 ), query );
+
+    return entry;
+}
+
+void DBProfiler::AddRows( Entry* entry, uint64 rows, uint64 bytes )
+{
+    if( NULL == entry )
+        return;
+
+    MutexLock lock( mMutex );
+
+    entry->rows += rows;
+    entry->bytes += bytes;
+}
+
+void DBProfiler::GetReport( SortKey key, size_t limit, std::vector<Entry>& into ) const
+{
+    {
+        MutexLock lock( mMutex );
+
+        into.clear();
+        into.reserve( mEntries.size() );
+
+        std::map<std::string, Entry>::const_iterator cur, end;
+        cur = mEntries.begin();
+        end = mEntries.end();
+        for(; cur != end; ++cur )
+        {
+            if( 0 < cur->second.count )
+                into.push_back( cur->second );
+        }
+    }
+
+    std::sort( into.begin(), into.end(), DBProfilerEntryCompare( key ) );
+
+    if( 0 < limit && into.size() > limit )
+        into.resize( limit );
+}
+
+void DBProfiler::Dump( SortKey key, size_t limit ) const
+{
+    std::vector<Entry> report;
+    GetReport( key, limit, report );
+
+    if( report.empty() )
+        return;
+
+    sLog.Log( "DBCore Profile", "%lu statements; count / total ms / avg us / p50 us / p99 us / max us / rows / bytes:", report.size() );
+
+    std::vector<Entry>::const_iterator cur, end;
+    cur = report.begin();
+    end = report.end();
+    for(; cur != end; ++cur )
+    {
+        sLog.Log( "DBCore Profile", I64u " / " I64u " / " I64u " / " I64u " / " I64u " / " I64u " / " I64u " / " I64u ": %s",
+                  cur->count, cur->totalTime / 1000, cur->Average(), cur->Percentile( 50 ), cur->Percentile( 99 ),
+                  cur->maxTime, cur->rows, cur->bytes, cur->fingerprint.c_str() );
+    }
+}
+
+void DBProfiler::Reset()
+{
+    MutexLock lock( mMutex );
+
+    // keep the entries themselves, results in flight may still point to them
+    std::map<std::string, Entry>::iterator cur, end;
+    cur = mEntries.begin();
+    end = mEntries.end();
+    for(; cur != end; ++cur )
+    {
+        std::string fingerprint;
+        fingerprint.swap( cur->second.fingerprint );
+
+        cur->second = Entry();
+        cur->second.fingerprint.swap( fingerprint );
+    }
+}
+
+bool DBProfiler::ParseSortKey( const char* name, SortKey& into )
+{
+    if( 0 == strcmp( name, "count" ) )
+        into = SortCount;
+    else if( 0 == strcmp( name, "total" ) )
+        into = SortTotal;
+    else if( 0 == strcmp( name, "avg" ) )
+        into = SortAverage;
+    else if( 0 == strcmp( name, "p99" ) )
+        into = SortP99;
+    else if( 0 == strcmp( name, "rows" ) )
+        into = SortRows;
+    else if( 0 == strcmp( name, "bytes" ) )
+        into = SortBytes;
+    else
+        return false;
+
+    return true;
+}
+
+void DBProfiler::_FingerprintFormat( const char* format, std::string& into )
+{
+    // the format already is a fingerprint; just collapse the whitespace of multi-line literals
+    into.clear();
+
+    bool space = false;
+    for(; '\0' != *format; ++format )
+    {
+        if( isspace( (unsigned char)*format ) )
+        {
+            space = !into.empty();
+            continue;
+        }
+
+        if( space )
+            into += ' ';
+        space = false;
+
+        into += *format;
+    }
+}
+
+void DBProfiler::_FingerprintQuery( const char* query, std::string& into )
+{
+    into.clear();
+
+    bool space = false;
+    for(; '\0' != *query && into.size() < DBPROFILER_MAX_FINGERPRINT; ++query )
+    {
+        const char c = *query;
+
+        if( isspace( (unsigned char)c ) )
+        {
+            space = !into.empty();
+            continue;
+        }
+
+        if( space )
+            into += ' ';
+        space = false;
+
+        if( '\'' == c || '"' == c )
+        {
+            // skip the string literal
+            for( ++query; '\0' != *query && c != *query; ++query )
+            {
+                if( '\\' == *query && '\0' != query[1] )
+                    ++query;
+            }
+
+            into += '?';
+
+            if( '\0' == *query )
+                break;
+        }
+        else if( isdigit( (unsigned char)c )
+                 && ( into.empty() || !( isalnum( (unsigned char)into[ into.size() - 1 ] ) || '_' == into[ into.size() - 1 ] ) ) )
+        {
+            // skip the number literal
+            while( isdigit( (unsigned char)query[1] ) || '.' == query[1] || 'e' == query[1] || 'E' == query[1]
+                   || ( ( '-' == query[1] || '+' == query[1] ) && ( 'e' == *query || 'E' == *query ) ) )
+                ++query;
+
+            into += '?';
+        }
+        else
+            into += c;
+
+        // all rows of a multi-row insert look the same
+        if( 7 <= into.size() && 0 == into.compare( into.size() - 7, 7, " VALUES" ) )
+        {
+            into += " ...";
+            break;
+        }
+    }
+}
+
+uint64 DBProfiler::_HashFormat( const char* format )
+{
+    uint64 hash = 14695981039346656037ULL;
+    for(; '\0' != *format; ++format )
+    {
+        hash ^= (uint8)*format;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+size_t DBProfiler::_Bucket( uint64 elapsed )
+{
+    if( elapsed < 4 )
+        return (size_t)elapsed;
+
+    uint32 msb = 0;
+    for( uint64 v = elapsed; 1 < v; v >>= 1 )
+        ++msb;
+
+    // 4 buckets per power of two
+    const size_t bucket = ( msb - 1 ) * 4 + (size_t)( ( elapsed >> ( msb - 2 ) ) & 3 );
+    return std::min( bucket, BUCKET_COUNT - 1 );
+}
@@ -0,0 +1,587 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "CommonPCH.h"
+
+#include "database/dbcore.h"
+#include "database/dbsnapshot.h"
+
+#include "log/LogNew.h"
+#include "utils/crc32.h"
+#include "utils/utils_string.h"
+
+/// Identifies a snapshot file.
+static const char DBSNAPSHOT_MAGIC[ 8 ] = "EVESNAP";
+/// Strings up to this length are stored only once.
+static const size_t DBSNAPSHOT_MAX_SHARED_STRING = 16;
+
+/************************************************************************/
+/* DBSnapshot::Result                                                   */
+/************************************************************************/
+/// Rows of a single query, read straight from the mapped file.
+class DBSnapshot::Result
+: public DBResultSet
+{
+public:
+    Result( const DBSnapshot& snapshot, const TableHeader& table, uint32 firstRow, uint32 rowCount )
+    : mSnapshot( snapshot ),
+      mColumnCount( table.columnCount ),
+      mColumns( snapshot._Array<Column>( table.columns ) ),
+      mFields( snapshot._Array<Field>( table.rows ) + (size_t)firstRow * table.columnCount ),
+      mRowCount( rowCount ),
+      mCurrent( 0 ),
+      mRow( table.columnCount ),
+      mLengths( table.columnCount )
+    {
+    }
+
+    uint32 ColumnCount() const { return mColumnCount; }
+    const char* ColumnName( uint32 index ) const { return mSnapshot._String( mColumns[ index ].name ); }
+    DBTYPE ColumnType( uint32 index ) const { return (DBTYPE)mColumns[ index ].type; }
+
+    bool IsUnsigned( uint32 index ) const { return 0 != mColumns[ index ].isUnsigned; }
+    bool IsBinary( uint32 index ) const { return 0 != mColumns[ index ].isBinary; }
+
+    bool FetchRow( const char* const*& row, const unsigned long*& lengths )
+    {
+        if( mCurrent >= mRowCount || 0 == mColumnCount )
+            return false;
+
+        const Field* fields = mFields + (size_t)mCurrent * mColumnCount;
+        for( uint32 i = 0; i < mColumnCount; ++i )
+        {
+            mRow[ i ] = ( 0 == fields[ i ].offset ? NULL : mSnapshot._String( fields[ i ].offset ) );
+            mLengths[ i ] = fields[ i ].length;
+        }
+
+        ++mCurrent;
+
+        row = &mRow[ 0 ];
+        lengths = &mLengths[ 0 ];
+        return true;
+    }
+
+    size_t RowCount() const { return mRowCount; }
+    bool Rewind() { mCurrent = 0; return true; }
+
+protected:
+    const DBSnapshot& mSnapshot;
+
+    const uint32 mColumnCount;
+    const Column* const mColumns;
+    const Field* const mFields;
+    const uint32 mRowCount;
+    uint32 mCurrent;
+
+    std::vector<const char*> mRow;
+    std::vector<unsigned long> mLengths;
+};
+
+/************************************************************************/
+/* DBSnapshot                                                           */
+/************************************************************************/
+DBSnapshot::DBSnapshot()
+: mData( NULL ),
+  mSize( 0 ),
+#ifdef WIN32
+  mFile( INVALID_HANDLE_VALUE ),
+  mMapping( NULL ),
+#endif /* WIN32 */
+  mTables( NULL )
+{
+}
+
+DBSnapshot::~DBSnapshot()
+{
+    Close();
+}
+
+bool DBSnapshot::Build( std::string& err, const char* file, const char* const* formats, size_t count )
+{
+    std::vector<TableHeader> tables;
+    std::vector<Column> columns;
+    std::vector<Field> fields;
+    std::vector<Key> keys;
+
+    // offset 0 means NULL, so the pool starts with a dummy byte
+    std::string pool( 1, '\0' );
+    std::map<std::string, uint32> shared;
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        std::string query, keyColumn;
+        if( !_ParseFormat( formats[ i ], query, keyColumn ) )
+        {
+            sprintf( err, "Unsupported query format (only a trailing 'WHERE column=%%u' is allowed): %s", formats[ i ] );
+            return false;
+        }
+
+        DBQueryResult res;
+        if( !sDatabase.RunQueryStream( res, "%s", query.c_str() ) )
+        {
+            sprintf( err, "Query '%s' failed: %s", query.c_str(), res.error.c_str() );
+            return false;
+        }
+
+        TableHeader t;
+        memset( &t, 0, sizeof( t ) );
+
+        t.format = (uint32)pool.size();
+        pool.append( formats[ i ] );
+        pool += '\0';
+
+        // the key comes as an extra last column
+        t.columnCount = res.ColumnCount() - ( keyColumn.empty() ? 0 : 1 );
+        t.columns = (uint32)columns.size();
+        for( uint32 c = 0; c < t.columnCount; ++c )
+        {
+            Column col;
+            col.name = (uint32)pool.size();
+            col.type = (uint8)res.ColumnType( c );
+            col.isUnsigned = res.IsUnsigned( c ) ? 1 : 0;
+            col.isBinary = res.IsBinary( c ) ? 1 : 0;
+            col.unused = 0;
+
+            pool.append( res.ColumnName( c ) );
+            pool += '\0';
+
+            columns.push_back( col );
+        }
+
+        t.rows = (uint32)fields.size();
+        t.keys = (uint32)keys.size();
+
+        DBResultRow row;
+        while( res.GetRow( row ) )
+        {
+            if( !keyColumn.empty() )
+            {
+                // "WHERE key=%u" never matches NULL
+                if( row.IsNull( t.columnCount ) )
+                    continue;
+
+                const uint32 key = row.GetUInt( t.columnCount );
+                if( 0 < t.keyCount && keys.back().key == key )
+                {
+                    ++keys.back().rowCount;
+                }
+                else if( 0 < t.keyCount && keys.back().key > key )
+                {
+                    sprintf( err, "Rows of '%s' are not sorted by %s.", query.c_str(), keyColumn.c_str() );
+                    return false;
+                }
+                else
+                {
+                    Key k;
+                    k.key = key;
+                    k.firstRow = t.rowCount;
+                    k.rowCount = 1;
+
+                    keys.push_back( k );
+                    ++t.keyCount;
+                }
+            }
+
+            for( uint32 c = 0; c < t.columnCount; ++c )
+            {
+                Field f;
+                f.offset = 0;
+                f.length = 0;
+
+                if( !row.IsNull( c ) )
+                {
+                    const std::string value( row.GetText( c ), row.ColumnLength( c ) );
+
+                    f.length = (uint32)value.size();
+                    if( value.size() <= DBSNAPSHOT_MAX_SHARED_STRING )
+                    {
+                        std::pair<std::map<std::string, uint32>::iterator, bool> ins =
+                            shared.insert( std::make_pair( value, (uint32)pool.size() ) );
+                        f.offset = ins.first->second;
+
+                        if( !ins.second )
+                        {
+                            fields.push_back( f );
+                            continue;
+                        }
+                    }
+                    else
+                        f.offset = (uint32)pool.size();
+
+                    pool.append( value );
+                    pool += '\0';
+                }
+
+                fields.push_back( f );
+            }
+
+            ++t.rowCount;
+        }
+
+        sLog.Log( "DBSnapshot", "%u rows, %u keys: %s", t.rowCount, t.keyCount, query.c_str() );
+
+        tables.push_back( t );
+    }
+
+    // lay out the file and turn indexes into file offsets
+    const uint64 tablesOffset = sizeof( Header );
+    const uint64 columnsOffset = tablesOffset + tables.size() * sizeof( TableHeader );
+    const uint64 fieldsOffset = columnsOffset + columns.size() * sizeof( Column );
+    const uint64 keysOffset = fieldsOffset + fields.size() * sizeof( Field );
+    const uint64 poolOffset = keysOffset + keys.size() * sizeof( Key );
+    const uint64 size = poolOffset + pool.size();
+
+    if( size > 0xFFFFFFFF )
+    {
+        err = "Snapshot would exceed 4 GiB.";
+        return false;
+    }
+
+    std::vector<TableHeader>::iterator tcur, tend;
+    tcur = tables.begin();
+    tend = tables.end();
+    for(; tcur != tend; ++tcur )
+    {
+        tcur->format += (uint32)poolOffset;
+        tcur->columns = (uint32)( columnsOffset + tcur->columns * sizeof( Column ) );
+        tcur->rows = (uint32)( fieldsOffset + tcur->rows * sizeof( Field ) );
+        tcur->keys = (uint32)( keysOffset + tcur->keys * sizeof( Key ) );
+    }
+
+    std::vector<Column>::iterator ccur, cend;
+    ccur = columns.begin();
+    cend = columns.end();
+    for(; ccur != cend; ++ccur )
+        ccur->name += (uint32)poolOffset;
+
+    std::vector<Field>::iterator fcur, fend;
+    fcur = fields.begin();
+    fend = fields.end();
+    for(; fcur != fend; ++fcur )
+    {
+        if( 0 != fcur->offset )
+            fcur->offset += (uint32)poolOffset;
+    }
+
+    // the sections in the order they appear in the file
+    const std::pair<const void*, size_t> sections[] =
+    {
+        std::make_pair( tables.empty() ? NULL : (const void*)&tables[ 0 ], tables.size() * sizeof( TableHeader ) ),
+        std::make_pair( columns.empty() ? NULL : (const void*)&columns[ 0 ], columns.size() * sizeof( Column ) ),
+        std::make_pair( fields.empty() ? NULL : (const void*)&fields[ 0 ], fields.size() * sizeof( Field ) ),
+        std::make_pair( keys.empty() ? NULL : (const void*)&keys[ 0 ], keys.size() * sizeof( Key ) ),
+        std::make_pair( (const void*)pool.data(), pool.size() )
+    };
+    const size_t sectionCount = sizeof( sections ) / sizeof( sections[ 0 ] );
+
+    Header h;
+    memset( &h, 0, sizeof( h ) );
+    memcpy( h.magic, DBSNAPSHOT_MAGIC, sizeof( h.magic ) );
+    h.version = VERSION;
+    h.size = (uint32)size;
+    h.tableCount = (uint32)tables.size();
+
+    uint32 crc = 0xFFFFFFFF;
+    for( size_t i = 0; i < sectionCount; ++i )
+    {
+        if( 0 < sections[ i ].second )
+            crc = CRC32::Update( (const uint8*)sections[ i ].first, sections[ i ].second, crc );
+    }
+    h.checksum = CRC32::Finish( crc );
+
+    FILE* out = fopen( file, "wb" );
+    if( NULL == out )
+    {
+        sprintf( err, "Unable to open '%s' for writing.", file );
+        return false;
+    }
+
+    bool success = ( 1 == fwrite( &h, sizeof( h ), 1, out ) );
+    for( size_t i = 0; success && i < sectionCount; ++i )
+    {
+        if( 0 < sections[ i ].second )
+            success = ( 1 == fwrite( sections[ i ].first, sections[ i ].second, 1, out ) );
+    }
+
+    if( 0 != fclose( out ) )
+        success = false;
+
+    if( !success )
+    {
+        sprintf( err, "Failed to write '%s'.", file );
+        return false;
+    }
+
+    sLog.Log( "DBSnapshot", "Wrote %lu tables, %lu fields, %lu bytes into %s.",
+              tables.size(), fields.size(), (size_t)size, file );
+
+    return true;
+}
+
+bool DBSnapshot::Open( std::string& err, const char* file )
+{
+    Close();
+
+    const uint32 start = GetTickCount();
+
+#ifdef WIN32
+    mFile = CreateFileA( file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( INVALID_HANDLE_VALUE == mFile )
+    {
+        sprintf( err, "Unable to open '%s'.", file );
+        return false;
+    }
+
+    mSize = GetFileSize( mFile, NULL );
+    mMapping = CreateFileMappingA( mFile, NULL, PAGE_READONLY, 0, 0, NULL );
+    if( NULL != mMapping )
+        mData = (const uint8*)MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 );
+#else /* !WIN32 */
+    int fd = open( file, O_RDONLY );
+    if( -1 == fd )
+    {
+        sprintf( err, "Unable to open '%s': %s", file, strerror( errno ) );
+        return false;
+    }
+
+    struct stat st;
+    if( 0 == fstat( fd, &st ) && 0 < st.st_size )
+    {
+        mSize = (size_t)st.st_size;
+
+        void* data = mmap( NULL, mSize, PROT_READ, MAP_SHARED, fd, 0 );
+        if( MAP_FAILED != data )
+            mData = (const uint8*)data;
+    }
+
+    // the mapping keeps the file referenced
+    ::close( fd );
+#endif /* !WIN32 */
+
+    if( NULL == mData )
+    {
+        sprintf( err, "Unable to map '%s'.", file );
+        Close();
+        return false;
+    }
+
+    const Header* h = _Array<Header>( 0 );
+    if( mSize < sizeof( Header )
+        || 0 != memcmp( h->magic, DBSNAPSHOT_MAGIC, sizeof( h->magic ) ) )
+    {
+        sprintf( err, "'%s' is not a snapshot.", file );
+        Close();
+        return false;
+    }
+
+    if( VERSION != h->version )
+    {
+        sprintf( err, "'%s' is of version %u, expected %u; rebuild it.", file, h->version, VERSION );
+        Close();
+        return false;
+    }
+
+    if( mSize != h->size
+        || h->checksum != CRC32::Generate( mData + sizeof( Header ), mSize - sizeof( Header ) ) )
+    {
+        sprintf( err, "'%s' is truncated or corrupt.", file );
+        Close();
+        return false;
+    }
+
+    // the checksum covers accidents; bounds are still checked once so nothing can point outside the map
+    if( sizeof( Header ) + (uint64)h->tableCount * sizeof( TableHeader ) > mSize )
+    {
+        sprintf( err, "'%s' is corrupt.", file );
+        Close();
+        return false;
+    }
+
+    mTables = _Array<TableHeader>( sizeof( Header ) );
+    for( uint32 i = 0; i < h->tableCount; ++i )
+    {
+        const TableHeader& t = mTables[ i ];
+
+        if( t.format >= mSize
+            || t.columns + (uint64)t.columnCount * sizeof( Column ) > mSize
+            || t.rows + (uint64)t.rowCount * t.columnCount * sizeof( Field ) > mSize
+            || t.keys + (uint64)t.keyCount * sizeof( Key ) > mSize
+            || NULL == memchr( mData + t.format, '\0', mSize - t.format ) )
+        {
+            sprintf( err, "Table %u of '%s' is corrupt.", i, file );
+            Close();
+            return false;
+        }
+
+        mFormatIndex.push_back( FormatIndexEntry( _FormatChecksum( _String( t.format ) ), i ) );
+    }
+    std::sort( mFormatIndex.begin(), mFormatIndex.end() );
+
+    mHits.assign( h->tableCount, 0 );
+
+    sLog.Log( "DBSnapshot", "Mapped %u tables (%lu KiB) from %s in %u ms.",
+              h->tableCount, mSize / 1024, file, GetTickCount() - start );
+
+    return true;
+}
+
+void DBSnapshot::Close()
+{
+    MutexLock lock( mMutex );
+
+#ifdef WIN32
+    if( NULL != mData )
+        UnmapViewOfFile( mData );
+    if( NULL != mMapping )
+        CloseHandle( mMapping );
+    if( INVALID_HANDLE_VALUE != mFile )
+        CloseHandle( mFile );
+
+    mMapping = NULL;
+    mFile = INVALID_HANDLE_VALUE;
+#else /* !WIN32 */
+    if( NULL != mData )
+        munmap( (void*)mData, mSize );
+#endif /* !WIN32 */
+
+    mData = NULL;
+    mSize = 0;
+    mTables = NULL;
+
+    mFormatIndex.clear();
+    mHits.clear();
+}
+
+DBResultSet* DBSnapshot::Find( const char* format, va_list args )
+{
+    if( NULL == mData )
+        return NULL;
+
+    // the index does not change while open, so most queries (those not in the snapshot) take no lock
+    const uint32 checksum = _FormatChecksum( format );
+
+    std::vector<FormatIndexEntry>::const_iterator cur, end;
+    cur = std::lower_bound( mFormatIndex.begin(), mFormatIndex.end(), checksum, _FormatLess );
+    end = mFormatIndex.end();
+    for(; cur != end && cur->first == checksum; ++cur )
+    {
+        if( 0 == strcmp( format, _String( mTables[ cur->second ].format ) ) )
+            break;
+    }
+
+    if( cur == end || cur->first != checksum )
+        return NULL;
+
+    const uint32 index = cur->second;
+    {
+        MutexLock lock( mMutex );
+
+        ++mHits[ index ];
+    }
+
+    const TableHeader& t = mTables[ index ];
+
+    uint32 firstRow = 0, rowCount = t.rowCount;
+    if( 0 < t.keyCount )
+    {
+        const uint32 key = va_arg( args, uint32 );
+
+        const Key* begin = _Array<Key>( t.keys );
+        const Key* end = begin + t.keyCount;
+
+        const Key* k = std::lower_bound( begin, end, key, _KeyLess );
+        if( k != end && k->key == key )
+        {
+            firstRow = k->firstRow;
+            rowCount = k->rowCount;
+        }
+        else
+            rowCount = 0;
+    }
+
+    return new Result( *this, t, firstRow, rowCount );
+}
+
+void DBSnapshot::Dump() const
+{
+    MutexLock lock( mMutex );
+
+    if( NULL == mData )
+        return;
+
+    sLog.Log( "DBSnapshot", "Uses / rows of %lu tables:", mHits.size() );
+
+    for( size_t i = 0; i < mHits.size(); ++i )
+        sLog.Log( "DBSnapshot", I64u " / %u: %s", mHits[ i ], mTables[ i ].rowCount, _String( mTables[ i ].format ) );
+}
+
+uint32 DBSnapshot::_FormatChecksum( const char* format )
+{
+    return CRC32::Generate( reinterpret_cast<const uint8*>( format ), strlen( format ) );
+}
+
+bool DBSnapshot::_ParseFormat( const char* format, std::string& query, std::string& keyColumn )
+{
+    keyColumn.clear();
+
+    const char* percent = strchr( format, '%' );
+    if( NULL == percent )
+    {
+        query = format;
+        return true;
+    }
+
+    // the one and only conversion must be the key at the very end
+    if( 0 != strcmp( percent, "%u" ) )
+        return false;
+
+    std::string head( format, percent );
+
+    std::string::size_type end = head.find_last_not_of( ' ' );
+    if( std::string::npos == end || '=' != head[ end ] )
+        return false;
+
+    end = head.find_last_not_of( ' ', end - 1 );
+    if( std::string::npos == end )
+        return false;
+
+    std::string::size_type begin = end + 1;
+    while( 0 < begin && ( isalnum( (unsigned char)head[ begin - 1 ] ) || '_' == head[ begin - 1 ] || '.' == head[ begin - 1 ] ) )
+        --begin;
+
+    keyColumn = head.substr( begin, end + 1 - begin );
+    if( keyColumn.empty() || begin < 7 || 0 != head.compare( begin - 7, 7, " WHERE " ) )
+        return false;
+
+    head.erase( begin - 7 );
+
+    // select the key as the last column and sort by it
+    const std::string::size_type from = head.find( " FROM " );
+    if( std::string::npos == from )
+        return false;
+
+    query = head.substr( 0, from ) + ", " + keyColumn + head.substr( from ) + " ORDER BY " + keyColumn;
+    return true;
+}
@@ -0,0 +1,891 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "CommonPCH.h"
+
+#ifdef EVEMU_SQLITE_ENABLE
+
+#include <sqlite3.h>
+
+#include "database/dbsqlite.h"
+
+/************************************************************************/
+/* Helpers                                                              */
+/************************************************************************/
+static bool _IsIdentChar( char c )
+{
+    return isalnum( (unsigned char)c ) || '_' == c || '$' == c;
+}
+
+static size_t _SkipSpace( const char* query, size_t len, size_t pos )
+{
+    while( pos < len && isspace( (unsigned char)query[ pos ] ) )
+        ++pos;
+
+    return pos;
+}
+
+/**
+ * @brief Matches space separated words case-insensitively.
+ *
+ * @param[in,out] pos Position to start at; position after the last word on success.
+ */
+static bool _MatchWords( const char* query, size_t len, size_t& pos, const char* words )
+{
+    size_t cur = pos;
+    while( '\0' != *words )
+    {
+        size_t wordLen = strcspn( words, " " );
+
+        cur = _SkipSpace( query, len, cur );
+        if( cur + wordLen > len
+            || 0 != strncasecmp( query + cur, words, wordLen )
+            || ( cur + wordLen < len && _IsIdentChar( query[ cur + wordLen ] ) ) )
+        {
+            return false;
+        }
+
+        cur += wordLen;
+        words += wordLen;
+        while( ' ' == *words )
+            ++words;
+    }
+
+    pos = cur;
+    return true;
+}
+
+/// Finds the ')' matching the '(' at given position; skips quoted parts.
+static size_t _FindClosingParen( const std::string& str, size_t open )
+{
+    int depth = 0;
+    char quote = 0;
+
+    for( size_t i = open; i < str.size(); ++i )
+    {
+        const char c = str[ i ];
+        if( 0 != quote )
+        {
+            if( '\\' == c )
+                ++i;
+            else if( quote == c )
+                quote = 0;
+        }
+        else if( '\'' == c || '"' == c || '`' == c )
+            quote = c;
+        else if( '(' == c )
+            ++depth;
+        else if( ')' == c && 0 == --depth )
+            return i;
+    }
+
+    return std::string::npos;
+}
+
+/// Splits a column or key definition into words; a word directly followed by '(' includes the parenthesized part.
+static void _Tokenize( const std::string& def, std::vector<std::string>& into )
+{
+    into.clear();
+
+    size_t i = 0;
+    while( i < def.size() )
+    {
+        if( isspace( (unsigned char)def[ i ] ) )
+        {
+            ++i;
+            continue;
+        }
+
+        size_t end = i;
+        if( '\'' == def[ i ] || '"' == def[ i ] || '`' == def[ i ] )
+        {
+            const char quote = def[ i ];
+            for( ++end; end < def.size() && quote != def[ end ]; ++end )
+            {
+                if( '\\' == def[ end ] )
+                    ++end;
+            }
+            ++end;
+        }
+        else if( '(' == def[ i ] )
+        {
+            end = _FindClosingParen( def, i ) + 1;
+        }
+        else
+        {
+            while( end < def.size() && !isspace( (unsigned char)def[ end ] ) && '(' != def[ end ] )
+                ++end;
+
+            if( end < def.size() && '(' == def[ end ] )
+                end = _FindClosingParen( def, end ) + 1;
+        }
+
+        if( 0 == end || end > def.size() )
+            end = def.size();
+
+        into.push_back( def.substr( i, end - i ) );
+        i = end;
+    }
+}
+
+static bool _TokenIs( const std::vector<std::string>& tokens, size_t index, const char* word )
+{
+    return index < tokens.size() && 0 == strcasecmp( tokens[ index ].c_str(), word );
+}
+
+static std::string _Unquote( const std::string& name )
+{
+    if( 2 <= name.size() && '`' == name[ 0 ] && '`' == name[ name.size() - 1 ] )
+        return name.substr( 1, name.size() - 2 );
+
+    return name;
+}
+
+/// Returns the column list of a key definition, without prefix lengths.
+static std::string _KeyColumns( const std::string& def )
+{
+    const size_t open = def.find( '(' );
+    if( std::string::npos == open )
+        return "";
+
+    const size_t close = _FindClosingParen( def, open );
+    if( std::string::npos == close )
+        return "";
+
+    // `name`(10) -> `name`
+    std::string cols;
+    int depth = 0;
+    for( size_t i = open + 1; i < close; ++i )
+    {
+        if( '(' == def[ i ] )
+            ++depth;
+        else if( ')' == def[ i ] )
+            --depth;
+        else if( 0 == depth )
+            cols += def[ i ];
+    }
+
+    return cols;
+}
+
+static DBTYPE _DeclTypeToDBTYPE( const char* decl, bool& isUnsigned )
+{
+    std::string type( decl );
+    for( size_t i = 0; i < type.size(); ++i )
+        type[ i ] = (char)tolower( (unsigned char)type[ i ] );
+
+    isUnsigned = ( std::string::npos != type.find( "unsigned" ) );
+
+    if( std::string::npos != type.find( "bigint" ) )
+        return isUnsigned ? DBTYPE_UI8 : DBTYPE_I8;
+    else if( std::string::npos != type.find( "tinyint" ) )
+        return isUnsigned ? DBTYPE_UI1 : DBTYPE_I1;
+    else if( std::string::npos != type.find( "smallint" ) )
+        return isUnsigned ? DBTYPE_UI2 : DBTYPE_I2;
+    else if( std::string::npos != type.find( "int" ) )
+        return isUnsigned ? DBTYPE_UI4 : DBTYPE_I4;
+    else if( 0 == type.compare( 0, 3, "bit" ) )
+        return DBTYPE_BOOL;
+    else if( std::string::npos != type.find( "double" )
+             || std::string::npos != type.find( "real" )
+             || std::string::npos != type.find( "decimal" )
+             || std::string::npos != type.find( "numeric" ) )
+        return DBTYPE_R8;
+    else if( std::string::npos != type.find( "float" ) )
+        return DBTYPE_R4;
+    else if( std::string::npos != type.find( "timestamp" ) )
+        return DBTYPE_FILETIME;
+    else if( std::string::npos != type.find( "blob" )
+             || std::string::npos != type.find( "binary" ) )
+        return DBTYPE_BYTES;
+    else
+        return DBTYPE_WSTR;
+}
+
+/* MySQL functions missing in SQLite */
+static void _SQLNow( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    const time_t now = time( NULL );
+
+    char buf[ 32 ];
+    strftime( buf, sizeof( buf ), "%Y-%m-%d %H:%M:%S", localtime( &now ) );
+
+    sqlite3_result_text( ctx, buf, -1, SQLITE_TRANSIENT );
+}
+
+static void _SQLUnixTimestamp( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    if( 0 == argc )
+    {
+        sqlite3_result_int64( ctx, (sqlite3_int64)time( NULL ) );
+        return;
+    }
+
+    const char* text = (const char*)sqlite3_value_text( argv[ 0 ] );
+    if( NULL == text )
+    {
+        sqlite3_result_null( ctx );
+        return;
+    }
+
+    tm t;
+    memset( &t, 0, sizeof( t ) );
+    if( 3 > sscanf( text, "%d-%d-%d %d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour, &t.tm_min, &t.tm_sec ) )
+    {
+        sqlite3_result_int( ctx, 0 );
+        return;
+    }
+
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    t.tm_isdst = -1;
+
+    sqlite3_result_int64( ctx, (sqlite3_int64)mktime( &t ) );
+}
+
+static void _SQLConcat( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    std::string result;
+    for( int i = 0; i < argc; ++i )
+    {
+        const char* text = (const char*)sqlite3_value_text( argv[ i ] );
+        if( NULL == text )
+        {
+            sqlite3_result_null( ctx );
+            return;
+        }
+
+        result.append( text, sqlite3_value_bytes( argv[ i ] ) );
+    }
+
+    sqlite3_result_text( ctx, result.c_str(), (int)result.size(), SQLITE_TRANSIENT );
+}
+
+static void _SQLExtreme( sqlite3_context* ctx, int argc, sqlite3_value** argv, bool greatest )
+{
+    sqlite3_value* best = NULL;
+    for( int i = 0; i < argc; ++i )
+    {
+        if( SQLITE_NULL == sqlite3_value_type( argv[ i ] ) )
+        {
+            sqlite3_result_null( ctx );
+            return;
+        }
+
+        if( NULL == best
+            || ( greatest ? sqlite3_value_double( argv[ i ] ) > sqlite3_value_double( best )
+                          : sqlite3_value_double( argv[ i ] ) < sqlite3_value_double( best ) ) )
+        {
+            best = argv[ i ];
+        }
+    }
+
+    if( NULL == best )
+        sqlite3_result_null( ctx );
+    else
+        sqlite3_result_value( ctx, best );
+}
+
+static void _SQLGreatest( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    _SQLExtreme( ctx, argc, argv, true );
+}
+
+static void _SQLLeast( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    _SQLExtreme( ctx, argc, argv, false );
+}
+
+static void _SQLRand( sqlite3_context* ctx, int argc, sqlite3_value** argv )
+{
+    sqlite3_result_double( ctx, rand() / ( RAND_MAX + 1.0 ) );
+}
+
+/************************************************************************/
+/* DBSQLiteResult                                                       */
+/************************************************************************/
+DBSQLiteResult::DBSQLiteResult()
+: mRowCount( 0 ),
+  mNextRow( 0 )
+{
+}
+
+bool DBSQLiteResult::FetchRow( const char* const*& row, const unsigned long*& lengths )
+{
+    if( mNextRow >= mRowCount || mColumns.empty() )
+        return false;
+
+    const size_t first = mNextRow * mColumns.size();
+    for( size_t i = 0; i < mColumns.size(); ++i )
+    {
+        const size_t offset = mOffsets[ first + i ];
+        mRow[ i ] = ( std::string::npos == offset ? NULL : mData.c_str() + offset );
+    }
+
+    row = &mRow[ 0 ];
+    lengths = &mLengths[ first ];
+
+    ++mNextRow;
+    return true;
+}
+
+int DBSQLiteResult::_Fetch( sqlite3_stmt* stmt )
+{
+    const int columnCount = sqlite3_column_count( stmt );
+
+    mColumns.resize( columnCount );
+    mRow.resize( columnCount );
+
+    for( int i = 0; i < columnCount; ++i )
+    {
+        mColumns[ i ].name = sqlite3_column_name( stmt, i );
+        mColumns[ i ].isUnsigned = false;
+
+        // columns of expressions get their type from their values below
+        const char* decl = sqlite3_column_decltype( stmt, i );
+        mColumns[ i ].type = ( NULL != decl ? _DeclTypeToDBTYPE( decl, mColumns[ i ].isUnsigned ) : DBTYPE_ERROR );
+    }
+
+    std::vector<int> storage( columnCount, SQLITE_NULL );
+
+    int rc;
+    while( SQLITE_ROW == ( rc = sqlite3_step( stmt ) ) )
+    {
+        for( int i = 0; i < columnCount; ++i )
+        {
+            // must be asked before the value is converted to text
+            const int type = sqlite3_column_type( stmt, i );
+            if( SQLITE_NULL == type )
+            {
+                mOffsets.push_back( std::string::npos );
+                mLengths.push_back( 0 );
+                continue;
+            }
+
+            if( SQLITE_NULL == storage[ i ] )
+                storage[ i ] = type;
+
+            const void* value = ( SQLITE_BLOB == type ? sqlite3_column_blob( stmt, i ) : sqlite3_column_text( stmt, i ) );
+            const int bytes = sqlite3_column_bytes( stmt, i );
+
+            mOffsets.push_back( mData.size() );
+            mLengths.push_back( bytes );
+
+            mData.append( (const char*)value, bytes );
+            mData += '\0';
+        }
+
+        ++mRowCount;
+    }
+
+    for( int i = 0; i < columnCount; ++i )
+    {
+        if( DBTYPE_ERROR != mColumns[ i ].type )
+            continue;
+
+        switch( storage[ i ] )
+        {
+            case SQLITE_INTEGER: mColumns[ i ].type = DBTYPE_I8;    break;
+            case SQLITE_FLOAT:   mColumns[ i ].type = DBTYPE_R8;    break;
+            case SQLITE_BLOB:    mColumns[ i ].type = DBTYPE_BYTES; break;
+            default:             mColumns[ i ].type = DBTYPE_WSTR;  break;
+        }
+    }
+
+    return rc;
+}
+
+/************************************************************************/
+/* DBSQLiteBackend                                                      */
+/************************************************************************/
+DBSQLiteBackend::DBSQLiteBackend()
+: mDB( NULL ),
+  mPending( NULL ),
+  mFieldCount( 0 ),
+  mAffectedRows( 0 )
+{
+}
+
+DBSQLiteBackend::~DBSQLiteBackend()
+{
+    Close();
+}
+
+bool DBSQLiteBackend::Connect( DBerror& err, const char* host, const char* user, const char* password,
+                               const char* database, int16 port, bool compress, bool ssl )
+{
+    Close();
+
+    const int rc = sqlite3_open_v2( database, &mDB, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL );
+    if( SQLITE_OK != rc )
+    {
+        _SetError( err, rc, NULL != mDB ? sqlite3_errmsg( mDB ) : "Out of memory" );
+        Close();
+        return false;
+    }
+
+    sqlite3_create_function( mDB, "now",            0, SQLITE_UTF8, NULL, &_SQLNow,           NULL, NULL );
+    sqlite3_create_function( mDB, "unix_timestamp", 0, SQLITE_UTF8, NULL, &_SQLUnixTimestamp, NULL, NULL );
+    sqlite3_create_function( mDB, "unix_timestamp", 1, SQLITE_UTF8, NULL, &_SQLUnixTimestamp, NULL, NULL );
+    sqlite3_create_function( mDB, "concat",        -1, SQLITE_UTF8, NULL, &_SQLConcat,        NULL, NULL );
+    sqlite3_create_function( mDB, "greatest",      -1, SQLITE_UTF8, NULL, &_SQLGreatest,      NULL, NULL );
+    sqlite3_create_function( mDB, "least",         -1, SQLITE_UTF8, NULL, &_SQLLeast,         NULL, NULL );
+    sqlite3_create_function( mDB, "rand",           0, SQLITE_UTF8, NULL, &_SQLRand,          NULL, NULL );
+
+    // a stand-in for benchmarks; durability is not a concern
+    sqlite3_exec( mDB, "PRAGMA synchronous = OFF; PRAGMA journal_mode = MEMORY;", NULL, NULL, NULL );
+
+    _ClearError( err );
+    return true;
+}
+
+void DBSQLiteBackend::Close()
+{
+    _FinalizePending();
+
+    if( NULL != mDB )
+    {
+        sqlite3_close( mDB );
+        mDB = NULL;
+    }
+}
+
+bool DBSQLiteBackend::Execute( DBerror& err, const char* query, uint32 querylen )
+{
+    _FinalizePending();
+    mFieldCount = 0;
+    mAffectedRows = 0;
+
+    if( NULL == mDB )
+    {
+        _SetError( err, SQLITE_MISUSE, "Not connected" );
+        return false;
+    }
+
+    std::string sql;
+    _TranslateQuery( query, querylen, sql );
+
+    // translated dumps may carry several statements
+    const char* cur = sql.c_str();
+    while( '\0' != *cur )
+    {
+        sqlite3_stmt* stmt = NULL;
+        const char* tail = NULL;
+
+        int rc = sqlite3_prepare_v2( mDB, cur, -1, &stmt, &tail );
+        if( SQLITE_OK != rc )
+        {
+            _SetError( err, rc, sqlite3_errmsg( mDB ) );
+            return false;
+        }
+        cur = tail;
+
+        // nothing but whitespace or a comment
+        if( NULL == stmt )
+            continue;
+
+        if( 0 < sqlite3_column_count( stmt ) )
+        {
+            // the rows are fetched by StoreResult()
+            mPending = stmt;
+            mFieldCount = sqlite3_column_count( stmt );
+            break;
+        }
+
+        while( SQLITE_ROW == ( rc = sqlite3_step( stmt ) ) )
+            ;
+
+        if( SQLITE_DONE != rc )
+        {
+            _SetError( err, rc, sqlite3_errmsg( mDB ) );
+            sqlite3_finalize( stmt );
+            return false;
+        }
+
+        sqlite3_finalize( stmt );
+        mAffectedRows = sqlite3_changes( mDB );
+    }
+
+    _ClearError( err );
+    return true;
+}
+
+DBResultSet* DBSQLiteBackend::StoreResult( DBerror& err )
+{
+    if( NULL == mPending )
+    {
+        _SetError( err, SQLITE_MISUSE, "No result" );
+        return NULL;
+    }
+
+    DBSQLiteResult* result = new DBSQLiteResult;
+    if( SQLITE_DONE != result->_Fetch( mPending ) )
+    {
+        _SetError( err, sqlite3_errcode( mDB ), sqlite3_errmsg( mDB ) );
+        _FinalizePending();
+
+        SafeDelete( result );
+        return NULL;
+    }
+
+    _FinalizePending();
+    mAffectedRows = result->RowCount();
+
+    return result;
+}
+
+uint64 DBSQLiteBackend::InsertID()
+{
+    return ( NULL != mDB ? sqlite3_last_insert_rowid( mDB ) : 0 );
+}
+
+bool DBSQLiteBackend::_TranslateDumpStatement( std::string& statement )
+{
+    // server and session settings, locking and schema changes do not apply
+    static const char* const SKIPPED[] =
+    {
+        "SET", "USE", "LOCK", "UNLOCK", "DELIMITER", "ALTER", "CREATE DATABASE", "DROP DATABASE"
+    };
+
+    for( size_t i = 0; i < sizeof( SKIPPED ) / sizeof( SKIPPED[ 0 ] ); ++i )
+    {
+        size_t pos = 0;
+        if( _MatchWords( statement.c_str(), statement.size(), pos, SKIPPED[ i ] ) )
+            return false;
+    }
+
+    size_t pos = 0;
+    if( _MatchWords( statement.c_str(), statement.size(), pos, "CREATE TABLE" ) )
+        _TranslateCreateTable( statement );
+
+    return true;
+}
+
+void DBSQLiteBackend::_TranslateCreateTable( std::string& statement )
+{
+    const size_t open = statement.find( '(' );
+    if( std::string::npos == open )
+        return;
+
+    const size_t close = _FindClosingParen( statement, open );
+    if( std::string::npos == close )
+        return;
+
+    // the table name is the last word before the definitions
+    std::vector<std::string> head;
+    _Tokenize( statement.substr( 0, open ), head );
+    const std::string table = _Unquote( head.back() );
+
+    // split the definitions at top level commas
+    std::vector<std::string> defs;
+    size_t start = open + 1;
+    for( size_t i = start; i <= close; ++i )
+    {
+        const char c = statement[ i ];
+        if( '\'' == c || '"' == c || '`' == c )
+        {
+            for( ++i; i < close && c != statement[ i ]; ++i )
+            {
+                if( '\\' == statement[ i ] )
+                    ++i;
+            }
+        }
+        else if( '(' == c )
+        {
+            i = _FindClosingParen( statement, i );
+            if( std::string::npos == i )
+                return;
+        }
+        else if( ',' == c || i == close )
+        {
+            defs.push_back( statement.substr( start, i - start ) );
+            start = i + 1;
+        }
+    }
+
+    // an AUTO_INCREMENT column which is the whole primary key becomes an alias of rowid
+    std::string autoColumn, primaryKey;
+    std::vector<std::string> tokens;
+    for( size_t i = 0; i < defs.size(); ++i )
+    {
+        _Tokenize( defs[ i ], tokens );
+
+        if( _TokenIs( tokens, 0, "PRIMARY" ) )
+            primaryKey = _Unquote( _KeyColumns( defs[ i ] ) );
+        else
+        {
+            for( size_t j = 0; j < tokens.size(); ++j )
+            {
+                if( _TokenIs( tokens, j, "AUTO_INCREMENT" ) )
+                    autoColumn = _Unquote( tokens[ 0 ] );
+            }
+        }
+    }
+    const bool rowid = ( !autoColumn.empty() && autoColumn == primaryKey );
+
+    std::string body, indexes;
+    for( size_t i = 0; i < defs.size(); ++i )
+    {
+        _Tokenize( defs[ i ], tokens );
+        if( tokens.empty() )
+            continue;
+
+        std::string def;
+        if( _TokenIs( tokens, 0, "PRIMARY" ) )
+        {
+            if( rowid )
+                continue;
+
+            def = "PRIMARY KEY (" + _KeyColumns( defs[ i ] ) + ")";
+        }
+        else if( _TokenIs( tokens, 0, "UNIQUE" ) )
+        {
+            def = "UNIQUE (" + _KeyColumns( defs[ i ] ) + ")";
+        }
+        else if( _TokenIs( tokens, 0, "KEY" ) || _TokenIs( tokens, 0, "INDEX" )
+                 || _TokenIs( tokens, 0, "FULLTEXT" ) || _TokenIs( tokens, 0, "SPATIAL" ) )
+        {
+            // index names are global in SQLite
+            size_t name = ( _TokenIs( tokens, 1, "KEY" ) || _TokenIs( tokens, 1, "INDEX" ) ? 2 : 1 );
+            std::string index = table + "_" + ( name < tokens.size() && '(' != tokens[ name ][ 0 ]
+                                                ? _Unquote( tokens[ name ] ) : "idx" );
+            if( std::string::npos != index.find( '(' ) )
+                index.erase( index.find( '(' ) );
+
+            indexes += ";\nCREATE INDEX `" + index + "` ON `" + table + "` (" + _KeyColumns( defs[ i ] ) + ")";
+            continue;
+        }
+        else if( _TokenIs( tokens, 0, "CONSTRAINT" ) || _TokenIs( tokens, 0, "FOREIGN" ) || _TokenIs( tokens, 0, "CHECK" ) )
+        {
+            continue;
+        }
+        else
+        {
+            // column definition
+            def = tokens[ 0 ];
+
+            // the type; SQLite wants "int unsigned(10)" rather than "int(10) unsigned"
+            std::string type = ( 1 < tokens.size() ? tokens[ 1 ] : "" ), args;
+            if( 0 == strncasecmp( type.c_str(), "enum(", 5 ) || 0 == strncasecmp( type.c_str(), "set(", 4 ) )
+                type = "varchar(255)";
+            else if( std::string::npos != type.find( '(' ) )
+            {
+                args = type.substr( type.find( '(' ) );
+                type.erase( type.find( '(' ) );
+            }
+
+            size_t j = 2;
+            for(; _TokenIs( tokens, j, "UNSIGNED" ) || _TokenIs( tokens, j, "SIGNED" ) || _TokenIs( tokens, j, "ZEROFILL" ); ++j )
+            {
+                if( !_TokenIs( tokens, j, "ZEROFILL" ) )
+                    type += " " + tokens[ j ];
+            }
+
+            if( rowid && _Unquote( tokens[ 0 ] ) == autoColumn )
+                def += " INTEGER PRIMARY KEY AUTOINCREMENT";
+            else if( !type.empty() )
+                def += " " + type + args;
+
+            for(; j < tokens.size(); ++j )
+            {
+                if( _TokenIs( tokens, j, "AUTO_INCREMENT" ) )
+                    continue;
+                else if( _TokenIs( tokens, j, "COMMENT" ) || _TokenIs( tokens, j, "COLLATE" ) || _TokenIs( tokens, j, "CHARSET" ) )
+                    ++j;
+                else if( _TokenIs( tokens, j, "CHARACTER" ) )
+                    j += 2;
+                else if( _TokenIs( tokens, j, "ON" ) && _TokenIs( tokens, j + 1, "UPDATE" ) )
+                    j += 2;
+                else
+                    def += " " + tokens[ j ];
+            }
+        }
+
+        if( !body.empty() )
+            body += ",\n  ";
+        body += def;
+    }
+
+    statement = statement.substr( 0, open ) + "(\n  " + body + "\n)" + indexes;
+}
+
+void DBSQLiteBackend::_TranslateQuery( const char* query, uint32 querylen, std::string& into )
+{
+    into.clear();
+    into.reserve( querylen + 16 );
+
+    const size_t len = querylen;
+    bool upsert = false;
+    // last word, to spot INSERT IGNORE
+    std::string lastWord;
+
+    size_t i = 0;
+    while( i < len )
+    {
+        const char c = query[ i ];
+
+        if( '\'' == c || '"' == c )
+        {
+            // string literal; MySQL escapes with backslashes, SQLite by doubling quotes
+            into += '\'';
+            for( ++i; i < len; ++i )
+            {
+                const char d = query[ i ];
+                if( '\\' == d && i + 1 < len )
+                {
+                    const char e = query[ ++i ];
+                    switch( e )
+                    {
+                        case '0':                   break; // SQLite text cannot hold NUL
+                        case 'n':  into += '\n';    break;
+                        case 'r':  into += '\r';    break;
+                        case 't':  into += '\t';    break;
+                        case 'b':  into += '\b';    break;
+                        case 'Z':  into += '\032';  break;
+                        case '\'': into += "''";    break;
+                        case '%':
+                        case '_':  into += '\\'; into += e; break;
+                        default:   into += e;       break;
+                    }
+                }
+                else if( c == d )
+                {
+                    if( i + 1 < len && c == query[ i + 1 ] )
+                    {
+                        into += ( '\'' == c ? "''" : "\"" );
+                        ++i;
+                    }
+                    else
+                        break;
+                }
+                else if( '\'' == d )
+                    into += "''";
+                else
+                    into += d;
+            }
+
+            into += '\'';
+            ++i;
+
+            lastWord.clear();
+        }
+        else if( '`' == c )
+        {
+            const char* end = (const char*)memchr( query + i + 1, '`', len - i - 1 );
+            const size_t next = ( NULL != end ? end - query + 1 : len );
+
+            into.append( query + i, next - i );
+            i = next;
+
+            lastWord.clear();
+        }
+        else if( '0' == c && i + 1 < len && ( 'x' == query[ i + 1 ] || 'X' == query[ i + 1 ] )
+                 && ( 0 == i || !_IsIdentChar( query[ i - 1 ] ) ) )
+        {
+            // hex literal 0xABCD -> X'ABCD'
+            size_t end = i + 2;
+            while( end < len && isxdigit( (unsigned char)query[ end ] ) )
+                ++end;
+
+            into += "X'";
+            if( 1 == ( end - i ) % 2 )
+                into += '0';
+            into.append( query + i + 2, end - i - 2 );
+            into += '\'';
+
+            i = end;
+        }
+        else if( ( isalpha( (unsigned char)c ) || '_' == c )
+                 && ( 0 == i || !_IsIdentChar( query[ i - 1 ] ) ) )
+        {
+            size_t end = i;
+            while( end < len && _IsIdentChar( query[ end ] ) )
+                ++end;
+
+            const std::string word( query + i, end - i );
+            const size_t next = _SkipSpace( query, len, end );
+
+            if( 0 == strcasecmp( word.c_str(), "IGNORE" ) && 0 == strcasecmp( lastWord.c_str(), "INSERT" ) )
+            {
+                into += "OR IGNORE";
+            }
+            else if( 0 == strcasecmp( word.c_str(), "ON" ) && _MatchWords( query, len, end, "DUPLICATE KEY UPDATE" ) )
+            {
+                into += "ON CONFLICT DO UPDATE SET";
+                upsert = true;
+            }
+            else if( upsert && 0 == strcasecmp( word.c_str(), "VALUES" ) && next < len && '(' == query[ next ] )
+            {
+                // VALUES(col) -> excluded.col
+                const char* close = (const char*)memchr( query + next, ')', len - next );
+                if( NULL != close )
+                {
+                    std::string column( query + next + 1, close - query - next - 1 );
+                    column.erase( 0, column.find_first_not_of( " " ) );
+                    column.erase( column.find_last_not_of( " " ) + 1 );
+
+                    into += "excluded.";
+                    into += column;
+
+                    end = close - query + 1;
+                }
+                else
+                    into += word;
+            }
+            else if( 0 == strcasecmp( word.c_str(), "TRUNCATE" ) && _MatchWords( query, len, end, "TABLE" ) )
+            {
+                into += "DELETE FROM";
+            }
+            else if( 0 == strcasecmp( word.c_str(), "IF" ) && next < len && '(' == query[ next ] )
+            {
+                into += "IIF";
+            }
+            else
+                into += word;
+
+            lastWord = word;
+            i = end;
+        }
+        else
+        {
+            into += c;
+            ++i;
+
+            if( !isspace( (unsigned char)c ) )
+                lastWord.clear();
+        }
+    }
+}
+
+void DBSQLiteBackend::_FinalizePending()
+{
+    if( NULL != mPending )
+    {
+        sqlite3_finalize( mPending );
+        mPending = NULL;
+    }
+}
+
+#endif /* EVEMU_SQLITE_ENABLE */
@@ -0,0 +1,663 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+#include "CommonPCH.h"
+
+#include "database/dbcore.h"
+#include "database/dbwritequeue.h"
+
+#include "log/LogNew.h"
+
+/// How often the background thread checks the queue, in ms.
+static const uint32 DBWRITEQUEUE_LOOP_GRANULARITY = 50;
+/// Upper bound of a single statement; stays well below default max_allowed_packet.
+static const size_t DBWRITEQUEUE_MAX_STATEMENT = 512 * 1024;
+/// How long to wait after losing the connection before writing again, in ms.
+static const uint32 DBWRITEQUEUE_RETRY_DELAY = 5000;
+/// How many times Stop() tries to write the last rows while the connection is lost.
+static const uint32 DBWRITEQUEUE_STOP_ATTEMPTS = 3;
+
+DBWriteQueue::DBWriteQueue()
+: mDepth( 0 ),
+  mOldestQueued( 0 ),
+  mConnectionLost( false ),
+  mConnectionLostAt( 0 ),
+  mFlushInterval( 0 ),
+  mBatchSize( 0 ),
+  mRunning( false ),
+  mLoopStarted( false )
+{
+    memset( &mStats, 0, sizeof( mStats ) );
+}
+
+DBWriteQueue::~DBWriteQueue()
+{
+    Stop();
+}
+
+DBWriteQueue::TableID DBWriteQueue::AddTable( const char* table, const char* keyColumns, const char* valueColumns, bool update )
+{
+    MutexLock lock( mMQueue );
+
+    Table t;
+    t.name = table;
+    t.keyColumns = keyColumns;
+    t.valueColumns = valueColumns;
+    t.update = update;
+    t.writing = false;
+
+    // UPDATE ... CASE <key> WHEN ... needs a single key column
+    assert( !update || std::string::npos == t.keyColumns.find( ',' ) );
+
+    t.insertPrefix = "INSERT INTO ";
+    t.insertPrefix += t.name;
+    t.insertPrefix += " (";
+    t.insertPrefix += t.keyColumns;
+    t.insertPrefix += ", ";
+    t.insertPrefix += t.valueColumns;
+    t.insertPrefix += ") VALUES ";
+
+    // build "col = VALUES(col)" for every value column
+    t.updateSuffix = " ON DUPLICATE KEY UPDATE ";
+
+    std::string::size_type start = 0;
+    while( start < t.valueColumns.size() )
+    {
+        std::string::size_type end = t.valueColumns.find( ',', start );
+        if( std::string::npos == end )
+            end = t.valueColumns.size();
+
+        std::string column = t.valueColumns.substr( start, end - start );
+        column.erase( 0, column.find_first_not_of( ' ' ) );
+        column.erase( column.find_last_not_of( ' ' ) + 1 );
+
+        if( 0 != start )
+            t.updateSuffix += ", ";
+        t.updateSuffix += column;
+        t.updateSuffix += " = VALUES(";
+        t.updateSuffix += column;
+        t.updateSuffix += ")";
+
+        t.columns.push_back( column );
+
+        start = end + 1;
+    }
+
+    mTables.push_back( t );
+    return (TableID)( mTables.size() - 1 );
+}
+
+void DBWriteQueue::Start( uint32 flushInterval, uint32 batchSize )
+{
+    mFlushInterval = flushInterval;
+    mBatchSize = ( 0 < batchSize ? batchSize : 1 );
+
+    if( 0 == mFlushInterval || mRunning )
+        return;
+
+    mRunning = true;
+    mLoopStarted = false;
+
+#ifdef WIN32
+    _beginthread( DBWriteQueue::_FlushLoop, 0, this );
+#else
+    pthread_t thread;
+    pthread_create( &thread, NULL, &DBWriteQueue::_FlushLoop, this );
+    pthread_detach( thread );
+#endif
+
+    // Stop() waits on mMLoopRunning, so the loop must hold it before we return
+    while( !mLoopStarted )
+        Sleep( 1 );
+
+    sLog.Log( "DBWriteQueue", "Started; flushing every %u ms or %u rows.", mFlushInterval, mBatchSize );
+}
+
+void DBWriteQueue::Stop()
+{
+    if( !mRunning )
+        return;
+
+    mRunning = false;
+
+    // wait for the loop to stop
+    mMLoopRunning.Lock();
+    mMLoopRunning.Unlock();
+
+    // whatever is still pending must hit the DB before we go
+    uint32 attempts = 1;
+    while( !_Flush() && attempts++ < DBWRITEQUEUE_STOP_ATTEMPTS )
+        Sleep( DBWRITEQUEUE_RETRY_DELAY );
+    mFlushInterval = 0;
+
+    if( 0 < mDepth )
+        sLog.Error( "DBWriteQueue", "The connection to the database is lost; %u rows were not written.", mDepth );
+
+    // once only; the destructor runs after the log is gone
+    if( 0 < mStats.flushes )
+    {
+        sLog.Log( "DBWriteQueue", "Wrote " I64u " rows (" I64u " coalesced, " I64u " failed, " I64u " retried) in %u flushes, avg %u ms, max %u ms.",
+                  mStats.rowsWritten, mStats.rowsCoalesced, mStats.rowsFailed, mStats.rowsRetried, mStats.flushes,
+                  (uint32)( mStats.totalFlushTime / mStats.flushes ), mStats.maxFlushTime );
+    }
+}
+
+bool DBWriteQueue::Queue( TableID table, const std::string& key, const std::string& values )
+{
+    RowMap rows;
+    rows[ key ] = values;
+
+    return Queue( table, rows );
+}
+
+bool DBWriteQueue::Queue( TableID table, const RowMap& rows )
+{
+    if( rows.empty() )
+        return true;
+
+    if( !mRunning )
+    {
+        // write-through; nothing keeps the rows for another try, so the caller is told
+        MutexLock lock( mMFlush );
+
+        RowMap unwritten;
+        if( _WriteRows( mTables[ table ], rows, unwritten ) )
+            return true;
+
+        MutexLock queueLock( mMQueue );
+        mStats.rowsFailed += unwritten.size();
+        return false;
+    }
+
+    MutexLock lock( mMQueue );
+
+    RowMap& pending = mTables[ table ].rows;
+
+    RowMap::const_iterator cur, end;
+    cur = rows.begin();
+    end = rows.end();
+    for(; cur != end; ++cur )
+    {
+        std::pair<RowMap::iterator, bool> res = pending.insert( *cur );
+        ++mStats.rowsQueued;
+
+        if( !res.second )
+        {
+            // coalesce with the pending row
+            res.first->second = cur->second;
+            ++mStats.rowsCoalesced;
+            continue;
+        }
+
+        if( 0 == mDepth++ )
+            mOldestQueued = GetTickCount();
+    }
+
+    if( mDepth > mStats.maxDepth )
+        mStats.maxDepth = mDepth;
+
+    return true;
+}
+
+void DBWriteQueue::Discard( TableID table, const std::string& key )
+{
+    // wait for rows which are being written right now
+    MutexLock flushLock( mMFlush );
+    MutexLock lock( mMQueue );
+
+    RowMap& rows = mTables[ table ].rows;
+    const std::string prefix = key + ",";
+
+    RowMap::iterator cur = rows.lower_bound( key );
+    while( cur != rows.end()
+           && ( cur->first == key || 0 == cur->first.compare( 0, prefix.size(), prefix ) ) )
+    {
+        rows.erase( cur++ );
+        --mDepth;
+    }
+}
+
+bool DBWriteQueue::IsPending( TableID table, const std::string& key ) const
+{
+    MutexLock lock( mMQueue );
+
+    const Table& t = mTables[ table ];
+    if( t.writing )
+        return true;
+
+    const std::string prefix = key + ",";
+
+    RowMap::const_iterator cur = t.rows.lower_bound( key );
+    return ( cur != t.rows.end()
+             && ( cur->first == key || 0 == cur->first.compare( 0, prefix.size(), prefix ) ) );
+}
+
+void DBWriteQueue::Flush()
+{
+    _Flush();
+}
+
+void DBWriteQueue::FlushFor( const char* query )
+{
+    std::vector<bool> tables;
+    {
+        MutexLock lock( mMQueue );
+
+        bool any = false;
+        for( size_t i = 0; i < mTables.size(); ++i )
+        {
+            const Table& table = mTables[ i ];
+
+            const bool flush = ( ( !table.rows.empty() || table.writing )
+                                 && _Mentions( query, table.name ) );
+            if( flush )
+            {
+                if( tables.empty() )
+                    tables.resize( mTables.size(), false );
+
+                tables[ i ] = true;
+                any = true;
+            }
+        }
+
+        if( !any )
+            return;
+    }
+
+    // also waits for the rows being written by the background thread
+    _Flush( &tables );
+}
+
+void DBWriteQueue::GetStats( Stats& into ) const
+{
+    MutexLock lock( mMQueue );
+
+    into = mStats;
+    into.depth = mDepth;
+}
+
+bool DBWriteQueue::_Flush( const std::vector<bool>* tables )
+{
+    MutexLock flushLock( mMFlush );
+
+    std::vector<Table> pending;
+    {
+        MutexLock lock( mMQueue );
+
+        // take the pending rows, leaving empty maps behind for new ones
+        uint32 taken = 0;
+        pending.resize( mTables.size() );
+        for( size_t i = 0; i < mTables.size(); ++i )
+        {
+            // tables added since the caller looked are not asked for
+            if( ( NULL != tables && ( i >= tables->size() || !(*tables)[ i ] ) ) || mTables[ i ].rows.empty() )
+                continue;
+
+            Table& table = mTables[ i ];
+            taken += (uint32)table.rows.size();
+
+            pending[ i ].name = table.name;
+            pending[ i ].keyColumns = table.keyColumns;
+            pending[ i ].columns = table.columns;
+            pending[ i ].update = table.update;
+            pending[ i ].insertPrefix = table.insertPrefix;
+            pending[ i ].updateSuffix = table.updateSuffix;
+            pending[ i ].rows.swap( table.rows );
+
+            table.writing = true;
+        }
+
+        if( 0 == taken )
+            return true;
+
+        mDepth -= taken;
+    }
+
+    const uint32 start = GetTickCount();
+
+    // rows which could not be written because the connection is lost
+    std::vector<RowMap> unwritten( pending.size() );
+    bool lost = false;
+
+    for( size_t i = 0; i < pending.size(); ++i )
+    {
+        if( pending[ i ].rows.empty() )
+            continue;
+
+        // no use trying the other tables once the connection is gone
+        if( lost )
+            unwritten[ i ].swap( pending[ i ].rows );
+        else if( !_WriteRows( pending[ i ], pending[ i ].rows, unwritten[ i ] ) )
+            lost = !unwritten[ i ].empty();
+    }
+
+    const uint32 elapsed = GetTickCount() - start;
+
+    MutexLock lock( mMQueue );
+
+    uint32 requeued = 0;
+    for( size_t i = 0; i < pending.size(); ++i )
+    {
+        if( pending[ i ].name.empty() )
+            continue;
+
+        mTables[ i ].writing = false;
+
+        // put the rows back; a newer row queued meanwhile wins
+        RowMap::const_iterator cur, end;
+        cur = unwritten[ i ].begin();
+        end = unwritten[ i ].end();
+        for(; cur != end; ++cur )
+        {
+            if( mTables[ i ].rows.insert( *cur ).second )
+                ++requeued;
+        }
+    }
+
+    if( 0 < requeued )
+    {
+        mDepth += requeued;
+        mOldestQueued = start;
+        mStats.rowsRetried += requeued;
+    }
+
+    mConnectionLost = lost;
+    if( lost )
+        mConnectionLostAt = GetTickCount();
+
+    ++mStats.flushes;
+    mStats.lastFlushTime = elapsed;
+    mStats.totalFlushTime += elapsed;
+    if( elapsed > mStats.maxFlushTime )
+        mStats.maxFlushTime = elapsed;
+
+    return !lost;
+}
+
+bool DBWriteQueue::_WriteRows( const Table& table, const RowMap& rows, RowMap& unwritten )
+{
+    std::string query;
+    RowBatch batch;
+    bool lost = false, dropped = false;
+
+    RowMap::const_iterator cur = rows.begin();
+    while( cur != rows.end() && !lost )
+    {
+        batch.clear();
+
+        // pack as many rows as fit into a single statement; an UPDATE repeats the key for every column
+        size_t size = 0;
+        for(; cur != rows.end(); ++cur )
+        {
+            size_t rowSize = cur->first.size() + cur->second.size() + 8;
+            if( table.update )
+                rowSize += ( cur->first.size() + 12 ) * table.columns.size();
+
+            if( !batch.empty() && size + rowSize > DBWRITEQUEUE_MAX_STATEMENT )
+                break;
+
+            size += rowSize;
+            batch.push_back( &*cur );
+        }
+
+        uint64 written = 0, failed = 0;
+
+        RowBatch::const_iterator bcur, bend;
+        bcur = batch.begin();
+        bend = batch.end();
+
+        if( _BuildStatement( table, batch, query )
+            && _Execute( query, lost ) )
+        {
+            written = batch.size();
+            bcur = bend;
+        }
+        else if( !lost )
+        {
+            // isolate the offending row(s) so the rest is not lost
+            sLog.Error( "DBWriteQueue", "Batch of %u rows into %s failed, retrying row by row.", (uint32)batch.size(), table.name.c_str() );
+
+            for(; bcur != bend; ++bcur )
+            {
+                const RowBatch row( 1, *bcur );
+
+                if( _BuildStatement( table, row, query )
+                    && _Execute( query, lost ) )
+                {
+                    ++written;
+                }
+                else if( lost )
+                    break;
+                else
+                {
+                    sLog.Error( "DBWriteQueue", "Dropping row (%s) of %s.", (*bcur)->first.c_str(), table.name.c_str() );
+                    ++failed;
+                }
+            }
+        }
+
+        // the rest of the batch waits for the connection to come back
+        for(; bcur != bend; ++bcur )
+            unwritten.insert( **bcur );
+
+        if( 0 < failed )
+            dropped = true;
+
+        MutexLock lock( mMQueue );
+
+        ++mStats.statements;
+        mStats.rowsWritten += written;
+        mStats.rowsFailed += failed;
+    }
+
+    if( lost )
+    {
+        unwritten.insert( cur, rows.end() );
+        sLog.Error( "DBWriteQueue", "Lost the connection to the database, %u rows of %s not written.", (uint32)unwritten.size(), table.name.c_str() );
+    }
+
+    return !lost && !dropped;
+}
+
+bool DBWriteQueue::_Execute( const std::string& query, bool& connectionLost )
+{
+    int32 errNo = 0;
+    if( sDatabase.RunQuery( query.c_str(), (int32)query.size(), NULL, NULL, NULL, NULL, &errNo ) )
+        return true;
+
+    connectionLost = sDatabase.IsConnectionLost( (uint32)errNo );
+    return false;
+}
+
+bool DBWriteQueue::_BuildStatement( const Table& table, const RowBatch& batch, std::string& into ) const
+{
+    RowBatch::const_iterator cur, end;
+    end = batch.end();
+
+    if( !table.update )
+    {
+        into = table.insertPrefix;
+
+        for( cur = batch.begin(); cur != end; ++cur )
+        {
+            if( cur != batch.begin() )
+                into += ", ";
+
+            into += "(";
+            into += (*cur)->first;
+            into += ", ";
+            into += (*cur)->second;
+            into += ")";
+        }
+
+        into += table.updateSuffix;
+        return true;
+    }
+
+    /*
+     * UPDATE table SET col = CASE key WHEN k1 THEN v1 WHEN k2 THEN v2 ... END, ...
+     *  WHERE key IN (k1, k2, ...)
+     */
+    std::vector< std::vector<std::string> > values( batch.size() );
+    for( size_t i = 0; i < batch.size(); ++i )
+    {
+        _SplitValues( batch[ i ]->second, values[ i ] );
+        if( values[ i ].size() != table.columns.size() )
+        {
+            sLog.Error( "DBWriteQueue", "Row (%s) of %s has %u values for %u columns.",
+                        batch[ i ]->first.c_str(), table.name.c_str(), (uint32)values[ i ].size(), (uint32)table.columns.size() );
+            return false;
+        }
+    }
+
+    into = "UPDATE ";
+    into += table.name;
+    into += " SET ";
+
+    for( size_t c = 0; c < table.columns.size(); ++c )
+    {
+        if( 0 != c )
+            into += ", ";
+
+        into += table.columns[ c ];
+        into += " = CASE ";
+        into += table.keyColumns;
+
+        for( size_t i = 0; i < batch.size(); ++i )
+        {
+            into += " WHEN ";
+            into += batch[ i ]->first;
+            into += " THEN ";
+            into += values[ i ][ c ];
+        }
+
+        into += " END";
+    }
+
+    into += " WHERE ";
+    into += table.keyColumns;
+    into += " IN (";
+
+    for( cur = batch.begin(); cur != end; ++cur )
+    {
+        if( cur != batch.begin() )
+            into += ", ";
+
+        into += (*cur)->first;
+    }
+
+    into += ")";
+    return true;
+}
+
+void DBWriteQueue::_SplitValues( const std::string& values, std::vector<std::string>& into )
+{
+    into.clear();
+
+    std::string::size_type start = 0;
+    char quote = 0;
+    for( std::string::size_type i = 0; i <= values.size(); ++i )
+    {
+        if( i == values.size() || ( 0 == quote && ',' == values[ i ] ) )
+        {
+            std::string value = values.substr( start, i - start );
+            value.erase( 0, value.find_first_not_of( ' ' ) );
+            value.erase( value.find_last_not_of( ' ' ) + 1 );
+
+            into.push_back( value );
+            start = i + 1;
+        }
+        else if( 0 != quote )
+        {
+            // DBcore::DoEscapeString escapes with backslashes
+            if( '\\' == values[ i ] )
+                ++i;
+            else if( quote == values[ i ] )
+                quote = 0;
+        }
+        else if( '\'' == values[ i ] || '"' == values[ i ] )
+            quote = values[ i ];
+    }
+}
+
+bool DBWriteQueue::_Mentions( const char* query, const std::string& name )
+{
+    // the name must stand on its own, so "entity" does not match "entity_attributes"
+    for( const char* pos = strstr( query, name.c_str() ); NULL != pos; pos = strstr( pos + 1, name.c_str() ) )
+    {
+        const char before = ( pos == query ? ' ' : pos[ -1 ] );
+        const char after = pos[ name.size() ];
+
+        if( !isalnum( (unsigned char)before ) && '_' != before
+            && !isalnum( (unsigned char)after ) && '_' != after )
+            return true;
+    }
+
+    return false;
+}
+
+thread_return_t DBWriteQueue::_FlushLoop( void* arg )
+{
+    DBWriteQueue* queue = reinterpret_cast<DBWriteQueue*>( arg );
+    assert( queue != NULL );
+
+    THREAD_RETURN( queue->_FlushLoop() );
+}
+
+thread_return_t DBWriteQueue::_FlushLoop()
+{
+    mMLoopRunning.Lock();
+    mLoopStarted = true;
+
+    // a connection of our own, so a flush does not wait for a query
+    // (or a streamed result) of the main loop to finish, nor the other way round
+    DBerror err;
+    if( !sDatabase.OpenThreadConnection( err ) )
+        sLog.Error( "DBWriteQueue", "Failed to open a database connection, using the shared one: %s", err.c_str() );
+
+    while( mRunning )
+    {
+        bool flush;
+        {
+            MutexLock lock( mMQueue );
+
+            // give a lost connection some time before trying again
+            flush = ( 0 < mDepth
+                      && ( !mConnectionLost || GetTickCount() - mConnectionLostAt >= DBWRITEQUEUE_RETRY_DELAY )
+                      && ( mDepth >= mBatchSize
+                           || GetTickCount() - mOldestQueued >= mFlushInterval ) );
+        }
+
+        if( flush )
+            _Flush();
+        else
+            Sleep( DBWRITEQUEUE_LOOP_GRANULARITY );
+    }
+
+    sDatabase.CloseThreadConnection();
+
+    mMLoopRunning.Unlock();
+
+    THREAD_RETURN( NULL );
+}
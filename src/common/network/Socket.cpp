@@ -80,6 +80,24 @@ unsigned int Socket::send( const void* buf, unsigned int len, int flags )
     return ::send( mSock, (const char*)buf, len, flags );
 }
 
+unsigned int Socket::sendv( const sendvec_t* vec, unsigned int count, int flags )
+{
+#ifdef WIN32
+    DWORD sent;
+    if( 0 != ::WSASend( mSock, (LPWSABUF)vec, count, &sent, flags, NULL, NULL ) )
+        return SOCKET_ERROR;
+
+    return sent;
+#else
+    msghdr msg;
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msg_iov = (iovec*)vec;
+    msg.msg_iovlen = count;
+
+    return ::sendmsg( mSock, &msg, flags );
+#endif /* !WIN32 */
+}
+
 unsigned int Socket::sendto( const void* buf, unsigned int len, int flags, const sockaddr* to, unsigned int tolen )
 {
     return ::sendto( mSock, (const char*)buf, len, flags, to, tolen );
@@ -193,6 +193,12 @@ void TCPConnection::Disconnect()
 }
 
 bool TCPConnection::Send( Buffer** data )
+{
+    std::vector<MappedSlice> slices;
+    return Send( data, slices );
+}
+
+bool TCPConnection::Send( Buffer** data, std::vector<MappedSlice>& slices )
 {
     // Invalidate pointer
     Buffer* buf = *data;
@@ -205,15 +211,40 @@ bool TCPConnection::Send( Buffer** data )
     if( state != STATE_CONNECTED )
     {
         SafeDelete( buf );
+        ReleaseSlices( slices );
 
         return false;
     }
 
-    // Push buffer to the send queue
+    // Push the buffer to the send queue, cut where the slices go
     MutexLock queueLock( mMSendQueue );
 
-    mSendQueue.push_back( buf );
+    size_t offset = 0;
+    std::vector<MappedSlice>::const_iterator cur, end;
+    cur = slices.begin();
+    end = slices.end();
+    for(; cur != end; ++cur )
+    {
+        assert( offset <= cur->offset && cur->offset <= buf->size() );
+
+        if( offset < cur->offset )
+        {
+            SendChunk chunk = { &(*buf)[ offset ], cur->offset - offset, NULL, NULL };
+            mSendQueue.push_back( chunk );
+        }
+
+        SendChunk chunk = { cur->data, cur->length, NULL, cur->file };
+        mSendQueue.push_back( chunk );
+
+        offset = cur->offset;
+    }
+
+    // The last chunk of the buffer owns it, even if it is empty
+    SendChunk chunk = { ( offset < buf->size() ? &(*buf)[ offset ] : NULL ), buf->size() - offset, buf, NULL };
+    mSendQueue.push_back( chunk );
+
     buf = NULL;
+    slices.clear();
 
     return true;
 }
@@ -320,14 +351,28 @@ bool TCPConnection::SendData( char* errbuf )
     if( state != STATE_CONNECTED && state != STATE_DISCONNECTING )
         return false;
 
-    mMSendQueue.Lock();
-    while( !mSendQueue.empty() )
+    sendvec_t vec[ TCPCONN_SENDVEC_SIZE ];
+
+    while( true )
     {
-        Buffer* buf = mSendQueue.front();
-        mSendQueue.pop_front();
+        // Gather the front of the queue; nobody else pops chunks while we hold mMSock
+        unsigned int count = 0;
+        size_t size = 0;
+
+        mMSendQueue.Lock();
+        for(; count < TCPCONN_SENDVEC_SIZE && count < mSendQueue.size(); ++count )
+        {
+            const SendChunk& chunk = mSendQueue[ count ];
+
+            SetSendVec( vec[ count ], chunk.data, chunk.length );
+            size += chunk.length;
+        }
         mMSendQueue.Unlock();
 
-        int status = mSock->send( &(*buf)[ 0 ], buf->size(), MSG_NOSIGNAL );
+        if( 0 == count )
+            break;
+
+        int status = mSock->sendv( vec, count, MSG_NOSIGNAL );
 
         if( status == SOCKET_ERROR )
         {
@@ -349,37 +394,41 @@ bool TCPConnection::SendData( char* errbuf )
                     snprintf( errbuf, TCPCONN_ERRBUF_SIZE, "TCPConnection::SendData(): send(): Errorcode: %s", strerror( errno ) );
 #endif
 
-                SafeDelete( buf );
                 return false;
             }
         }
 
-        if( (size_t)status > buf->size() )
+        if( (size_t)status > size )
         {
             if( errbuf )
                 snprintf( errbuf, TCPCONN_ERRBUF_SIZE, "TCPConnection::SendData(): WTF! status > size." );
 
-            SafeDelete( buf );
             return false;
         }
-        else if( (size_t)status < buf->size() )
-        {
-            if( status > 0 )
-                buf->AssignSeq( buf->begin<uint8>() + status, buf->end<uint8>() );
 
-            MutexLock queueLock( mMSendQueue );
+        // Drop whatever has been sent
+        size_t sent = status;
 
-            mSendQueue.push_front( buf );
-            buf = NULL;
-        }
-        else
+        MutexLock queueLock( mMSendQueue );
+        for(; 0 < count; --count )
         {
-            SafeDelete( buf );
-        }
+            SendChunk& chunk = mSendQueue.front();
+            if( sent < chunk.length )
+            {
+                chunk.data += sent;
+                chunk.length -= sent;
+                break;
+            }
 
-        mMSendQueue.Lock();
+            sent -= chunk.length;
+
+            SafeDelete( chunk.buffer );
+            if( NULL != chunk.file )
+                chunk.file->DecRef();
+
+            mSendQueue.pop_front();
+        }
     }
-    mMSendQueue.Unlock();
 
     return true;
 }
@@ -463,10 +512,13 @@ void TCPConnection::ClearBuffers()
 
     while( !mSendQueue.empty() )
     {
-        Buffer* buf = mSendQueue.front();
-        mSendQueue.pop_front();
+        SendChunk& chunk = mSendQueue.front();
 
-        SafeDelete( buf );
+        SafeDelete( chunk.buffer );
+        if( NULL != chunk.file )
+            chunk.file->DecRef();
+
+        mSendQueue.pop_front();
     }
 
     SafeDelete( mRecvBuf );
@@ -0,0 +1,124 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "CommonPCH.h"
+
+#include "utils/MappedFile.h"
+
+MappedFile* MappedFile::Open( const std::string& filename )
+{
+    const uint8* data = NULL;
+    size_t size = 0;
+
+#ifdef WIN32
+    // others may move the file aside while it is mapped, so it can be replaced
+    HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( INVALID_HANDLE_VALUE == file )
+        return NULL;
+
+    size = GetFileSize( file, NULL );
+    HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+    if( NULL != mapping )
+    {
+        data = (const uint8*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+        // the view keeps the mapping referenced
+        CloseHandle( mapping );
+    }
+
+    CloseHandle( file );
+#else /* !WIN32 */
+    int fd = open( filename.c_str(), O_RDONLY );
+    if( -1 == fd )
+        return NULL;
+
+    struct stat st;
+    if( 0 == fstat( fd, &st ) && 0 < st.st_size )
+    {
+        size = (size_t)st.st_size;
+
+        void* map = mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+        if( MAP_FAILED != map )
+            data = (const uint8*)map;
+    }
+
+    // the mapping keeps the file referenced
+    ::close( fd );
+#endif /* !WIN32 */
+
+    if( NULL == data )
+        return NULL;
+
+    return new MappedFile( data, size );
+}
+
+MappedFile::MappedFile( const uint8* data, size_t size )
+: mData( data ),
+  mSize( size ),
+  mRefCount( 1 )
+{
+}
+
+MappedFile::~MappedFile()
+{
+    assert( 0 == mRefCount );
+
+#ifdef WIN32
+    UnmapViewOfFile( mData );
+#else /* !WIN32 */
+    munmap( (void*)mData, mSize );
+#endif /* !WIN32 */
+}
+
+void MappedFile::IncRef() const
+{
+    MutexLock lock( mMRefCount );
+
+    ++mRefCount;
+}
+
+void MappedFile::DecRef() const
+{
+    {
+        MutexLock lock( mMRefCount );
+
+        assert( 0 < mRefCount );
+        if( 0 < --mRefCount )
+            return;
+    }
+
+    delete this;
+}
+
+void ReleaseSlices( std::vector<MappedSlice>& slices )
+{
+    std::vector<MappedSlice>::const_iterator cur, end;
+    cur = slices.begin();
+    end = slices.end();
+    for(; cur != end; ++cur )
+        cur->file->DecRef();
+
+    slices.clear();
+}
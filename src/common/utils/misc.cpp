@@ -27,6 +27,15 @@
 
 #include "utils/misc.h"
 
+#ifdef WIN32
+#   include <psapi.h>
+#   ifdef _MSC_VER
+#       pragma comment( lib, "psapi.lib" )
+#   endif /* _MSC_VER */
+#else
+#   include <sys/resource.h>
+#endif /* !WIN32 */
+
 static uint16 crc16_table[ 256 ] =
 {
     0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
@@ -91,6 +100,28 @@ uint64 filesize( FILE* fd )
 #endif
 }
 
+uint64 GetPeakMemoryUsage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) ) )
+        return 0;
+
+    return pmc.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if( 0 != getrusage( RUSAGE_SELF, &usage ) )
+        return 0;
+
+#   ifdef __APPLE__
+    return usage.ru_maxrss;
+#   else
+    // kilobytes on Linux and BSDs
+    return (uint64)usage.ru_maxrss * 1024;
+#   endif /* !__APPLE__ */
+#endif /* !WIN32 */
+}
+
 uint64 npowof2( uint64 num )
 {
     --num;
@@ -74,6 +74,9 @@ uint64 Win32TimeNow() {
     GetSystemTimeAsFileTime(&ft);
     return((uint64(ft.dwHighDateTime) << 32) | uint64(ft.dwLowDateTime));
 #else
-    return(UnixTimeToWin32Time(time(NULL), 0));
+    timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return(UnixTimeToWin32Time(tv.tv_sec, tv.tv_usec * 1000));
 #endif
 }
@@ -35,6 +35,9 @@
 #include "utils/EVEUtils.h"
 
 const uint32 CacheFileMagic = 0xFF886622;
+const uint32 CachePackMagic = 0x4B504F43;   // "COPK"
+const uint32 CachePackEntryDeflated = 0x1;
+static const uint32 CachePackVersion = 2;
 static const uint32 HackCacheNodeID = 333444;
 
 CachedObjectMgr::~CachedObjectMgr()
@@ -51,7 +54,7 @@ CachedObjectMgr::~CachedObjectMgr()
 /************************************************************************/
 /* CacheRecord                                                          */
 /************************************************************************/
-CachedObjectMgr::CacheRecord::CacheRecord() : objectID(NULL), timestamp(0), version(0), cache(NULL) {}
+CachedObjectMgr::CacheRecord::CacheRecord() : objectID(NULL), timestamp(0), version(0), cache(NULL), deflated(false) {}
 CachedObjectMgr::CacheRecord::~CacheRecord()
 {
 	PyDecRef( objectID );
@@ -126,8 +129,9 @@ void CachedObjectMgr::UpdateCacheFromSS(const std::string &objectID, PySubStream
 
     PyString* str = new PyString( objectID );
 
-    PyBuffer* buf = cache.cache->data();
-    PyIncRef( buf );
+    // the stream says whether the content is deflated
+    Buffer* data = new Buffer( cache.cache->data()->content() );
+    PyBuffer* buf = new PyBuffer( &data, cache.compressed );
 
     _UpdateCache(str, &buf);
 
@@ -156,7 +160,7 @@ void CachedObjectMgr::UpdateCache(const PyRep *objectID, PyRep **in_cached_data)
 	PyDecRef( cached_data );
 
     if( res ) {
-	    PyBuffer* buf = new PyBuffer( &data );
+	    PyBuffer* buf = new PyBuffer( &data, IsDeflated( *data ) );
         _UpdateCache( objectID, &buf );
     } else {
         sLog.Error( "Cached Obj Mgr", "Failed to marshal or deflate new cache object." );
@@ -175,8 +179,9 @@ void CachedObjectMgr::_UpdateCache(const PyRep *objectID, PyBuffer **buffer)
 	// retake ownership
     r->cache = *buffer;
 	*buffer = NULL;
+    r->deflated = r->cache->deflated();
 
-    r->version = CRC32::Generate( &r->cache->content()[0], r->cache->content().size() );
+    r->version = CRC32::Generate( r->cache->data(), r->cache->size() );
 
     const std::string str = OIDToString(objectID);
 
@@ -185,11 +190,11 @@ void CachedObjectMgr::_UpdateCache(const PyRep *objectID, PyBuffer **buffer)
 
     if(res != m_cachedObjects.end()) {
 
-		sLog.Debug("CachedObjMgr","Destroying old cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), res->second->cache->content().size(), res->second->version); 
+		sLog.Debug("CachedObjMgr","Destroying old cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), res->second->cache->size(), res->second->version); 
 		SafeDelete( res->second );
     }
 
-	sLog.Debug("CachedObjMgr","Registering new cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), r->cache->content().size(), r->version);
+	sLog.Debug("CachedObjMgr","Registering new cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), r->cache->size(), r->version);
 
     m_cachedObjects[str] = r;
 }
@@ -239,10 +244,7 @@ PyObject *CachedObjectMgr::GetCachedObject(const PyRep *objectID)
     co.objectID = res->second->objectID; PyIncRef(res->second->objectID);
     co.cache = res->second->cache;
 
-    if(res->second->cache->content().size() == 0 || res->second->cache->content()[0] == MarshalHeaderByte)
-        co.compressed = false;
-    else
-        co.compressed = true;
+    co.compressed = res->second->deflated;
 
 	sLog.Debug("CachedObjMgr","Returning cached object '%s' with checksum 0x%x", str.c_str(), co.version);
 
@@ -265,6 +267,16 @@ bool CachedObjectMgr::IsCacheUpToDate(const PyRep *objectID, uint32 version, uin
             && res->second->timestamp == timestamp);
 }
 
+uint64 CachedObjectMgr::GetCacheTimestamp(const std::string &objectID) const
+{
+    // a plain string collapses to itself, see OIDToString()
+    CachedObjMapConstItr res = m_cachedObjects.find(objectID);
+    if(res == m_cachedObjects.end())
+        return 0;
+
+    return res->second->timestamp;
+}
+
 bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const std::string &objectID)
 {
     //this is sub-optimal, but it keeps things more consistent (in case StringCollapseVisitor ever gets more complicated)
@@ -283,15 +295,40 @@ bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const PyRe
 {
     const std::string str = OIDToString(objectID);
 
+    CacheFileHeader header;
+    Buffer* buf = NULL;
+    if( !ReadCacheFile( cacheDir, str, header, &buf ) )
+        return false;
+
+    CachedObjMapItr res = m_cachedObjects.find( str );
+
+    if( res != m_cachedObjects.end() )
+        SafeDelete( res->second );
+
+    CacheRecord* cache = new CacheRecord;
+    
+    // a .cache file carries no flag; a marshal stream starts with MarshalHeaderByte unless it is deflated
+    cache->deflated = ( 0 < buf->size() && IsDeflated( *buf ) );
+    cache->objectID = (PyRep*)objectID; PyIncRef(objectID);
+    cache->cache = new PyBuffer( &buf, cache->deflated );
+    cache->timestamp = header.timestamp;
+    cache->version = header.version;
+
+    m_cachedObjects[ str ] = cache;
+
+    return true;
+}
+
+bool CachedObjectMgr::ReadCacheFile(const std::string &cacheDir, const std::string &objectID, CacheFileHeader &header, Buffer **into)
+{
     std::string filename(cacheDir);
-    filename += "/" + str + ".cache";
+    filename += "/" + objectID + ".cache";
 
     FILE *f = fopen(filename.c_str(), "rb");
 
     if(f == NULL)
         return false;
 
-    CacheFileHeader header;
     if(fread(&header, sizeof(header), 1, f) != 1) {
         fclose(f);
         return false;
@@ -313,19 +350,27 @@ bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const PyRe
 
     fclose( f );
 
-    CachedObjMapItr res = m_cachedObjects.find( str );
+    *into = buf;
+    return true;
+}
 
-    if( res != m_cachedObjects.end() )
-        SafeDelete( res->second );
+bool CachedObjectMgr::AddCache(const std::string &objectID, Buffer **data, uint64 timestamp, uint32 version, bool deflated)
+{
+    if( HaveCached( objectID ) )
+    {
+        SafeDelete( *data );
+        return false;
+    }
 
     CacheRecord* cache = new CacheRecord;
-    
-    cache->objectID = (PyRep*)objectID; PyIncRef(objectID);
-    cache->cache = new PyBuffer( &buf );
-    cache->timestamp = header.timestamp;
-    cache->version = header.version;
 
-    m_cachedObjects[ str ] = cache;
+    cache->objectID = new PyString( objectID );
+    cache->cache = new PyBuffer( data, deflated );
+    cache->timestamp = timestamp;
+    cache->version = version;
+    cache->deflated = deflated;
+
+    m_cachedObjects[ objectID ] = cache;
 
     return true;
 }
@@ -348,9 +393,20 @@ bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const PyRep
     if(res == m_cachedObjects.end())
         return false;
 
+    CacheFileHeader header;
+    header.timestamp = res->second->timestamp;
+    header.version = res->second->version;
+    header.magic = CacheFileMagic;
+    header.length = res->second->cache->content().size();
+
+    return WriteCacheFile(cacheDir, str, header, res->second->cache->content());
+}
+
+bool CachedObjectMgr::WriteCacheFile(const std::string &cacheDir, const std::string &objectID, const CacheFileHeader &header, const Buffer &data)
+{
     std::string filename(cacheDir);
     filename += "/";
-    filename += str;
+    filename += objectID;
     filename += ".cache";
 
     FILE *f = fopen(filename.c_str(), "wb");
@@ -358,18 +414,12 @@ bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const PyRep
     if(f == NULL)
         return false;
 
-    CacheFileHeader header;
-    header.timestamp = res->second->timestamp;
-    header.version = res->second->version;
-    header.magic = CacheFileMagic;
-    header.length = res->second->cache->content().size();
-    
     if(fwrite(&header, sizeof(header), 1, f) != 1) {
         fclose(f);
         return false;
     }
     
-    if(fwrite(&res->second->cache->content()[0], sizeof(uint8), header.length, f) != header.length) {
+    if(fwrite(&data[0], sizeof(uint8), header.length, f) != header.length) {
         __asm{int 3};
         fclose(f);
         return false;
@@ -378,6 +428,172 @@ bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const PyRep
     return true;
 }
 
+size_t CachedObjectMgr::LoadPack(const std::string &cacheDir)
+{
+    const std::string filename = cacheDir + "/cache.pack";
+    const uint32 start = GetTickCount();
+
+    MappedFile *pack = MappedFile::Open( filename );
+    if( pack == NULL )
+        return 0;
+
+    const uint8 *data = pack->data();
+    const size_t size = pack->size();
+    const CachePackHeader *header = (const CachePackHeader *)data;
+    const CachePackEntry *entries = (const CachePackEntry *)( data + sizeof( CachePackHeader ) );
+
+    bool valid = ( size >= sizeof( CachePackHeader )
+                   && CachePackMagic == header->magic
+                   && CachePackVersion == header->version
+                   && size == header->size
+                   && size >= sizeof( CachePackHeader ) + (uint64)header->count * sizeof( CachePackEntry )
+                   && header->checksum == CRC32::Generate( data + sizeof( CachePackHeader ), size - sizeof( CachePackHeader ) ) );
+
+    for( uint32 i = 0; valid && i < header->count; i++ )
+    {
+        const CachePackEntry &e = entries[ i ];
+        valid = ( e.name + (uint64)e.nameLength <= size && e.data + (uint64)e.length <= size );
+    }
+
+    if( !valid )
+    {
+        sLog.Error( "CachedObjMgr", "'%s' is outdated or corrupt; it will be rebuilt.", filename.c_str() );
+
+        pack->DecRef();
+        return 0;
+    }
+
+    uint32 loaded = 0;
+    for( uint32 i = 0; i < header->count; i++ )
+    {
+        const CachePackEntry &e = entries[ i ];
+        const std::string str( (const char *)data + e.name, e.nameLength );
+
+        if( HaveCached( str ) )
+            continue;
+
+        CacheRecord *cache = new CacheRecord;
+
+        cache->objectID = new PyString( str );
+        cache->deflated = ( 0 != ( e.flags & CachePackEntryDeflated ) );
+        cache->cache = new PyBuffer( pack, data + e.data, e.length, cache->deflated );
+        cache->timestamp = e.timestamp;
+        cache->version = e.version;
+
+        m_cachedObjects[ str ] = cache;
+        ++loaded;
+    }
+
+    // the records hold references of their own
+    pack->DecRef();
+
+    if( 0 < loaded )
+        sLog.Log( "CachedObjMgr", "Mapped %u cached objects (" I64u " bytes) from '%s' in %u ms.",
+                  loaded, (uint64)size, filename.c_str(), GetTickCount() - start );
+
+    return loaded;
+}
+
+bool CachedObjectMgr::SavePack(const std::string &cacheDir) const
+{
+    std::vector<CachePackEntry> entries;
+    std::vector<const CacheRecord *> records;
+
+    CachedObjMapConstItr cur, end;
+    cur = m_cachedObjects.begin();
+    end = m_cachedObjects.end();
+    for(; cur != end; cur++)
+    {
+        // other IDs cannot be rebuilt from their collapsed string
+        if( !cur->second->objectID->IsString() )
+            continue;
+
+        CachePackEntry e;
+        e.timestamp = cur->second->timestamp;
+        e.version = cur->second->version;
+        e.nameLength = (uint32)cur->first.size();
+        e.length = (uint32)cur->second->cache->size();
+        e.flags = ( cur->second->deflated ? CachePackEntryDeflated : 0 );
+
+        entries.push_back( e );
+        records.push_back( cur->second );
+    }
+
+    if( entries.empty() )
+        return true;
+
+    // lay out the names and contents behind the index
+    uint64 offset = sizeof( CachePackHeader ) + entries.size() * sizeof( CachePackEntry );
+    for( size_t i = 0; i < entries.size(); i++ )
+    {
+        entries[ i ].name = (uint32)offset;
+        offset += entries[ i ].nameLength;
+        entries[ i ].data = (uint32)offset;
+        offset += entries[ i ].length;
+    }
+
+    if( offset > 0xFFFFFFFF )
+    {
+        sLog.Error( "CachedObjMgr", "Cached objects do not fit into a pack." );
+        return false;
+    }
+
+    // the contents are written from where they are, which may be the mapping of the current pack
+    uint32 crc = CRC32::Update( (const uint8 *)&entries[0], entries.size() * sizeof( CachePackEntry ), 0xFFFFFFFF );
+    for( size_t i = 0; i < records.size(); i++ )
+    {
+        const std::string str = OIDToString( records[ i ]->objectID );
+
+        crc = CRC32::Update( (const uint8 *)str.data(), str.size(), crc );
+        if( 0 < entries[ i ].length )
+            crc = CRC32::Update( records[ i ]->cache->data(), entries[ i ].length, crc );
+    }
+
+    CachePackHeader header;
+    header.magic = CachePackMagic;
+    header.version = CachePackVersion;
+    header.count = (uint32)entries.size();
+    header.checksum = CRC32::Finish( crc );
+    header.size = offset;
+
+    // write aside and swap, so a crash never leaves a torn pack behind
+    const std::string filename = cacheDir + "/cache.pack";
+    const std::string tmpname = filename + ".tmp";
+
+    FILE *f = fopen( tmpname.c_str(), "wb" );
+    if( f == NULL )
+        return false;
+
+    bool success = ( 1 == fwrite( &header, sizeof( header ), 1, f )
+                     && 1 == fwrite( &entries[0], entries.size() * sizeof( CachePackEntry ), 1, f ) );
+    for( size_t i = 0; success && i < records.size(); i++ )
+    {
+        const std::string str = OIDToString( records[ i ]->objectID );
+
+        success = ( ( str.empty() || 1 == fwrite( str.data(), str.size(), 1, f ) )
+                    && ( 0 == entries[ i ].length || 1 == fwrite( records[ i ]->cache->data(), entries[ i ].length, 1, f ) ) );
+    }
+    if( 0 != fclose( f ) )
+        success = false;
+
+#ifdef WIN32
+    // a pack that is still mapped may be moved aside, but not replaced
+    const std::string oldname = filename + ".old";
+    remove( oldname.c_str() );
+    if( success )
+        rename( filename.c_str(), oldname.c_str() );
+#endif /* WIN32 */
+    if( !success || 0 != rename( tmpname.c_str(), filename.c_str() ) )
+    {
+        remove( tmpname.c_str() );
+        return false;
+    }
+
+    sLog.Log( "CachedObjMgr", "Saved %u cached objects (" I64u " bytes) into '%s'.", header.count, header.size, filename.c_str() );
+
+    return true;
+}
+
 /*
 void CachedObjectMgr::AddCacheHint(const char *oname, const char *key, PyDict *into) {
     PyRep *t = _MakeCacheHint(oname);
@@ -433,12 +433,13 @@ PyList *DBResultToPackedRowList( DBQueryResult &result )
 {
 	DBRowDescriptor *header = new DBRowDescriptor( result );
 
-    PyList *res = new PyList( result.GetRowCount() );
+    // the row count is not known up front for streamed results
+    PyList *res = new PyList();
 
     DBResultRow row;
-    for( uint32 i = 0; result.GetRow( row ); i++ )
+    while( result.GetRow( row ) )
     {
-        res->SetItem( i, CreatePackedRow( row, header ) );
+        res->AddItem( CreatePackedRow( row, header ) );
         PyIncRef( header );
     }
 
@@ -0,0 +1,163 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVECommonPCH.h"
+
+#include "database/StaticSnapshot.h"
+
+// dgmtypeattributemgr
+const char STATIC_QUERY_TYPE_ATTRIBUTES[] =
+    "SELECT * FROM dgmTypeAttributes ORDER BY typeID";
+
+// StaticUniverse
+const char STATIC_QUERY_UNIVERSE_ITEMS[] =
+    "SELECT"
+    " mapDenormalize.itemID, mapDenormalize.itemName, mapDenormalize.typeID, mapDenormalize.solarSystemID,"
+    " mapDenormalize.x, mapDenormalize.y, mapDenormalize.z,"
+    " mapDenormalize.security, mapDenormalize.radius, mapDenormalize.celestialIndex, mapDenormalize.orbitIndex,"
+    " mapSolarSystems.factionID"
+    " FROM mapDenormalize"
+    " LEFT JOIN mapSolarSystems USING (solarSystemID)";
+
+const char STATIC_QUERY_REGIONS[] =
+    "SELECT"
+    " regionID, regionName, factionID, x, y, z"
+    " FROM mapRegions";
+
+const char STATIC_QUERY_CONSTELLATIONS[] =
+    "SELECT"
+    " constellationID, constellationName, factionID, regionID, x, y, z"
+    " FROM mapConstellations";
+
+const char STATIC_QUERY_SOLAR_SYSTEMS[] =
+    "SELECT"
+    " solarSystemID, solarSystemName, factionID, constellationID, x, y, z,"
+    " xMin, yMin, zMin,"
+    " xMax, yMax, zMax,"
+    " luminosity,"
+    " border, fringe, corridor, hub, international, regional, constellation,"
+    " security, radius, sunTypeID, securityClass"
+    " FROM mapSolarSystems"
+    " ORDER BY solarSystemID";
+
+const char STATIC_QUERY_STATIONS[] =
+    "SELECT"
+    " stationID, stationName, stationTypeID, corporationID, solarSystemID, x, y, z,"
+    " security, dockingCostPerVolume, maxShipVolumeDockable, officeRentalCost, operationID,"
+    " reprocessingEfficiency, reprocessingStationsTake, reprocessingHangarFlag"
+    " FROM staStations"
+    " ORDER BY stationID";
+
+// InventoryDB, used by ItemFactory
+const char STATIC_QUERY_CATEGORY[] =
+    "SELECT"
+    " categoryName,"
+    " description,"
+    " published"
+    " FROM invCategories"
+    " WHERE categoryID=%u";
+
+const char STATIC_QUERY_GROUP[] =
+    "SELECT"
+    " categoryID,"
+    " groupName,"
+    " description,"
+    " useBasePrice,"
+    " allowManufacture,"
+    " allowRecycler,"
+    " anchored,"
+    " anchorable,"
+    " fittableNonSingleton,"
+    " published"
+    " FROM invGroups"
+    " WHERE groupID=%u";
+
+const char STATIC_QUERY_TYPE[] =
+    "SELECT"
+    " groupID,"
+    " typeName,"
+    " description,"
+    " radius,"
+    " mass,"
+    " volume,"
+    " capacity,"
+    " portionSize,"
+    " raceID,"
+    " basePrice,"
+    " published,"
+    " marketGroupID,"
+    " chanceOfDuplicating"
+    " FROM invTypes"
+    " WHERE typeID=%u";
+
+const char STATIC_QUERY_BLUEPRINT_TYPE[] =
+    "SELECT"
+    " parentBlueprintTypeID,"
+    " productTypeID,"
+    " productionTime,"
+    " techLevel,"
+    " researchProductivityTime,"
+    " researchMaterialTime,"
+    " researchCopyTime,"
+    " researchTechTime,"
+    " productivityModifier,"
+    " materialModifier,"
+    " wasteFactor / 100,"   // we have it in db as percentage ...
+    " chanceOfReverseEngineering,"
+    " maxProductionLimit"
+    " FROM invBlueprintTypes"
+    " WHERE blueprintTypeID=%u";
+
+const char STATIC_QUERY_SHIP_TYPE[] =
+    "SELECT"
+    " weaponTypeID, miningTypeID, skillTypeID"
+    " FROM shipTypes"
+    " WHERE shipTypeID = %u";
+
+const char STATIC_QUERY_STATION_TYPE[] =
+    "SELECT"
+    " 0 as dockingBayGraphicID, 0 as hangarGraphicID,"
+    " dockEntryX, dockEntryY, dockEntryZ,"
+    " dockOrientationX, dockOrientationY, dockOrientationZ,"
+    " operationID, officeSlots, reprocessingEfficiency, conquerable"
+    " FROM staStationTypes"
+    " WHERE stationTypeID = %u";
+
+const char* const STATIC_SNAPSHOT_QUERIES[] =
+{
+    STATIC_QUERY_TYPE_ATTRIBUTES,
+    STATIC_QUERY_UNIVERSE_ITEMS,
+    STATIC_QUERY_REGIONS,
+    STATIC_QUERY_CONSTELLATIONS,
+    STATIC_QUERY_SOLAR_SYSTEMS,
+    STATIC_QUERY_STATIONS,
+    STATIC_QUERY_CATEGORY,
+    STATIC_QUERY_GROUP,
+    STATIC_QUERY_TYPE,
+    STATIC_QUERY_BLUEPRINT_TYPE,
+    STATIC_QUERY_SHIP_TYPE,
+    STATIC_QUERY_STATION_TYPE
+};
+const size_t STATIC_SNAPSHOT_QUERY_COUNT = ( sizeof( STATIC_SNAPSHOT_QUERIES ) / sizeof( const char* ) );
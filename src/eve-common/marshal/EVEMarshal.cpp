@@ -41,36 +41,100 @@ bool Marshal( const PyRep* rep, Buffer& into )
 
 bool MarshalDeflate( const PyRep* rep, Buffer& into, const uint32 deflationLimit )
 {
-    Buffer data;
-    if( !Marshal( rep, data ) )
+    // marshal right behind whatever the caller has put into the buffer already
+    const size_t start = into.size();
+
+    MarshalStream v;
+    if( !v.Save( rep, into ) )
+    {
+        into.ResizeAt( into.begin<uint8>() + start, 0 );
         return false;
+    }
 
-    if( data.size() >= deflationLimit )
-        return DeflateData( data, into );
-    else
+    // deflated buffers (cached objects) would only cost time to deflate once more
+    if( into.size() - start - v.GetDeflatedSize() < deflationLimit )
+        return true;
+
+    const Buffer data( into.begin<uint8>() + start, into.end<uint8>() );
+    into.ResizeAt( into.begin<uint8>() + start, 0 );
+
+    return DeflateData( data, into );
+}
+
+bool MarshalDeflate( const PyRep* rep, Buffer& into, std::vector<MappedSlice>& slices, const uint32 deflationLimit )
+{
+    assert( slices.empty() );
+
+    const size_t start = into.size();
+
+    MarshalStream v;
+    if( !v.Save( rep, into, slices ) )
     {
-        into.AppendSeq( data.begin<uint8>(), data.end<uint8>() );
+        into.ResizeAt( into.begin<uint8>() + start, 0 );
+        ReleaseSlices( slices );
+        return false;
+    }
+
+    if( into.size() - start + v.GetSlicedSize() - v.GetDeflatedSize() < deflationLimit )
         return true;
+
+    // deflating takes the whole stream in one piece
+    Buffer data;
+    data.Reserve<uint8>( into.size() - start + v.GetSlicedSize() );
+
+    size_t offset = start;
+    std::vector<MappedSlice>::const_iterator cur, end;
+    cur = slices.begin();
+    end = slices.end();
+    for(; cur != end; ++cur )
+    {
+        data.AppendSeq( into.begin<uint8>() + offset, into.begin<uint8>() + cur->offset );
+        data.AppendSeq( cur->data, cur->data + cur->length );
+
+        offset = cur->offset;
     }
+    data.AppendSeq( into.begin<uint8>() + offset, into.end<uint8>() );
+
+    ReleaseSlices( slices );
+    into.ResizeAt( into.begin<uint8>() + start, 0 );
+
+    return DeflateData( data, into );
 }
 
 /************************************************************************/
 /* MarshalStream                                                        */
 /************************************************************************/
+/** Mapped buffers smaller than this are cheaper to copy than to send from their mapping. */
+static const size_t MARSHAL_SLICE_MIN_SIZE = 0x400;
+
 MarshalStream::MarshalStream()
-: mBuffer( NULL )
+: mBuffer( NULL ),
+  mDeflatedSize( 0 ),
+  mSlices( NULL ),
+  mSlicedSize( 0 )
 {
 }
 
 bool MarshalStream::Save( const PyRep* rep, Buffer& into )
 {
     mBuffer = &into;
+    mDeflatedSize = 0;
+    mSlicedSize = 0;
     bool res = SaveStream( rep );
     mBuffer = NULL;
 
     return res;
 }
 
+bool MarshalStream::Save( const PyRep* rep, Buffer& into, std::vector<MappedSlice>& slices )
+{
+    mSlices = &slices;
+    bool res = Save( rep, into );
+    mSlices = NULL;
+
+    return res;
+}
+
 bool MarshalStream::SaveStream( const PyRep* rep )
 {
     if( rep == NULL )
@@ -196,10 +260,31 @@ bool MarshalStream::VisitBuffer( const PyBuffer* rep )
 {
     Put<uint8>( Op_PyBuffer );
 
-    const Buffer& buf = rep->content();
+    const uint8* data = rep->data();
+    const size_t size = rep->size();
+
+    if( rep->deflated() )
+        mDeflatedSize += size;
+
+    PutSizeEx( size );
+
+    if( NULL != mSlices && NULL != rep->mapping() && MARSHAL_SLICE_MIN_SIZE <= size )
+    {
+        // sent straight from the mapping
+        MappedSlice slice;
+        slice.offset = mBuffer->size();
+        slice.file = rep->mapping();
+        slice.data = data;
+        slice.length = size;
 
-    PutSizeEx( buf.size() );
-    Put( buf.begin<uint8>(), buf.end<uint8>() );
+        slice.file->IncRef();
+        mSlices->push_back( slice );
+        mSlicedSize += size;
+    }
+    else
+    {
+        Put( data, data + size );
+    }
 
     return true;
 }
@@ -522,6 +607,10 @@ bool MarshalStream::VisitSubStream( const PySubStream* rep )
             return false;
         }
 
+        //a stream nobody else holds is marshaled in place, so its mapped buffers stay in their slices
+        if(mSlices != NULL && rep->GetRefCount() == 1)
+            return SaveSubStream( rep->decoded() );
+
         //unmarshaled stream
         //we have to marshal the substream.
         rep->EncodeData();
@@ -543,6 +632,41 @@ bool MarshalStream::VisitSubStream( const PySubStream* rep )
 
 //! TODO: check the implementation of this...
 // we should never visit a checksummed stream... NEVER...
+bool MarshalStream::SaveSubStream( const PyRep* rep )
+{
+    // room for the longest size; moved up below if the short one does
+    const size_t sizeAt = mBuffer->size();
+    Put<uint8>( 0xFF );
+    Put<uint32>( 0 );
+
+    const size_t start = mBuffer->size();
+    const size_t slices = mSlices->size();
+    const size_t sliced = mSlicedSize;
+
+    if( !SaveStream( rep ) )
+        return false;
+
+    const size_t flat = mBuffer->size() - start;
+    const size_t size = flat + mSlicedSize - sliced;
+
+    if( size < 0xFF )
+    {
+        const uint8* body = &( *mBuffer )[ start ];
+        mBuffer->AssignSeqAt( mBuffer->begin<uint8>() + sizeAt + 1, body, body + flat );
+        mBuffer->Resize<uint8>( mBuffer->size() - sizeof( uint32 ) );
+        mBuffer->AssignAt<uint8>( mBuffer->begin<uint8>() + sizeAt, size );
+
+        for(size_t i = slices; i < mSlices->size(); i++)
+            ( *mSlices )[ i ].offset -= sizeof( uint32 );
+    }
+    else
+    {
+        mBuffer->AssignAt<uint32>( ( mBuffer->begin<uint8>() + sizeAt + 1 ).As<uint32>(), size );
+    }
+
+    return true;
+}
+
 bool MarshalStream::VisitChecksumedStream( const PyChecksumedStream* rep )
 {
     assert(false && "MarshalStream on the server size should never send checksummed objects");
@@ -55,18 +55,29 @@ void EVETCPConnection::QueueRep( const PyRep* rep )
     const Buffer::iterator<uint32> bufLen = buf->end<uint32>();
     buf->ResizeAt( bufLen, 1 );
 
-    if( !MarshalDeflate( rep, *buf ) )
+    // mapped buffers (cached objects) are sent from their mapping
+    std::vector<MappedSlice> slices;
+    size_t sliced = 0;
+
+    if( !MarshalDeflate( rep, *buf, slices ) )
         sLog.Error( "Network", "Failed to marshal new packet." );
-    else if( PACKET_SIZE_LIMIT < buf->size() )
-        sLog.Error( "Network", "Packet length %u exceeds hardcoded packet length limit %lu.", buf->size(), PACKET_SIZE_LIMIT );
     else
     {
-        // write length
-        *bufLen = ( buf->size() - sizeof( uint32 ) );
+        for( size_t i = 0; i < slices.size(); i++ )
+            sliced += slices[ i ].length;
+
+        if( PACKET_SIZE_LIMIT < buf->size() + sliced )
+            sLog.Error( "Network", "Packet length %u exceeds hardcoded packet length limit %u.", (uint32)( buf->size() + sliced ), PACKET_SIZE_LIMIT );
+        else
+        {
+            // write length
+            *bufLen = (uint32)( buf->size() + sliced - sizeof( uint32 ) );
 
-        Send( &buf );
+            Send( &buf, slices );
+        }
     }
 
+    ReleaseSlices( slices );
     SafeDelete( buf );
 }
 
@@ -281,14 +281,51 @@ int32 PyNone::hash() const
 /************************************************************************/
 /* PyRep Buffer Class                                                   */
 /************************************************************************/
-PyBuffer::PyBuffer( size_t len, const uint8& value ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( len, value ) ), mHashCache( -1 ) {}
-PyBuffer::PyBuffer( const Buffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( buffer ) ), mHashCache( -1 ) {}
+PyBuffer::PyBuffer( size_t len, const uint8& value ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( len, value ) ), mHashCache( -1 ), mMapping( NULL ), mMappedData( NULL ), mMappedSize( 0 ), mDeflated( false ) {}
+PyBuffer::PyBuffer( const Buffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( buffer ) ), mHashCache( -1 ), mMapping( NULL ), mMappedData( NULL ), mMappedSize( 0 ), mDeflated( false ) {}
 
-PyBuffer::PyBuffer( Buffer** buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( *buffer ), mHashCache( -1 ) { *buffer = NULL; }
-PyBuffer::PyBuffer( const PyString& str ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( str.content().begin(), str.content().end() ) ), mHashCache( -1 ) {}
-PyBuffer::PyBuffer( const PyBuffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( buffer.content() ) ), mHashCache( buffer.mHashCache ) {}
+PyBuffer::PyBuffer( Buffer** buffer, bool deflated ) : PyRep( PyRep::PyTypeBuffer ), mValue( *buffer ), mHashCache( -1 ), mMapping( NULL ), mMappedData( NULL ), mMappedSize( 0 ), mDeflated( deflated ) { *buffer = NULL; }
+PyBuffer::PyBuffer( const PyString& str ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( str.content().begin(), str.content().end() ) ), mHashCache( -1 ), mMapping( NULL ), mMappedData( NULL ), mMappedSize( 0 ), mDeflated( false ) {}
+PyBuffer::PyBuffer( const PyBuffer& buffer ) : PyRep( PyRep::PyTypeBuffer ),
+  mValue( NULL == buffer.mapping() ? new Buffer( buffer.content() ) : NULL ), mHashCache( buffer.mHashCache ),
+  mMapping( buffer.mMapping ), mMappedData( buffer.mMappedData ), mMappedSize( buffer.mMappedSize ), mDeflated( buffer.mDeflated )
+{
+    // a copy of a mapped buffer references the same bytes
+    if( NULL != mMapping )
+        mMapping->IncRef();
+}
+
+PyBuffer::PyBuffer( const MappedFile* file, const uint8* data, size_t len, bool deflated ) : PyRep( PyRep::PyTypeBuffer ),
+  mValue( NULL ), mHashCache( -1 ), mMapping( file ), mMappedData( data ), mMappedSize( len ), mDeflated( deflated )
+{
+    assert( mMapping->data() <= mMappedData && mMappedData + mMappedSize <= mMapping->data() + mMapping->size() );
+
+    mMapping->IncRef();
+}
+
+PyBuffer::~PyBuffer()
+{
+    delete mValue;
+
+    if( NULL != mMapping )
+        mMapping->DecRef();
+}
 
-PyBuffer::~PyBuffer() { delete mValue; }
+const Buffer& PyBuffer::content() const
+{
+    if( NULL == mValue )
+        mValue = new Buffer( mMappedData, mMappedData + mMappedSize );
+
+    return *mValue;
+}
+
+const uint8* PyBuffer::data() const
+{
+    if( NULL != mMapping )
+        return ( 0 < mMappedSize ? mMappedData : NULL );
+
+    return ( 0 < mValue->size() ? &(*mValue)[ 0 ] : NULL );
+}
 
 bool PyBuffer::visit( PyVisitor& v ) const
 {
@@ -320,12 +357,12 @@ int32 PyBuffer::hash() const
 
     //if (!get_buf(self, &ptr, &size, ANY_BUFFER))
     //    return -1;
-    p = (unsigned char *) &content()[0];
-    len = content().size();
+    p = (unsigned char *) data();
+    len = size();
     x = *p << 7;
     while( --len >= 0 )
         x = (1000003*x) ^ *p++;
-    x ^= content().size();
+    x ^= size();
     if( x == -1 )
         x = -2;
     mHashCache = x;
@@ -334,7 +371,10 @@ int32 PyBuffer::hash() const
 
 size_t PyBuffer::size() const
 {
-    return content().size();
+    if( NULL != mMapping )
+        return mMappedSize;
+
+    return mValue->size();
 }
 
 /************************************************************************/
@@ -344,7 +384,7 @@ PyString::PyString( const char* str ) : PyRep( PyRep::PyTypeString ), mValue( st
 PyString::PyString( const char* str, size_t len ) : PyRep( PyRep::PyTypeString ), mValue( str, len ), mHashCache( -1 ) {}
 PyString::PyString( const std::string& str ) : PyRep( PyRep::PyTypeString ), mValue( str ), mHashCache( -1 ) {}
 
-PyString::PyString( const PyBuffer& buf ) : PyRep( PyRep::PyTypeString ), mValue( (const char *) &buf.content()[0], buf.content().size() ), mHashCache( -1 ) {}
+PyString::PyString( const PyBuffer& buf ) : PyRep( PyRep::PyTypeString ), mValue( (const char *) buf.data(), buf.size() ), mHashCache( -1 ) {}
 PyString::PyString( const PyToken& token ) : PyRep( PyRep::PyTypeString ), mValue( token.content() ), mHashCache( -1 ) {}
 PyString::PyString( const PyString& oth ) : PyRep( PyRep::PyTypeString ), mValue( oth.mValue ), mHashCache( oth.mHashCache ) {}
 
@@ -10,7 +10,7 @@ const EvilNumber EvilTime_Day = Win32Time_Hour * 24;
 const EvilNumber EvilTime_Month = Win32Time_Day * 30;
 const EvilNumber EvilTime_Year = Win32Time_Month * 12;
 
-PyRep* EvilNumber::GetPyObject()
+PyRep* EvilNumber::GetPyObject() const
 {
     if (mType == evil_number_int) {
         if ( mValue.iVal > INT_MAX || mValue.iVal < INT_MIN)
@@ -22,18 +22,20 @@ PyRep* EvilNumber::GetPyObject()
         return (PyRep*)new PyFloat(mValue.fVal);
     else {
         assert(false);
-        return false;
+        return NULL;
     }
 }
 
-inline void EvilNumber::CheckIntegrety()
+void EvilNumber::CheckIntegrety()
 {
-    // check if we are a integer
-    int cmp_val = (int)mValue.fVal;
-    if (float(cmp_val) == mValue.fVal) {
-        //we are a integer.... /me cheers...
-        mValue.iVal = cmp_val;
-        mType = evil_number_int;
+    // check if we are a integer; the range check keeps the cast defined
+    if (mValue.fVal > -9223372036854775808.0 && mValue.fVal < 9223372036854775808.0) {
+        int64 cmp_val = (int64)mValue.fVal;
+        if (double(cmp_val) == mValue.fVal) {
+            //we are a integer.... /me cheers...
+            mValue.iVal = cmp_val;
+            mType = evil_number_int;
+        }
     }
 }
 
@@ -76,181 +78,91 @@ bool EvilNumber::to_float()
     return true;
 }
 
-int64 EvilNumber::get_int()
+int64 EvilNumber::_GetIntSlow() const
 {
-    if( mType != evil_number_int ) {
-        int64 temp = (int64)mValue.fVal;
+    int64 temp = (int64)mValue.fVal;
 
-        /* this checks if the type convention lost stuff behind the comma */
-        if (double(temp) != mValue.fVal)
-            sLog.Warning("EvilNumber", "Invalid call get_int called on a double");
+    /* this checks if the type convention lost stuff behind the comma */
+    if (double(temp) != mValue.fVal)
+        sLog.Warning("EvilNumber", "Invalid call get_int called on a double");
 
-        return (int64)mValue.fVal;
-    }
-    return mValue.iVal;
+    return temp;
 }
 
-double EvilNumber::get_float()
+double EvilNumber::_GetFloatSlow() const
 {
-    if( mType != evil_number_float ) {
-        double temp = (double)mValue.iVal;
-            
-        /* this checks if the type convention ended up on a double overflow */
-        if (int64(temp) != mValue.iVal)
-            sLog.Warning("EvilNumber", "Invalid call get_float called on a int");
-
-        return (double)mValue.iVal;
-    }
-    return mValue.fVal;
-}
+    double temp = (double)mValue.iVal;
 
+    /* this checks if the type convention ended up on a double overflow */
+    if (int64(temp) != mValue.iVal)
+        sLog.Warning("EvilNumber", "Invalid call get_float called on a int");
 
-void EvilNumber::Multiply( EvilNumber & val )
-{
-    if (val.mType == mType) {
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal * val.mValue.fVal;
-        } else if (mType == evil_number_int) {
-            this->mValue.iVal = this->mValue.iVal * val.mValue.iVal;
-        }
-    } else {
-        // we assume that the val argument is the opposite of the 'this' type
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal*float(val.mValue.iVal);
-        } else if (mType == evil_number_int) {
-            float tVal = (float)mValue.iVal; // normal integer number
-            this->mValue.fVal = tVal*val.mValue.fVal;
-            mType = evil_number_float;
-        } else {
-            assert(false); // crash
-        }
-
-        // check if we are a integer
-        CheckIntegrety();
-    }
+    return temp;
 }
 
-void EvilNumber::Divide( EvilNumber & val )
+/* the mixed cases are done in double precision and turned back into an
+ * integer if the result allows it.
+ */
+EvilNumber EvilNumber::_MultiplyMixed( const EvilNumber& val ) const
 {
-    if (val.mType == mType) {
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal / val.mValue.fVal;
-        } else if (mType == evil_number_int) {
-            // make sure we can do things like 2 / 4 = 0.5f
-            this->mValue.fVal = float(this->mValue.iVal) / float(val.mValue.iVal);
-            mType = evil_number_float;
-            // check if its possibly a integer
-            CheckIntegrety();
-        }
-    } else {
-        // we assume that the val argument is the opposite of the 'this' type
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal/float(val.mValue.iVal);
-        } else if (mType == evil_number_int) {
-            float tVal = (float)mValue.iVal; // normal integer number
-            this->mValue.fVal = tVal/val.mValue.fVal;
-            mType = evil_number_float;
-        } else {
-            assert(false); // crash
-        }
-
-        // check if we are a integer
-        CheckIntegrety();
-    }
+    EvilNumber result(_AsDouble() * val._AsDouble());
+    result.CheckIntegrety();
+    return result;
 }
 
-void EvilNumber::Add( EvilNumber & val )
+EvilNumber EvilNumber::_DivideMixed( const EvilNumber& val ) const
 {
-    if (val.mType == mType) {
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal + val.mValue.fVal;
-        } else if (mType == evil_number_int) {
-            this->mValue.iVal = this->mValue.iVal + val.mValue.iVal;
-        }
-    } else {
-        // we assume that the val argument is the opposite of the 'this' type
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal+float(val.mValue.iVal);
-        } else if (mType == evil_number_int) {
-            float tVal = (float)mValue.iVal; // normal integer number
-            this->mValue.fVal = tVal+val.mValue.fVal;
-            mType = evil_number_float;
-        } else {
-            assert(false); // crash
-        }
-
-        // check if we are a integer
-        CheckIntegrety();
-    }
+    EvilNumber result(_AsDouble() / val._AsDouble());
+    result.CheckIntegrety();
+    return result;
 }
 
-void EvilNumber::Sub( EvilNumber & val )
+EvilNumber EvilNumber::_AddMixed( const EvilNumber& val ) const
 {
-    if (val.mType == mType) {
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal - val.mValue.fVal;
-        } else if (mType == evil_number_int) {
-            this->mValue.iVal = this->mValue.iVal - val.mValue.iVal;
-        }
-    } else {
-        // we assume that the val argument is the opposite of the 'this' type
-        if (mType == evil_number_float) {
-            this->mValue.fVal = this->mValue.fVal-float(val.mValue.iVal);
-        } else if (mType == evil_number_int) {
-            float tVal = (float)mValue.iVal; // normal integer number
-            this->mValue.fVal = tVal-val.mValue.fVal;
-            mType = evil_number_float;
-        } else {
-            assert(false); // crash
-        }
-
-        // check if we are a integer
-        CheckIntegrety();
-    }
+    EvilNumber result(_AsDouble() + val._AsDouble());
+    result.CheckIntegrety();
+    return result;
 }
 
-EvilNumber::EvilNumber() : mType(evil_number_nan)
+EvilNumber EvilNumber::_SubMixed( const EvilNumber& val ) const
 {
-    mValue.iVal = 0;
+    EvilNumber result(_AsDouble() - val._AsDouble());
+    result.CheckIntegrety();
+    return result;
 }
 
-EvilNumber::EvilNumber( float val ) : mType(evil_number_float)
+void EvilNumber::_MultiplySlow( double factor )
 {
-    mValue.fVal = val;
-}
+    mValue.fVal = _AsDouble() * factor;
+    mType = evil_number_float;
 
-EvilNumber::EvilNumber( int val ) : mType(evil_number_int)
-{
-    mValue.iVal = val;
+    CheckIntegrety();
 }
 
-EvilNumber::EvilNumber( double val ) : mType(evil_number_float)
+void EvilNumber::_AddSlow( double amount )
 {
-    mValue.fVal = val;
+    mValue.fVal = _AsDouble() + amount;
+    mType = evil_number_float;
+
+    CheckIntegrety();
 }
 
-EvilNumber::EvilNumber( int64 val ) : mType(evil_number_int)
+void EvilNumber::MultiplyAll( EvilNumber* values, size_t count, double factor )
 {
-    mValue.iVal = val;
+    for (size_t i = 0; i < count; ++i)
+        values[i].Multiply(factor);
 }
 
-/* this is tricky, as we only handle signed calculations.
- * so this has the potentional to go wrong.
- */
-EvilNumber::EvilNumber( uint64 val ) : mType(evil_number_int)
+void EvilNumber::AddAll( EvilNumber* values, size_t count, double amount )
 {
-    mValue.iVal = *((int64*)&val);
+    for (size_t i = 0; i < count; ++i)
+        values[i].Add(amount);
 }
 
-EvilNumber operator*(const EvilNumber& val, const EvilNumber& val2)
+void EvilNumber::MultiplyEach( EvilNumber* values, const double* factors, size_t count )
 {
-    EvilNumber result = val;
-    result = result * val2;
-    return result;
-
-    //val.Multiply((EvilNumber &)val2);
-    //return *this;
-    //return EvilNumber(0);
+    for (size_t i = 0; i < count; ++i)
+        values[i].Multiply(factors[i]);
 }
 
 EvilNumber EvilTimeNow(){
@@ -27,6 +27,10 @@
 #include "EVEVersion.h"
 
 static const uint32 PING_INTERVAL_US = 60000;
+/// How often (in ms) to look whether the destination of a jump has been booted.
+static const uint32 CLIENT_JUMP_PENDING_POLL = 100;
+/// How long (in ms) to wait for it before booting it ourselves.
+static const uint32 CLIENT_JUMP_PENDING_TIMEOUT = 30000;
 
 Client::Client(PyServiceMgr &services, EVETCPConnection** con)
 : DynamicSystemEntity(NULL),
@@ -39,6 +43,7 @@ Client::Client(PyServiceMgr &services, EVETCPConnection** con)
 //  m_lastDestinyTime(Timer::GetTimeSeconds()),
   m_moveState(msIdle),
   m_moveTimer(500),
+  m_jumpPendingSince(0),
   m_movePoint(0, 0, 0),
   m_timeEndTrain(0),
   m_destinyEventQueue( new PyList ),
@@ -145,6 +150,7 @@ void Client::Process() {
             break;
         //used to delay stargate animation
         case msJump:
+        case msJumpPending:
             _ExecuteJump();
             break;
         }
@@ -453,6 +459,8 @@ void Client::MoveItem(uint32 itemID, uint32 location, EVEItemFlags flag)
     if(was_module || (item->flag() >= flagSlotFirst && item->flag() <= flagSlotLast)) {
         //it was equipped, or is now. so mModulesMgr need to know.
         mModulesMgr.UpdateModules();
+        //and so does our slim item, which lists the fitting.
+        InvalidateCache();
     }
 }
 
@@ -802,6 +810,8 @@ void Client::QueueDestinyEvent(PyTuple** multiEvent)
 }
 
 void Client::_SendQueuedUpdates() {
+    TIC_PHASE( PHASE_ENCODE );
+
     if( !m_destinyUpdateQueue->empty() )
     {
         DoDestinyUpdateMain dum;
@@ -963,6 +973,9 @@ void Client::StargateJump(uint32 fromGate, uint32 toGate) {
     m_movePoint = position;
     m_movePoint.MakeRandomPointOnSphere( 10000 );   // Make Jump-In point a random spot on a 10km radius sphere about the stargate
 
+    //have the destination booted while the JumpOut animation plays
+    m_services.entity_list.PrefetchSystem( solarSystemID );
+
     m_destiny->SendJumpOut(fromGate);
     //TODO: send 'effects.GateActivity' on 'toGate' at the same time
 
@@ -1013,6 +1026,25 @@ void Client::_ExecuteJump() {
     if(m_destiny == NULL)
         return;
 
+    //the loader is still reading the destination; keep the loop going and look again later.
+    if(m_services.entity_list.IsSystemBooting(m_moveSystemID)) {
+        const uint32 now = GetTickCount();
+        if(m_jumpPendingSince == 0)
+            m_jumpPendingSince = now;
+
+        if(now - m_jumpPendingSince < CLIENT_JUMP_PENDING_TIMEOUT) {
+            _postMove(msJumpPending, CLIENT_JUMP_PENDING_POLL);
+            return;
+        }
+
+        sLog.Warning("Client","%s: Gave up waiting for system %u after %u ms, booting it now.", GetName(), m_moveSystemID, now - m_jumpPendingSince);
+    }
+
+    if(m_jumpPendingSince != 0) {
+        _log(CLIENT__MESSAGE, "%s: Waited %u ms for system %u to boot.", GetName(), GetTickCount() - m_jumpPendingSince, m_moveSystemID);
+        m_jumpPendingSince = 0;
+    }
+
     MoveToLocation(m_moveSystemID, m_movePoint);
 }
 
@@ -1340,6 +1372,9 @@ DoDestinyUpdate ,*args= ([(31759,
 void Client::JoinCorporationUpdate(uint32 corp_id) {
     GetChar()->JoinCorporation(corp_id);
 
+    //the corporation is part of our slim item.
+    InvalidateCache();
+
     _UpdateSession( GetChar() );
 
     //logs indicate that we need to push this update out asap.
@@ -57,21 +57,37 @@ EVEServerConfig::EVEServerConfig()
     character.startBalance = 6666000000.0f;
 
     // database
+    database.backend = "mysql";
     database.host = "localhost";
     database.port = 3306;
     database.username = "eve";
     database.password = "eve";
     database.db = "eve";
+    database.dumps = "";
+    database.flushInterval = 1000;
+    database.flushBatchSize = 1000;
+    database.profileQueries = true;
+    database.slowQueryThreshold = 250;
+    database.cacheStaticUniverse = true;
+    database.itemCacheMaxItems = 200000;
+    database.itemCacheMaxMemory = 0;
+    database.cachePrimeThreads = 4;
+    database.cachePrimeInBackground = false;
+    database.cacheRefreshInterval = 60;
 
     // files
     files.log = "../log/eve-server.log";
     files.logSettings = "../etc/log.ini";
     files.cacheDir = "";
+    files.staticSnapshot = "";
 	files.imageDir = "../images/";
 
     // net
     net.port = 26001;
 	net.imageServer = "localhost";
+
+    // world
+    world.systemIdleTimeout = 900;
 }
 
 bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
@@ -82,6 +98,7 @@ bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
     AddMemberParser( "database",  &EVEServerConfig::ProcessDatabase );
     AddMemberParser( "files",     &EVEServerConfig::ProcessFiles );
     AddMemberParser( "net",       &EVEServerConfig::ProcessNet );
+    AddMemberParser( "world",     &EVEServerConfig::ProcessWorld );
 
     // parse the element
     const bool result = ParseElementChildren( ele );
@@ -92,6 +109,7 @@ bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
     RemoveParser( "database" );
     RemoveParser( "files" );
     RemoveParser( "net" );
+    RemoveParser( "world" );
 
     // return status of parsing
     return result;
@@ -123,19 +141,43 @@ bool EVEServerConfig::ProcessCharacter( const TiXmlElement* ele )
 
 bool EVEServerConfig::ProcessDatabase( const TiXmlElement* ele )
 {
+    AddValueParser( "backend",  database.backend );
     AddValueParser( "host",     database.host );
     AddValueParser( "port",     database.port );
     AddValueParser( "username", database.username );
     AddValueParser( "password", database.password );
     AddValueParser( "db",       database.db );
+    AddValueParser( "dumps",    database.dumps );
+    AddValueParser( "flushInterval",  database.flushInterval );
+    AddValueParser( "flushBatchSize", database.flushBatchSize );
+    AddValueParser( "profileQueries",     database.profileQueries );
+    AddValueParser( "slowQueryThreshold", database.slowQueryThreshold );
+    AddValueParser( "cacheStaticUniverse", database.cacheStaticUniverse );
+    AddValueParser( "itemCacheMaxItems",   database.itemCacheMaxItems );
+    AddValueParser( "itemCacheMaxMemory",  database.itemCacheMaxMemory );
+    AddValueParser( "cachePrimeThreads",   database.cachePrimeThreads );
+    AddValueParser( "cachePrimeInBackground", database.cachePrimeInBackground );
+    AddValueParser( "cacheRefreshInterval", database.cacheRefreshInterval );
 
     const bool result = ParseElementChildren( ele );
 
+    RemoveParser( "backend" );
     RemoveParser( "host" );
     RemoveParser( "port" );
     RemoveParser( "username" );
     RemoveParser( "password" );
     RemoveParser( "db" );
+    RemoveParser( "dumps" );
+    RemoveParser( "flushInterval" );
+    RemoveParser( "flushBatchSize" );
+    RemoveParser( "profileQueries" );
+    RemoveParser( "slowQueryThreshold" );
+    RemoveParser( "cacheStaticUniverse" );
+    RemoveParser( "itemCacheMaxItems" );
+    RemoveParser( "itemCacheMaxMemory" );
+    RemoveParser( "cachePrimeThreads" );
+    RemoveParser( "cachePrimeInBackground" );
+    RemoveParser( "cacheRefreshInterval" );
 
     return result;
 }
@@ -145,6 +187,7 @@ bool EVEServerConfig::ProcessFiles( const TiXmlElement* ele )
     AddValueParser( "log",         files.log );
     AddValueParser( "logSettings", files.logSettings );
     AddValueParser( "cacheDir",    files.cacheDir );
+    AddValueParser( "staticSnapshot", files.staticSnapshot );
 	AddValueParser( "imageDir",	   files.imageDir );
 
     const bool result = ParseElementChildren( ele );
@@ -152,6 +195,7 @@ bool EVEServerConfig::ProcessFiles( const TiXmlElement* ele )
     RemoveParser( "log" );
     RemoveParser( "logSettings" );
     RemoveParser( "cacheDir" );
+    RemoveParser( "staticSnapshot" );
 	RemoveParser( "imageDir" );
 
     return result;
@@ -169,3 +213,14 @@ bool EVEServerConfig::ProcessNet( const TiXmlElement* ele )
 
     return result;
 }
+
+bool EVEServerConfig::ProcessWorld( const TiXmlElement* ele )
+{
+    AddValueParser( "systemIdleTimeout", world.systemIdleTimeout );
+
+    const bool result = ParseElementChildren( ele );
+
+    RemoveParser( "systemIdleTimeout" );
+
+    return result;
+}
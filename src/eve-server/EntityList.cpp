@@ -25,8 +25,41 @@
 
 #include "EVEServerPCH.h"
 
-EntityList::EntityList() : m_services( NULL ) {}
+/// How often (in ms) to look for idle systems.
+static const int32 ENTITYLIST_HIBERNATE_CHECK_INTERVAL = 10000;
+/// How often (in ms) the loader looks for systems to read.
+static const uint32 ENTITYLIST_LOADER_GRANULARITY = 10;
+
+struct EntityList::SystemLoad
+{
+	SystemLoad(uint32 systemID)
+	: done( false ),
+	  success( false ),
+	  loadTime( 0 )
+	{
+		data.systemID = systemID;
+	}
+
+	SystemBootData data;
+	/// set by the loader once it is done; it does not touch the load anymore then
+	bool done;
+	bool success;
+	/// in us
+	uint64 loadTime;
+};
+
+EntityList::EntityList()
+: m_loading( false ),
+  m_loaderStarted( false ),
+  m_systemIdleTimeout( 0 ),
+  m_hibernateTimer( ENTITYLIST_HIBERNATE_CHECK_INTERVAL ),
+  m_services( NULL )
+{
+	memset( &m_systemStats, 0, sizeof( m_systemStats ) );
+}
 EntityList::~EntityList() {
+	StopLoader();
+
 	{
 	    client_list::iterator cur, end;
 	    cur = m_clients.begin();
@@ -106,7 +139,7 @@ void EntityList::Process()
         {
             sLog.Log("Entity List", "Destroying system");
 			tmp = cur++;
-			delete cur->second;
+			delete active_system;
 			m_systems.erase(tmp);
 		}
         else
@@ -118,6 +151,21 @@ void EntityList::Process()
 	{
 		DestinyManager::TicCompleted();
 	}
+
+	//one at a time, so that a whole fleet jumping out does not stall us at once.
+	if( m_loading )
+		_BootLoadedSystem();
+	else if( !m_prefetchSystems.empty() )
+	{
+		const uint32 systemID = *m_prefetchSystems.begin();
+		m_prefetchSystems.erase( m_prefetchSystems.begin() );
+
+		if( m_systems.find( systemID ) == m_systems.end() && _BootSystem( systemID ) != NULL )
+			m_systemStats.prefetches++;
+	}
+
+	if( 0 < m_systemIdleTimeout && m_hibernateTimer.Check() )
+		_HibernateIdleSystems();
 }
 
 Client *EntityList::FindCharacter(uint32 char_id) const {
@@ -375,7 +423,194 @@ SystemManager *EntityList::FindOrBootSystem(uint32 systemID) {
 	if(res != m_systems.end())
 		return(res->second);
 
-    sLog.Log("Entity List", "Booting system %u", systemID);
+	return _BootSystem(systemID);
+}
+
+void EntityList::PrefetchSystem(uint32 systemID) {
+	system_list::iterator res;
+	res = m_systems.find(systemID);
+	if(res != m_systems.end()) {
+		//make sure it is still up when they arrive.
+		res->second->KeepAwake();
+		return;
+	}
+
+	if(!m_loading) {
+		m_prefetchSystems.insert(systemID);
+		return;
+	}
+
+	MutexLock lock(m_loadLock);
+	if(m_loads.find(systemID) != m_loads.end())
+		return;
+
+	SystemLoad *load = new SystemLoad(systemID);
+
+	m_loads[systemID] = load;
+	m_loadQueue.push_back(load);
+
+	//the rows are read now, but used a few passes later.
+	m_services->item_factory.QueuePrefetch();
+}
+
+bool EntityList::IsSystemBooting(uint32 systemID) const {
+	MutexLock lock(m_loadLock);
+	return(m_loads.find(systemID) != m_loads.end());
+}
+
+void EntityList::StartLoader() {
+	if(m_loading)
+		return;
+
+	m_loading = true;
+	m_loaderStarted = false;
+
+#ifdef WIN32
+	_beginthread( EntityList::_LoaderLoop, 0, this );
+#else
+	pthread_t thread;
+	pthread_create( &thread, NULL, &EntityList::_LoaderLoop, this );
+	pthread_detach( thread );
+#endif
+
+	//StopLoader() waits on m_loaderRunning, so the loader must hold it before we return
+	while(!m_loaderStarted)
+		Sleep( 1 );
+
+	sLog.Log("Entity List", "Started the system loader.");
+}
+
+void EntityList::StopLoader() {
+	if(!m_loading)
+		return;
+
+	m_loading = false;
+
+	//wait for the loader to stop
+	m_loaderRunning.Lock();
+	m_loaderRunning.Unlock();
+
+	//whatever it read is not going to be booted now
+	load_list::iterator cur, end;
+	cur = m_loads.begin();
+	end = m_loads.end();
+	for(; cur != end; cur++) {
+		m_services->item_factory.CancelPrefetch();
+		delete cur->second;
+	}
+	m_loads.clear();
+	m_loadQueue.clear();
+}
+
+thread_return_t EntityList::_LoaderLoop(void *arg) {
+	EntityList *list = reinterpret_cast<EntityList *>( arg );
+	assert( list != NULL );
+
+	THREAD_RETURN( list->_LoaderLoop() );
+}
+
+thread_return_t EntityList::_LoaderLoop() {
+	m_loaderRunning.Lock();
+	m_loaderStarted = true;
+
+	//a connection of our own, so the main loop does not queue up behind us
+	DBerror err;
+	if(!sDatabase.OpenThreadConnection(err))
+		sLog.Error("Entity List", "System loader failed to open a database connection, using the shared one: %s", err.c_str());
+
+	while(m_loading) {
+		SystemLoad *load = NULL;
+		{
+			MutexLock lock(m_loadLock);
+			if(!m_loadQueue.empty()) {
+				load = m_loadQueue.front();
+				m_loadQueue.pop_front();
+			}
+		}
+
+		if(load == NULL) {
+			Sleep( ENTITYLIST_LOADER_GRANULARITY );
+			continue;
+		}
+
+		//nobody else touches the load until it is done
+		const uint64 start = Win32TimeNow();
+		const bool success = SystemManager::LoadSystem(m_services->item_factory, load->data);
+		const uint64 loadTime = ( Win32TimeNow() - start ) / 10;
+
+		MutexLock lock(m_loadLock);
+		load->success = success;
+		load->loadTime = loadTime;
+		load->done = true;
+	}
+
+	sDatabase.CloseThreadConnection();
+
+	m_loaderRunning.Unlock();
+
+	THREAD_RETURN( NULL );
+}
+
+void EntityList::_BootLoadedSystem() {
+	SystemLoad *load = NULL;
+	{
+		MutexLock lock(m_loadLock);
+
+		load_list::iterator cur, end;
+		cur = m_loads.begin();
+		end = m_loads.end();
+		for(; cur != end; cur++) {
+			if(cur->second->done) {
+				load = cur->second;
+				m_loads.erase(cur);
+				break;
+			}
+		}
+	}
+
+	if(load == NULL)
+		return;
+
+	const uint32 systemID = load->data.systemID;
+	if(m_systems.find(systemID) != m_systems.end()) {
+		//FindOrBootSystem() could not wait for us.
+		m_services->item_factory.CancelPrefetch();
+	} else if(!load->success) {
+		m_services->item_factory.CancelPrefetch();
+		sLog.Error("Entity List", "Failed to read system %u ahead of a jump.", systemID);
+	} else if(_BootSystem(systemID, load) != NULL) {
+		m_systemStats.prefetches++;
+	}
+
+	delete load;
+}
+
+void EntityList::DepopNPCs() {
+	system_list::iterator cur, end;
+	cur = m_systems.begin();
+	end = m_systems.end();
+	for(; cur != end; cur++)
+		cur->second->DepopNPCs();
+}
+
+void EntityList::GetSystemStats(SystemStats &into) const {
+	into = m_systemStats;
+
+	into.live = uint32(m_systems.size());
+	into.liveBytes = 0;
+
+	system_list::const_iterator cur, end;
+	cur = m_systems.begin();
+	end = m_systems.end();
+	for(; cur != end; cur++)
+		into.liveBytes += cur->second->GetMemoryUsage();
+}
+
+SystemManager *EntityList::_BootSystem(uint32 systemID, SystemLoad *load) {
+	//FindOrBootSystem() may have beaten the prefetch.
+	m_prefetchSystems.erase(systemID);
+
+    sLog.Log("Entity List", "Booting system %u%s", systemID, (load != NULL ? " read by the loader" : ""));
 /*	
     ItemData idata(
         5,
@@ -385,12 +620,60 @@ SystemManager *EntityList::FindOrBootSystem(uint32 systemID) {
         1
 	);
 */
+	const uint64 start = Win32TimeNow();
+
 	SystemManager *mgr = new SystemManager(systemID, *m_services);//, idata);
-	if(!mgr->BootSystem()) {
+	const bool booted = (load != NULL ? mgr->BootSystem(load->data) : mgr->BootSystem());
+	if(!booted) {
 		delete mgr;
 		return NULL;
 	}
 	
+	//only what the main loop spent here; the loader reads in parallel to it
+	const uint64 bootTime = ( Win32TimeNow() - start ) / 10;
+	m_systemStats.boots++;
+	m_systemStats.totalBootTime += bootTime;
+	m_systemStats.lastBootTime = bootTime;
+	if( bootTime > m_systemStats.maxBootTime )
+		m_systemStats.maxBootTime = bootTime;
+
+	const uint64 loadTime = (load != NULL ? load->loadTime : 0);
+	m_systemStats.totalLoadTime += loadTime;
+	if( loadTime > m_systemStats.maxLoadTime )
+		m_systemStats.maxLoadTime = loadTime;
+
 	m_systems[systemID] = mgr;
+
+	sLog.Log("Entity List", "Booted system %s (%u) in %.1f ms (read by the loader in %.1f ms), ~%lu KB; %lu systems live",
+	         mgr->GetName().c_str(), systemID, bootTime / 1000.0, loadTime / 1000.0, mgr->GetMemoryUsage() / 1024, m_systems.size());
 	return mgr;
 }
+
+void EntityList::_HibernateIdleSystems() {
+	const uint32 now = Timer::GetTimeSeconds();
+
+	system_list::iterator cur, end, tmp;
+	cur = m_systems.begin();
+	end = m_systems.end();
+	while(cur != end) {
+		SystemManager *system = cur->second;
+		if(system->GetClientCount() > 0 || now - system->GetIdleSince() < m_systemIdleTimeout) {
+			cur++;
+			continue;
+		}
+
+		const uint32 systemID = cur->first;
+		const uint32 idle = now - system->GetIdleSince();
+		const size_t memory = system->GetMemoryUsage();
+
+		system->Hibernate();
+		delete system;
+
+		tmp = cur++;
+		m_systems.erase(tmp);
+		m_systemStats.hibernations++;
+
+		sLog.Log("Entity List", "Hibernated system %u after %u s without clients, ~%lu KB freed; %lu systems live",
+		         systemID, idle, memory / 1024, m_systems.size());
+	}
+}
@@ -153,9 +153,8 @@ PyResult NetService::Handle_GetInitVals(PyCallArgs &call) {
 	PyRep* serverinfo = m_manager->cache_service->GetCacheHint(str);
     PyDecRef( str );
 
-	PyDict* initvals = new PyDict();
     //send all the cache hints needed for server info.
-	m_manager->cache_service->InsertCacheHints(ObjCacheService::hLoginCachables, initvals);
+	PyDict* initvals = m_manager->cache_service->GetCacheHints(ObjCacheService::hLoginCachables);
 
 	PyTuple* result = new PyTuple( 2 );
 	result->SetItem( 0, serverinfo );
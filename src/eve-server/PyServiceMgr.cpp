@@ -60,7 +60,9 @@ PyServiceMgr::~PyServiceMgr() {
 }
 
 void PyServiceMgr::Process() {
-	//well... we used to have something to do, but not right now...
+	// cached objects still being primed in background
+	if(cache_service != NULL)
+		cache_service->Process();
 }
 
 void PyServiceMgr::RegisterService(PyService *d) {
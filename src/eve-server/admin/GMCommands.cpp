@@ -1164,3 +1164,229 @@ PyResult Command_kenny( Client* who, CommandDB* db, PyServiceMgr* services, cons
 	return NULL;
 }
 
+
+PyResult Command_dbprofile( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    DBProfiler::SortKey key = DBProfiler::SortTotal;
+    size_t limit = 20;
+
+    if( args.argCount() >= 2 )
+    {
+        if( args.arg( 1 ) == "reset" )
+        {
+            sDatabase.profiler().Reset();
+            return new PyString( "Query statistics cleared." );
+        }
+
+        if( !DBProfiler::ParseSortKey( args.arg( 1 ).c_str(), key ) )
+            throw PyException( MakeCustomError("Correct Usage: /dbprofile [count|total|avg|p99|rows|bytes] [limit] | reset") );
+    }
+
+    if( args.argCount() >= 3 )
+    {
+        if( !args.isNumber( 2 ) )
+            throw PyException( MakeCustomError("Argument 2 should be the number of statements to show.") );
+
+        limit = atoi( args.arg( 2 ).c_str() );
+    }
+
+    std::vector<DBProfiler::Entry> report;
+    sDatabase.profiler().GetReport( key, limit, report );
+
+    std::string result = "count / total ms / avg us / p50 us / p99 us / rows / bytes<br>";
+
+    std::vector<DBProfiler::Entry>::const_iterator cur, end;
+    cur = report.begin();
+    end = report.end();
+    for(; cur != end; cur++)
+    {
+        // keep the popup readable and its markup intact
+        std::string fingerprint = cur->fingerprint.substr( 0, 120 );
+        for( size_t pos = fingerprint.find( '<' ); std::string::npos != pos; pos = fingerprint.find( '<', pos ) )
+            fingerprint.replace( pos, 1, "&lt;" );
+
+        std::string line;
+        sprintf( line, I64u " / " I64u " / " I64u " / " I64u " / " I64u " / " I64u " / " I64u ": %s<br>",
+                 cur->count, cur->totalTime / 1000, cur->Average(), cur->Percentile( 50 ), cur->Percentile( 99 ),
+                 cur->rows, cur->bytes, fingerprint.c_str() );
+        result += line;
+    }
+
+    return new PyString( result );
+}
+
+PyResult Command_dbqueue( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() == 2 )
+    {
+        if( args.arg( 1 ) != "flush" )
+            throw PyException( MakeCustomError("Correct Usage: /dbqueue [flush]") );
+
+        sDBWriteQueue.Flush();
+    }
+
+    DBWriteQueue::Stats stats;
+    sDBWriteQueue.GetStats( stats );
+
+    std::string result;
+    sprintf( result,
+        "Pending rows: %u (peak %u)<br>"
+        "Rows queued: " I64u ", coalesced: " I64u "<br>"
+        "Rows written: " I64u " in " I64u " statements, failed: " I64u ", retried: " I64u "<br>"
+        "Flushes: %u, last %u ms, avg %u ms, max %u ms",
+        stats.depth, stats.maxDepth,
+        stats.rowsQueued, stats.rowsCoalesced,
+        stats.rowsWritten, stats.statements, stats.rowsFailed, stats.rowsRetried,
+        stats.flushes, stats.lastFlushTime,
+        ( 0 < stats.flushes ? (uint32)( stats.totalFlushTime / stats.flushes ) : 0 ),
+        stats.maxFlushTime );
+
+    AttributeMap::SaveStats attrStats;
+    AttributeMap::GetSaveStats( attrStats );
+
+    std::string attrResult;
+    sprintf( attrResult,
+        "<br>Attribute saves: " I64u ", rows: " I64u " (avg %u, last %u, max %u per save)",
+        attrStats.saves, attrStats.rowsWritten,
+        ( 0 < attrStats.saves ? (uint32)( attrStats.rowsWritten / attrStats.saves ) : 0 ),
+        attrStats.lastRows, attrStats.maxRows );
+    result += attrResult;
+
+    AttributeMap::MemoryStats memStats;
+    AttributeMap::GetMemoryStats( memStats );
+
+    /* what the per-item copies of the defaults (one map node each) would have cost */
+    const uint64 mapNode = 4 * sizeof( void* ) + sizeof( std::pair<uint32, EvilNumber> );
+    const uint64 bytes = memStats.maps * sizeof( AttributeMap ) + memStats.overrides * sizeof( AttributeMap::Override );
+    const uint64 copied = memStats.maps * sizeof( AttributeMap ) + ( memStats.defaults + memStats.overrides ) * mapNode;
+
+    sprintf( attrResult,
+        "<br>Attribute maps: %u, overrides: " I64u ", shared defaults: " I64u "<br>"
+        "Attribute memory: " I64u " bytes (%u per item), with copied defaults ~" I64u " bytes (%u per item)",
+        memStats.maps, memStats.overrides, memStats.defaults,
+        bytes, ( 0 < memStats.maps ? (uint32)( bytes / memStats.maps ) : 0 ),
+        copied, ( 0 < memStats.maps ? (uint32)( copied / memStats.maps ) : 0 ) );
+    result += attrResult;
+
+    return new PyString( result );
+}
+
+PyResult Command_itemcache( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    uint32 evicted = 0;
+    if( args.argCount() == 2 )
+    {
+        if( args.arg( 1 ) != "evict" )
+            throw PyException( MakeCustomError("Correct Usage: /itemcache [evict]") );
+
+        evicted = services->item_factory.EvictItems( true );
+    }
+
+    ItemFactory::CacheStats stats;
+    services->item_factory.GetCacheStats( stats );
+
+    const uint64 lookups = stats.hits + stats.misses;
+
+    std::string result;
+    sprintf( result,
+        "Cached items: %u, ~" I64u " KB<br>"
+        "Hits: " I64u ", misses: " I64u " (%u%% hit rate)<br>"
+        "Evictions: " I64u " in %u sweeps (%u just now)",
+        stats.resident, stats.residentBytes / 1024,
+        stats.hits, stats.misses, ( 0 < lookups ? (uint32)( stats.hits * 100 / lookups ) : 0 ),
+        stats.evictions, stats.sweeps, evicted );
+
+    return new PyString( result );
+}
+
+PyResult Command_tablechanged( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() < 2 )
+        throw PyException( MakeCustomError("Correct Usage: /tablechanged (table) [table ...]") );
+
+    std::string result;
+    for( uint32 i = 1; i < args.argCount(); ++i )
+    {
+        const size_t objects = services->cache_service->TableChanged( args.arg( i ).c_str() );
+
+        std::string line;
+        sprintf( line, "%s: %lu cached objects affected<br>", args.arg( i ).c_str(), objects );
+        result += line;
+    }
+
+    return new PyString( result );
+}
+
+PyResult Command_configcache( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() == 2 )
+    {
+        if( args.arg( 1 ) != "flush" )
+            throw PyException( MakeCustomError("Correct Usage: /configcache [flush]") );
+
+        sConfigCache.Clear();
+    }
+
+    std::string result;
+    for( uint32 i = 0; i < ConfigCache::KindCount; ++i )
+    {
+        const ConfigCache::Kind kind = (ConfigCache::Kind)i;
+
+        ConfigCache::Stats stats;
+        sConfigCache.GetStats( kind, stats );
+
+        const uint64 lookups = stats.hits + stats.misses;
+
+        std::string line;
+        sprintf( line,
+            "%s: %u cached, %u unknown; "
+            "hits: " I64u ", misses: " I64u " (%u%% hit rate); "
+            "queries: " I64u ", saved: " I64u "<br>",
+            ConfigCache::GetKindName( kind ), stats.entries, stats.negativeEntries,
+            stats.hits, stats.misses, ( 0 < lookups ? (uint32)( stats.hits * 100 / lookups ) : 0 ),
+            stats.queries, stats.queriesSaved );
+        result += line;
+    }
+
+    return new PyString( result );
+}
+
+PyResult Command_bubbles( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    SystemManager* system = who->System();
+    if( NULL == system )
+        throw PyException( MakeCustomError( "You are not in a solar system." ) );
+
+    BubbleManager::Stats stats;
+    system->bubbles.GetStats( stats );
+
+    std::string result;
+    sprintf( result,
+        "Bubbles in %s: %u live (%u empty), peak %u<br>"
+        "Created: " I64u ", reclaimed: " I64u ", entities merged: " I64u,
+        system->GetName().c_str(), stats.live, stats.empty, stats.peak,
+        stats.created, stats.reclaimed, stats.merged );
+
+    return new PyString( result );
+}
+
+PyResult Command_systems( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    EntityList::SystemStats stats;
+    services->entity_list.GetSystemStats( stats );
+
+    std::string result;
+    sprintf( result,
+        "Live systems: %u, ~" I64u " KB<br>"
+        "Boots: %u (%u prefetched), last %u ms, avg %u ms, max %u ms<br>"
+        "Loader: avg %u ms, max %u ms<br>"
+        "Hibernations: %u",
+        stats.live, stats.liveBytes / 1024,
+        stats.boots, stats.prefetches, (uint32)( stats.lastBootTime / 1000 ),
+        ( 0 < stats.boots ? (uint32)( stats.totalBootTime / stats.boots / 1000 ) : 0 ),
+        (uint32)( stats.maxBootTime / 1000 ),
+        ( 0 < stats.prefetches ? (uint32)( stats.totalLoadTime / stats.prefetches / 1000 ) : 0 ),
+        (uint32)( stats.maxLoadTime / 1000 ), stats.hibernations );
+
+    return new PyString( result );
+}
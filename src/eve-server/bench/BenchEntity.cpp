@@ -0,0 +1,114 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchEntity.h"
+
+using namespace Destiny;
+
+BenchEntity::BenchEntity( uint32 id, const GPoint& position )
+: mID( id ),
+  mPosition( position ),
+  mVelocity( 0, 0, 0 ),
+  mUpdates( 0 ),
+  mEvents( 0 )
+{
+    sprintf( mName, "Bench Ship %u", id );
+}
+
+void BenchEntity::QueueDestinyUpdate( PyTuple** du )
+{
+    // not consumed, like NPCs do
+    ++mUpdates;
+}
+
+void BenchEntity::QueueDestinyEvent( PyTuple** multiEvent )
+{
+    ++mEvents;
+}
+
+void BenchEntity::EncodeDestiny( Buffer& into ) const
+{
+    // same layout as DynamicSystemEntity::EncodeDestiny() for a stopped ship
+    BallHeader head;
+    head.entityID = GetID();
+    head.mode = Destiny::DSTBALL_STOP;
+    head.radius = GetRadius();
+    head.x = GetPosition().x;
+    head.y = GetPosition().y;
+    head.z = GetPosition().z;
+    head.sub_type = IsFree | IsMassive | IsInteractive;
+    into.Append( head );
+
+    MassSector mass;
+    mass.mass = 1000000.0;
+    mass.cloak = 0;
+    mass.unknown52 = 0xFFFFFFFFFFFFFFFFLL;
+    mass.corpID = 1000044;
+    mass.allianceID = 0;
+    into.Append( mass );
+
+    ShipSector ship;
+    ship.max_speed = 300.0;
+    ship.velocity_x = GetVelocity().x;
+    ship.velocity_y = GetVelocity().y;
+    ship.velocity_z = GetVelocity().z;
+    ship.unknown_x = 0.0;
+    ship.unknown_y = 0.0;
+    ship.unknown_z = 0.0;
+    ship.agility = 1.0;
+    ship.speed_fraction = 0.0;
+    into.Append( ship );
+
+    DSTBALL_STOP_Struct main;
+    main.formationID = 0xFF;
+    into.Append( main );
+
+    const uint8 nameLen = utf8::distance( mName.begin(), mName.end() );
+    into.Append( nameLen );
+
+    const Buffer::iterator<uint16> name = into.end<uint16>();
+    into.ResizeAt( name, nameLen );
+    utf8::utf8to16( mName.begin(), mName.end(), name );
+}
+
+PyDict* BenchEntity::MakeSlimItem() const
+{
+    PyDict* slim = new PyDict();
+    slim->SetItemString( "itemID", new PyInt( GetID() ) );
+    slim->SetItemString( "typeID", new PyInt( 587 ) );  // Rifter
+    slim->SetItemString( "ownerID", new PyInt( 1000044 ) );
+    return slim;
+}
+
+void BenchEntity::MakeDamageState( DoDestinyDamageState& into ) const
+{
+    into.shield = 1.0;
+    into.tau = 100000;
+    into.timestamp = Win32TimeNow();
+    into.armor = 1.0;
+    into.structure = 1.0;
+}
@@ -0,0 +1,220 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/Benchmarks.h"
+
+static const char* const LOG_SETTINGS_FILE = EVEMU_ROOT_DIR"etc/log.ini";
+
+// normally defined by the server's main.cpp; the scenarios do not load dogma.
+dgmtypeattributemgr * _sDgmTypeAttrMgr = NULL;
+
+const EVEBenchmark EVEBENCH_BENCHMARKS[] =
+{
+    { "bubbles",    &BubbleBenchmark,     "Bubble lookup and placement; args: [bubbles] [lookups]" },
+    { "bubblesoak", &BubbleSoakBenchmark, "Ships warping between many points; args: [ships] [minutes]" },
+    { "destiny",    &DestinyBenchmark,    "Per-ball destiny integration; args: [tics] [balls ...]" },
+    { "simulation", &SimulationBenchmark, "Destiny tics of a system full of ships; args: [ships] [tics] [clients]" },
+    { "waves",      &WaveBenchmark,       "NPC waves killed within one pass; args: [NPCs per wave] [waves] [ships] [statics]" },
+    { "setstate",   &SetStateBenchmark,   "SetState and AddBalls for ships arriving at a gate; args: [celestials] [ships] [count] [arrivals per tic]" },
+    { "hangar",     &HangarBenchmark,     "Loading the contents of a station hangar; args: [items] [items of others] [attributes per item]" },
+    { "evictsoak",  &EvictSoakBenchmark,  "Evicting and reloading the items of a station hangar under write load; args: [items] [rounds] [cached items] [flush interval ms]" },
+    { "itemload",   &ItemLoadBenchmark,   "Type attribute table and loading stacks of a few types; args: [items] [types] [saved attributes per item]" },
+    { "startup",    &StartupBenchmark,    "Static data loaded at startup, with and without the snapshot; args: build|sql|snapshot [types] [attributes per type] [celestials]" },
+    { "logins",     &LoginBenchmark,      "Cached objects sent to clients logging in at once; args: build|heap|mapped [logins] [objects] [KiB per object]" }
+};
+const size_t EVEBENCH_BENCHMARK_COUNT = ( sizeof( EVEBENCH_BENCHMARKS ) / sizeof( EVEBenchmark ) );
+
+/// Number of allocations made with operator new.
+static uint64 sBenchAllocations = 0;
+/// Bytes currently allocated with operator new.
+static uint64 sBenchAllocatedBytes = 0;
+
+/// Every block starts with its size; this much keeps the rest aligned as malloc would.
+static const size_t BENCH_ALLOCATION_HEADER = 16;
+
+void* operator new( size_t size )
+{
+    ++sBenchAllocations;
+
+    uint8* p = (uint8*)malloc( BENCH_ALLOCATION_HEADER + size );
+    if( NULL == p )
+        throw std::bad_alloc();
+
+    *(size_t*)p = size;
+    sBenchAllocatedBytes += size;
+
+    return p + BENCH_ALLOCATION_HEADER;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* p ) throw()
+{
+    if( NULL == p )
+        return;
+
+    uint8* block = (uint8*)p - BENCH_ALLOCATION_HEADER;
+    sBenchAllocatedBytes -= *(size_t*)block;
+
+    free( block );
+}
+
+void operator delete[]( void* p ) throw()
+{
+    operator delete( p );
+}
+
+uint64 BenchAllocations()
+{
+    return sBenchAllocations;
+}
+
+uint64 BenchAllocatedBytes()
+{
+    return sBenchAllocatedBytes;
+}
+
+void BenchRSS( uint64& current, uint64& peak )
+{
+    current = peak = 0;
+
+#ifndef WIN32
+    rusage usage;
+    if( 0 == ::getrusage( RUSAGE_SELF, &usage ) )
+        peak = usage.ru_maxrss;
+
+    FILE* f = fopen( "/proc/self/statm", "r" );
+    if( NULL != f )
+    {
+        unsigned long size, resident;
+        if( 2 == fscanf( f, "%lu %lu", &size, &resident ) )
+            current = (uint64)resident * ::sysconf( _SC_PAGESIZE ) / 1024;
+
+        fclose( f );
+    }
+
+    // the kernel updates the high water mark lazily
+    if( current > peak )
+        peak = current;
+#endif /* !WIN32 */
+}
+
+void BenchCPUTime( uint64& process, uint64& thread )
+{
+    process = thread = 0;
+
+#ifndef WIN32
+    rusage usage;
+    if( 0 == ::getrusage( RUSAGE_SELF, &usage ) )
+        process = (uint64)( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#   ifdef RUSAGE_THREAD
+    if( 0 == ::getrusage( RUSAGE_THREAD, &usage ) )
+        thread = (uint64)( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#   endif /* RUSAGE_THREAD */
+#endif /* !WIN32 */
+}
+
+bool BenchOpenDatabase( const char* cmdName, const char* const statements[], size_t statementCount, const char* database )
+{
+#ifdef EVEMU_SQLITE_ENABLE
+    if( !sDatabase.SetBackend( "sqlite" ) )
+    {
+        sLog.Error( cmdName, "Failed to select the SQLite backend." );
+        return false;
+    }
+
+    DBerror err;
+    if( !sDatabase.Open( err, "localhost", "", "", database, 0 ) )
+    {
+        sLog.Error( cmdName, "Failed to open the database: %s", err.c_str() );
+        return false;
+    }
+
+    for( size_t i = 0; i < statementCount; ++i )
+    {
+        if( !sDatabase.RunQuery( err, "%s", statements[ i ] ) )
+        {
+            sLog.Error( cmdName, "Failed to set up the database: %s", err.c_str() );
+            return false;
+        }
+    }
+
+    return true;
+#else /* !EVEMU_SQLITE_ENABLE */
+    sLog.Error( cmdName, "The scenario reads the database; configure with EVEMU_SQLITE_ENABLE to run it in memory." );
+    return false;
+#endif /* !EVEMU_SQLITE_ENABLE */
+}
+
+const EVEBenchmark* FindBenchmark( const std::string& name )
+{
+    for( size_t i = 0; i < EVEBENCH_BENCHMARK_COUNT; ++i )
+    {
+        const EVEBenchmark* b = &EVEBENCH_BENCHMARKS[i];
+
+        if( b->name == name )
+            return b;
+    }
+
+    return NULL;
+}
+
+int main( int argc, char* argv[] )
+{
+    if( !load_log_settings( LOG_SETTINGS_FILE ) )
+        sLog.Warning( "init", "Unable to read %s (this file is optional)", LOG_SETTINGS_FILE );
+
+    if( 2 > argc )
+    {
+        sLog.Log( "eve-bench", "Usage: %s scenario [args]; scenarios:", argv[0] );
+        for( size_t i = 0; i < EVEBENCH_BENCHMARK_COUNT; ++i )
+            sLog.Log( "eve-bench", "    %-12s %s", EVEBENCH_BENCHMARKS[i].name, EVEBENCH_BENCHMARKS[i].description );
+
+        return 1;
+    }
+
+    const EVEBenchmark* b = FindBenchmark( argv[1] );
+    if( NULL == b )
+    {
+        sLog.Error( "eve-bench", "Unknown scenario '%s'.", argv[1] );
+        return 1;
+    }
+
+    std::string line;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( 1 < i )
+            line += ' ';
+        line += argv[i];
+    }
+
+    ( *b->callback )( Seperator( line.c_str() ) );
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchShip.h"
+
+/**
+ * The DestinyManager of a frigate; it has no item to read the
+ * capabilities from.
+ */
+class BenchShipDestiny
+: public DestinyManager
+{
+public:
+    BenchShipDestiny( SystemEntity* self, SystemManager* system, const GPoint& position )
+    : DestinyManager( self, system )
+    {
+        m_position = position;
+
+        m_radius = 40.0;
+        m_mass = 1067000.0;
+        m_maxShipVelocity = 365.0;
+        m_shipAgility = 3.2;
+        _UpdateDerrived();
+    }
+
+    static void NextTic() { ++m_stamp; }
+};
+
+BenchShip::BenchShip( uint32 id, SystemManager* system, const GPoint& position, bool client )
+: BenchEntity( id, position ),
+  mSystem( system ),
+  mDestiny( NULL ),
+  mClient( client ),
+  mUpdateQueue( new PyList ),
+  mEventQueue( new PyList ),
+  mBytesSent( 0 ),
+  mPacketsSent( 0 )
+{
+    mDestiny = new BenchShipDestiny( this, system, position );
+}
+
+BenchShip::~BenchShip()
+{
+    SafeDelete( mDestiny );
+
+    PyDecRef( mUpdateQueue );
+    PyDecRef( mEventQueue );
+}
+
+void BenchShip::SendQueuedUpdates()
+{
+    TIC_PHASE( PHASE_ENCODE );
+
+    // what Client::_SendQueuedUpdates() hands to SendNotification()
+    PyTuple* t = NULL;
+    if( !mUpdateQueue->empty() )
+    {
+        DoDestinyUpdateMain dum;
+
+        dum.updates = mUpdateQueue;
+        PyIncRef( mUpdateQueue );
+
+        dum.events = mEventQueue;
+        PyIncRef( mEventQueue );
+
+        dum.waitForBubble = false;
+
+        t = dum.Encode();
+    }
+    else if( !mEventQueue->empty() )
+    {
+        Notify_OnMultiEvent nom;
+
+        nom.events = mEventQueue;
+        PyIncRef( mEventQueue );
+
+        t = nom.Encode();
+    }
+
+    if( NULL != t )
+    {
+        Buffer packet;
+        if( MarshalDeflate( t, packet ) )
+        {
+            mBytesSent += packet.size();
+            ++mPacketsSent;
+        }
+
+        PyDecRef( t );
+    }
+
+    mEventQueue->clear();
+    mUpdateQueue->clear();
+}
+
+PyDict* BenchShip::MakeSlimItem() const
+{
+    // same entries as Client::MakeSlimItem(), with four modules fitted
+    PyDict* slim = BenchEntity::MakeSlimItem();
+    slim->SetItemString( "charID", new PyInt( 90000000 + GetID() % 1000000 ) );
+    slim->SetItemString( "corpID", new PyInt( 1000044 ) );
+    slim->SetItemString( "allianceID", new PyNone );
+    slim->SetItemString( "warFactionID", new PyNone );
+
+    PyList* modules = new PyList;
+    for( uint32 i = 0; i < 4; ++i )
+    {
+        PyTuple* t = new PyTuple( 2 );
+        t->SetItem( 0, new PyInt( GetID() * 8 + i ) );
+        t->SetItem( 1, new PyInt( 3057 ) );  // 125mm Gatling AutoCannon I
+
+        modules->AddItem( t );
+    }
+    slim->SetItemString( "modules", modules );
+
+    slim->SetItemString( "color", new PyFloat( 0.0 ) );
+    slim->SetItemString( "bounty", new PyInt( 0 ) );
+    slim->SetItemString( "securityStatus", new PyFloat( 0.0 ) );
+    return slim;
+}
+
+void BenchShip::NextTic()
+{
+    BenchShipDestiny::NextTic();
+}
+
+void BenchShip::ProcessDestiny()
+{
+    mDestiny->Process();
+}
+
+void BenchShip::QueueDestinyUpdate( PyTuple** du )
+{
+    ++mUpdates;
+    if( !mClient )
+        return;
+
+    DoDestinyAction act;
+    act.update_id = DestinyManager::GetStamp();
+    act.update = *du;
+    *du = NULL;
+
+    mUpdateQueue->AddItem( act.Encode() );
+}
+
+void BenchShip::QueueDestinyEvent( PyTuple** multiEvent )
+{
+    ++mEvents;
+    if( !mClient )
+        return;
+
+    mEventQueue->AddItem( *multiEvent );
+    *multiEvent = NULL;
+}
@@ -0,0 +1,414 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchEntity.h"
+#include "bench/Benchmarks.h"
+
+/// Half-size of the benchmark system; 40 AU.
+static const double BUBBLE_BENCH_SYSTEM_EXTENT = 40.0 * 149597870700.0;
+/// Number of celestials (gates, stations, belts ...) bubbles gather around.
+static const uint32 BUBBLE_BENCH_SITE_COUNT = 150;
+/// Half-size of the area around a celestial where ships show up; 15000 km.
+static const double BUBBLE_BENCH_SITE_EXTENT = 15000000.0;
+/// Number of safe spots ships warp to, besides the celestials.
+static const uint32 BUBBLE_SOAK_SAFESPOT_COUNT = 50;
+/// Half-size of the area around a warp destination where ships land; 20 km.
+static const double BUBBLE_SOAK_LANDING_EXTENT = 20000.0;
+/// Distance at which a warping ship starts slowing down and updating its bubble; 100000 km.
+static const double BUBBLE_SOAK_SLOWDOWN_DISTANCE = 100000000.0;
+
+/**
+ * Exposes the bubble index of BubbleManager, so bubbles can
+ * be placed at points without any entities in them.
+ */
+class BenchBubbleManager
+: public BubbleManager
+{
+public:
+    SystemBubble* Find( const GPoint& pos ) const { return _FindBubble( pos ); }
+
+    /** The linear search BubbleManager used before the grid. */
+    SystemBubble* FindLinear( const GPoint& pos ) const
+    {
+        std::vector<SystemBubble*>::const_iterator cur, end;
+        cur = m_bubbles.begin();
+        end = m_bubbles.end();
+        for(; cur != end; ++cur )
+        {
+            if( (*cur)->InBubble( pos ) )
+                return *cur;
+        }
+
+        return NULL;
+    }
+
+    /**
+     * @brief Does what Add() does for an entity at @a pos moving along @a heading.
+     *
+     * @param[in] naive Place the bubble as before the overlap check, ahead of the entity.
+     *
+     * @return The bubble the entity ends up in.
+     */
+    SystemBubble* Place( const GPoint& pos, const GVector& heading, bool naive )
+    {
+        SystemBubble* b = _FindBubble( pos );
+        if( NULL != b )
+            return b;
+
+        if( !naive )
+            return _CreateBubble( pos, heading );
+
+        GVector direction( heading );
+        direction.normalize();
+
+        b = new SystemBubble( pos + direction * ( 0.96 * GetBubbleRadius() ), GetBubbleRadius() );
+        _AddBubble( b );
+
+        return b;
+    }
+
+    /** @return Number of bubble pairs which overlap. */
+    uint32 CountOverlappingPairs() const
+    {
+        const SystemBubble* nearest;
+
+        uint32 count = 0;
+        std::vector<SystemBubble*>::const_iterator cur, end;
+        cur = m_bubbles.begin();
+        end = m_bubbles.end();
+        for(; cur != end; ++cur )
+            // the bubble itself is counted as well
+            count += _CountOverlaps( (*cur)->m_center, &nearest ) - 1;
+
+        return count / 2;
+    }
+
+    /**
+     * @brief Does the periodic work of Process() at given simulated time.
+     *
+     * @param[in] legacy Only re-add wandering entities, as before bubbles were reclaimed.
+     */
+    void ProcessAt( int32 now, bool legacy )
+    {
+        if( !legacy )
+        {
+            BubbleManager::ProcessAt( now );
+            return;
+        }
+
+        std::vector<SystemEntity*> wanderers;
+
+        std::vector<SystemBubble*>::const_iterator cur, end;
+        cur = m_bubbles.begin();
+        end = m_bubbles.end();
+        for(; cur != end; ++cur )
+            (*cur)->ProcessWander( wanderers );
+
+        std::vector<SystemEntity*>::const_iterator curw, endw;
+        curw = wanderers.begin();
+        endw = wanderers.end();
+        for(; curw != endw; ++curw )
+            Add( *curw, true );
+    }
+
+    const SystemBubble* GetBubble( size_t index ) const { return m_bubbles[ index ]; }
+    size_t GetCellCount() const { return m_cells.size(); }
+};
+
+/// Places the celestials bubbles to gather around.
+static void BubbleBenchmarkSites( std::vector<GPoint>& into )
+{
+    BenchRandom rnd( 1 );
+
+    into.clear();
+    for( uint32 i = 0; i < BUBBLE_BENCH_SITE_COUNT; ++i )
+        into.push_back( rnd.NextPoint( BUBBLE_BENCH_SYSTEM_EXTENT ) );
+}
+
+/// Spreads bubbles around given celestials until there are @a count of them; returns time taken in us.
+static double BubbleBenchmarkFill( BenchBubbleManager& mgr, const std::vector<GPoint>& sites, uint32 count, bool naive )
+{
+    BenchRandom rnd( 2 );
+
+    const uint64 start = Win32TimeNow();
+    // ships mostly show up around celestials
+    for( uint32 attempt = 0; mgr.GetBubbleCount() < count && attempt < count * 100; ++attempt )
+    {
+        const GPoint& site = sites[ (size_t)rnd.Next( 0, BUBBLE_BENCH_SITE_COUNT ) ];
+
+        const GPoint pos( site + rnd.NextPoint( BUBBLE_BENCH_SITE_EXTENT ) );
+        const GVector heading( rnd.NextPoint( 1.0 ) );
+
+        mgr.Place( pos, heading, naive );
+    }
+
+    return BenchElapsed( start );
+}
+
+void BubbleBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 count = 5000;
+    if( 2 <= cmd.argCount() )
+        count = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+    uint32 lookups = 200000;
+    if( 3 <= cmd.argCount() )
+        lookups = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+    if( 0 == count || 0 == lookups )
+    {
+        sLog.Error( cmdName, "Usage: %s [bubbles] [lookups]", cmdName );
+        return;
+    }
+
+    std::vector<GPoint> sites;
+    BubbleBenchmarkSites( sites );
+
+    BenchBubbleManager naive;
+    BubbleBenchmarkFill( naive, sites, count, true );
+
+    BenchBubbleManager mgr;
+    const double fill = BubbleBenchmarkFill( mgr, sites, count, false );
+
+    sLog.Log( cmdName, "%lu bubbles in %lu grid cells, created in %.0f us (%.2f us per bubble)",
+              mgr.GetBubbleCount(), mgr.GetCellCount(), fill, fill / mgr.GetBubbleCount() );
+    sLog.Log( cmdName, "overlapping bubble pairs: %u with overlap check, %u when placed ahead of the ship",
+              mgr.CountOverlappingPairs(), naive.CountOverlappingPairs() );
+
+    // half of the lookups next to bubbles, where about half of them hit, half anywhere
+    BenchRandom rnd( 3 );
+
+    std::vector<GPoint> points;
+    points.reserve( lookups );
+    for( uint32 i = 0; i < lookups; ++i )
+    {
+        if( 0 == ( i & 1 ) )
+            points.push_back( rnd.NextPoint( BUBBLE_BENCH_SYSTEM_EXTENT ) );
+        else
+            points.push_back( mgr.GetBubble( (size_t)rnd.Next( 0, (double)mgr.GetBubbleCount() ) )->m_center
+                              + rnd.NextPoint( BubbleManager::GetBubbleRadius() ) );
+    }
+
+    uint32 hits = 0;
+    uint64 start = Win32TimeNow();
+    for( uint32 i = 0; i < lookups; ++i )
+    {
+        if( NULL != mgr.Find( points[ i ] ) )
+            ++hits;
+    }
+    const double grid = BenchElapsed( start );
+
+    uint32 linearHits = 0;
+    start = Win32TimeNow();
+    for( uint32 i = 0; i < lookups; ++i )
+    {
+        if( NULL != mgr.FindLinear( points[ i ] ) )
+            ++linearHits;
+    }
+    const double linear = BenchElapsed( start );
+
+    uint32 mismatches = 0;
+    for( uint32 i = 0; i < lookups; ++i )
+    {
+        if( mgr.FindLinear( points[ i ] ) != mgr.Find( points[ i ] ) )
+            ++mismatches;
+    }
+
+    sLog.Log( cmdName, "%u lookups, %u hits: grid %.1f ns, linear %.1f ns per lookup",
+              lookups, hits, grid * 1000.0 / lookups, linear * 1000.0 / lookups );
+    if( 0 < mismatches || linearHits != hits )
+        sLog.Error( cmdName, "%u lookups found a different bubble than the linear search.", mismatches );
+}
+
+/// A ship of the soak test.
+struct BubbleSoakShip
+{
+    BenchEntity* entity;
+
+    /// Where the ship is warping to.
+    GPoint destination;
+    /// Seconds left in warp before the ship starts slowing down; negative if not warping.
+    int32 cruise;
+    /// Steps of the slowdown taken so far.
+    uint32 slowdown;
+    /// Seconds left until the ship warps off again.
+    int32 idle;
+};
+
+/// Results of a single soak run.
+struct BubbleSoakResult
+{
+    BubbleManager::Stats stats;
+    uint64 updates;
+    double elapsed;
+};
+
+/**
+ * @brief Warps ships between points for given time, ticking once a simulated second.
+ *
+ * Warps mimic DestinyManager: the ship stays in its bubble while it
+ * accelerates and cruises, then updates its bubble every second while
+ * it slows down, its distance to the destination shrinking by a factor
+ * of e each second.
+ */
+static void BubbleSoakRun( const char* cmdName, const std::vector<GPoint>& points, uint32 shipCount, uint32 minutes, bool legacy, BubbleSoakResult& into )
+{
+    BenchRandom rnd( 4 );
+    BenchBubbleManager mgr;
+
+    std::vector<BubbleSoakShip> ships( shipCount );
+    for( uint32 i = 0; i < shipCount; ++i )
+    {
+        BubbleSoakShip& ship = ships[ i ];
+
+        const GPoint& start = points[ (size_t)rnd.Next( 0, (double)points.size() ) ];
+        ship.entity = new BenchEntity( 140000000 + i, start + rnd.NextPoint( BUBBLE_SOAK_LANDING_EXTENT ) );
+        ship.cruise = -1;
+        ship.slowdown = 0;
+        ship.idle = (int32)rnd.Next( 0, 300 );
+
+        mgr.Add( ship.entity, true );
+    }
+
+    const uint64 start = Win32TimeNow();
+
+    const int32 wanderInterval = (int32)BubbleManager::GetWanderInterval();
+    for( int32 now = 1000; now <= (int32)minutes * 60 * 1000; now += 1000 )
+    {
+        for( uint32 i = 0; i < shipCount; ++i )
+        {
+            BubbleSoakShip& ship = ships[ i ];
+            BenchEntity* ent = ship.entity;
+
+            if( 0 <= ship.cruise )
+            {
+                if( 0 < ship.cruise-- )
+                    continue;
+
+                // slowing down; the last step lands the ship
+                const double left = BUBBLE_SOAK_SLOWDOWN_DISTANCE * exp( -(double)ship.slowdown++ );
+                if( left < 1000.0 )
+                {
+                    ent->SetPosition( ship.destination );
+                    ent->SetVelocity( GVector( 0, 0, 0 ) );
+
+                    ship.cruise = -1;
+                    ship.idle = (int32)rnd.Next( 30, 300 );
+                }
+                else
+                {
+                    GVector heading( ent->GetPosition(), ship.destination );
+                    heading.normalize();
+
+                    ent->SetPosition( ship.destination - heading * left );
+                }
+
+                mgr.UpdateBubble( ent, true );
+            }
+            else if( 0 < ship.idle-- )
+            {
+                // drift around the landing spot
+                if( 0 == ( now / 1000 + i ) % 10 )
+                    ent->SetVelocity( GVector( rnd.NextPoint( 200.0 ) ) );
+
+                ent->SetPosition( ent->GetPosition() + ent->GetVelocity() );
+                mgr.UpdateBubble( ent, true );
+            }
+            else
+            {
+                // align and warp off; 5 - 60 s of acceleration and cruise
+                const GPoint& to = points[ (size_t)rnd.Next( 0, (double)points.size() ) ];
+
+                ship.destination = to + rnd.NextPoint( BUBBLE_SOAK_LANDING_EXTENT );
+                ship.cruise = (int32)rnd.Next( 5, 60 );
+                ship.slowdown = 0;
+            }
+        }
+
+        if( 0 == now % wanderInterval )
+            mgr.ProcessAt( now, legacy );
+
+        if( 0 == now % ( 10 * 60 * 1000 ) )
+        {
+            BubbleManager::Stats stats;
+            mgr.GetStats( stats );
+
+            sLog.Log( cmdName, "%s %3d min: %5u live (%5u empty), peak %5u, created " I64u ", reclaimed " I64u ", merged " I64u,
+                      legacy ? "legacy " : "reclaim", now / 60000, stats.live, stats.empty, stats.peak,
+                      stats.created, stats.reclaimed, stats.merged );
+        }
+    }
+
+    into.elapsed = BenchElapsed( start );
+    mgr.GetStats( into.stats );
+
+    into.updates = 0;
+    for( uint32 i = 0; i < shipCount; ++i )
+    {
+        BenchEntity* ent = ships[ i ].entity;
+        into.updates += ent->GetUpdateCount();
+
+        mgr.Remove( ent, false );
+        delete ent;
+    }
+}
+
+void BubbleSoakBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 ships = 500;
+    if( 2 <= cmd.argCount() )
+        ships = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+    uint32 minutes = 120;
+    if( 3 <= cmd.argCount() )
+        minutes = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+    if( 0 == ships || 0 == minutes )
+    {
+        sLog.Error( cmdName, "Usage: %s [ships] [minutes]", cmdName );
+        return;
+    }
+
+    // ships land at celestials and at safe spots
+    std::vector<GPoint> points;
+    BubbleBenchmarkSites( points );
+
+    BenchRandom rnd( 5 );
+    for( uint32 i = 0; i < BUBBLE_SOAK_SAFESPOT_COUNT; ++i )
+        points.push_back( rnd.NextPoint( BUBBLE_BENCH_SYSTEM_EXTENT ) );
+
+    sLog.Log( cmdName, "%u ships warping between %lu points for %u minutes", ships, points.size(), minutes );
+
+    BubbleSoakResult legacy, reclaim;
+    BubbleSoakRun( cmdName, points, ships, minutes, true, legacy );
+    BubbleSoakRun( cmdName, points, ships, minutes, false, reclaim );
+
+    sLog.Log( cmdName, "legacy:  %5u bubbles left, " I64u " destiny updates, %.0f ms",
+              legacy.stats.live, legacy.updates, legacy.elapsed / 1000.0 );
+    sLog.Log( cmdName, "reclaim: %5u bubbles left, " I64u " destiny updates, %.0f ms",
+              reclaim.stats.live, reclaim.updates, reclaim.elapsed / 1000.0 );
+}
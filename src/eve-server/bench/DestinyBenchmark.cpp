@@ -0,0 +1,195 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchEntity.h"
+#include "bench/Benchmarks.h"
+
+/// Ships spread around a grid of this half-size; 100 km.
+static const double DESTINY_BENCH_EXTENT = 100000.0;
+
+/// Movement a ball of the benchmark keeps up.
+enum DestinyBenchMode
+{
+    DESTINY_BENCH_GOTO,
+    DESTINY_BENCH_STOP,
+    DESTINY_BENCH_ORBIT
+};
+
+/**
+ * A DestinyManager of a ship without a system.
+ */
+class BenchDestinyManager
+: public DestinyManager
+{
+public:
+    BenchDestinyManager( SystemEntity* self, DestinyBenchMode mode, BenchRandom& rnd )
+    : DestinyManager( self, NULL ),
+      mMode( mode )
+    {
+        // a frigate
+        m_radius = 40.0;
+        m_mass = 1067000.0;
+        m_maxShipVelocity = 365.0;
+        m_shipAgility = 3.2;
+
+        m_position = rnd.NextPoint( DESTINY_BENCH_EXTENT );
+        m_velocity = GVector( rnd.NextPoint( 300.0 ) );
+
+        switch( mMode )
+        {
+            case DESTINY_BENCH_GOTO:
+            {
+                GPoint direction( rnd.NextPoint( 1.0 ) );
+                direction.normalize();
+
+                GotoDirection( direction, false );
+            } break;
+
+            case DESTINY_BENCH_STOP:
+                Stop( false );
+                break;
+
+            case DESTINY_BENCH_ORBIT:
+                // _Orbit() needs a system to find its target in; only its last step is taken
+                SetSpeedFraction( 1.0, false );
+                break;
+        }
+    }
+
+    void Tic()
+    {
+        if( DESTINY_BENCH_ORBIT != mMode )
+        {
+            ProcessTic();
+            return;
+        }
+
+        // accelerate along a circle around the origin, as _Orbit() ends up doing
+        GVector tangent( -m_position.y, m_position.x, 0.0 );
+        tangent.normalize();
+
+        _MoveAccel( tangent * m_accelerationFactor );
+    }
+
+protected:
+    const DestinyBenchMode mMode;
+};
+
+/// A set of balls and the entities they belong to, iterated like SystemManager does.
+class DestinyBenchWorld
+{
+public:
+    DestinyBenchWorld( uint32 count )
+    {
+        BenchRandom rnd( 6 );
+
+        for( uint32 i = 0; i < count; ++i )
+        {
+            // interleaved allocations, as entities are created in a running server
+            BenchEntity* ent = new BenchEntity( 140000000 + i, GPoint( 0, 0, 0 ) );
+            const DestinyBenchMode mode = (DestinyBenchMode)( i % 5 < 2 ? DESTINY_BENCH_GOTO : ( i % 5 < 3 ? DESTINY_BENCH_STOP : DESTINY_BENCH_ORBIT ) );
+
+            mEntities.push_back( ent );
+            mBalls[ ent->GetID() ] = new BenchDestinyManager( ent, mode, rnd );
+        }
+    }
+
+    ~DestinyBenchWorld()
+    {
+        std::map<uint32, BenchDestinyManager*>::iterator cur, end;
+        cur = mBalls.begin();
+        end = mBalls.end();
+        for(; cur != end; ++cur )
+            delete cur->second;
+
+        for( size_t i = 0; i < mEntities.size(); ++i )
+            delete mEntities[ i ];
+    }
+
+    /// Runs given number of tics; returns time taken in us.
+    double Run( uint32 tics )
+    {
+        const uint64 start = Win32TimeNow();
+
+        for( uint32 t = 0; t < tics; ++t )
+        {
+            std::map<uint32, BenchDestinyManager*>::const_iterator cur, end;
+            cur = mBalls.begin();
+            end = mBalls.end();
+            for(; cur != end; ++cur )
+                cur->second->Tic();
+        }
+
+        return BenchElapsed( start );
+    }
+
+protected:
+    std::vector<BenchEntity*> mEntities;
+    std::map<uint32, BenchDestinyManager*> mBalls;
+};
+
+static void DestinyBenchmarkRun( const char* cmdName, uint32 count, uint32 tics )
+{
+    DestinyBenchWorld world( count );
+
+    // one warm-up tic
+    world.Run( 1 );
+
+    const double time = world.Run( tics );
+
+    const uint64 ballTics = (uint64)count * tics;
+    sLog.Log( cmdName, "%5u balls: %.1f ns per ball and tic", count, time * 1000.0 / ballTics );
+}
+
+void DestinyBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 tics = 200;
+    if( 2 <= cmd.argCount() )
+        tics = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+    if( 0 == tics )
+    {
+        sLog.Error( cmdName, "Usage: %s [tics] [balls ...]", cmdName );
+        return;
+    }
+
+    if( 3 > cmd.argCount() )
+    {
+        DestinyBenchmarkRun( cmdName, 100, tics );
+        DestinyBenchmarkRun( cmdName, 1000, tics );
+        DestinyBenchmarkRun( cmdName, 5000, tics );
+        return;
+    }
+
+    for( uint32 i = 2; i < cmd.argCount(); ++i )
+    {
+        const uint32 count = strtoul( cmd.arg( i ).c_str(), NULL, 0 );
+        if( 0 < count )
+            DestinyBenchmarkRun( cmdName, count, tics );
+    }
+}
@@ -0,0 +1,843 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/Benchmarks.h"
+
+/// Station the hangar is in.
+static const uint32 INVENTORY_BENCH_STATION_ID = 60003760;
+/// Character whose hangar is loaded.
+static const uint32 INVENTORY_BENCH_CHARACTER_ID = 140000001;
+/// Corporation of the character.
+static const uint32 INVENTORY_BENCH_CORPORATION_ID = 1000044;
+/// Solar system of the station.
+static const uint32 INVENTORY_BENCH_SYSTEM_ID = 30000142;
+/// Every this many items is a container ...
+static const uint32 INVENTORY_BENCH_CONTAINER_EVERY = 100;
+/// ... holding this many items.
+static const uint32 INVENTORY_BENCH_CONTAINER_SIZE = 10;
+
+/// Type of all the items; Tritanium, a plain InventoryItem.
+static const uint32 INVENTORY_BENCH_TYPE_ID = 34;
+/// Saved attribute the soak changes along with the quantity.
+static const uint32 INVENTORY_BENCH_SOAK_ATTRIBUTE = 100;
+/// Every this many rounds of the soak, the station hangar is listed.
+static const uint32 INVENTORY_BENCH_SOAK_LIST_EVERY = 500;
+
+/// First typeID of the types the item load scenario adds.
+static const uint32 INVENTORY_BENCH_FIRST_TYPE_ID = 100000;
+/// Kinds of types the item load scenario adds in turn, each with about as many attributes as the real ones.
+static const struct
+{
+    const char* name;
+    uint32 categoryID;
+    uint32 groupID;
+    uint32 attributeCount;
+} INVENTORY_BENCH_KINDS[] =
+{
+    { "ammo",     EVEDB::invCategories::Charge,   EVEDB::invGroups::Ammo,     40 },
+    { "asteroid", EVEDB::invCategories::Asteroid, EVEDB::invGroups::Veldspar, 12 },
+    { "mineral",  EVEDB::invCategories::Material, EVEDB::invGroups::Mineral,  4 }
+};
+/// Number of INVENTORY_BENCH_KINDS; the items are of the first type of each.
+static const uint32 INVENTORY_BENCH_KIND_COUNT = sizeof( INVENTORY_BENCH_KINDS ) / sizeof( INVENTORY_BENCH_KINDS[ 0 ] );
+
+/// Opens an in-memory database with the entity tables and one item type.
+static bool InventoryBenchmarkOpenDatabase( const char* cmdName )
+{
+    static const char* const statements[] =
+    {
+        "CREATE TABLE entity ( itemID INTEGER PRIMARY KEY, itemName TEXT, typeID INTEGER, ownerID INTEGER, locationID INTEGER,"
+        " flag INTEGER, contraband INTEGER, singleton INTEGER, quantity INTEGER, x REAL, y REAL, z REAL, customInfo TEXT )",
+        "CREATE INDEX entityLocation ON entity ( locationID )",
+        "CREATE TABLE entity_attributes ( itemID INTEGER, attributeID INTEGER, valueInt INTEGER, valueFloat REAL,"
+        " PRIMARY KEY ( itemID, attributeID ) )",
+        "CREATE TABLE invCategories ( categoryID INTEGER PRIMARY KEY, categoryName TEXT, description TEXT, published INTEGER )",
+        "CREATE TABLE invGroups ( groupID INTEGER PRIMARY KEY, categoryID INTEGER, groupName TEXT, description TEXT,"
+        " useBasePrice INTEGER, allowManufacture INTEGER, allowRecycler INTEGER, anchored INTEGER, anchorable INTEGER,"
+        " fittableNonSingleton INTEGER, published INTEGER )",
+        "CREATE TABLE invTypes ( typeID INTEGER PRIMARY KEY, groupID INTEGER, typeName TEXT, description TEXT, radius REAL,"
+        " mass REAL, volume REAL, capacity REAL, portionSize INTEGER, raceID INTEGER, basePrice REAL, published INTEGER,"
+        " marketGroupID INTEGER, chanceOfDuplicating REAL )",
+        "CREATE TABLE dgmTypeAttributes ( typeID INTEGER, attributeID INTEGER, valueInt INTEGER, valueFloat REAL,"
+        " PRIMARY KEY ( typeID, attributeID ) )",
+        "INSERT INTO invCategories VALUES ( 4, 'Material', '', 1 )",
+        "INSERT INTO invGroups VALUES ( 18, 4, 'Mineral', '', 1, 0, 0, 0, 0, 0, 1 )",
+        "INSERT INTO invTypes VALUES ( 34, 18, 'Tritanium', '', 1, 0, 0.01, 0, 1, NULL, 2, 1, NULL, 0 )",
+        "INSERT INTO dgmTypeAttributes VALUES ( 34, 4, NULL, 0 )"
+    };
+
+    return BenchOpenDatabase( cmdName, statements, sizeof( statements ) / sizeof( const char* ) );
+}
+
+/// Adds INVENTORY_BENCH_STATION_ID, so it can be loaded along with its hangar.
+static bool InventoryBenchmarkAddStation()
+{
+    static const char* const statements[] =
+    {
+        "CREATE TABLE staStationTypes ( stationTypeID INTEGER PRIMARY KEY, dockEntryX REAL, dockEntryY REAL, dockEntryZ REAL,"
+        " dockOrientationX REAL, dockOrientationY REAL, dockOrientationZ REAL, operationID INTEGER, officeSlots INTEGER,"
+        " reprocessingEfficiency REAL, conquerable INTEGER )",
+        "CREATE TABLE staStations ( stationID INTEGER PRIMARY KEY, stationName TEXT, stationTypeID INTEGER, corporationID INTEGER,"
+        " solarSystemID INTEGER, x REAL, y REAL, z REAL, security REAL, dockingCostPerVolume REAL, maxShipVolumeDockable REAL,"
+        " officeRentalCost INTEGER, operationID INTEGER, reprocessingEfficiency REAL, reprocessingStationsTake REAL,"
+        " reprocessingHangarFlag INTEGER )",
+        "CREATE TABLE mapDenormalize ( itemID INTEGER PRIMARY KEY, itemName TEXT, typeID INTEGER, solarSystemID INTEGER,"
+        " x REAL, y REAL, z REAL, security REAL, radius REAL, celestialIndex INTEGER, orbitIndex INTEGER )",
+        "INSERT INTO invCategories VALUES ( 3, 'Station', '', 0 )",
+        "INSERT INTO invGroups VALUES ( 15, 3, 'Station', '', 1, 0, 0, 0, 0, 0, 0 )",
+        "INSERT INTO invTypes VALUES ( 1529, 15, 'Caldari Administrative Station', '', 20000, 0, 0, 0, 1, 1, 0, 0, NULL, 0 )",
+        "INSERT INTO staStationTypes VALUES ( 1529, 0, 0, 0, 0, 0, 1, 22, 4, 0.5, 0 )"
+    };
+
+    DBerror err;
+    for( size_t i = 0; i < sizeof( statements ) / sizeof( const char* ); ++i )
+    {
+        if( !sDatabase.RunQuery( err, "%s", statements[ i ] ) )
+            return false;
+    }
+
+    return sDatabase.RunQuery( err,
+        "INSERT INTO staStations VALUES ( %u, 'Bench Station', 1529, %u, %u, 0, 0, 0, 0.5, 0, 50000000, 10000, 22, 0.5, 0.05, 4 )",
+        INVENTORY_BENCH_STATION_ID, INVENTORY_BENCH_CORPORATION_ID, INVENTORY_BENCH_SYSTEM_ID )
+        && sDatabase.RunQuery( err,
+        "INSERT INTO mapDenormalize VALUES ( %u, 'Bench Station', 1529, %u, 0, 0, 0, 0.5, 20000, 0, 0 )",
+        INVENTORY_BENCH_STATION_ID, INVENTORY_BENCH_SYSTEM_ID );
+}
+
+/// Adds an item with @a attributeCount saved attributes.
+static bool InventoryBenchmarkAddItem( uint32 itemID, uint32 ownerID, uint32 locationID, bool singleton, uint32 attributeCount,
+                                       uint32 typeID = INVENTORY_BENCH_TYPE_ID )
+{
+    DBerror err;
+    if( !sDatabase.RunQuery( err,
+        "INSERT INTO entity VALUES ( %u, '', %u, %u, %u, %u, 0, %u, 1, 0, 0, 0, '' )",
+        itemID, typeID, ownerID, locationID, uint32( flagHangar ), ( singleton ? 1 : 0 ) ) )
+        return false;
+
+    for( uint32 i = 0; i < attributeCount; ++i )
+    {
+        if( !sDatabase.RunQuery( err,
+            "INSERT INTO entity_attributes VALUES ( %u, %u, NULL, %f )",
+            itemID, 100 + i, 1.5 * i ) )
+            return false;
+    }
+
+    return true;
+}
+
+/// Adds @a count items of @a ownerID to the station; every INVENTORY_BENCH_CONTAINER_EVERY-th is a container with some more.
+static bool InventoryBenchmarkFillHangar( uint32& itemID, uint32 ownerID, uint32 count, uint32 attributeCount )
+{
+    for( uint32 i = 0; i < count; ++i )
+    {
+        const uint32 containerID = itemID++;
+        const bool container = ( 0 == ( i + 1 ) % INVENTORY_BENCH_CONTAINER_EVERY );
+
+        if( !InventoryBenchmarkAddItem( containerID, ownerID, INVENTORY_BENCH_STATION_ID, container, attributeCount ) )
+            return false;
+
+        for( uint32 j = 0; container && j < INVENTORY_BENCH_CONTAINER_SIZE; ++j )
+        {
+            if( !InventoryBenchmarkAddItem( itemID++, ownerID, containerID, false, attributeCount ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/// Fills the station: the hangar of the character and those of a hundred others docked there.
+static bool InventoryBenchmarkFillHangars( uint32 itemCount, uint32 otherCount, uint32 attributeCount )
+{
+    uint32 itemID = 200000000;
+
+    DBerror err;
+    if( !sDatabase.RunQuery( err, "BEGIN" ) )
+        return false;
+
+    if( !InventoryBenchmarkFillHangar( itemID, INVENTORY_BENCH_CHARACTER_ID, itemCount, attributeCount ) )
+        return false;
+
+    for( uint32 i = 0; i < 100; ++i )
+    {
+        const uint32 count = otherCount / 100 + ( i < otherCount % 100 ? 1 : 0 );
+        if( !InventoryBenchmarkFillHangar( itemID, INVENTORY_BENCH_CHARACTER_ID + 1 + i, count, attributeCount ) )
+            return false;
+    }
+
+    return sDatabase.RunQuery( err, "COMMIT" );
+}
+
+/// Sums the statements the profiler has seen since the last reset.
+static void InventoryBenchmarkQueries( uint64& count, uint64& rows )
+{
+    std::vector<DBProfiler::Entry> report;
+    sDatabase.profiler().GetReport( DBProfiler::SortCount, 0, report );
+
+    count = rows = 0;
+    for( size_t i = 0; i < report.size(); ++i )
+    {
+        count += report[ i ].count;
+        rows += report[ i ].rows;
+    }
+}
+
+/// Loads the contents of the station the way Inventory::LoadContents() did before prefetching: one item at a time.
+static uint32 InventoryBenchmarkLoadOneByOne( InventoryDB& db, uint32 clientLocationID )
+{
+    std::vector<uint32> parents( 1, INVENTORY_BENCH_STATION_ID );
+    uint32 loaded = 0;
+
+    while( !parents.empty() )
+    {
+        const uint32 parentID = parents.back();
+        parents.pop_back();
+
+        std::vector<uint32> contents;
+        db.GetItemContents( parentID, contents );
+
+        for( size_t i = 0; i < contents.size(); ++i )
+        {
+            ItemData data;
+            if( !db.GetItem( contents[ i ], data ) )
+                continue;
+
+            // the owner check of Inventory::LoadContents()
+            if( data.ownerID != INVENTORY_BENCH_CHARACTER_ID && data.ownerID != INVENTORY_BENCH_CORPORATION_ID
+                && data.locationID != clientLocationID )
+                continue;
+
+            std::map<uint32, std::map<uint32, EvilNumber> > attributes;
+            db.GetItemAttributes( std::vector<uint32>( 1, contents[ i ] ), attributes );
+            ++loaded;
+
+            if( data.singleton )
+                parents.push_back( contents[ i ] );
+        }
+    }
+
+    return loaded;
+}
+
+/// Loads the contents of the station level by level, as ItemFactory::BeginPrefetch() does.
+static uint32 InventoryBenchmarkLoadByLocation( InventoryDB& db, uint32 characterID, uint32 clientLocationID )
+{
+    std::vector<uint32> parents( 1, INVENTORY_BENCH_STATION_ID );
+    uint32 loaded = 0;
+
+    while( !parents.empty() )
+    {
+        std::map<uint32, ItemData> level;
+        std::map<uint32, std::map<uint32, EvilNumber> > attributes;
+        db.GetItemsByLocation( parents, level, characterID, INVENTORY_BENCH_CORPORATION_ID, clientLocationID );
+        db.GetItemAttributesByLocation( parents, attributes, characterID, INVENTORY_BENCH_CORPORATION_ID, clientLocationID );
+
+        parents.clear();
+
+        std::map<uint32, ItemData>::const_iterator cur, end;
+        cur = level.begin();
+        end = level.end();
+        for(; cur != end; cur++)
+        {
+            ++loaded;
+
+            if( cur->second.singleton )
+                parents.push_back( cur->first );
+        }
+    }
+
+    return loaded;
+}
+
+void HangarBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 itemCount = 10000;
+    if( 2 <= cmd.argCount() )
+        itemCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 otherCount = 10000;
+    if( 3 <= cmd.argCount() )
+        otherCount = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 attributeCount = 4;
+    if( 4 <= cmd.argCount() )
+        attributeCount = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    if( 0 == itemCount )
+    {
+        sLog.Error( cmdName, "Usage: %s [items] [items of others] [attributes per item]", cmdName );
+        return;
+    }
+
+    if( !InventoryBenchmarkOpenDatabase( cmdName ) )
+        return;
+
+    if( !InventoryBenchmarkFillHangars( itemCount, otherCount, attributeCount ) )
+    {
+        sLog.Error( cmdName, "Failed to fill the hangars." );
+        return;
+    }
+
+    // keep query logging out of the timings
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    InventoryDB db;
+    sDatabase.profiler().SetEnabled( true );
+
+    sLog.Log( cmdName, "%u items with %u attributes each, %u items of others in the same station, every %uth a container of %u more:",
+              itemCount, attributeCount, otherCount, INVENTORY_BENCH_CONTAINER_EVERY, INVENTORY_BENCH_CONTAINER_SIZE );
+
+    // the owner check lets everything in the client's own location through, so docked
+    // at the station the hangars of the others are loaded too, but not their containers
+    static const struct
+    {
+        const char* name;
+        /// 0 one by one, 1 by location, 2 by location and owner
+        int method;
+        uint32 clientLocationID;
+    } runs[] =
+    {
+        { "one by one, docked",   0, INVENTORY_BENCH_STATION_ID },
+        { "one by one, in space", 0, INVENTORY_BENCH_SYSTEM_ID },
+        { "by location",          1, 0 },
+        { "by owner, docked",     2, INVENTORY_BENCH_STATION_ID },
+        { "by owner, in space",   2, INVENTORY_BENCH_SYSTEM_ID }
+    };
+
+    for( size_t r = 0; r < sizeof( runs ) / sizeof( runs[ 0 ] ); ++r )
+    {
+        sDatabase.profiler().Reset();
+        const uint64 start = Win32TimeNow();
+
+        uint32 loaded;
+        if( 0 == runs[ r ].method )
+            loaded = InventoryBenchmarkLoadOneByOne( db, runs[ r ].clientLocationID );
+        else
+            loaded = InventoryBenchmarkLoadByLocation( db, ( 2 == runs[ r ].method ? INVENTORY_BENCH_CHARACTER_ID : 0 ), runs[ r ].clientLocationID );
+
+        const double elapsed = BenchElapsed( start );
+
+        uint64 queries, rows;
+        InventoryBenchmarkQueries( queries, rows );
+
+        sLog.Log( cmdName, "    %-22s %.1f ms, " I64u " queries, " I64u " rows, %u items",
+                  runs[ r ].name, elapsed / 1000.0, queries, rows, loaded );
+    }
+
+    sDatabase.profiler().SetEnabled( false );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
+
+/// What the soak expects an item to hold.
+struct InventoryBenchmarkExpected
+{
+    uint32 quantity;
+    double value;
+};
+
+/// Compares an item against what has been saved last; logs and returns false on a mismatch.
+static bool InventoryBenchmarkCheck( const char* cmdName, InventoryItemRef item, const InventoryBenchmarkExpected& expected )
+{
+    if( !item )
+    {
+        sLog.Error( cmdName, "Failed to load an item." );
+        return false;
+    }
+
+    const double value = item->GetAttribute( INVENTORY_BENCH_SOAK_ATTRIBUTE ).get_float();
+    if( item->quantity() == expected.quantity && value == expected.value )
+        return true;
+
+    sLog.Error( cmdName, "Item %u has quantity %u and value %.0f, saved were %u and %.0f.",
+                item->itemID(), item->quantity(), value, expected.quantity, expected.value );
+    return false;
+}
+
+void EvictSoakBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 itemCount = 2000;
+    if( 2 <= cmd.argCount() )
+        itemCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 rounds = 20000;
+    if( 3 <= cmd.argCount() )
+        rounds = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 cacheSize = 100;
+    if( 4 <= cmd.argCount() )
+        cacheSize = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    uint32 flushInterval = 20;
+    if( 5 <= cmd.argCount() )
+        flushInterval = strtoul( cmd.arg( 4 ).c_str(), NULL, 0 );
+
+    if( 0 == itemCount || 0 == cacheSize || 0 == flushInterval )
+    {
+        sLog.Error( cmdName, "Usage: %s [items] [rounds] [cached items] [flush interval in ms]", cmdName );
+        return;
+    }
+
+    if( !InventoryBenchmarkOpenDatabase( cmdName ) )
+        return;
+
+    if( !InventoryBenchmarkAddStation() )
+    {
+        sLog.Error( cmdName, "Failed to add the station." );
+        return;
+    }
+
+    const uint32 firstID = 200000000;
+    DBerror err;
+    sDatabase.RunQuery( err, "BEGIN" );
+    for( uint32 i = 0; i < itemCount; ++i )
+        InventoryBenchmarkAddItem( firstID + i, INVENTORY_BENCH_CHARACTER_ID, INVENTORY_BENCH_STATION_ID, false, 1 );
+    sDatabase.RunQuery( err, "COMMIT" );
+
+    // every item is read back often; keep the query logging out of it
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    _sDgmTypeAttrMgr = new dgmtypeattributemgr();
+
+    InventoryBenchmarkExpected initial;
+    initial.quantity = 1;
+    initial.value = 0.0;
+    std::vector<InventoryBenchmarkExpected> expected( itemCount, initial );
+
+    ItemFactory factory( sEntityList );
+    factory.SetCacheLimits( cacheSize, 0 );
+
+    // the station stays loaded, as its system does, and its hangar holds the items
+    StationRef station = factory.GetStation( INVENTORY_BENCH_STATION_ID );
+    if( !station )
+    {
+        sLog.Error( cmdName, "Failed to load the station." );
+
+        SafeDelete( _sDgmTypeAttrMgr );
+        if( debug )
+            log_enable( DEBUG__DEBUG );
+        return;
+    }
+
+    // writes stay queued for a while, so evictions and reloads race them
+    sDBWriteQueue.Start( flushInterval, 1000 );
+
+    BenchRandom random( 36 );
+    ItemFactory::PrefetchData prefetch;
+    bool prefetchQueued = false;
+    uint32 writes = 0, reads = 0, prefetches = 0, mismatches = 0;
+    uint32 lists = 0, incompleteLists = 0, maxResident = 0;
+    uint64 listLoads = 0, listReleased = 0;
+    double listTime = 0.0;
+
+    const uint64 start = Win32TimeNow();
+    for( uint32 n = 0; n < rounds; ++n )
+    {
+        const uint32 i = uint32( random.Next( 0, itemCount ) );
+        const double action = random.Next();
+
+        if( 0.6 > action )
+        {
+            // a change, saved through the queue
+            InventoryBenchmarkExpected& e = expected[ i ];
+
+            InventoryItemRef item = factory.GetItem( firstID + i );
+            if( !InventoryBenchmarkCheck( cmdName, item, e ) )
+                ++mismatches;
+
+            if( item )
+            {
+                ++e.quantity;
+                e.value += 1.0;
+
+                item->SetAttribute( INVENTORY_BENCH_SOAK_ATTRIBUTE, e.value, false );
+                item->SetQuantity( e.quantity, false );
+            }
+            ++writes;
+        }
+        else if( 0.97 > action )
+        {
+            // read back, from the cache or the DB
+            if( !InventoryBenchmarkCheck( cmdName, factory.GetItem( firstID + i ), expected[ i ] ) )
+                ++mismatches;
+            ++reads;
+        }
+        else if( !prefetchQueued )
+        {
+            // the system loader reads the rows now and hands them over later
+            factory.QueuePrefetch();
+            factory.LoadPrefetch( std::vector<uint32>( 1, INVENTORY_BENCH_STATION_ID ), prefetch );
+            prefetchQueued = true;
+        }
+        else
+        {
+            factory.BeginPrefetch( prefetch );
+            for( uint32 j = 0; j < 20; ++j )
+            {
+                const uint32 k = uint32( random.Next( 0, itemCount ) );
+                if( !InventoryBenchmarkCheck( cmdName, factory.GetItem( firstID + k ), expected[ k ] ) )
+                    ++mismatches;
+            }
+            factory.EndPrefetch();
+
+            prefetchQueued = false;
+            ++prefetches;
+        }
+
+        if( 0 == n % INVENTORY_BENCH_SOAK_LIST_EVERY )
+        {
+            // a player opens the hangar; whatever the cache has released is read again, and only that
+            std::vector<InventoryItemRef> items;
+            Inventory *hangar = factory.GetInventory( INVENTORY_BENCH_STATION_ID, false );
+            if( hangar != NULL )
+                listReleased += itemCount - hangar->FindByFlag( flagHangar, items );
+            items.clear();
+
+            ItemFactory::CacheStats before, after;
+            factory.GetCacheStats( before );
+
+            const uint64 listStart = Win32TimeNow();
+            hangar = factory.GetInventory( INVENTORY_BENCH_STATION_ID );
+            listTime += BenchElapsed( listStart );
+
+            factory.GetCacheStats( after );
+            listLoads += after.misses - before.misses;
+
+            if( hangar == NULL || itemCount != hangar->FindByFlag( flagHangar, items ) )
+                ++incompleteLists;
+            ++lists;
+        }
+
+        if( 0 == n % 50 )
+        {
+            factory.EvictItems();
+
+            // the hangar must not keep its items in the cache
+            ItemFactory::CacheStats stats;
+            factory.GetCacheStats( stats );
+            maxResident = std::max( maxResident, stats.resident );
+        }
+    }
+
+    if( prefetchQueued )
+        factory.CancelPrefetch();
+
+    const double elapsed = BenchElapsed( start );
+
+    DBWriteQueue::Stats queueStats;
+    sDBWriteQueue.GetStats( queueStats );
+    const uint32 pending = queueStats.depth;
+
+    sDBWriteQueue.Stop();
+
+    // and all of them once more, straight from the DB
+    factory.EvictItems( true );
+    for( uint32 i = 0; i < itemCount; ++i )
+    {
+        if( !InventoryBenchmarkCheck( cmdName, factory.GetItem( firstID + i ), expected[ i ] ) )
+            ++mismatches;
+    }
+
+    ItemFactory::CacheStats cacheStats;
+    factory.GetCacheStats( cacheStats );
+
+    sLog.Log( cmdName, "%u items, %u cached at most, rows flushed every %u ms; %u rounds in %.1f s:",
+              itemCount, cacheSize, flushInterval, rounds, elapsed / 1000000.0 );
+    sLog.Log( cmdName, "    %u writes, %u reads, %u prefetches handed over, %u hangar listings (%u incomplete)",
+              writes, reads, prefetches, lists, incompleteLists );
+    sLog.Log( cmdName, "    listings reloaded " I64u " items of " I64u " released, in %.2f ms per listing",
+              listLoads, listReleased, ( 0 < lists ? listTime / lists / 1000.0 : 0.0 ) );
+    sLog.Log( cmdName, "    " I64u " evictions, " I64u " loads, at most %u items cached after a sweep",
+              cacheStats.evictions, cacheStats.misses, maxResident );
+    sLog.Log( cmdName, "    " I64u " rows written in %u flushes, %u still pending at the end",
+              queueStats.rowsWritten, queueStats.flushes, pending );
+    sLog.Log( cmdName, "    %u items did not hold what had been saved last", mismatches );
+
+    SafeDelete( _sDgmTypeAttrMgr );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
+
+/// Adds @a typeCount types, cycling through INVENTORY_BENCH_KINDS, along with their attributes.
+static bool InventoryBenchmarkAddTypes( uint32 typeCount )
+{
+    DBerror err;
+
+    const char* const statements[] =
+    {
+        "INSERT INTO invCategories VALUES ( 8, 'Charge', '', 1 )",
+        "INSERT INTO invCategories VALUES ( 25, 'Asteroid', '', 1 )",
+        "INSERT INTO invGroups VALUES ( 83, 8, 'Projectile Ammo', '', 1, 0, 0, 0, 0, 0, 1 )",
+        "INSERT INTO invGroups VALUES ( 462, 25, 'Veldspar', '', 1, 0, 0, 0, 0, 0, 1 )"
+    };
+    for( size_t i = 0; i < sizeof( statements ) / sizeof( const char* ); ++i )
+    {
+        if( !sDatabase.RunQuery( err, "%s", statements[ i ] ) )
+            return false;
+    }
+
+    for( uint32 i = 0; i < typeCount; ++i )
+    {
+        const uint32 typeID = INVENTORY_BENCH_FIRST_TYPE_ID + i;
+        const uint32 kind = i % INVENTORY_BENCH_KIND_COUNT;
+
+        if( !sDatabase.RunQuery( err,
+            "INSERT INTO invTypes VALUES ( %u, %u, 'Bench %s %u', '', 1, 0, 0.01, 0, 1, NULL, 2, 1, NULL, 0 )",
+            typeID, INVENTORY_BENCH_KINDS[ kind ].groupID, INVENTORY_BENCH_KINDS[ kind ].name, i ) )
+            return false;
+
+        // spread out like the real attributeIDs; every other one is an integer
+        for( uint32 j = 0; j < INVENTORY_BENCH_KINDS[ kind ].attributeCount; ++j )
+        {
+            bool success;
+            if( 0 == j % 2 )
+                success = sDatabase.RunQuery( err, "INSERT INTO dgmTypeAttributes VALUES ( %u, %u, %u, NULL )", typeID, 4 + 7 * j, j );
+            else
+                success = sDatabase.RunQuery( err, "INSERT INTO dgmTypeAttributes VALUES ( %u, %u, NULL, %f )", typeID, 4 + 7 * j, 0.5 * j );
+
+            if( !success )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/// The attributes of a type as dgmtypeattributemgr kept them before they were flattened: a list of separately allocated entries.
+struct InventoryBenchmarkListSet
+{
+    std::list<DmgTypeAttribute*> attributeset;
+};
+
+/// An attribute as AttributeMap kept it when every item had its own copy of the type defaults.
+struct InventoryBenchmarkCopiedAttribute
+{
+    InventoryBenchmarkCopiedAttribute( const EvilNumber& num, bool isOverride )
+    : value( num ), overridden( isOverride ), dirty( false ) {}
+
+    EvilNumber value;
+    bool overridden;
+    bool dirty;
+};
+typedef std::map<uint32, InventoryBenchmarkCopiedAttribute> InventoryBenchmarkCopiedMap;
+
+void ItemLoadBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 itemCount = 30000;
+    if( 2 <= cmd.argCount() )
+        itemCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 typeCount = 10000;
+    if( 3 <= cmd.argCount() )
+        typeCount = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 savedCount = 2;
+    if( 4 <= cmd.argCount() )
+        savedCount = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    if( 0 == itemCount || INVENTORY_BENCH_KIND_COUNT > typeCount )
+    {
+        sLog.Error( cmdName, "Usage: %s [items] [types, at least %u] [saved attributes per item]", cmdName, INVENTORY_BENCH_KIND_COUNT );
+        return;
+    }
+
+    if( !InventoryBenchmarkOpenDatabase( cmdName ) )
+        return;
+
+    // stacks in the hangar, of the first type of each kind in turn
+    const uint32 firstID = 200000000;
+    DBerror err;
+    bool success = sDatabase.RunQuery( err, "BEGIN" ) && InventoryBenchmarkAddTypes( typeCount );
+    for( uint32 i = 0; success && i < itemCount; ++i )
+        success = InventoryBenchmarkAddItem( firstID + i, INVENTORY_BENCH_CHARACTER_ID, INVENTORY_BENCH_STATION_ID, false, savedCount,
+                                             INVENTORY_BENCH_FIRST_TYPE_ID + i % INVENTORY_BENCH_KIND_COUNT );
+    if( !success || !sDatabase.RunQuery( err, "COMMIT" ) )
+    {
+        sLog.Error( cmdName, "Failed to fill the database." );
+        return;
+    }
+
+    // keep query logging out of the timings
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    // the shared table, as the server builds it at startup
+    uint64 bytes = BenchAllocatedBytes();
+    uint64 start = Win32TimeNow();
+
+    _sDgmTypeAttrMgr = new dgmtypeattributemgr();
+
+    const double tableElapsed = BenchElapsed( start );
+    const uint64 tableBytes = BenchAllocatedBytes() - bytes;
+
+    // the same attributes in the layout it replaced
+    bytes = BenchAllocatedBytes();
+    uint64 allocations = BenchAllocations();
+    uint64 attributeCount = 0;
+
+    std::map<uint32, InventoryBenchmarkListSet*> lists;
+    for( uint32 i = 0; i < typeCount; ++i )
+    {
+        DgmTypeAttributeSet set;
+        sDgmTypeAttrMgr.GetDmgTypeAttributeSet( INVENTORY_BENCH_FIRST_TYPE_ID + i, set );
+
+        InventoryBenchmarkListSet* list = new InventoryBenchmarkListSet;
+        for( DgmTypeAttributeSet::AttrSetItr itr = set.begin(); itr != set.end(); itr++ )
+            list->attributeset.push_back( new DmgTypeAttribute( *itr ) );
+
+        lists.insert( std::make_pair( INVENTORY_BENCH_FIRST_TYPE_ID + i, list ) );
+        attributeCount += set.size();
+    }
+
+    const uint64 listBytes = BenchAllocatedBytes() - bytes;
+    const uint64 listAllocations = BenchAllocations() - allocations;
+
+    std::map<uint32, InventoryBenchmarkListSet*>::iterator cur, end;
+    cur = lists.begin();
+    end = lists.end();
+    for(; cur != end; cur++)
+    {
+        std::list<DmgTypeAttribute*>::iterator itr = cur->second->attributeset.begin();
+        for(; itr != cur->second->attributeset.end(); itr++)
+            SafeDelete( *itr );
+
+        SafeDelete( cur->second );
+    }
+    lists.clear();
+
+    sLog.Log( cmdName, "%u types with " I64u " attributes; %u stacks of %u types in a hangar, %u saved attributes each:",
+              typeCount, attributeCount, itemCount, INVENTORY_BENCH_KIND_COUNT, savedCount );
+    sLog.Log( cmdName, "    type table built in %.1f ms, " I64u " bytes; as a list per type " I64u " bytes in " I64u " blocks",
+              tableElapsed / 1000.0, tableBytes, listBytes, listAllocations );
+
+    {
+        ItemFactory factory( sEntityList );
+
+        // the types are shared by all the items; keep loading them out of it
+        for( uint32 i = 0; i < INVENTORY_BENCH_KIND_COUNT; ++i )
+            factory.GetType( INVENTORY_BENCH_FIRST_TYPE_ID + i );
+
+        std::vector<InventoryItemRef> items;
+        items.reserve( itemCount );
+
+        bytes = BenchAllocatedBytes();
+        start = Win32TimeNow();
+        for( uint32 i = 0; i < itemCount; ++i )
+        {
+            InventoryItemRef item = factory.GetItem( firstID + i );
+            if( item )
+                items.push_back( item );
+        }
+        const double loadElapsed = BenchElapsed( start );
+        const uint64 itemBytes = BenchAllocatedBytes() - bytes;
+
+        sLog.Log( cmdName, "    %lu items loaded in %.1f ms, %.0f items/s, %.0f bytes per item",
+                  items.size(), loadElapsed / 1000.0, items.size() / ( loadElapsed / 1000000.0 ), double( itemBytes ) / items.size() );
+
+        // what each item holds of its attributes, against a copy of all the type defaults as before
+        std::vector<uint32> itemIDs;
+        for( size_t i = 0; i < items.size(); ++i )
+            itemIDs.push_back( items[ i ]->itemID() );
+
+        std::map<uint32, std::map<uint32, EvilNumber> > saved;
+        factory.db().GetItemAttributes( itemIDs, saved );
+
+        std::vector<AttributeMap::OverrideVector> overrides( items.size() );
+        std::vector<InventoryBenchmarkCopiedMap> copies( items.size() );
+
+        for( uint32 k = 0; k < INVENTORY_BENCH_KIND_COUNT; ++k )
+        {
+            const uint32 typeID = INVENTORY_BENCH_FIRST_TYPE_ID + k;
+
+            DgmTypeAttributeSet defaults;
+            sDgmTypeAttrMgr.GetDmgTypeAttributeSet( typeID, defaults );
+
+            // as AttributeMap::Load() does now
+            uint32 count = 0;
+            bytes = BenchAllocatedBytes();
+            for( size_t i = 0; i < items.size(); ++i )
+            {
+                if( items[ i ]->typeID() != typeID )
+                    continue;
+
+                const std::map<uint32, EvilNumber>& rows = saved[ items[ i ]->itemID() ];
+                overrides[ i ].reserve( rows.size() );
+
+                std::map<uint32, EvilNumber>::const_iterator row = rows.begin();
+                for(; row != rows.end(); row++)
+                    overrides[ i ].push_back( AttributeMap::Override( row->first, row->second, false ) );
+                ++count;
+            }
+            const uint64 overrideBytes = BenchAllocatedBytes() - bytes;
+
+            // as it did when the defaults were copied
+            bytes = BenchAllocatedBytes();
+            for( size_t i = 0; i < items.size(); ++i )
+            {
+                if( items[ i ]->typeID() != typeID )
+                    continue;
+
+                InventoryBenchmarkCopiedMap& copy = copies[ i ];
+                for( DgmTypeAttributeSet::AttrSetItr itr = defaults.begin(); itr != defaults.end(); itr++ )
+                    copy.insert( copy.end(), std::make_pair( (uint32)itr->attributeID, InventoryBenchmarkCopiedAttribute( itr->number, false ) ) );
+
+                const std::map<uint32, EvilNumber>& rows = saved[ items[ i ]->itemID() ];
+                std::map<uint32, EvilNumber>::const_iterator row = rows.begin();
+                for(; row != rows.end(); row++)
+                {
+                    InventoryBenchmarkCopiedMap::iterator res = copy.find( row->first );
+                    if( res == copy.end() )
+                        copy.insert( std::make_pair( row->first, InventoryBenchmarkCopiedAttribute( row->second, true ) ) );
+                    else
+                        res->second = InventoryBenchmarkCopiedAttribute( row->second, true );
+                }
+            }
+            const uint64 copyBytes = BenchAllocatedBytes() - bytes;
+
+            const double perItem = double( itemBytes ) / items.size();
+            const double overridePerItem = double( overrideBytes ) / count;
+            const double copyPerItem = double( copyBytes ) / count;
+            sLog.Log( cmdName, "    %-8s (%lu defaults): overrides %.0f bytes per item; copied defaults %.0f, so about %.0f bytes per item before",
+                      INVENTORY_BENCH_KINDS[ k ].name, defaults.size(), overridePerItem, copyPerItem, perItem - overridePerItem + copyPerItem );
+        }
+    }
+
+    SafeDelete( _sDgmTypeAttrMgr );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
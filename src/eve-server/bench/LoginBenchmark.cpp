@@ -0,0 +1,456 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/Benchmarks.h"
+
+/// Directory the "build" step writes the pack and the cache files into; in the working directory.
+static const char* const LOGIN_BENCH_CACHE_DIR = "login-bench";
+/// Port the server side listens on, on the loopback.
+static const uint16 LOGIN_BENCH_PORT = 26099;
+/// Marshaled size of a row of the objects, roughly; for sizing them.
+static const uint32 LOGIN_BENCH_ROW_SIZE = 48;
+/// Give up once the clients have received nothing for this long (ms).
+static const uint32 LOGIN_BENCH_STALL_TIMEOUT = 10000;
+/// How often (in ms) the clients sample the RSS.
+static const uint32 LOGIN_BENCH_RSS_INTERVAL = 10;
+
+/// Client side of the logins: sockets drained by a thread of their own.
+struct LoginBenchmarkClients
+{
+    std::vector<Socket*> sockets;
+
+    /// Protects the members below.
+    Mutex lock;
+    /// Bytes to receive in all.
+    uint64 expected;
+    /// Bytes received so far.
+    uint64 received;
+    /// Peak RSS seen while receiving, in KiB.
+    uint64 peakRSS;
+    /// Set by the main thread to stop the drain.
+    bool stop;
+};
+
+/// @return ID of the index-th object.
+static std::string LoginBenchmarkObjectID( uint32 index )
+{
+    char name[64];
+    snprintf( name, sizeof( name ), "config.BulkData.bench%02u", index );
+    return name;
+}
+
+/// Builds rows as bulk data has them, about given marshaled size in all.
+static PyRep* LoginBenchmarkObject( uint32 index, uint32 size, BenchRandom& random )
+{
+    const uint32 rowCount = std::max<uint32>( 1, size / LOGIN_BENCH_ROW_SIZE );
+
+    PyList* rows = new PyList( rowCount );
+    for( uint32 i = 0; i < rowCount; ++i )
+    {
+        char name[64];
+        snprintf( name, sizeof( name ), "Bench Row %u of Object %u", i, index );
+
+        PyTuple* row = new PyTuple( 4 );
+        row->SetItem( 0, new PyInt( 100000 + i ) );
+        row->SetItem( 1, new PyString( name ) );
+        row->SetItem( 2, new PyFloat( random.Next( 0.0, 1e6 ) ) );
+        row->SetItem( 3, new PyInt( (int32)random.Next( 0.0, 1e9 ) ) );
+
+        rows->SetItem( i, row );
+    }
+
+    return rows;
+}
+
+/// Generates the objects; writes each into a cache file as the prime workers do, and all of them into the pack.
+static void LoginBenchmarkBuild( const char* cmdName, uint32 objectCount, uint32 objectKiB )
+{
+    mkdir( LOGIN_BENCH_CACHE_DIR, 0755 );
+
+    CachedObjectMgr mgr;
+    BenchRandom random( 38 );
+    uint64 bytes = 0;
+
+    for( uint32 i = 0; i < objectCount; ++i )
+    {
+        const std::string objectID = LoginBenchmarkObjectID( i );
+
+        PyRep* object = LoginBenchmarkObject( i, objectKiB * 1024, random );
+        Buffer* data = new Buffer;
+        const bool res = MarshalDeflate( object, *data );
+        PyDecRef( object );
+
+        if( !res )
+        {
+            sLog.Error( cmdName, "Failed to marshal object %u.", i );
+            SafeDelete( data );
+            return;
+        }
+
+        CacheFileHeader header;
+        header.timestamp = Win32TimeNow();
+        header.version = CRC32::Generate( &( *data )[0], data->size() );
+        header.length = (uint32)data->size();
+        header.magic = CacheFileMagic;
+
+        if( !CachedObjectMgr::WriteCacheFile( LOGIN_BENCH_CACHE_DIR, objectID, header, *data ) )
+        {
+            sLog.Error( cmdName, "Failed to write the cache file of object %u.", i );
+            SafeDelete( data );
+            return;
+        }
+
+        bytes += data->size();
+        mgr.AddCache( objectID, &data, header.timestamp, header.version, IsDeflated( *data ) );
+    }
+
+    if( !mgr.SavePack( LOGIN_BENCH_CACHE_DIR ) )
+    {
+        sLog.Error( cmdName, "Failed to save the pack." );
+        return;
+    }
+
+    sLog.Log( cmdName, "%u objects of " I64u " KiB in all written into %s.", objectCount, bytes / 1024, LOGIN_BENCH_CACHE_DIR );
+    sLog.Log( cmdName, "Now run '%s heap' and '%s mapped', each in a process of its own so their RSS can be compared.", cmdName, cmdName );
+}
+
+/// Builds the reply to a GetCachableObject call, as Client::_SendCallReturn does.
+static PyRep* LoginBenchmarkReply( CachedObjectMgr& mgr, const std::string& objectID, uint32 callID )
+{
+    PyPacket* p = new PyPacket;
+    p->type_string = "macho.CallRsp";
+    p->type = CALL_RSP;
+
+    p->source.type = PyAddress::Node;
+    p->source.typeID = 888444;
+    p->source.service = "objectCaching";
+
+    p->dest.type = PyAddress::Client;
+    p->dest.typeID = 1;
+    p->dest.callID = callID;
+
+    p->userid = 1;
+
+    p->payload = new PyTuple( 1 );
+    p->payload->SetItem( 0, new PySubStream( mgr.GetCachedObject( objectID ) ) );
+
+    PyRep* r = p->Encode();
+    SafeDelete( p );
+
+    return r;
+}
+
+/// Marshals every reply as sent and as the copying marshaler has it; the bytes must match.
+static bool LoginBenchmarkCheck( CachedObjectMgr& mgr, uint32 objectCount, uint64& bytes, uint64& sliced )
+{
+    bytes = sliced = 0;
+
+    for( uint32 i = 0; i < objectCount; ++i )
+    {
+        // copied, as PySubStream::EncodeData() has it
+        PyRep* r = LoginBenchmarkReply( mgr, LoginBenchmarkObjectID( i ), i );
+        Buffer flat;
+        Marshal( r, flat );
+        PyDecRef( r );
+
+        // as QueueRep() sends it; a reply of its own, the one above holds its substream encoded
+        r = LoginBenchmarkReply( mgr, LoginBenchmarkObjectID( i ), i );
+        Buffer data;
+        std::vector<MappedSlice> slices;
+        MarshalDeflate( r, data, slices );
+        PyDecRef( r );
+
+        Buffer spliced;
+        size_t offset = 0;
+        for( size_t j = 0; j < slices.size(); ++j )
+        {
+            spliced.AppendSeq( data.begin<uint8>() + offset, data.begin<uint8>() + slices[ j ].offset );
+            spliced.AppendSeq( slices[ j ].data, slices[ j ].data + slices[ j ].length );
+
+            offset = slices[ j ].offset;
+            sliced += slices[ j ].length;
+        }
+        spliced.AppendSeq( data.begin<uint8>() + offset, data.end<uint8>() );
+        ReleaseSlices( slices );
+
+        if( spliced.size() != flat.size() || 0 != memcmp( &spliced[0], &flat[0], flat.size() ) )
+            return false;
+
+        // with the length in front
+        bytes += sizeof( uint32 ) + flat.size();
+    }
+
+    return true;
+}
+
+/// Receives everything on the client sockets; samples the RSS meanwhile.
+static thread_return_t LoginBenchmarkDrain( void* arg )
+{
+    LoginBenchmarkClients* clients = reinterpret_cast<LoginBenchmarkClients*>( arg );
+
+    static uint8 buf[ 0x10000 ];
+    uint32 sampled = 0;
+
+    while( true )
+    {
+        uint64 received = 0;
+        for( size_t i = 0; i < clients->sockets.size(); ++i )
+        {
+            int status;
+            while( 0 < ( status = (int)clients->sockets[ i ]->recv( buf, sizeof( buf ), 0 ) ) )
+                received += status;
+        }
+
+        uint64 rss = 0, peak = 0;
+        if( LOGIN_BENCH_RSS_INTERVAL <= GetTickCount() - sampled )
+        {
+            BenchRSS( rss, peak );
+            sampled = GetTickCount();
+        }
+
+        {
+            MutexLock lock( clients->lock );
+
+            clients->received += received;
+            clients->peakRSS = std::max( clients->peakRSS, rss );
+
+            if( clients->stop )
+                break;
+        }
+
+        if( 0 == received )
+            Sleep( 1 );
+    }
+
+    THREAD_RETURN( NULL );
+}
+
+/// Connects the clients and replies with every object to each of them, interleaved as concurrent logins are.
+static void LoginBenchmarkRun( const char* cmdName, CachedObjectMgr& mgr, uint32 loginCount, uint32 objectCount )
+{
+    uint64 expected, sliced;
+    if( !LoginBenchmarkCheck( mgr, objectCount, expected, sliced ) )
+    {
+        sLog.Error( cmdName, "The replies sent from the mapping differ from the copied ones." );
+        return;
+    }
+    expected *= loginCount;
+
+    char errbuf[ TCPCONN_ERRBUF_SIZE ];
+    EVETCPServer tcps;
+    if( !tcps.Open( LOGIN_BENCH_PORT, errbuf ) )
+    {
+        sLog.Error( cmdName, "Failed to listen on port %u: %s", LOGIN_BENCH_PORT, errbuf );
+        return;
+    }
+
+    LoginBenchmarkClients clients;
+    clients.expected = expected;
+    clients.received = 0;
+    clients.peakRSS = 0;
+    clients.stop = false;
+
+    sockaddr_in address;
+    memset( &address, 0, sizeof( address ) );
+    address.sin_family = AF_INET;
+    address.sin_port = htons( LOGIN_BENCH_PORT );
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    std::vector<EVETCPConnection*> connections;
+    for( uint32 i = 0; i < loginCount; ++i )
+    {
+        Socket* sock = new Socket( AF_INET, SOCK_STREAM, 0 );
+        if( 0 != sock->connect( (const sockaddr*)&address, sizeof( address ) ) )
+        {
+            sLog.Error( cmdName, "Failed to connect client %u.", i );
+            SafeDelete( sock );
+            break;
+        }
+
+#ifdef WIN32
+        unsigned long nonblocking = 1;
+        sock->ioctl( FIONBIO, &nonblocking );
+#else
+        sock->fcntl( F_SETFL, O_NONBLOCK );
+#endif
+        clients.sockets.push_back( sock );
+
+        EVETCPConnection* tcpc;
+        while( NULL == ( tcpc = tcps.PopConnection() ) )
+            Sleep( 1 );
+        connections.push_back( tcpc );
+    }
+
+    if( connections.size() == loginCount )
+    {
+        uint64 rss, peak;
+        BenchRSS( rss, peak );
+        sLog.Log( cmdName, "%u logins of %u objects each; " I64u " KiB per login, " I64u " KiB of it sent from the mapping; RSS " I64u " KiB before:",
+                  loginCount, objectCount, expected / loginCount / 1024, sliced / 1024, rss );
+
+#ifdef WIN32
+        _beginthread( LoginBenchmarkDrain, 0, &clients );
+#else
+        pthread_t thread;
+        pthread_create( &thread, NULL, LoginBenchmarkDrain, &clients );
+#endif
+
+        uint64 cpuStart, threadStart;
+        BenchCPUTime( cpuStart, threadStart );
+        const uint64 start = Win32TimeNow();
+
+        // what Client does for every GetCachableObject call
+        for( uint32 i = 0; i < objectCount; ++i )
+        {
+            const std::string objectID = LoginBenchmarkObjectID( i );
+
+            for( uint32 j = 0; j < loginCount; ++j )
+            {
+                PyRep* r = LoginBenchmarkReply( mgr, objectID, i );
+                connections[ j ]->QueueRep( r );
+                PyDecRef( r );
+            }
+        }
+
+        uint64 cpuQueued, threadQueued;
+        BenchCPUTime( cpuQueued, threadQueued );
+        const double queued = BenchElapsed( start );
+
+        uint64 received = 0, last = 0;
+        uint32 progress = GetTickCount();
+        while( received < expected && GetTickCount() - progress < LOGIN_BENCH_STALL_TIMEOUT )
+        {
+            Sleep( 1 );
+
+            MutexLock lock( clients.lock );
+            received = clients.received;
+
+            if( last != received )
+            {
+                last = received;
+                progress = GetTickCount();
+            }
+        }
+
+        uint64 cpuEnd, threadEnd;
+        BenchCPUTime( cpuEnd, threadEnd );
+        const double elapsed = BenchElapsed( start );
+
+        {
+            MutexLock lock( clients.lock );
+            clients.stop = true;
+        }
+#ifndef WIN32
+        pthread_join( thread, NULL );
+#endif
+
+        if( received != expected )
+            sLog.Error( cmdName, "The clients received " I64u " bytes of " I64u ".", received, expected );
+
+        BenchRSS( rss, peak );
+        sLog.Log( cmdName, "    queued in %.1f ms (%.1f ms CPU on the main thread); all received after %.1f ms",
+                  queued / 1000.0, ( threadQueued - threadStart ) / 1000.0, elapsed / 1000.0 );
+        sLog.Log( cmdName, "    process CPU %.1f ms until queued, %.1f ms until received (sending and receiving threads included)",
+                  ( cpuQueued - cpuStart ) / 1000.0, ( cpuEnd - cpuStart ) / 1000.0 );
+        sLog.Log( cmdName, "    peak RSS while sending " I64u " KiB, RSS " I64u " KiB after, peak RSS " I64u " KiB",
+                  clients.peakRSS, rss, peak );
+    }
+
+    for( size_t i = 0; i < connections.size(); ++i )
+        SafeDelete( connections[ i ] );
+    for( size_t i = 0; i < clients.sockets.size(); ++i )
+        SafeDelete( clients.sockets[ i ] );
+
+    tcps.Close();
+}
+
+void LoginBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    const std::string mode = ( 2 <= cmd.argCount() ? cmd.arg( 1 ) : "" );
+
+    uint32 loginCount = 500;
+    if( 3 <= cmd.argCount() )
+        loginCount = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 objectCount = 50;
+    if( 4 <= cmd.argCount() )
+        objectCount = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    uint32 objectKiB = 256;
+    if( 5 <= cmd.argCount() )
+        objectKiB = strtoul( cmd.arg( 4 ).c_str(), NULL, 0 );
+
+    if( ( "build" != mode && "heap" != mode && "mapped" != mode ) || 0 == loginCount || 0 == objectCount )
+    {
+        sLog.Error( cmdName, "Usage: %s build|heap|mapped [logins] [objects] [KiB per object]", cmdName );
+        return;
+    }
+
+    // keep the per-object logging out of the timings
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    if( "build" == mode )
+    {
+        LoginBenchmarkBuild( cmdName, objectCount, objectKiB );
+    }
+    else
+    {
+        CachedObjectMgr mgr;
+        const uint64 start = Win32TimeNow();
+
+        // as ObjCacheService does without a pack, and with one
+        uint32 loaded = 0;
+        if( "heap" == mode )
+        {
+            for( uint32 i = 0; i < objectCount; ++i )
+            {
+                if( mgr.LoadCachedFromFile( LOGIN_BENCH_CACHE_DIR, LoginBenchmarkObjectID( i ) ) )
+                    ++loaded;
+            }
+        }
+        else
+        {
+            loaded = (uint32)mgr.LoadPack( LOGIN_BENCH_CACHE_DIR );
+        }
+
+        if( loaded < objectCount )
+            sLog.Error( cmdName, "Loaded %u objects of %u; run '%s build' first.", loaded, objectCount, cmdName );
+        else
+        {
+            sLog.Log( cmdName, "Loaded %u objects from the %s in %.1f ms.",
+                      loaded, ( "heap" == mode ? "cache files" : "pack" ), BenchElapsed( start ) / 1000.0 );
+
+            LoginBenchmarkRun( cmdName, mgr, loginCount, objectCount );
+        }
+    }
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
@@ -0,0 +1,218 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchShip.h"
+#include "bench/Benchmarks.h"
+
+/// System the scenario runs in; only its ID is used.
+static const uint32 SETSTATE_BENCH_SYSTEM_ID = 30000142;
+/// Celestials are spread in a disc of this radius; 20 AU.
+static const double SETSTATE_BENCH_EXTENT = 20.0 * ONE_AU_IN_METERS;
+/// Ships of the camp sit within this distance of the gate; 10 km.
+static const double SETSTATE_BENCH_CAMP_RADIUS = 10000.0;
+
+/// Groups of the celestials after the sun, in the proportions of a common system.
+static const uint32 SETSTATE_BENCH_GROUPS[] =
+{
+    EVEDB::invGroups::Planet,
+    EVEDB::invGroups::Moon,
+    EVEDB::invGroups::Moon,
+    EVEDB::invGroups::Moon,
+    EVEDB::invGroups::Asteroid_Belt,
+    EVEDB::invGroups::Moon,
+    EVEDB::invGroups::Station,
+    EVEDB::invGroups::Moon,
+    EVEDB::invGroups::Stargate
+};
+static const size_t SETSTATE_BENCH_GROUP_COUNT = sizeof( SETSTATE_BENCH_GROUPS ) / sizeof( uint32 );
+
+/// Fills an in-memory database with just what SystemManager::MakeSetState() reads.
+static bool SetStateBenchmarkOpenDatabase( const char* cmdName )
+{
+    static const char* const statements[] =
+    {
+        "CREATE TABLE entity ( itemID INTEGER PRIMARY KEY, typeID INTEGER, ownerID INTEGER, locationID INTEGER, flag INTEGER,"
+        " contraband INTEGER, singleton INTEGER, quantity INTEGER, customInfo TEXT )",
+        "CREATE TABLE invTypes ( typeID INTEGER PRIMARY KEY, groupID INTEGER )",
+        "CREATE TABLE invGroups ( groupID INTEGER PRIMARY KEY, categoryID INTEGER )",
+        "CREATE TABLE droneState ( droneID INTEGER PRIMARY KEY, solarSystemID INTEGER, ownerID INTEGER, controllerID INTEGER,"
+        " activityState INTEGER, typeID INTEGER, controllerOwnerID INTEGER )",
+        "CREATE INDEX droneStateSolarSystem ON droneState ( solarSystemID )",
+        "INSERT INTO invGroups VALUES ( 5, 2 )",
+        "INSERT INTO invTypes VALUES ( 5, 5 )"
+    };
+
+    if( !BenchOpenDatabase( cmdName, statements, sizeof( statements ) / sizeof( const char* ) ) )
+        return false;
+
+    DBerror err;
+    if( !sDatabase.RunQuery( err, "INSERT INTO entity VALUES ( %u, 5, 1, 20000020, 0, 0, 1, 1, NULL )", SETSTATE_BENCH_SYSTEM_ID ) )
+    {
+        sLog.Error( cmdName, "Failed to set up the database: %s", err.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+static void SetStateBenchmarkRun( const char* cmdName, uint32 celestialCount, uint32 shipCount, uint32 count, uint32 fleetSize )
+{
+    ItemFactory factory( sEntityList );
+    PyServiceMgr services( 888444, sEntityList, factory );
+
+    // not booted; the celestials are made up below
+    SystemManager system( SETSTATE_BENCH_SYSTEM_ID, services );
+    BenchRandom random( 48 );
+
+    // the sun, then a flat disc of the rest
+    GPoint gate( 0, 0, 0 );
+    for( uint32 i = 0; i < celestialCount; ++i )
+    {
+        DBSystemEntity entity;
+        entity.itemID = 40000000 + i;
+        entity.groupID = ( 0 == i ? EVEDB::invGroups::Sun : SETSTATE_BENCH_GROUPS[ ( i - 1 ) % SETSTATE_BENCH_GROUP_COUNT ] );
+        entity.typeID = entity.groupID;
+        entity.orbitID = 40000000;
+        entity.radius = ( 0 == i ? 500000000.0 : 5000000.0 );
+        entity.security = 0.9;
+        sprintf( entity.itemName, "Bench Prime %s - Moon %u", ( 0 == i % 2 ? "VII" : "IV" ), i );
+
+        entity.position = GPoint( 0, 0, 0 );
+        if( 0 < i )
+        {
+            entity.position = random.NextPoint( SETSTATE_BENCH_EXTENT );
+            entity.position.y *= 0.05;
+        }
+
+        if( EVEDB::invGroups::Stargate == entity.groupID )
+            gate = entity.position;
+
+        system.AddEntity( SimpleSystemEntity::MakeEntity( &system, entity ) );    // owned by the system
+    }
+
+    // a camp on the gate
+    for( uint32 i = 0; i < shipCount; ++i )
+    {
+        GPoint offset( random.NextPoint( 1.0 ) );
+        offset.normalize();
+
+        BenchShip* ship = new BenchShip( 140000000 + i, &system, gate + offset * random.Next( 2500.0, SETSTATE_BENCH_CAMP_RADIUS ), false );
+        system.AddEntity( ship );    // owned by the system
+    }
+
+    // and the ship which jumps in, again and again
+    BenchShip* arrival = new BenchShip( 150000000, &system, gate + GPoint( 0, 5000, 0 ), false );
+    system.AddEntity( arrival );    // owned by the system
+
+    double setStateTime = 0.0, addBallsTime = 0.0;
+    uint64 setStateAllocations = 0, addBallsAllocations = 0;
+    size_t stateSize = 0;
+
+    // the whole state for each arrival
+    for( uint32 n = 0; n < count; ++n )
+    {
+        // what is kept for a tic is made again
+        if( 0 == n % fleetSize )
+            BenchShip::NextTic();
+
+        DoDestiny_SetState ss;
+        ss.stamp = DestinyManager::GetStamp();
+        ss.ego = arrival->GetID();
+
+        const uint64 allocations = BenchAllocations();
+        const uint64 start = Win32TimeNow();
+
+        system.MakeSetState( arrival->Bubble(), ss );
+
+        setStateTime += BenchElapsed( start );
+        setStateAllocations += BenchAllocations() - allocations;
+
+        stateSize = ss.destiny_state->content().size();
+    }
+
+    // then leaving the bubble and coming back, as after a jump
+    for( uint32 n = 0; n < count; ++n )
+    {
+        if( 0 == n % fleetSize )
+            BenchShip::NextTic();
+
+        system.bubbles.Remove( arrival, false );
+
+        const uint64 allocations = BenchAllocations();
+        const uint64 start = Win32TimeNow();
+
+        system.bubbles.Add( arrival, true );
+
+        addBallsTime += BenchElapsed( start );
+        addBallsAllocations += BenchAllocations() - allocations;
+    }
+
+    sLog.Log( cmdName, "%u celestials, %u ships in the bubble, %u arrivals, %u per tic:", celestialCount, shipCount, count, fleetSize );
+    sLog.Log( cmdName, "    SetState %.1f us, %.1f allocations, %lu bytes of balls",
+              setStateTime / count, double( setStateAllocations ) / count, stateSize );
+    sLog.Log( cmdName, "    entering the bubble (AddBalls to the arrival, AddBall to the camp) %.1f us, %.1f allocations",
+              addBallsTime / count, double( addBallsAllocations ) / count );
+}
+
+void SetStateBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 celestialCount = 100;
+    if( 2 <= cmd.argCount() )
+        celestialCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 shipCount = 100;
+    if( 3 <= cmd.argCount() )
+        shipCount = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 count = 1000;
+    if( 4 <= cmd.argCount() )
+        count = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    uint32 fleetSize = 1;
+    if( 5 <= cmd.argCount() )
+        fleetSize = strtoul( cmd.arg( 4 ).c_str(), NULL, 0 );
+
+    if( 0 == celestialCount || 0 == count || 0 == fleetSize )
+    {
+        sLog.Error( cmdName, "Usage: %s [celestials] [ships] [count] [arrivals per tic]", cmdName );
+        return;
+    }
+
+    if( !SetStateBenchmarkOpenDatabase( cmdName ) )
+        return;
+
+    // BubbleManager logs every bubble change; printing that would be most of what we measure
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    SetStateBenchmarkRun( cmdName, celestialCount, shipCount, count, fleetSize );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
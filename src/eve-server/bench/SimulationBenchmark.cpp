@@ -0,0 +1,315 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchShip.h"
+#include "bench/Benchmarks.h"
+
+/// System the scenario runs in; only its ID is used.
+static const uint32 SIM_BENCH_SYSTEM_ID = 30000142;
+/// Celestials are spread in a disc of this radius; 20 AU.
+static const double SIM_BENCH_EXTENT = 20.0 * ONE_AU_IN_METERS;
+/// Number of planets, moons and stargates besides the sun.
+static const uint32 SIM_BENCH_CELESTIALS = 60;
+/// Ships start and land within this distance of a celestial; 30 km.
+static const double SIM_BENCH_SITE_RADIUS = 30000.0;
+/// Average number of tics between two orders of a ship.
+static const uint32 SIM_BENCH_ORDER_INTERVAL = 30;
+
+/// What a ship may be told to do.
+enum SimBenchOrder
+{
+    SIM_BENCH_WARP,
+    SIM_BENCH_ORBIT,
+    SIM_BENCH_FOLLOW,
+    SIM_BENCH_APPROACH
+};
+
+/// A sun, planet, moon or stargate: static and in everybody's destiny state.
+class BenchCelestial
+: public BenchEntity
+{
+public:
+    BenchCelestial( uint32 id, const GPoint& position ) : BenchEntity( id, position ) {}
+
+    bool IsStaticEntity() const { return true; }
+    bool IsVisibleSystemWide() const { return true; }
+    double GetRadius() const { return 5000.0; }
+};
+
+/**
+ * @brief A system full of ships, each of them given a new order now and then.
+ *
+ * Ships keep to sites around the celestials: they warp between them
+ * and orbit, follow or approach each other or the celestial of the site.
+ */
+class SimBenchScript
+{
+public:
+    SimBenchScript( SystemManager& system, uint32 shipCount, uint32 clientCount )
+    : mSystem( system ),
+      mRandom( 46 )
+    {
+        // the sun, then a flat disc of the rest
+        for( uint32 i = 0; i <= SIM_BENCH_CELESTIALS; ++i )
+        {
+            GPoint position( 0, 0, 0 );
+            if( 0 < i )
+            {
+                position = mRandom.NextPoint( SIM_BENCH_EXTENT );
+                position.y *= 0.05;
+            }
+
+            BenchCelestial* cel = new BenchCelestial( 40000000 + i, position );
+            mSystem.AddEntity( cel );    // owned by the system
+
+            mCelestials.push_back( cel );
+        }
+        mSites.resize( mCelestials.size() );
+
+        for( uint32 i = 0; i < shipCount; ++i )
+        {
+            const uint32 site = (uint32)mRandom.Next( 0, (double)mCelestials.size() );
+
+            BenchShip* ship = new BenchShip( 140000000 + i, &mSystem, _SitePoint( site ), i < clientCount );
+            mSystem.AddEntity( ship );    // owned by the system
+
+            mShips.push_back( ship );
+            mShipSites.push_back( site );
+            mSites[ site ].push_back( i );
+        }
+    }
+
+    const std::vector<BenchShip*>& GetShips() const { return mShips; }
+    size_t GetCelestialCount() const { return mCelestials.size(); }
+
+    /// Gives every ship its first order.
+    void Start()
+    {
+        for( uint32 i = 0; i < mShips.size(); ++i )
+            _Order( i );
+    }
+
+    /// Gives orders to the ships whose turn it is.
+    void Tic()
+    {
+        for( uint32 i = 0; i < mShips.size(); ++i )
+        {
+            // do not break off warps
+            if( Destiny::DSTBALL_WARP == mShips[ i ]->Destiny()->GetState() )
+                continue;
+
+            if( mRandom.Next() * SIM_BENCH_ORDER_INTERVAL < 1.0 )
+                _Order( i );
+        }
+    }
+
+protected:
+    /// @return Random landing spot at given site.
+    GPoint _SitePoint( uint32 site )
+    {
+        GPoint offset( mRandom.NextPoint( 1.0 ) );
+        offset.normalize();
+
+        return mCelestials[ site ]->GetPosition() + offset * mRandom.Next( 6000.0, SIM_BENCH_SITE_RADIUS );
+    }
+
+    /// @return Something at the site of given ship for it to fly around.
+    SystemEntity* _SiteTarget( uint32 index )
+    {
+        const std::vector<uint32>& site = mSites[ mShipSites[ index ] ];
+
+        // one in four goes for the celestial
+        if( 1 < site.size() && 0.25 <= mRandom.Next() )
+        {
+            const uint32 other = site[ (size_t)mRandom.Next( 0, (double)site.size() ) ];
+            if( other != index )
+                return mShips[ other ];
+        }
+
+        return mCelestials[ mShipSites[ index ] ];
+    }
+
+    void _Order( uint32 index )
+    {
+        DestinyManager* destiny = mShips[ index ]->Destiny();
+
+        const double roll = mRandom.Next();
+        const SimBenchOrder order = ( roll < 0.25 ? SIM_BENCH_WARP
+                                      : roll < 0.55 ? SIM_BENCH_ORBIT
+                                      : roll < 0.75 ? SIM_BENCH_FOLLOW
+                                      : SIM_BENCH_APPROACH );
+
+        switch( order )
+        {
+            case SIM_BENCH_WARP:
+            {
+                const uint32 site = (uint32)mRandom.Next( 0, (double)mCelestials.size() );
+                _Move( index, site );
+
+                destiny->WarpTo( _SitePoint( site ), 0.0 );
+            } break;
+
+            case SIM_BENCH_ORBIT:
+                destiny->Orbit( _SiteTarget( index ), mRandom.Next( 500.0, 5000.0 ) );
+                break;
+
+            case SIM_BENCH_FOLLOW:
+                destiny->Follow( _SiteTarget( index ), mRandom.Next( 1000.0, 2500.0 ) );
+                break;
+
+            case SIM_BENCH_APPROACH:
+                // what the client sends for approach
+                destiny->Follow( _SiteTarget( index ), 50.0 );
+                break;
+        }
+    }
+
+    /// Moves given ship to another site.
+    void _Move( uint32 index, uint32 site )
+    {
+        std::vector<uint32>& from = mSites[ mShipSites[ index ] ];
+        from.erase( std::find( from.begin(), from.end(), index ) );
+
+        mSites[ site ].push_back( index );
+        mShipSites[ index ] = site;
+    }
+
+    SystemManager& mSystem;
+    BenchRandom mRandom;
+
+    std::vector<BenchCelestial*> mCelestials;
+    std::vector<BenchShip*> mShips;
+    /// Site of each ship.
+    std::vector<uint32> mShipSites;
+    /// Ships of each site.
+    std::vector< std::vector<uint32> > mSites;
+};
+
+static void SimulationBenchmarkRun( const char* cmdName, uint32 shipCount, uint32 clientCount, uint32 tics )
+{
+    ItemFactory factory( sEntityList );
+    PyServiceMgr services( 888444, sEntityList, factory );
+
+    // not booted; the script builds it up without a database
+    SystemManager system( SIM_BENCH_SYSTEM_ID, services );
+    SimBenchScript script( system, shipCount, clientCount );
+
+    const std::vector<BenchShip*>& ships = script.GetShips();
+    const uint32 wanderTics = std::max<uint32>( 1, BubbleManager::GetWanderInterval() / 1000 );
+
+    sTicProfiler.Reset();
+
+    uint64 worst = 0;
+    const uint64 start = TicProfiler::GetNanoTime();
+
+    script.Start();
+    for( uint32 t = 1; t <= tics; ++t )
+    {
+        const uint64 ticStart = TicProfiler::GetNanoTime();
+
+        // what EntityList::Process() does once per destiny tic
+        BenchShip::NextTic();
+        script.Tic();
+        system.ProcessDestiny();
+
+        if( 0 == t % wanderTics )
+            system.bubbles.ProcessAt( t * 1000 );
+
+        // clients send their queues out once per server loop
+        for( size_t i = 0; i < clientCount; ++i )
+            ships[ i ]->SendQueuedUpdates();
+
+        worst = std::max( worst, TicProfiler::GetNanoTime() - ticStart );
+    }
+
+    const uint64 total = TicProfiler::GetNanoTime() - start;
+
+    sLog.Log( cmdName, "%u ships (%u clients), %lu celestials, %u tics: %.3f ms per tic, worst %.3f ms, %lu bubbles",
+              shipCount, clientCount, script.GetCelestialCount(), tics,
+              total / 1.0e6 / tics, worst / 1.0e6, system.bubbles.GetBubbleCount() );
+
+    uint64 phases = 0;
+    for( uint32 p = 0; p < TicProfiler::PHASE_COUNT; ++p )
+    {
+        const TicProfiler::Phase phase = (TicProfiler::Phase)p;
+        phases += sTicProfiler.GetTime( phase );
+
+        sLog.Log( cmdName, "    %-10s %8.3f ms per tic %5.1f%%, " I64u " calls",
+                  TicProfiler::GetPhaseName( phase ), sTicProfiler.GetTime( phase ) / 1.0e6 / tics,
+                  100.0 * sTicProfiler.GetTime( phase ) / total, sTicProfiler.GetCount( phase ) );
+    }
+    // giving orders and the loops above
+    sLog.Log( cmdName, "    %-10s %8.3f ms per tic %5.1f%%",
+              "other", ( total - phases ) / 1.0e6 / tics, 100.0 * ( total - phases ) / total );
+
+    if( 0 < clientCount )
+    {
+        uint64 bytes = 0, packets = 0, updates = 0;
+        for( size_t i = 0; i < clientCount; ++i )
+        {
+            bytes += ships[ i ]->GetBytesSent();
+            packets += ships[ i ]->GetPacketsSent();
+            updates += ships[ i ]->GetUpdateCount();
+        }
+
+        const double clientTics = (double)clientCount * tics;
+        sLog.Log( cmdName, "    per client and tic: %.1f bytes, %.2f notifications, %.2f updates",
+                  bytes / clientTics, packets / clientTics, updates / clientTics );
+    }
+}
+
+void SimulationBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 shipCount = 1000;
+    if( 2 <= cmd.argCount() )
+        shipCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 tics = 300;
+    if( 3 <= cmd.argCount() )
+        tics = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 clientCount = shipCount / 4;
+    if( 4 <= cmd.argCount() )
+        clientCount = std::min<uint32>( shipCount, strtoul( cmd.arg( 3 ).c_str(), NULL, 0 ) );
+
+    if( 0 == shipCount || 0 == tics )
+    {
+        sLog.Error( cmdName, "Usage: %s [ships] [tics] [clients]", cmdName );
+        return;
+    }
+
+    // BubbleManager logs every bubble change; printing that would be most of what we measure
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    SimulationBenchmarkRun( cmdName, shipCount, clientCount, tics );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
@@ -0,0 +1,313 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/Benchmarks.h"
+
+/// Database the "build" step fills; in the working directory.
+static const char* const STARTUP_BENCH_DATABASE = "startup-bench.db";
+/// Snapshot the "build" step compiles from it.
+static const char* const STARTUP_BENCH_SNAPSHOT = "startup-bench.snap";
+
+/// First typeID of the types; all of them minerals, so nothing but invTypes is read for them.
+static const uint32 STARTUP_BENCH_FIRST_TYPE_ID = 100000;
+/// Celestials per solar system ...
+static const uint32 STARTUP_BENCH_SYSTEM_SIZE = 100;
+/// ... solar systems per constellation ...
+static const uint32 STARTUP_BENCH_CONSTELLATION_SIZE = 7;
+/// ... and constellations per region, roughly as in the real map.
+static const uint32 STARTUP_BENCH_REGION_SIZE = 16;
+/// Every this many solar systems has a station.
+static const uint32 STARTUP_BENCH_STATION_EVERY = 3;
+
+/// All the tables STATIC_SNAPSHOT_QUERIES read, with just the columns they read.
+static const char* const STARTUP_BENCH_TABLES[] =
+{
+    "CREATE TABLE dgmTypeAttributes ( typeID INTEGER, attributeID INTEGER, valueInt INTEGER, valueFloat REAL,"
+    " PRIMARY KEY ( typeID, attributeID ) )",
+    "CREATE TABLE invCategories ( categoryID INTEGER PRIMARY KEY, categoryName TEXT, description TEXT, published INTEGER )",
+    "CREATE TABLE invGroups ( groupID INTEGER PRIMARY KEY, categoryID INTEGER, groupName TEXT, description TEXT,"
+    " useBasePrice INTEGER, allowManufacture INTEGER, allowRecycler INTEGER, anchored INTEGER, anchorable INTEGER,"
+    " fittableNonSingleton INTEGER, published INTEGER )",
+    "CREATE TABLE invTypes ( typeID INTEGER PRIMARY KEY, groupID INTEGER, typeName TEXT, description TEXT, radius REAL,"
+    " mass REAL, volume REAL, capacity REAL, portionSize INTEGER, raceID INTEGER, basePrice REAL, published INTEGER,"
+    " marketGroupID INTEGER, chanceOfDuplicating REAL )",
+    "CREATE TABLE invBlueprintTypes ( blueprintTypeID INTEGER PRIMARY KEY, parentBlueprintTypeID INTEGER, productTypeID INTEGER,"
+    " productionTime INTEGER, techLevel INTEGER, researchProductivityTime INTEGER, researchMaterialTime INTEGER,"
+    " researchCopyTime INTEGER, researchTechTime INTEGER, productivityModifier INTEGER, materialModifier INTEGER,"
+    " wasteFactor INTEGER, chanceOfReverseEngineering REAL, maxProductionLimit INTEGER )",
+    "CREATE TABLE shipTypes ( shipTypeID INTEGER PRIMARY KEY, weaponTypeID INTEGER, miningTypeID INTEGER, skillTypeID INTEGER )",
+    "CREATE TABLE staStationTypes ( stationTypeID INTEGER PRIMARY KEY, dockEntryX REAL, dockEntryY REAL, dockEntryZ REAL,"
+    " dockOrientationX REAL, dockOrientationY REAL, dockOrientationZ REAL, operationID INTEGER, officeSlots INTEGER,"
+    " reprocessingEfficiency REAL, conquerable INTEGER )",
+    "CREATE TABLE mapDenormalize ( itemID INTEGER PRIMARY KEY, itemName TEXT, typeID INTEGER, solarSystemID INTEGER,"
+    " x REAL, y REAL, z REAL, security REAL, radius REAL, celestialIndex INTEGER, orbitIndex INTEGER )",
+    "CREATE TABLE mapRegions ( regionID INTEGER PRIMARY KEY, regionName TEXT, factionID INTEGER, x REAL, y REAL, z REAL )",
+    "CREATE TABLE mapConstellations ( constellationID INTEGER PRIMARY KEY, constellationName TEXT, factionID INTEGER,"
+    " regionID INTEGER, x REAL, y REAL, z REAL )",
+    "CREATE TABLE mapSolarSystems ( solarSystemID INTEGER PRIMARY KEY, solarSystemName TEXT, factionID INTEGER,"
+    " constellationID INTEGER, x REAL, y REAL, z REAL, xMin REAL, yMin REAL, zMin REAL, xMax REAL, yMax REAL, zMax REAL,"
+    " luminosity REAL, border INTEGER, fringe INTEGER, corridor INTEGER, hub INTEGER, international INTEGER,"
+    " regional INTEGER, constellation INTEGER, security REAL, radius REAL, sunTypeID INTEGER, securityClass TEXT )",
+    "CREATE TABLE staStations ( stationID INTEGER PRIMARY KEY, stationName TEXT, stationTypeID INTEGER, corporationID INTEGER,"
+    " solarSystemID INTEGER, x REAL, y REAL, z REAL, security REAL, dockingCostPerVolume REAL, maxShipVolumeDockable REAL,"
+    " officeRentalCost INTEGER, operationID INTEGER, reprocessingEfficiency REAL, reprocessingStationsTake REAL,"
+    " reprocessingHangarFlag INTEGER )",
+    "INSERT INTO invCategories VALUES ( 4, 'Material', '', 1 )",
+    "INSERT INTO invGroups VALUES ( 18, 4, 'Mineral', '', 1, 0, 0, 0, 0, 0, 1 )"
+};
+
+/// Fills the static tables with about as many rows as the real ones have.
+static bool StartupBenchmarkFill( uint32 typeCount, uint32 attributeCount, uint32 celestialCount )
+{
+    DBerror err;
+    if( !sDatabase.RunQuery( err, "BEGIN" ) )
+        return false;
+
+    for( uint32 i = 0; i < typeCount; ++i )
+    {
+        const uint32 typeID = STARTUP_BENCH_FIRST_TYPE_ID + i;
+
+        if( !sDatabase.RunQuery( err,
+            "INSERT INTO invTypes VALUES ( %u, 18, 'Bench Type %u', 'A type made up by eve-bench.', 1, 0, 0.01, 0, 1, NULL, 2, 1, NULL, 0 )",
+            typeID, i ) )
+            return false;
+
+        // spread out like the real attributeIDs; every other one is an integer
+        for( uint32 j = 0; j < attributeCount; ++j )
+        {
+            bool success;
+            if( 0 == j % 2 )
+                success = sDatabase.RunQuery( err, "INSERT INTO dgmTypeAttributes VALUES ( %u, %u, %u, NULL )", typeID, 4 + 7 * j, j );
+            else
+                success = sDatabase.RunQuery( err, "INSERT INTO dgmTypeAttributes VALUES ( %u, %u, NULL, %f )", typeID, 4 + 7 * j, 0.5 * j );
+
+            if( !success )
+                return false;
+        }
+    }
+
+    const uint32 systemCount = std::max<uint32>( 1, celestialCount / STARTUP_BENCH_SYSTEM_SIZE );
+    const uint32 constellationCount = ( systemCount + STARTUP_BENCH_CONSTELLATION_SIZE - 1 ) / STARTUP_BENCH_CONSTELLATION_SIZE;
+    const uint32 regionCount = ( constellationCount + STARTUP_BENCH_REGION_SIZE - 1 ) / STARTUP_BENCH_REGION_SIZE;
+
+    BenchRandom random( 33 );
+
+    for( uint32 i = 0; i < regionCount; ++i )
+    {
+        const GPoint p( random.NextPoint( 1e18 ) );
+        if( !sDatabase.RunQuery( err, "INSERT INTO mapRegions VALUES ( %u, 'Bench Region %u', 500001, %f, %f, %f )",
+                                 10000000 + i, i, p.x, p.y, p.z ) )
+            return false;
+    }
+
+    for( uint32 i = 0; i < constellationCount; ++i )
+    {
+        const GPoint p( random.NextPoint( 1e18 ) );
+        if( !sDatabase.RunQuery( err, "INSERT INTO mapConstellations VALUES ( %u, 'Bench Constellation %u', 500001, %u, %f, %f, %f )",
+                                 20000000 + i, i, 10000000 + i / STARTUP_BENCH_REGION_SIZE, p.x, p.y, p.z ) )
+            return false;
+    }
+
+    for( uint32 i = 0; i < systemCount; ++i )
+    {
+        const uint32 systemID = 30000000 + i;
+        const GPoint p( random.NextPoint( 1e18 ) );
+
+        if( !sDatabase.RunQuery( err,
+            "INSERT INTO mapSolarSystems VALUES ( %u, 'Bench System %u', 500001, %u, %f, %f, %f, -1e13, -1e13, -1e13, 1e13, 1e13, 1e13,"
+            " 1, 0, 0, 0, 0, 0, 0, 0, %f, 1e13, 6, 'B' )",
+            systemID, i, 20000000 + i / STARTUP_BENCH_CONSTELLATION_SIZE, p.x, p.y, p.z, random.Next( -1.0, 1.0 ) ) )
+            return false;
+
+        if( 0 == i % STARTUP_BENCH_STATION_EVERY
+            && !sDatabase.RunQuery( err,
+            "INSERT INTO staStations VALUES ( %u, 'Bench System %u - Bench Station', 1529, 1000044, %u, %f, %f, %f,"
+            " 0.5, 0, 50000000, 10000, 22, 0.5, 0.05, 4 )",
+            60000000 + i, i, systemID, p.x, p.y, p.z ) )
+            return false;
+    }
+
+    // the sun, planets and moons of each system, and a gate every ten
+    for( uint32 i = 0; i < celestialCount; ++i )
+    {
+        const uint32 index = i % STARTUP_BENCH_SYSTEM_SIZE;
+        const uint32 itemID = ( 0 != index && 0 == index % 10 ? 50000000 : 40000000 ) + i;
+        const GPoint p( random.NextPoint( 1e13 ) );
+
+        if( !sDatabase.RunQuery( err,
+            "INSERT INTO mapDenormalize VALUES ( %u, 'Bench System %u - Moon %u', %u, %u, %f, %f, %f, %f, %f, %u, %u )",
+            itemID, i / STARTUP_BENCH_SYSTEM_SIZE, index, ( 0 == index ? 6 : 14 ), 30000000 + i / STARTUP_BENCH_SYSTEM_SIZE,
+            p.x, p.y, p.z, random.Next( -1.0, 1.0 ), random.Next( 1e6, 1e8 ), index / 10, index % 10 ) )
+            return false;
+    }
+
+    return sDatabase.RunQuery( err, "COMMIT" );
+}
+
+/// Throws a file out of the page cache, so the next read of it comes from the disk.
+static void StartupBenchmarkDropCache( const char* file )
+{
+#ifdef WIN32
+    // no way to do that for a single file; the cold run is only as cold as the cache happens to be
+#else /* !WIN32 */
+    const int fd = ::open( file, O_RDONLY );
+    if( -1 == fd )
+        return;
+
+    ::posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+    ::close( fd );
+#endif /* !WIN32 */
+}
+
+/// Loads the static data as the server does at startup, and the types of the items; logs the time it took and the memory it holds.
+static void StartupBenchmarkLoad( const char* cmdName, const char* name, uint32 typeCount )
+{
+    const uint64 bytes = BenchAllocatedBytes();
+    const uint64 start = Win32TimeNow();
+
+    // as main() does
+    _sDgmTypeAttrMgr = new dgmtypeattributemgr();
+    const bool universe = sStaticUniverse.Load();
+
+    // and then the types, as ItemFactory loads them on first use
+    ItemFactory factory( sEntityList );
+
+    uint32 types = 0;
+    for( uint32 i = 0; i < typeCount; ++i )
+    {
+        if( NULL != factory.GetType( STARTUP_BENCH_FIRST_TYPE_ID + i ) )
+            ++types;
+    }
+
+    const double elapsed = BenchElapsed( start );
+    const uint64 heap = BenchAllocatedBytes() - bytes;
+
+    uint64 rss, peak;
+    BenchRSS( rss, peak );
+
+    sLog.Log( cmdName, "    %-15s %.1f ms, %u types%s; heap " I64u " KiB, RSS " I64u " KiB, peak RSS " I64u " KiB",
+              name, elapsed / 1000.0, types, ( universe ? "" : ", universe failed" ), heap / 1024, rss, peak );
+
+    sStaticUniverse.Clear();
+    SafeDelete( _sDgmTypeAttrMgr );
+}
+
+/// Fills the database and compiles the snapshot from it.
+static void StartupBenchmarkBuild( const char* cmdName, uint32 typeCount, uint32 attributeCount, uint32 celestialCount )
+{
+    remove( STARTUP_BENCH_DATABASE );
+    remove( STARTUP_BENCH_SNAPSHOT );
+
+    if( !BenchOpenDatabase( cmdName, STARTUP_BENCH_TABLES, sizeof( STARTUP_BENCH_TABLES ) / sizeof( const char* ), STARTUP_BENCH_DATABASE ) )
+        return;
+
+    if( !StartupBenchmarkFill( typeCount, attributeCount, celestialCount ) )
+    {
+        sLog.Error( cmdName, "Failed to fill the database." );
+        return;
+    }
+
+    const uint64 start = Win32TimeNow();
+
+    std::string err;
+    if( !DBSnapshot::Build( err, STARTUP_BENCH_SNAPSHOT, STATIC_SNAPSHOT_QUERIES, STATIC_SNAPSHOT_QUERY_COUNT ) )
+    {
+        sLog.Error( cmdName, "Failed to build the snapshot: %s", err.c_str() );
+        return;
+    }
+
+    sLog.Log( cmdName, "%u types with %u attributes each, %u celestials in %s; snapshot %s built in %.1f ms.",
+              typeCount, attributeCount, celestialCount, STARTUP_BENCH_DATABASE, STARTUP_BENCH_SNAPSHOT, BenchElapsed( start ) / 1000.0 );
+    sLog.Log( cmdName, "Now run '%s sql %u' and '%s snapshot %u', each in a process of its own so their RSS can be compared.",
+              cmdName, typeCount, cmdName, typeCount );
+}
+
+void StartupBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    const std::string mode = ( 2 <= cmd.argCount() ? cmd.arg( 1 ) : "" );
+
+    uint32 typeCount = 20000;
+    if( 3 <= cmd.argCount() )
+        typeCount = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 attributeCount = 20;
+    if( 4 <= cmd.argCount() )
+        attributeCount = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    uint32 celestialCount = 100000;
+    if( 5 <= cmd.argCount() )
+        celestialCount = strtoul( cmd.arg( 4 ).c_str(), NULL, 0 );
+
+    if( ( "build" != mode && "sql" != mode && "snapshot" != mode ) || 0 == typeCount )
+    {
+        sLog.Error( cmdName, "Usage: %s build|sql|snapshot [types] [attributes per type] [celestials]", cmdName );
+        return;
+    }
+
+    // keep query logging out of the timings
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    if( "build" == mode )
+    {
+        StartupBenchmarkBuild( cmdName, typeCount, attributeCount, celestialCount );
+    }
+    else
+    {
+        // cold: nothing of the files in the page cache, as after a reboot
+        StartupBenchmarkDropCache( STARTUP_BENCH_DATABASE );
+        StartupBenchmarkDropCache( STARTUP_BENCH_SNAPSHOT );
+
+        if( BenchOpenDatabase( cmdName, NULL, 0, STARTUP_BENCH_DATABASE ) )
+        {
+            uint64 rss, peak;
+            BenchRSS( rss, peak );
+            sLog.Log( cmdName, "Loading %u types and the universe from the %s; RSS " I64u " KiB before:",
+                      typeCount, ( "sql" == mode ? "database" : "snapshot" ), rss );
+
+            std::string err;
+            for( int run = 0; run < 2; ++run )
+            {
+                // warm: mapped again, as by a restart right after the last one
+                if( "snapshot" == mode && !sDatabase.snapshot().Open( err, STARTUP_BENCH_SNAPSHOT ) )
+                {
+                    sLog.Error( cmdName, "Failed to open the snapshot: %s", err.c_str() );
+                    break;
+                }
+
+                StartupBenchmarkLoad( cmdName, ( 0 == run ? "cold" : "warm" ), typeCount );
+
+                sDatabase.snapshot().Close();
+            }
+        }
+    }
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
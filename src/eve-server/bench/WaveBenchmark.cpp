@@ -0,0 +1,325 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+#include "bench/BenchEntity.h"
+#include "bench/Benchmarks.h"
+
+/// System the scenario runs in; only its ID is used.
+static const uint32 WAVE_BENCH_SYSTEM_ID = 30000142;
+/// Celestials and asteroids are spread in a cube of this half-size; 10 AU.
+static const double WAVE_BENCH_EXTENT = 10.0 * ONE_AU_IN_METERS;
+/// The fight takes place within this distance of the origin; 50 km.
+static const double WAVE_BENCH_SITE_RADIUS = 50000.0;
+/// Passes of SystemManager::Process() per wave; the wave dies in the middle one.
+static const uint32 WAVE_BENCH_PASSES = 10;
+
+/// Calls of Process() during the run.
+struct WaveBenchCounters
+{
+    WaveBenchCounters() : pass( 1 ), calls( 0 ), repeats( 0 ) {}
+
+    /// Number of the current pass.
+    uint32 pass;
+    /// Calls of Process() of all entities.
+    uint64 calls;
+    /// Calls of Process() of entities which were processed in the same pass already.
+    uint64 repeats;
+};
+
+/// An entity which counts the passes reaching it.
+class WaveBenchEntity
+: public BenchEntity
+{
+public:
+    WaveBenchEntity( uint32 id, const GPoint& position, WaveBenchCounters& counters )
+    : BenchEntity( id, position ),
+      mCounters( counters ),
+      mLastPass( 0 )
+    {
+    }
+
+    void Process() { _Tic(); }
+
+protected:
+    /// @return False if this pass has reached us before.
+    bool _Tic()
+    {
+        SystemEntity::Process();
+
+        ++mCounters.calls;
+        if( mCounters.pass == mLastPass )
+        {
+            ++mCounters.repeats;
+            return false;
+        }
+
+        mLastPass = mCounters.pass;
+        return true;
+    }
+
+    WaveBenchCounters& mCounters;
+    uint32 mLastPass;
+};
+
+/// A celestial or an asteroid.
+class WaveBenchStatic
+: public WaveBenchEntity
+{
+public:
+    WaveBenchStatic( uint32 id, const GPoint& position, WaveBenchCounters& counters ) : WaveBenchEntity( id, position, counters ) {}
+
+    bool IsStaticEntity() const { return true; }
+};
+
+class WaveBenchScript;
+
+/// A player ship; fires once per pass, as its weapons cycle.
+class WaveBenchGunner
+: public WaveBenchEntity
+{
+public:
+    WaveBenchGunner( uint32 id, const GPoint& position, WaveBenchCounters& counters, WaveBenchScript& script )
+    : WaveBenchEntity( id, position, counters ),
+      mScript( script )
+    {
+    }
+
+    void Process();
+
+protected:
+    WaveBenchScript& mScript;
+};
+
+/**
+ * @brief A fight against NPC waves.
+ *
+ * A wave is spawned at once, the way SpawnEntry::_DoSpawn() drops its
+ * NPCs into the system. When armed, the gunners kill the whole wave
+ * within a single pass; every kill removes the NPC from the system,
+ * as NPC::Killed() does, and adds a wreck in its place.
+ */
+class WaveBenchScript
+{
+public:
+    WaveBenchScript( SystemManager& system, uint32 npcCount, uint32 shipCount, uint32 staticCount )
+    : mSystem( system ),
+      mRandom( 47 ),
+      mNpcCount( npcCount ),
+      mKillsPerShot( ( npcCount + shipCount - 1 ) / shipCount ),
+      mNextID( 150000000 ),
+      mArmed( false )
+    {
+        for( uint32 i = 0; i < staticCount; ++i )
+            mSystem.AddEntity( new WaveBenchStatic( 40000000 + i, mRandom.NextPoint( WAVE_BENCH_EXTENT ), mCounters ) );    // owned by the system
+
+        for( uint32 i = 0; i < shipCount; ++i )
+            mSystem.AddEntity( new WaveBenchGunner( 140000000 + i, mRandom.NextPoint( WAVE_BENCH_SITE_RADIUS ), mCounters, *this ) );    // owned by the system
+    }
+
+    ~WaveBenchScript()
+    {
+        Bury();
+    }
+
+    WaveBenchCounters& GetCounters() { return mCounters; }
+
+    /// Clears the wrecks of the last wave and spawns a new one.
+    void Spawn()
+    {
+        std::vector<SystemEntity*>::iterator cur, end;
+        cur = mWrecks.begin();
+        end = mWrecks.end();
+        for(; cur != end; ++cur )
+        {
+            mSystem.RemoveEntity( *cur );
+            delete *cur;
+        }
+        mWrecks.clear();
+
+        // new items get higher IDs than the ships which fight them
+        for( uint32 i = 0; i < mNpcCount; ++i )
+        {
+            SystemEntity* npc = new WaveBenchEntity( mNextID++, mRandom.NextPoint( WAVE_BENCH_SITE_RADIUS ), mCounters );
+            mSystem.AddEntity( npc );
+
+            mNpcs.push_back( npc );
+        }
+    }
+
+    /// Makes the next pass kill the whole wave.
+    void Arm() { mArmed = true; }
+
+    /// Called by the gunners.
+    void Fire()
+    {
+        for( uint32 i = 0; i < mKillsPerShot && mArmed && !mNpcs.empty(); ++i )
+        {
+            SystemEntity* npc = mNpcs.back();
+            mNpcs.pop_back();
+
+            mSystem.RemoveEntity( npc );
+            mDead.push_back( npc );
+
+            SystemEntity* wreck = new WaveBenchEntity( mNextID++, npc->GetPosition(), mCounters );
+            mSystem.AddEntity( wreck );
+            mWrecks.push_back( wreck );
+        }
+
+        if( mNpcs.empty() )
+            mArmed = false;
+    }
+
+    /// Deletes NPCs killed in the last pass; the system does not own them anymore.
+    void Bury()
+    {
+        std::vector<SystemEntity*>::iterator cur, end;
+        cur = mDead.begin();
+        end = mDead.end();
+        for(; cur != end; ++cur )
+            delete *cur;
+        mDead.clear();
+    }
+
+protected:
+    SystemManager& mSystem;
+    BenchRandom mRandom;
+
+    const uint32 mNpcCount;
+    const uint32 mKillsPerShot;
+    uint32 mNextID;
+    bool mArmed;
+
+    WaveBenchCounters mCounters;
+
+    std::vector<SystemEntity*> mNpcs;
+    std::vector<SystemEntity*> mWrecks;
+    std::vector<SystemEntity*> mDead;
+};
+
+void WaveBenchGunner::Process()
+{
+    // weapons cycle once per pass, however often it reaches us
+    if( _Tic() )
+        mScript.Fire();
+}
+
+static void WaveBenchmarkRun( const char* cmdName, uint32 npcCount, uint32 waves, uint32 shipCount, uint32 staticCount )
+{
+    ItemFactory factory( sEntityList );
+    PyServiceMgr services( 888444, sEntityList, factory );
+
+    // not booted; the script builds it up without a database
+    SystemManager system( WAVE_BENCH_SYSTEM_ID, services );
+    WaveBenchScript script( system, npcCount, shipCount, staticCount );
+
+    WaveBenchCounters& counters = script.GetCounters();
+
+    double quietTime = 0.0, killTime = 0.0, worst = 0.0;
+    uint64 quietPasses = 0, killPasses = 0;
+    uint64 bubbleTime = 0, repeats = 0;
+
+    for( uint32 w = 0; w < waves; ++w )
+    {
+        script.Spawn();
+
+        for( uint32 p = 0; p < WAVE_BENCH_PASSES; ++p )
+        {
+            const bool kill = ( WAVE_BENCH_PASSES / 2 == p );
+            if( kill )
+                script.Arm();
+
+            sTicProfiler.Reset();
+            const uint64 repeated = counters.repeats;
+
+            const uint64 start = Win32TimeNow();
+            system.Process();
+            const double elapsed = BenchElapsed( start );
+
+            ++counters.pass;
+            script.Bury();
+
+            if( kill )
+            {
+                killTime += elapsed;
+                ++killPasses;
+
+                bubbleTime += sTicProfiler.GetTime( TicProfiler::PHASE_BUBBLES ) + sTicProfiler.GetTime( TicProfiler::PHASE_BUBBLECAST );
+                repeats += counters.repeats - repeated;
+            }
+            else
+            {
+                quietTime += elapsed;
+                ++quietPasses;
+            }
+
+            worst = std::max( worst, elapsed );
+        }
+    }
+
+    sLog.Log( cmdName, "%u statics, %u ships, %u NPCs per wave, %u waves:", staticCount, shipCount, npcCount, waves );
+    sLog.Log( cmdName, "    quiet pass %.3f ms, kill pass %.3f ms (%.3f ms of it adding and removing balls), worst %.3f ms",
+              quietTime / 1000.0 / quietPasses, killTime / 1000.0 / killPasses,
+              bubbleTime / 1.0e6 / killPasses, worst / 1000.0 );
+    sLog.Log( cmdName, "    %.1f entities processed again per kill pass; " I64u " calls of Process() in total",
+              double( repeats ) / killPasses, counters.calls );
+}
+
+void WaveBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 npcCount = 500;
+    if( 2 <= cmd.argCount() )
+        npcCount = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+
+    uint32 waves = 20;
+    if( 3 <= cmd.argCount() )
+        waves = strtoul( cmd.arg( 2 ).c_str(), NULL, 0 );
+
+    uint32 shipCount = 50;
+    if( 4 <= cmd.argCount() )
+        shipCount = strtoul( cmd.arg( 3 ).c_str(), NULL, 0 );
+
+    uint32 staticCount = 300;
+    if( 5 <= cmd.argCount() )
+        staticCount = strtoul( cmd.arg( 4 ).c_str(), NULL, 0 );
+
+    if( 0 == npcCount || 0 == waves || 0 == shipCount )
+    {
+        sLog.Error( cmdName, "Usage: %s [NPCs per wave] [waves] [ships] [statics]", cmdName );
+        return;
+    }
+
+    // BubbleManager logs every bubble change; printing that would be most of what we measure
+    const bool debug = is_log_enabled( DEBUG__DEBUG );
+    log_disable( DEBUG__DEBUG );
+
+    WaveBenchmarkRun( cmdName, npcCount, waves, shipCount, staticCount );
+
+    if( debug )
+        log_enable( DEBUG__DEBUG );
+}
@@ -25,6 +25,105 @@
 
 #include "EVEServerPCH.h"
 
+/**
+ * Tables each generator reads; a change to any of them makes the object stale.
+ * Keep in sync with the queries below.
+ */
+static const struct {
+	const char *objectID;
+	const char *tables[2];
+} ObjCacheTableDependencies[] = {
+	{ "charNewExtraCreationInfo.raceskills", { "raceSkills", NULL } },
+	{ "charNewExtraCreationInfo.careerskills", { "careerSkills", NULL } },
+	{ "charNewExtraCreationInfo.specialityskills", { "specialitySkills", NULL } },
+	{ "charNewExtraCreationInfo.careers", { "careers", NULL } },
+	{ "charNewExtraCreationInfo.specialities", { "specialities", NULL } },
+	{ "config.BulkData.paperdollResources", { "paperdollResources", NULL } },
+	{ "config.BulkData.paperdollColors", { "paperdollColors", NULL } },
+	{ "config.BulkData.paperdollModifierLocations", { "paperdollModifierLocations", NULL } },
+	{ "config.BulkData.paperdollSculptingLocations", { "paperdollSculptingLocations", NULL } },
+	{ "config.BulkData.paperdollColorNames", { "paperdollColorNames", NULL } },
+	{ "config.BulkData.paperdollColorRestrictions", { "paperdollColorRestrictions", NULL } },
+	{ "config.BulkData.bloodlineNames", { "bloodlineNames", NULL } },
+	{ "config.BulkData.locationscenes", { "locationScenes", NULL } },
+	{ "config.BulkData.overviewDefaults", { "overviewDefaults", NULL } },
+	{ "config.BulkData.schematicspinmap", { "schematicsPinMap", NULL } },
+	{ "config.BulkData.overviewDefaultGroups", { "overviewDefaultGroups", NULL } },
+	{ "config.BulkData.schematics", { "schematics", NULL } },
+	{ "config.BulkData.schematicstypemap", { "schematicsTypeMap", NULL } },
+	{ "config.BulkData.sounds", { "sounds", NULL } },
+	{ "config.BulkData.invtypematerials", { "invTypeMaterials", NULL } },
+	{ "config.BulkData.ownericons", { "ownerIcons", NULL } },
+	{ "config.BulkData.icons", { "icons", NULL } },
+	{ "config.BulkData.billtypes", { "billTypes", NULL } },
+	{ "config.BulkData.allianceshortnames", { "alliance_ShortNames", NULL } },
+	{ "config.BulkData.categories", { "invCategories", NULL } },
+	{ "config.BulkData.invtypereactions", { "invTypeReactions", NULL } },
+	{ "config.BulkData.dgmtypeattribs", { "dgmTypeAttributes", NULL } },
+	{ "config.BulkData.dgmtypeeffects", { "dgmTypeEffects", NULL } },
+	{ "config.BulkData.dgmeffects", { "dgmEffects", NULL } },
+	{ "config.BulkData.dgmattribs", { "dgmattribs", NULL } },
+	{ "config.BulkData.metagroups", { "invMetaGroups", NULL } },
+	{ "config.BulkData.ramactivities", { "ramActivities", NULL } },
+	{ "config.BulkData.ramaltypesdetailpergroup", { "ramAssemblyLineTypeDetailPerGroup", "ramAssemblyLineTypes" } },
+	{ "config.BulkData.ramaltypesdetailpercategory", { "ramAssemblyLineTypeDetailPerCategory", "ramAssemblyLineTypes" } },
+	{ "config.BulkData.ramaltypes", { "ramAssemblyLineTypes", NULL } },
+	{ "config.BulkData.ramcompletedstatuses", { "ramCompletedStatuses", NULL } },
+	{ "config.BulkData.ramtyperequirements", { "ramTypeRequirements", NULL } },
+	{ "config.BulkData.mapcelestialdescriptions", { "mapCelestialDescriptions", NULL } },
+	{ "config.BulkData.tickernames", { "corporation", NULL } },
+	{ "config.BulkData.groups", { "invGroups", NULL } },
+	{ "config.BulkData.certificates", { "crtCertificates", NULL } },
+	{ "config.BulkData.certificaterelationships", { "certificateRelationShips", NULL } },
+	{ "config.BulkData.shiptypes", { "shipTypes", NULL } },
+	{ "config.BulkData.locations", { "cacheLocations", NULL } },
+	{ "config.BulkData.locationwormholeclasses", { "mapLocationWormholeClasses", NULL } },
+	{ "config.BulkData.bptypes", { "bpTypes", NULL } },
+	{ "config.BulkData.graphics", { "graphics", NULL } },
+	{ "config.BulkData.types", { "invTypes", NULL } },
+	{ "config.BulkData.invmetatypes", { "invMetaTypes", NULL } },
+	{ "config.Bloodlines", { "chrBloodlines", NULL } },
+	{ "config.Units", { "eveUnits", NULL } },
+	{ "config.BulkData.units", { "eveUnits", NULL } },
+	{ "config.BulkData.owners", { "cacheOwners", NULL } },
+	{ "config.StaticOwners", { "eveStaticOwners", NULL } },
+	{ "config.Races", { "chrRaces", NULL } },
+	{ "config.Attributes", { "chrAttributes", NULL } },
+	{ "config.Flags", { "invFlags", NULL } },
+	{ "config.StaticLocations", { "eveStaticLocations", NULL } },
+	{ "config.InvContrabandTypes", { "invContrabandTypes", NULL } },
+	{ "charCreationInfo.bloodlines", { "chrBloodlines", NULL } },
+	{ "charCreationInfo.races", { "chrRaces", NULL } },
+	{ "charCreationInfo.ancestries", { "chrAncestries", NULL } },
+	{ "charCreationInfo.schools", { "chrSchools", "agtAgents" } },
+	{ "charCreationInfo.attributes", { "chrAttributes", NULL } },
+	{ "charCreationInfo.bl_accessories", { "chrBLAccessories", NULL } },
+	{ "charCreationInfo.bl_lights", { "chrBLLights", NULL } },
+	{ "charCreationInfo.bl_skins", { "chrBLSkins", NULL } },
+	{ "charCreationInfo.bl_beards", { "chrBLBeards", NULL } },
+	{ "charCreationInfo.bl_eyes", { "chrBLEyes", NULL } },
+	{ "charCreationInfo.bl_lipsticks", { "chrBLLipsticks", NULL } },
+	{ "charCreationInfo.bl_makeups", { "chrBLMakeups", NULL } },
+	{ "charCreationInfo.bl_hairs", { "chrBLHairs", NULL } },
+	{ "charCreationInfo.bl_backgrounds", { "chrBLBackgrounds", NULL } },
+	{ "charCreationInfo.bl_decos", { "chrBLDecos", NULL } },
+	{ "charCreationInfo.bl_eyebrows", { "chrBLEyebrows", NULL } },
+	{ "charCreationInfo.bl_costumes", { "chrBLCostumes", NULL } },
+	{ "charCreationInfo.eyebrows", { "chrEyebrows", NULL } },
+	{ "charCreationInfo.eyes", { "chrEyes", NULL } },
+	{ "charCreationInfo.decos", { "chrDecos", NULL } },
+	{ "charCreationInfo.hairs", { "chrHairs", NULL } },
+	{ "charCreationInfo.backgrounds", { "chrBackgrounds", NULL } },
+	{ "charCreationInfo.accessories", { "chrAccessories", NULL } },
+	{ "charCreationInfo.lights", { "chrLights", NULL } },
+	{ "charCreationInfo.costumes", { "chrCostumes", NULL } },
+	{ "charCreationInfo.makeups", { "chrMakeups", NULL } },
+	{ "charCreationInfo.beards", { "chrBeards", NULL } },
+	{ "charCreationInfo.skins", { "chrSkins", NULL } },
+	{ "charCreationInfo.lipsticks", { "chrLipsticks", NULL } },
+};
+static const uint32 ObjCacheTableDependencyCount = sizeof(ObjCacheTableDependencies) / sizeof(ObjCacheTableDependencies[0]);
+
 ObjCacheDB::ObjCacheDB()
 {
 	//register all the generators
@@ -123,6 +222,76 @@ ObjCacheDB::ObjCacheDB()
 	m_generators["charCreationInfo.beards"] = &ObjCacheDB::Generate_a_beards;
 	m_generators["charCreationInfo.skins"] = &ObjCacheDB::Generate_a_skins;
 	m_generators["charCreationInfo.lipsticks"] = &ObjCacheDB::Generate_a_lipsticks;
+
+	for(uint32 r = 0; r < ObjCacheTableDependencyCount; r++) {
+		for(uint32 t = 0; t < 2 && ObjCacheTableDependencies[r].tables[t] != NULL; t++) {
+			const std::string table = _TableKey(ObjCacheTableDependencies[r].tables[t]);
+
+			m_objectTables[ObjCacheTableDependencies[r].objectID].push_back(table);
+			m_tableObjects[table].push_back(ObjCacheTableDependencies[r].objectID);
+		}
+	}
+}
+
+std::string ObjCacheDB::_TableKey(const char *table)
+{
+	// MySQL on Windows folds table names, so a change may be recorded in any case
+	std::string key(table);
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
+const std::vector<std::string> *ObjCacheDB::GetObjectTables(const std::string &objectID) const
+{
+	std::map<std::string, std::vector<std::string> >::const_iterator res = m_objectTables.find(objectID);
+	if(res == m_objectTables.end())
+		return NULL;
+
+	return &res->second;
+}
+
+const std::vector<std::string> *ObjCacheDB::GetTableObjects(const char *table) const
+{
+	std::map<std::string, std::vector<std::string> >::const_iterator res = m_tableObjects.find(_TableKey(table));
+	if(res == m_tableObjects.end())
+		return NULL;
+
+	return &res->second;
+}
+
+bool ObjCacheDB::GetTableChanges(std::map<std::string, uint64> &into)
+{
+	DBQueryResult res;
+	if(!sDatabase.RunQuery(res, "SELECT tableName, changeTime FROM cacheTableChanges"))
+	{
+		_log(SERVICE__ERROR, "Failed to query table changes: %s", res.error.c_str());
+		return false;
+	}
+
+	DBResultRow row;
+	while(res.GetRow(row))
+		into[_TableKey(row.GetText(0))] = row.GetUInt64(1);
+
+	return true;
+}
+
+bool ObjCacheDB::MarkTableChanged(const char *table)
+{
+	std::string escaped;
+	sDatabase.DoEscapeString(escaped, _TableKey(table));
+
+	DBerror err;
+	if(!sDatabase.RunQuery(err,
+		"INSERT INTO cacheTableChanges (tableName, changeTime)"
+		" VALUES ('%s', " I64u ")"
+		" ON DUPLICATE KEY UPDATE changeTime = VALUES(changeTime)",
+		escaped.c_str(), Win32TimeNow()))
+	{
+		_log(SERVICE__ERROR, "Failed to record change of table '%s': %s", table, err.c_str());
+		return false;
+	}
+
+	return true;
 }
 
 PyRep *ObjCacheDB::GetCachableObject(const std::string &type)
@@ -145,7 +314,7 @@ PyRep *ObjCacheDB::Generate_CharNewExtraSpecialities()
 {
 	DBQueryResult res;
 	const char *q = "SELECT careerID, specialityID, specialityName, description, shortDescription, graphicID, iconID, dataID FROM specialities";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charNewExtraCreationInfo.specialities': %s", res.error.c_str());
 		return NULL;
@@ -157,7 +326,7 @@ PyRep *ObjCacheDB::Generate_CharNewExtraCareers()
 {
 	DBQueryResult res;
 	const char *q = "SELECT raceID, careerID, careerName, description, shortDescription, graphicID, schoolID, iconID, dataID FROM careers";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charNewExtraCreationInfo.careers': %s", res.error.c_str());
 		return NULL;
@@ -169,7 +338,7 @@ PyRep *ObjCacheDB::Generate_CharNewExtraSpecialitySkills()
 {
 	DBQueryResult res;
 	const char *q = "SELECT specialityID, skillTypeID, levels FROM specialitySkills";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charNewExtraCreationInfo.specialityskills': %s", res.error.c_str());
 		return NULL;
@@ -181,7 +350,7 @@ PyRep *ObjCacheDB::Generate_CharNewExtraCareerSkills()
 {
 	DBQueryResult res;
 	const char *q = "SELECT careerID, skillTypeID, levels FROM careerSkills";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charNewExtraCreationInfo.careerskills': %s", res.error.c_str());
 		return NULL;
@@ -193,7 +362,7 @@ PyRep *ObjCacheDB::Generate_CharNewExtraRaceSkills()
 {
 	DBQueryResult res;
 	const char *q = "SELECT raceID, skillTypeID, levels FROM raceSkills";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charNewExtraCreationInfo.raceSkills': %s", res.error.c_str());
 		return NULL;
@@ -205,7 +374,7 @@ PyRep *ObjCacheDB::Generate_Icons()
 {
 	DBQueryResult res;
 	const char *q = "SELECT iconID, iconFile, description, obsolete, iconType FROM icons";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.icons': %s", res.error.c_str());
 		return NULL;
@@ -217,7 +386,7 @@ PyRep *ObjCacheDB::Generate_Ownericons()
 {
 	DBQueryResult res;
 	const char *q = "SELECT ownerID, iconID FROM ownerIcons";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ownerIcons': %s", res.error.c_str());
 		return NULL;
@@ -229,7 +398,7 @@ PyRep *ObjCacheDB::Generate_Invtypematerials()
 {
 	DBQueryResult res;
 	const char *q = "SELECT typeID, materialTypeID, quantity FROM invTypeMaterials";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.invTypeMaterials': %s", res.error.c_str());
 		return NULL;
@@ -241,7 +410,7 @@ PyRep *ObjCacheDB::Generate_Sounds()
 {
 	DBQueryResult res;
 	const char *q = "SELECT soundID, soundFile, description, obsolete FROM sounds";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.sounds': %s", res.error.c_str());
 		return NULL;
@@ -253,7 +422,7 @@ PyRep *ObjCacheDB::Generate_Schematicstypemap()
 {
 	DBQueryResult res;
 	const char *q = "SELECT schematicID, typeID, quantity, isInput FROM schematicsTypeMap";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.schematicsTypeMap': %s", res.error.c_str());
 		return NULL;
@@ -265,7 +434,7 @@ PyRep *ObjCacheDB::Generate_Schematics()
 {
 	DBQueryResult res;
 	const char *q = "SELECT schematicID, schematicName, cycleTime, dataID FROM schematics";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.schematics': %s", res.error.c_str());
 		return NULL;
@@ -277,7 +446,7 @@ PyRep *ObjCacheDB::Generate_OverviewDefaultGroups()
 {
 	DBQueryResult res;
 	const char *q = "SELECT overviewID, groupID FROM overviewDefaultGroups";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.overviewDefaultGroups': %s", res.error.c_str());
 		return NULL;
@@ -289,7 +458,7 @@ PyRep *ObjCacheDB::Generate_Schematicspinmap()
 {
 	DBQueryResult res;
 	const char *q = "SELECT schematicID, pinTypeID FROM schematicsPinMap";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.schematicsPinMap': %s", res.error.c_str());
 		return NULL;
@@ -301,7 +470,7 @@ PyRep *ObjCacheDB::Generate_OverviewDefaults()
 {
 	DBQueryResult res;
 	const char *q = "SELECT dataID, overviewID, overviewName, overviewShortName FROM overviewDefaults";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.overviewDefaults': %s", res.error.c_str());
 		return NULL;
@@ -313,7 +482,7 @@ PyRep *ObjCacheDB::Generate_Locationscenes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT locationID, sceneID FROM locationScenes";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.locationScenes': %s", res.error.c_str());
 		return NULL;
@@ -325,7 +494,7 @@ PyRep *ObjCacheDB::Generate_BloodlineNames()
 {
 	DBQueryResult res;
 	const char *q = "SELECT nameID, bloodlineID, lastName FROM bloodlineNames";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.bloodlineNames': %s", res.error.c_str());
 		return NULL;
@@ -337,7 +506,7 @@ PyRep *ObjCacheDB::Generate_PaperdollColors()
 {
 	DBQueryResult res;
 	const char *q = "SELECT colorID, colorKey, hasSecondary, hasWeight, hasGloss FROM paperdollColors";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollColors': %s", res.error.c_str());
 		return NULL;
@@ -349,7 +518,7 @@ PyRep *ObjCacheDB::Generate_PaperdollColorRestrictions()
 {
 	DBQueryResult res;
 	const char *q = "SELECT colorNameID, gender, restrictions FROM paperdollColorRestrictions";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollColorRestrictions': %s", res.error.c_str());
 		return NULL;
@@ -361,7 +530,7 @@ PyRep *ObjCacheDB::Generate_PaperdollColorNames()
 {
 	DBQueryResult res;
 	const char *q = "SELECT colorNameID, colorName FROM paperdollColorNames";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollColorNames': %s", res.error.c_str());
 		return NULL;
@@ -373,7 +542,7 @@ PyRep *ObjCacheDB::Generate_PaperdollSculptingLocations()
 {
 	DBQueryResult res;
 	const char *q = "SELECT sculptLocationID, weightKeyCategory, weightKeyPrefix FROM paperdollSculptingLocations";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollSculptingLocations': %s", res.error.c_str());
 		return NULL;
@@ -385,7 +554,7 @@ PyRep *ObjCacheDB::Generate_PaperdollModifierLocations()
 {
 	DBQueryResult res;
 	const char *q = "SELECT modifierLocationID, modifierKey, variationKey FROM paperdollModifierLocations";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollModifierLocations': %s", res.error.c_str());
 		return NULL;
@@ -397,7 +566,7 @@ PyRep *ObjCacheDB::Generate_PaperdollResources()
 {
 	DBQueryResult res;
 	const char *q = "SELECT paperdollResourceID, resGender, resPath, restrictions FROM paperdollResources";
-	if (sDatabase.RunQuery(res, q) == false)
+	if (sDatabase.RunQueryStream(res, q) == false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.paperdollResources': %s", res.error.c_str());
 		return NULL;
@@ -409,7 +578,7 @@ PyRep *ObjCacheDB::Generate_BillTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT billTypeID,billTypeName,description FROM billTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.billtypes': %s",res.error.c_str());
 		return NULL;
@@ -421,7 +590,7 @@ PyRep *ObjCacheDB::Generate_AllianceShortnames()
 {
 	DBQueryResult res;
 	const char *q = "SELECT allianceID,shortName FROM alliance_ShortNames";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.alliance_ShortNames': %s",res.error.c_str());
 		return NULL;
@@ -433,7 +602,7 @@ PyRep *ObjCacheDB::Generate_invCategories()
 {
 	DBQueryResult res;
 	const char *q = "SELECT categoryID, categoryName, description, 0 as graphicID, iconID, published, 0 as dataID FROM invCategories";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.categories': %s",res.error.c_str());
 		return NULL;
@@ -445,7 +614,7 @@ PyRep *ObjCacheDB::Generate_invTypeReactions()
 {
 	DBQueryResult res;
 	const char *q = "SELECT reactionTypeID,input,typeID,quantity FROM invTypeReactions";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.invtypereactions': %s",res.error.c_str());
 		return NULL;
@@ -457,7 +626,7 @@ PyRep *ObjCacheDB::Generate_dgmTypeAttribs()
 {
 	DBQueryResult res;
 	const char *q = "SELECT	dgmTypeAttributes.typeID,	dgmTypeAttributes.attributeID,	IF(valueInt IS NULL, valueFloat, valueInt) AS value FROM dgmTypeAttributes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.dgmtypeattribs': %s",res.error.c_str());
 		return NULL;
@@ -469,7 +638,7 @@ PyRep *ObjCacheDB::Generate_dgmTypeEffects()
 {
 	DBQueryResult res;
 	const char *q = "SELECT typeID,effectID,isDefault FROM dgmTypeEffects";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.dgmtypeeffects': %s",res.error.c_str());
 		return NULL;
@@ -481,7 +650,7 @@ PyRep *ObjCacheDB::Generate_dgmEffects()
 {
 	DBQueryResult res;
 	const char *q = "SELECT effectID, effectName, effectCategory, preExpression, postExpression, description, guid, iconID, isOffensive, isAssistance, durationAttributeID, trackingSpeedAttributeID, dischargeAttributeID, rangeAttributeID, falloffAttributeID, published, displayName, isWarpSafe, rangeChance, electronicChance, propulsionChance, distribution, sfxName, npcUsageChanceAttributeID, npcActivationChanceAttributeID, 0 as graphicID, fittingUsageChanceAttributeID, 0 AS dataID FROM dgmEffects";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.dgmeffects': %s",res.error.c_str());
 		return NULL;
@@ -493,7 +662,7 @@ PyRep *ObjCacheDB::Generate_dgmAttribs()
 {
 	DBQueryResult res;
 	const char *q = "SELECT attributeID, attributeName, attributeCategory, description, maxAttributeID, attributeIdx, graphicID, chargeRechargeTimeID, defaultValue, published, unitID, displayName, stackable, highIsGood, iconID, dataID FROM dgmattribs";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.dgmattribs': %s",res.error.c_str());
 		return NULL;
@@ -505,7 +674,7 @@ PyRep *ObjCacheDB::Generate_invMetaGroups()
 {
 	DBQueryResult res;
 	const char *q = "SELECT metaGroupID, metaGroupName, description, iconID, 0 as graphicID, 0 AS dataID FROM invMetaGroups";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.metagroups': %s",res.error.c_str());
 		return NULL;
@@ -517,7 +686,7 @@ PyRep *ObjCacheDB::Generate_ramActivities()
 {
 	DBQueryResult res;
 	const char *q = "SELECT activityID, activityName, iconNo, description, published FROM ramActivities";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramactivities': %s",res.error.c_str());
 		return NULL;
@@ -529,7 +698,7 @@ PyRep *ObjCacheDB::Generate_ramALTypeGroup()
 {
 	DBQueryResult res;
 	const char *q = "SELECT a.assemblyLineTypeID, b.activityID, a.groupID, a.timeMultiplier, a.materialMultiplier FROM ramAssemblyLineTypeDetailPerGroup AS a LEFT JOIN ramAssemblyLineTypes AS b ON a.assemblyLineTypeID = b.assemblyLineTypeID";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramaltypesdetailpergroup': %s",res.error.c_str());
 		return NULL;
@@ -541,7 +710,7 @@ PyRep *ObjCacheDB::Generate_ramALTypeCategory()
 {
 	DBQueryResult res;
 	const char *q = "SELECT a.assemblyLineTypeID, b.activityID, a.categoryID, a.timeMultiplier, a.materialMultiplier FROM ramAssemblyLineTypeDetailPerCategory AS a LEFT JOIN ramAssemblyLineTypes AS b ON a.assemblyLineTypeID = b.assemblyLineTypeID";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramaltypesdetailpercategory': %s",res.error.c_str());
 		return NULL;
@@ -553,7 +722,7 @@ PyRep *ObjCacheDB::Generate_ramALTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT assemblyLineTypeID, assemblyLineTypeName, assemblyLineTypeName AS typeName, description, activityID, baseTimeMultiplier, baseMaterialMultiplier, volume FROM ramAssemblyLineTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramaltypes': %s",res.error.c_str());
 		return NULL;
@@ -565,7 +734,7 @@ PyRep *ObjCacheDB::Generate_ramCompletedStatuses()
 {
 	DBQueryResult res;
 	const char *q = "SELECT completedStatusID, completedStatusName FROM ramCompletedStatuses";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramcompletedstatuses': %s",res.error.c_str());
 		return NULL;
@@ -577,7 +746,7 @@ PyRep *ObjCacheDB::Generate_ramTypeRequirements()
 {
 	DBQueryResult res;
 	const char *q = "SELECT typeID, activityID, requiredTypeID, quantity, damagePerJob, recycle FROM ramTypeRequirements";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.ramtyperequirements': %s", res.error.c_str());
 		return NULL;
@@ -589,7 +758,7 @@ PyRep *ObjCacheDB::Generate_mapCelestialDescriptions()
 {
 	DBQueryResult res;
 	const char *q = "SELECT celestialID, description FROM mapCelestialDescriptions";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.mapcelestialdescriptions': %s", res.error.c_str());
 		return NULL;
@@ -601,7 +770,7 @@ PyRep *ObjCacheDB::Generate_tickerNames()
 {
 	DBQueryResult res;
 	const char *q = "SELECT corporationID,tickerName,shape1,shape2,shape3,color1,color2,color3 FROM corporation WHERE hasPlayerPersonnelManager=0";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.tickernames': %s", res.error.c_str());
 		return NULL;
@@ -613,7 +782,7 @@ PyRep *ObjCacheDB::Generate_invGroups()
 {
 	DBQueryResult res;
 	const char *q = "SELECT groupID, categoryID, groupName, description, iconID, 0 as graphicID, useBasePrice, allowManufacture, allowRecycler, anchored, anchorable, fittableNonSingleton, 1 AS published, 0 AS dataID FROM invGroups";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.groups': %s", res.error.c_str());
 		return NULL;
@@ -625,7 +794,7 @@ PyRep *ObjCacheDB::Generate_certificates()
 {
 	DBQueryResult res;
 	const char *q = "SELECT certificateID, categoryID, classID, grade, iconID, corpID, description, 0 AS dataID FROM crtCertificates";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.certificates': %s", res.error.c_str());
 		return NULL;
@@ -637,7 +806,7 @@ PyRep *ObjCacheDB::Generate_certificateRelationships()
 {
 	DBQueryResult res;
 	const char *q = "SELECT relationshipID, parentID, parentTypeID, parentLevel, childID, childTypeID FROM certificateRelationShips";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.certificaterelationships': %s", res.error.c_str());
 		return NULL;
@@ -649,7 +818,7 @@ PyRep *ObjCacheDB::Generate_invShipTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT shipTypeID, weaponTypeID, miningTypeID, skillTypeID FROM shipTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.shiptypes': %s", res.error.c_str());
 		return NULL;
@@ -661,7 +830,7 @@ PyRep *ObjCacheDB::Generate_cacheLocations()
 {
 	DBQueryResult res;
 	const char *q = "SELECT locationID, locationName, x, y, z FROM cacheLocations";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.locations': %s", res.error.c_str());
 		return NULL;
@@ -673,7 +842,7 @@ PyRep *ObjCacheDB::Generate_locationWormholeClasses()
 {
 	DBQueryResult res;
 	const char *q = "SELECT locationID, wormholeClassID FROM mapLocationWormholeClasses";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.locationwormholeclasses': %s", res.error.c_str());
 		return NULL;
@@ -685,7 +854,7 @@ PyRep *ObjCacheDB::Generate_invBlueprintTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT blueprintTypeID, parentBlueprintTypeID, productTypeID, productionTime, techLevel, researchProductivityTime, researchMaterialTime, researchCopyTime, researchTechTime, productivityModifier, materialModifier, wasteFactor, chanceOfReverseEngineering, maxProductionLimit FROM bpTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.bptypes': %s", res.error.c_str());
 		return NULL;
@@ -697,7 +866,7 @@ PyRep *ObjCacheDB::Generate_eveGraphics()
 {
 	DBQueryResult res;
 	const char *q = "SELECT graphicID, graphicFile, graphicName, description, obsolete, graphicType, collisionFile, paperdollFile, animationTemplate, collidable, explosionID, directoryID, graphicMinX, graphicMinY, graphicMinZ, graphicMaxX, graphicMaxY, graphicMaxZ from graphics";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.graphics': %s", res.error.c_str());
 		return NULL;
@@ -710,7 +879,7 @@ PyRep *ObjCacheDB::Generate_invTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT typeID, groupID, typeName, description, graphicID, radius, mass, volume, capacity, portionSize, raceID, basePrice, published, marketGroupID, chanceOfDuplicating, 0 as soundID, 0 as categoryID, iconID, 0 AS dataID FROM invTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.types': %s", res.error.c_str());
 		return NULL;
@@ -722,7 +891,7 @@ PyRep *ObjCacheDB::Generate_invMetaTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT typeID, parentTypeID, metaGroupID FROM invMetaTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.invmetatypes': %s", res.error.c_str());
 		return NULL;
@@ -734,7 +903,7 @@ PyRep *ObjCacheDB::Generate_chrBloodlines()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, bloodlineName, raceID, description, maleDescription, femaleDescription, shipTypeID, corporationID, perception, willpower,charisma, memory, intelligence, iconID, shortDescription, shortMaleDescription, shortFemaleDescription, 0 as dataID FROM chrBloodlines";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.Bloodlines': %s", res.error.c_str());
 		return NULL;
@@ -746,7 +915,7 @@ PyRep *ObjCacheDB::Generate_eveUnits()
 {
 	DBQueryResult res;
 	const char *q = "SELECT unitID, unitName, displayName FROM eveUnits";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.Units': %s", res.error.c_str());
 		return NULL;
@@ -758,7 +927,7 @@ PyRep *ObjCacheDB::Generate_eveBulkDataUnits()
 {
 	DBQueryResult res;
 	const char *q = "SELECT unitID, unitName, displayName FROM eveUnits";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.units': %s", res.error.c_str());
 		return NULL;
@@ -770,7 +939,7 @@ PyRep *ObjCacheDB::Generate_cacheOwners()
 {
 	DBQueryResult res;
 	const char *q = "SELECT ownerID, ownerName, typeID FROM cacheOwners";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.BulkData.owners': %s", res.error.c_str());
 		return NULL;
@@ -782,7 +951,7 @@ PyRep *ObjCacheDB::Generate_eveStaticOwners()
 {
 	DBQueryResult res;
 	const char *q = "SELECT ownerID, ownerName, typeID FROM eveStaticOwners";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.StaticOwners': %s", res.error.c_str());
 		return NULL;
@@ -794,7 +963,7 @@ PyRep *ObjCacheDB::Generate_chrRaces()
 {
 	DBQueryResult res;
 	const char *q = "SELECT raceID, raceName, description, iconID as graphicID, shortDescription, iconID, 0 AS dataID FROM chrRaces";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.Races': %s", res.error.c_str());
 		return NULL;
@@ -806,7 +975,7 @@ PyRep *ObjCacheDB::Generate_chrAttributes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT attributeID, attributeName, description, iconID, shortDescription, notes, iconID as graphicID FROM chrAttributes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.Attributes': %s", res.error.c_str());
 		return NULL;
@@ -818,7 +987,7 @@ PyRep *ObjCacheDB::Generate_invFlags()
 {
 	DBQueryResult res;
 	const char *q = "SELECT flagID, flagName, flagName as flagLabel, flagName as flagGroup, flagName as description, orderID FROM invFlags";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.Flags': %s", res.error.c_str());
 		return NULL;
@@ -830,7 +999,7 @@ PyRep *ObjCacheDB::Generate_eveStaticLocations()
 {
 	DBQueryResult res;
 	const char *q = "SELECT locationID, locationName, x, y, z FROM eveStaticLocations";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.StaticLocations': %s", res.error.c_str());
 		return NULL;
@@ -842,7 +1011,7 @@ PyRep *ObjCacheDB::Generate_invContrabandTypes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT factionID, typeID, standingLoss, confiscateMinSec, fineByValue, attackMinSec FROM invContrabandTypes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'config.InvContrabandTypes': %s", res.error.c_str());
 		return NULL;
@@ -854,7 +1023,7 @@ PyRep *ObjCacheDB::Generate_c_chrBloodlines()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, bloodlineName, raceID, description, maleDescription, femaleDescription, shipTypeID, corporationID, perception, willpower, charisma, memory, intelligence, iconID, iconID as graphicID, shortDescription, shortMaleDescription, shortFemaleDescription, 0 AS dataID FROM chrBloodlines";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bloodlines': %s", res.error.c_str());
 		return NULL;
@@ -866,7 +1035,7 @@ PyRep *ObjCacheDB::Generate_c_chrRaces()
 {
 	DBQueryResult res;
 	const char *q = "SELECT raceID, raceName, description, iconID, iconID AS graphicID, shortDescription, 0 AS dataID FROM chrRaces";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.races': %s", res.error.c_str());
 		return NULL;
@@ -878,7 +1047,7 @@ PyRep *ObjCacheDB::Generate_c_chrAncestries()
 {
 	DBQueryResult res;
 	const char *q = "SELECT ancestryID, ancestryName, bloodlineID, description, perception, willpower, charisma, memory, intelligence, iconID, iconID AS graphicID, shortDescription, 0 AS dataID FROM chrAncestries";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.ancestries': %s", res.error.c_str());
 		return NULL;
@@ -890,7 +1059,7 @@ PyRep *ObjCacheDB::Generate_c_chrSchools()
 {
 	DBQueryResult res;
 	const char *q = "SELECT raceID, schoolID, schoolName, description, graphicID, chrSchools.corporationID, chrSchools.agentID, newAgentID, iconID FROM chrSchools LEFT JOIN agtAgents USING (corporationID) GROUP BY schoolID";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.schools': %s", res.error.c_str());
 		return NULL;
@@ -902,7 +1071,7 @@ PyRep *ObjCacheDB::Generate_c_chrAttributes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT attributeID, attributeName, description, iconID, iconID as graphicID, shortDescription, notes FROM chrAttributes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.attributes': %s", res.error.c_str());
 		return NULL;
@@ -914,7 +1083,7 @@ PyRep *ObjCacheDB::Generate_bl_accessories()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, accessoryID FROM chrBLAccessories";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_accessories': %s", res.error.c_str());
 		return NULL;
@@ -926,7 +1095,7 @@ PyRep *ObjCacheDB::Generate_bl_lights()
 {
 	DBQueryResult res;
 	const char *q = "SELECT lightID, lightName FROM chrBLLights";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_lights': %s", res.error.c_str());
 		return NULL;
@@ -938,7 +1107,7 @@ PyRep *ObjCacheDB::Generate_bl_skins()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, skinID FROM chrBLSkins";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_skins': %s", res.error.c_str());
 		return NULL;
@@ -950,7 +1119,7 @@ PyRep *ObjCacheDB::Generate_bl_beards()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, beardID FROM chrBLBeards";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_beards': %s", res.error.c_str());
 		return NULL;
@@ -962,7 +1131,7 @@ PyRep *ObjCacheDB::Generate_bl_eyes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, eyesID FROM chrBLEyes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_eyes': %s", res.error.c_str());
 		return NULL;
@@ -974,7 +1143,7 @@ PyRep *ObjCacheDB::Generate_bl_lipsticks()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, lipstickID FROM chrBLLipsticks";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_lipsticks': %s", res.error.c_str());
 		return NULL;
@@ -986,7 +1155,7 @@ PyRep *ObjCacheDB::Generate_bl_makeups()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, makeupID FROM chrBLMakeups";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_makeups': %s", res.error.c_str());
 		return NULL;
@@ -998,7 +1167,7 @@ PyRep *ObjCacheDB::Generate_bl_hairs()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, hairID FROM chrBLHairs";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_hairs': %s", res.error.c_str());
 		return NULL;
@@ -1010,7 +1179,7 @@ PyRep *ObjCacheDB::Generate_bl_backgrounds()
 {
 	DBQueryResult res;
 	const char *q = "SELECT backgroundID, backgroundName FROM chrBLBackgrounds";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_backgrounds': %s", res.error.c_str());
 		return NULL;
@@ -1022,7 +1191,7 @@ PyRep *ObjCacheDB::Generate_bl_decos()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, decoID FROM chrBLDecos";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_decos': %s", res.error.c_str());
 		return NULL;
@@ -1034,7 +1203,7 @@ PyRep *ObjCacheDB::Generate_bl_eyebrows()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, eyebrowsID FROM chrBLEyebrows";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_eyebrows': %s", res.error.c_str());
 		return NULL;
@@ -1046,7 +1215,7 @@ PyRep *ObjCacheDB::Generate_bl_costumes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT bloodlineID, gender, costumeID FROM chrBLCostumes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.bl_costumes': %s", res.error.c_str());
 		return NULL;
@@ -1058,7 +1227,7 @@ PyRep *ObjCacheDB::Generate_a_eyebrows()
 {
 	DBQueryResult res;
 	const char *q = "SELECT eyebrowsID, eyebrowsName FROM chrEyebrows";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.eyebrows': %s", res.error.c_str());
 		return NULL;
@@ -1070,7 +1239,7 @@ PyRep *ObjCacheDB::Generate_a_eyes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT eyesID, eyesName FROM chrEyes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.eyes': %s", res.error.c_str());
 		return NULL;
@@ -1082,7 +1251,7 @@ PyRep *ObjCacheDB::Generate_a_decos()
 {
 	DBQueryResult res;
 	const char *q = "SELECT decoID, decoName FROM chrDecos";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.decos': %s", res.error.c_str());
 		return NULL;
@@ -1094,7 +1263,7 @@ PyRep *ObjCacheDB::Generate_a_hairs()
 {
 	DBQueryResult res;
 	const char *q = "SELECT hairID, hairName FROM chrHairs";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.hairs': %s", res.error.c_str());
 		return NULL;
@@ -1106,7 +1275,7 @@ PyRep *ObjCacheDB::Generate_a_backgrounds()
 {
 	DBQueryResult res;
 	const char *q = "SELECT backgroundID, backgroundName FROM chrBackgrounds";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.backgrounds': %s", res.error.c_str());
 		return NULL;
@@ -1118,7 +1287,7 @@ PyRep *ObjCacheDB::Generate_a_accessories()
 {
 	DBQueryResult res;
 	const char *q = "SELECT accessoryID, accessoryName FROM chrAccessories";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.accessories': %s", res.error.c_str());
 		return NULL;
@@ -1130,7 +1299,7 @@ PyRep *ObjCacheDB::Generate_a_lights()
 {
 	DBQueryResult res;
 	const char *q = "SELECT lightID, lightName FROM chrLights";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.lights': %s", res.error.c_str());
 		return NULL;
@@ -1142,7 +1311,7 @@ PyRep *ObjCacheDB::Generate_a_costumes()
 {
 	DBQueryResult res;
 	const char *q = "SELECT costumeID, costumeName FROM chrCostumes";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.costumes': %s", res.error.c_str());
 		return NULL;
@@ -1154,7 +1323,7 @@ PyRep *ObjCacheDB::Generate_a_makeups()
 {
 	DBQueryResult res;
 	const char *q = "SELECT makeupID, makeupName FROM chrMakeups";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.makeups': %s", res.error.c_str());
 		return NULL;
@@ -1166,7 +1335,7 @@ PyRep *ObjCacheDB::Generate_a_beards()
 {
 	DBQueryResult res;
 	const char *q = "SELECT beardID, beardName FROM chrBeards";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.beards': %s", res.error.c_str());
 		return NULL;
@@ -1178,7 +1347,7 @@ PyRep *ObjCacheDB::Generate_a_skins()
 {
 	DBQueryResult res;
 	const char *q = "SELECT skinID, skinName FROM chrSkins";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.skins': %s", res.error.c_str());
 		return NULL;
@@ -1190,7 +1359,7 @@ PyRep *ObjCacheDB::Generate_a_lipsticks()
 {
 	DBQueryResult res;
 	const char *q = "SELECT lipstickID, lipstickName FROM chrLipsticks";
-	if(sDatabase.RunQuery(res, q)==false)
+	if(sDatabase.RunQueryStream(res, q)==false)
 	{
 		_log(SERVICE__ERROR, "Error in query for cached object 'charCreationInfo.lipsticks': %s", res.error.c_str());
 		return NULL;
@@ -131,13 +131,28 @@ const uint32 ObjCacheService::CharCreateNewExtraCachableObjectCount = sizeof(Obj
 
 PyCallable_Make_InnerDispatcher(ObjCacheService)
 
+/// Number of objects listed in the prime report.
+static const size_t OBJCACHE_PRIME_REPORT_COUNT = 10;
+
 ObjCacheService::ObjCacheService(PyServiceMgr *mgr, const char *cacheDir)
 : PyService(mgr, "objectCaching"),
   m_dispatch(new Dispatcher(this)),
-  m_cacheDir(cacheDir)
+  m_cacheDir(cacheDir),
+  m_primeCritical(0),
+  m_primeNext(0),
+  m_primeWorkers(0),
+  m_primeMerged(0),
+  m_primeCriticalMerged(0),
+  m_primeStart(0),
+  m_primeThreads(0),
+  m_primeRefresh(false),
+  m_refreshTimer(0)
 {
 	_SetCallDispatcher(m_dispatch);
 
+	for(uint32 r = 0; r < hSetCount; r++)
+		m_hintSets[r] = NULL;
+
 	PyCallable_REG_CALL(ObjCacheService, GetCachableObject)
 
 	//register full name -> short key in m_cacheKeys
@@ -236,6 +251,9 @@ ObjCacheService::ObjCacheService(PyServiceMgr *mgr, const char *cacheDir)
 
 ObjCacheService::~ObjCacheService() {
 	delete m_dispatch;
+
+	for(uint32 r = 0; r < hSetCount; r++)
+		PySafeDecRef( m_hintSets[r] );
 }
 
 PyResult ObjCacheService::Handle_GetCachableObject(PyCallArgs &call) {
@@ -263,17 +281,431 @@ PyResult ObjCacheService::Handle_GetCachableObject(PyCallArgs &call) {
 	return result;
 }
 
-void ObjCacheService::PrimeCache()
+void ObjCacheService::PrimeCache(uint32 threads, bool background)
 {
+	m_primeStart = GetTickCount();
+	m_primeThreads = threads;
+	const uint64 peakBefore = GetPeakMemoryUsage();
+
+	// saved objects older than the last change of their tables get regenerated
+	m_db.GetTableChanges( m_tableChanges );
+
+	// whatever the pack holds is ready to be sent as it is
+	if(!m_cacheDir.empty() && 0 < m_cache.LoadPack( m_cacheDir )) {
+		CacheKeysMapConstItr cur, end;
+		cur = m_cacheKeys.begin();
+		end = m_cacheKeys.end();
+		for(; cur != end; cur++)
+		{
+			const uint64 timestamp = m_cache.GetCacheTimestamp( cur->first );
+			if(timestamp != 0 && _IsStale( cur->first, timestamp )) {
+				_log( SERVICE__CACHE, "Cached object '%s' in the pack is stale.", cur->first.c_str() );
+
+				PyString* str = new PyString( cur->first );
+				m_cache.InvalidateCache( str );
+				PyDecRef( str );
+			}
+		}
+	}
+
+	// the objects sent at login go first, so we may accept logins once they are done
+	std::set<std::string> queued;
+	for(uint32 r = 0; r < LoginCachableObjectCount; r++) {
+		if(m_cacheKeys.find(LoginCachableObjects[r]) != m_cacheKeys.end() && !m_cache.HaveCached(LoginCachableObjects[r])
+		   && queued.insert(LoginCachableObjects[r]).second)
+			m_primeQueue.push_back(LoginCachableObjects[r]);
+	}
+	m_primeCritical = m_primeQueue.size();
+
 	CacheKeysMapConstItr cur, end;
 	cur = m_cacheKeys.begin();
 	end = m_cacheKeys.end();
 	for(; cur != end; cur++)
     {
-		PyString* str = new PyString( cur->first );
-		_LoadCachableObject( str );
-        PyDecRef( str );
+		if(!m_cache.HaveCached(cur->first) && queued.insert(cur->first).second)
+			m_primeQueue.push_back(cur->first);
+	}
+
+	if(threads == 0) {
+		std::vector<std::string>::const_iterator cur, end;
+		cur = m_primeQueue.begin();
+		end = m_primeQueue.end();
+		for(; cur != end; cur++)
+		{
+			const uint32 start = GetTickCount();
+
+			PyString* str = new PyString( *cur );
+			_LoadCachableObject( str );
+			PyDecRef( str );
+
+			m_primeTimes.push_back( std::make_pair( GetTickCount() - start, *cur ) );
+		}
+
+		m_primeMerged = m_primeQueue.size();
+		m_primeCriticalMerged = m_primeCritical;
+	} else {
+		if(threads > m_primeQueue.size())
+			threads = (uint32)m_primeQueue.size();
+
+		sLog.Log( "ObjCacheService", "Priming %lu cached objects with %u threads.", m_primeQueue.size(), threads );
+
+		_StartPrimeWorkers( threads );
+
+		// merge whatever comes in until the login objects (or all of them) are there
+		while(true) {
+			_MergePrimed();
+
+			if(m_primeMerged == m_primeQueue.size())
+				break;
+			if(background && m_primeCriticalMerged == m_primeCritical) {
+				sLog.Log( "ObjCacheService", "Login objects primed in %u ms; priming %lu more in background.",
+				          GetTickCount() - m_primeStart, m_primeQueue.size() - m_primeMerged );
+				return;
+			}
+
+			Sleep( 10 );
+		}
+	}
+
+	// peak RSS is what the bulk queries cost us; compare before/after changes to the generators
+	sLog.Log( "ObjCacheService", "Primed %lu cached objects in %u ms; peak RSS %u MB -> %u MB.",
+	          m_primeQueue.size(), GetTickCount() - m_primeStart,
+	          (uint32)( peakBefore / ( 1024 * 1024 ) ), (uint32)( GetPeakMemoryUsage() / ( 1024 * 1024 ) ) );
+
+	_ReportPrime();
+	_SavePack();
+}
+
+void ObjCacheService::Process()
+{
+	if(m_primeMerged == m_primeQueue.size()) {
+		if(m_refreshTimer.Check())
+			_CheckTableChanges();
+		return;
+	}
+
+	_MergePrimed();
+
+	if(m_primeMerged == m_primeQueue.size()) {
+		if(m_primeRefresh) {
+			sLog.Log( "ObjCacheService", "Regenerated %lu stale cached objects in %u ms.", m_primeQueue.size(), GetTickCount() - m_primeStart );
+			m_primeTimes.clear();
+		} else {
+			sLog.Log( "ObjCacheService", "Primed %lu cached objects in %u ms.", m_primeQueue.size(), GetTickCount() - m_primeStart );
+			_ReportPrime();
+		}
+		_SavePack();
+	}
+}
+
+void ObjCacheService::SetRefreshInterval(uint32 seconds)
+{
+	if(seconds == 0)
+		m_refreshTimer.Disable();
+	else
+		m_refreshTimer.Start( seconds * 1000 );
+}
+
+size_t ObjCacheService::TableChanged(const char *table)
+{
+	m_db.MarkTableChanged( table );
+
+	// pick the change up on the next tick, whether polling is on or not
+	m_refreshTimer.Start( 1 );
+
+	const std::vector<std::string> *objects = m_db.GetTableObjects( table );
+	return ( objects == NULL ? 0 : objects->size() );
+}
+
+bool ObjCacheService::_IsStale(const std::string &objectID, uint64 timestamp) const
+{
+	const std::vector<std::string> *tables = m_db.GetObjectTables( objectID );
+	if(tables == NULL)
+		return false;
+
+	std::vector<std::string>::const_iterator cur, end;
+	cur = tables->begin();
+	end = tables->end();
+	for(; cur != end; cur++)
+	{
+		std::map<std::string, uint64>::const_iterator res = m_tableChanges.find( *cur );
+		if(res != m_tableChanges.end() && res->second > timestamp)
+			return true;
+	}
+
+	return false;
+}
+
+void ObjCacheService::_CheckTableChanges()
+{
+	std::map<std::string, uint64> changes;
+	if(!m_db.GetTableChanges( changes ))
+		return;
+
+	std::map<std::string, uint64>::const_iterator cur, end;
+	cur = changes.begin();
+	end = changes.end();
+	for(; cur != end; cur++)
+	{
+		uint64 &known = m_tableChanges[ cur->first ];
+		if(cur->second <= known)
+			continue;
+		known = cur->second;
+
+		// the owner and location names served by ConfigService come from these tables too
+		sConfigCache.TableChanged( cur->first.c_str() );
+
+		const std::vector<std::string> *objects = m_db.GetTableObjects( cur->first.c_str() );
+		if(objects == NULL)
+			continue;
+
+		std::vector<std::string>::const_iterator ocur, oend;
+		ocur = objects->begin();
+		oend = objects->end();
+		for(; ocur != oend; ocur++)
+		{
+			// objects nobody asked for yet are generated fresh on demand anyway
+			const uint64 timestamp = m_cache.GetCacheTimestamp( *ocur );
+			if(timestamp != 0 && timestamp < cur->second)
+				m_refreshPending.insert( *ocur );
+		}
+	}
+
+	if(!m_refreshPending.empty())
+		_StartRefresh();
+}
+
+void ObjCacheService::_StartRefresh()
+{
+	{
+		// the workers of the last batch may still be on their way out
+		MutexLock lock( m_primeLock );
+		if(m_primeWorkers != 0) {
+			m_refreshTimer.Start( 1 );
+			return;
+		}
 	}
+
+	m_primeQueue.assign( m_refreshPending.begin(), m_refreshPending.end() );
+	m_refreshPending.clear();
+
+	m_primeCritical = 0;
+	m_primeNext = 0;
+	m_primeMerged = 0;
+	m_primeCriticalMerged = 0;
+	m_primeStart = GetTickCount();
+	m_primeTimes.clear();
+	m_primeRefresh = true;
+
+	// always in background, the server is up already
+	const uint32 threads = std::max<uint32>( 1, std::min<uint32>( m_primeThreads, (uint32)m_primeQueue.size() ) );
+
+	sLog.Log( "ObjCacheService", "Regenerating %lu stale cached objects with %u threads.", m_primeQueue.size(), threads );
+
+	_StartPrimeWorkers( threads );
+}
+
+void ObjCacheService::_StartPrimeWorkers(uint32 threads)
+{
+	// Singleton<T>::get() does not lock, so the singletons the generators (RunQueryStream
+	// flushes the write queue) and the marshaler use are constructed here, before the workers race for them
+	MarshalStringTable::get();
+	DBWriteQueue::get();
+
+	m_primeWorkers = threads;
+	for(uint32 i = 0; i < threads; i++) {
+#ifdef WIN32
+		_beginthread( ObjCacheService::_PrimeLoop, 0, this );
+#else
+		pthread_t thread;
+		pthread_create( &thread, NULL, &ObjCacheService::_PrimeLoop, this );
+		pthread_detach( thread );
+#endif
+	}
+}
+
+thread_return_t ObjCacheService::_PrimeLoop(void *arg)
+{
+	ObjCacheService *service = reinterpret_cast<ObjCacheService *>( arg );
+	assert( service != NULL );
+
+	THREAD_RETURN( service->_PrimeLoop() );
+}
+
+thread_return_t ObjCacheService::_PrimeLoop()
+{
+	// a connection of our own, so the workers do not queue up on the shared one
+	DBerror err;
+	if(!sDatabase.OpenThreadConnection(err))
+		sLog.Error( "ObjCacheService", "Prime worker failed to open a database connection, using the shared one: %s", err.c_str() );
+
+	while(true) {
+		PrimedObject obj;
+		{
+			MutexLock lock( m_primeLock );
+
+			if(m_primeNext >= m_primeQueue.size())
+				break;
+
+			obj.index = m_primeNext++;
+			obj.objectID = m_primeQueue[ obj.index ];
+		}
+
+		_PrimeObject( obj.objectID, obj );
+
+		MutexLock lock( m_primeLock );
+		m_primed.push_back( obj );
+	}
+
+	sDatabase.CloseThreadConnection();
+
+	MutexLock lock( m_primeLock );
+	--m_primeWorkers;
+
+	THREAD_RETURN( NULL );
+}
+
+void ObjCacheService::_PrimeObject(const std::string &objectID, PrimedObject &into)
+{
+	/*
+	 * Runs on a worker thread: everything here must stay away from m_cache and
+	 * from PyReps anybody else can see. The objects are built, marshaled and
+	 * deflated privately; only the resulting buffers are handed over.
+	 */
+	const uint32 start = GetTickCount();
+
+	into.data = NULL;
+	into.timestamp = 0;
+	into.version = 0;
+	into.deflated = false;
+	into.fromFile = false;
+
+	CacheFileHeader header;
+	if(!m_cacheDir.empty() && CachedObjectMgr::ReadCacheFile( m_cacheDir, objectID, header, &into.data )) {
+		if(_IsStale( objectID, header.timestamp )) {
+			SafeDelete( into.data );
+		} else {
+			into.timestamp = header.timestamp;
+			into.version = header.version;
+			into.fromFile = true;
+		}
+	}
+
+	if(into.data == NULL) {
+		// taken before the queries run, so a change made meanwhile leaves the object stale
+		const uint64 timestamp = Win32TimeNow();
+
+		// if the generator fails, the main thread falls back to the old cache files
+		PyRep *cache = m_db.GetCachableObject( objectID );
+		if(cache != NULL) {
+			into.data = new Buffer;
+			const bool res = MarshalDeflate( cache, *into.data );
+			PyDecRef( cache );
+
+			if(res) {
+				into.timestamp = timestamp;
+				into.version = CRC32::Generate( &( *into.data )[0], into.data->size() );
+
+				if(!m_cacheDir.empty()) {
+					header.timestamp = into.timestamp;
+					header.version = into.version;
+					header.length = (uint32)into.data->size();
+					header.magic = CacheFileMagic;
+
+					if(!CachedObjectMgr::WriteCacheFile( m_cacheDir, objectID, header, *into.data ))
+						sLog.Error( "ObjCacheService", "Failed to save cache file for '%s' in '%s'", objectID.c_str(), m_cacheDir.c_str() );
+				}
+			} else {
+				sLog.Error( "ObjCacheService", "Failed to marshal or deflate cached object '%s'.", objectID.c_str() );
+				SafeDelete( into.data );
+			}
+		}
+	}
+
+	// the stream starts with MarshalHeaderByte unless MarshalDeflate has deflated it; that holds for the cache files too
+	if(into.data != NULL && 0 < into.data->size())
+		into.deflated = IsDeflated( *into.data );
+
+	into.time = GetTickCount() - start;
+}
+
+void ObjCacheService::_MergePrimed()
+{
+	std::vector<PrimedObject> primed;
+	{
+		MutexLock lock( m_primeLock );
+		primed.swap( m_primed );
+	}
+
+	std::vector<PrimedObject>::iterator cur, end;
+	cur = primed.begin();
+	end = primed.end();
+	for(; cur != end; cur++)
+	{
+		if(cur->data != NULL) {
+			PyString* str = new PyString( cur->objectID );
+
+			// a refresh replaces the stale object; otherwise the main thread may have built it on demand meanwhile, and that one stays
+			if(m_primeRefresh && m_cache.GetCacheTimestamp( cur->objectID ) < cur->timestamp) {
+				m_cache.InvalidateCache( str );
+				_InvalidateHintSets( str );
+			}
+
+			if(m_cache.AddCache( cur->objectID, &cur->data, cur->timestamp, cur->version, cur->deflated ))
+				_log( SERVICE__CACHE, "%s cached object '%s' in %u ms.", ( cur->fromFile ? "Loaded" : "Generated" ), cur->objectID.c_str(), cur->time );
+
+			PyDecRef( str );
+		} else {
+			// retry the old way, which includes falling back to the CCP cache files
+			const uint32 start = GetTickCount();
+
+			PyString* str = new PyString( cur->objectID );
+			_LoadCachableObject( str );
+			PyDecRef( str );
+
+			cur->time += GetTickCount() - start;
+		}
+
+		m_primeTimes.push_back( std::make_pair( cur->time, cur->objectID ) );
+
+		++m_primeMerged;
+		if(cur->index < m_primeCritical)
+			++m_primeCriticalMerged;
+	}
+}
+
+void ObjCacheService::_ReportPrime()
+{
+	std::sort( m_primeTimes.begin(), m_primeTimes.end() );
+
+	uint32 total = 0;
+	std::vector<std::pair<uint32, std::string> >::const_reverse_iterator cur, end;
+	cur = m_primeTimes.rbegin();
+	end = m_primeTimes.rend();
+	for(size_t i = 0; cur != end; cur++, i++)
+	{
+		total += cur->first;
+
+		if(i < OBJCACHE_PRIME_REPORT_COUNT)
+			sLog.Log( "ObjCacheService", "    %6u ms  %s", cur->first, cur->second.c_str() );
+		else
+			_log( SERVICE__CACHE, "    %6u ms  %s", cur->first, cur->second.c_str() );
+	}
+
+	sLog.Log( "ObjCacheService", "Sum of per-object prime times: %u ms (slowest %lu listed above).",
+	          total, std::min( m_primeTimes.size(), OBJCACHE_PRIME_REPORT_COUNT ) );
+
+	m_primeTimes.clear();
+}
+
+void ObjCacheService::_SavePack()
+{
+	// nothing new if everything came from the pack
+	if(m_cacheDir.empty() || m_primeQueue.empty())
+		return;
+
+	if(!m_cache.SavePack( m_cacheDir ))
+		sLog.Error( "ObjCacheService", "Failed to save the cached object pack in '%s'.", m_cacheDir.c_str() );
 }
 
 PySubStream* ObjCacheService::LoadCachedFile(const char *filename, const char *oname)
@@ -293,8 +725,14 @@ bool ObjCacheService::_LoadCachableObject(const PyRep *objectID) {
     {
 		if( m_cache.LoadCachedFromFile( m_cacheDir, objectID ) )
         {
-			_log( SERVICE__CACHE, "Loaded cached object '%s' from file.", objectID_string.c_str() );
-			return true;
+			if( !_IsStale( objectID_string, m_cache.GetCacheTimestamp( objectID_string ) ) )
+			{
+				_log( SERVICE__CACHE, "Loaded cached object '%s' from file.", objectID_string.c_str() );
+				return true;
+			}
+
+			_log( SERVICE__CACHE, "Cached object '%s' in file is stale, regenerating it.", objectID_string.c_str() );
+			m_cache.InvalidateCache( objectID );
 		}
 	}
 	
@@ -343,9 +781,9 @@ PyRep *ObjCacheService::GetCacheHint(const PyRep* objectID) {
 	return(cache_hint);
 }
 
-void ObjCacheService::InsertCacheHints(hintSet hset, PyDict *into) {
-	const char *const *objects = NULL;
-	uint32 object_count = 0;
+void ObjCacheService::_GetHintSet(hintSet hset, const char *const *&objects, uint32 &object_count) {
+	objects = NULL;
+	object_count = 0;
 	switch(hset) {
 	case hLoginCachables:
 		objects = LoginCachableObjects;
@@ -363,28 +801,78 @@ void ObjCacheService::InsertCacheHints(hintSet hset, PyDict *into) {
 		objects = CharCreateNewExtraCachableObjects;
 		object_count = CharCreateNewExtraCachableObjectCount;
 		break;
+	default:
+		break;
 	}
-	if(objects == NULL)
-		return;
-	uint32 r;
-	std::map<std::string, std::string>::const_iterator res;
-	for(r = 0; r < object_count; r++) {
-		//find the dict key to use for this object
-		res = m_cacheKeys.find(objects[r]);
-		if(res == m_cacheKeys.end()) {
-			_log(SERVICE__ERROR, "Unable to find cache key for object ID '%s', skipping.", objects[r]);
-			continue;
+}
+
+PyDict *ObjCacheService::GetCacheHints(hintSet hset) {
+	if(hset >= hSetCount)
+		return new PyDict();
+
+	if(m_hintSets[hset] == NULL) {
+		const char *const *objects;
+		uint32 object_count;
+		_GetHintSet(hset, objects, object_count);
+
+		PyDict *hints = new PyDict();
+		bool complete = true;
+
+		uint32 r;
+		std::map<std::string, std::string>::const_iterator res;
+		for(r = 0; r < object_count; r++) {
+			//find the dict key to use for this object
+			res = m_cacheKeys.find(objects[r]);
+			if(res == m_cacheKeys.end()) {
+				_log(SERVICE__ERROR, "Unable to find cache key for object ID '%s', skipping.", objects[r]);
+				continue;
+			}
+
+			//get the hint
+			PyString* str = new PyString( objects[r] );
+			PyRep *cache_hint = GetCacheHint( str );
+			PyDecRef( str );
+
+			if(cache_hint == NULL) {
+				complete = false;
+				continue;	//print already done.
+			}
+
+			hints->SetItemString(res->second.c_str(), cache_hint);
 		}
 
-		//get the hint
-        PyString* str = new PyString( objects[r] );
-		PyRep *cache_hint = GetCacheHint( str );
-        PyDecRef( str );
+		// a set with holes is built anew next time, the objects may load by then
+		if(!complete)
+			return hints;
 
-		if(cache_hint == NULL)
-			continue;	//print already done.
+		m_hintSets[hset] = hints;
+	}
+
+	PyIncRef( m_hintSets[hset] );
+	return m_hintSets[hset];
+}
+
+void ObjCacheService::_InvalidateHintSets(const PyRep *objectID) {
+	if(!objectID->IsString())
+		return;
+
+	const std::string &str = objectID->AsString()->content();
+	for(uint32 s = 0; s < hSetCount; s++) {
+		if(m_hintSets[s] == NULL)
+			continue;
 
-		into->SetItemString(res->second.c_str(), cache_hint);
+		const char *const *objects;
+		uint32 object_count;
+		_GetHintSet((hintSet)s, objects, object_count);
+
+		for(uint32 r = 0; r < object_count; r++) {
+			if(str == objects[r]) {
+				// callers may still hold the old dict; it stays valid until they let go
+				PyDecRef( m_hintSets[s] );
+				m_hintSets[s] = NULL;
+				break;
+			}
+		}
 	}
 }
 
@@ -394,11 +882,13 @@ bool ObjCacheService::IsCacheLoaded(const PyRep *objectID) const {
 
 void ObjCacheService::InvalidateCache(const PyRep *objectID) {
 	m_cache.InvalidateCache(objectID);
+	_InvalidateHintSets(objectID);
 }
 
 void ObjCacheService::GiveCache(const PyRep *objectID, PyRep **contents) {
 	//contents is consumed.
 	m_cache.UpdateCache(objectID, contents);
+	_InvalidateHintSets(objectID);
 }
 
 PyObject *ObjCacheService::MakeObjectCachedMethodCallResult(const PyRep *objectID, const char *versionCheck) {
@@ -115,20 +115,15 @@ PyResult CharUnboundMgrService::Handle_GetCharacterInfo(PyCallArgs &call) {
 }
 
 PyResult CharUnboundMgrService::Handle_GetCharCreationInfo(PyCallArgs &call) {
-	PyDict *result = new PyDict();
-
 	//send all the cache hints needed for char creation.
-	m_manager->cache_service->InsertCacheHints(
-		ObjCacheService::hCharCreateCachables,
-		result);
+	PyDict *result = m_manager->cache_service->GetCacheHints(ObjCacheService::hCharCreateCachables);
 	_log(CLIENT__MESSAGE, "Sending char creation info reply");
 
 	return result;
 }
 
 PyResult CharUnboundMgrService::Handle_GetCharNewExtraCreationInfo(PyCallArgs &call) {
-	PyDict *result = new PyDict();
-	m_manager->cache_service->InsertCacheHints(ObjCacheService::hCharCreateNewExtraCachables, result);
+	PyDict *result = m_manager->cache_service->GetCacheHints(ObjCacheService::hCharCreateNewExtraCachables);
 	_log(CLIENT__MESSAGE, "Sending char new extra creation info reply");
 	return result;
 }
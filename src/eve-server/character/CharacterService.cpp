@@ -111,12 +111,8 @@ PyResult CharacterService::Handle_GetOwnerNoteLabels(PyCallArgs &call) {
 }
 
 PyResult CharacterService::Handle_GetCharCreationInfo(PyCallArgs &call) {
-    PyDict *result = new PyDict();
-
     //send all the cache hints needed for char creation.
-    m_manager->cache_service->InsertCacheHints(
-        ObjCacheService::hCharCreateCachables,
-        result);
+    PyDict *result = m_manager->cache_service->GetCacheHints(ObjCacheService::hCharCreateCachables);
     _log(CLIENT__MESSAGE, "Sending char creation info reply");
 
     return result;
@@ -129,12 +125,8 @@ PyResult CharacterService::Handle_GetCharNewExtraCreationInfo(PyCallArgs &call)
 }
 
 PyResult CharacterService::Handle_GetAppearanceInfo(PyCallArgs &call) {
-    PyDict *result = new PyDict();
-
     //send all the cache hints needed for char creation.
-    m_manager->cache_service->InsertCacheHints(
-        ObjCacheService::hAppearanceCachables,
-        result );
+    PyDict *result = m_manager->cache_service->GetCacheHints(ObjCacheService::hAppearanceCachables);
 
     _log(CLIENT__MESSAGE, "Sending appearance info reply");
 
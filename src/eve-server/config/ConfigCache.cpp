@@ -0,0 +1,436 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+/// How long IDs which were not found stay cached.
+static const uint64 CONFIG_CACHE_NEGATIVE_TTL = 5 * Win32Time_Minute;
+/// How long rows stay cached; they are read again after that.
+static const uint64 CONFIG_CACHE_TTL = Win32Time_Hour;
+/// Entries of one kind above which expired ones are dropped, and then the oldest IDs.
+static const size_t CONFIG_CACHE_MAX_ENTRIES = 100000;
+
+/************************************************************************/
+/* ConfigCache                                                          */
+/************************************************************************/
+ConfigCache::ConfigCache()
+{
+    static const char* const ownerColumns[] = { "ownerID", "ownerName", "typeID", NULL };
+    static const char* const locationColumns[] = { "locationID", "locationName", "x", "y", "z", NULL };
+    static const char* const allianceColumns[] = { "allianceID", "shortName", NULL };
+    static const char* const tickerColumns[] = { "corporationID", "tickerName", "shape1", "shape2", "shape3", "color1", "color2", "color3", NULL };
+
+    static const char* const* const columns[ KindCount ] = { ownerColumns, locationColumns, allianceColumns, tickerColumns };
+    static const FetchMethod fetch[ KindCount ] =
+    {
+        &ConfigDB::GetOwnerLines,
+        &ConfigDB::GetLocationLines,
+        &ConfigDB::GetAllianceShortNameLines,
+        &ConfigDB::GetCorpTickerNameLines
+    };
+    static const char* const tables[ KindCount ][ 4 ] =
+    {
+        { "entity", "evestaticowners", "character_", NULL },
+        { "entity", "mapdenormalize", NULL, NULL },
+        { "entity", NULL, NULL, NULL },
+        { "corporation", NULL, NULL, NULL }
+    };
+
+    for( size_t i = 0; i < KindCount; ++i )
+    {
+        Table& table = mTables[ i ];
+
+        size_t count = 0;
+        while( NULL != columns[ i ][ count ] )
+            ++count;
+
+        table.header = new PyList( count );
+        for( size_t c = 0; c < count; ++c )
+            table.header->SetItemString( c, columns[ i ][ c ] );
+
+        table.fetch = fetch[ i ];
+        for( size_t t = 0; t < 4; ++t )
+            table.tables[ t ] = tables[ i ][ t ];
+
+        table.negativeEntries = 0;
+        table.hits = 0;
+        table.misses = 0;
+        table.queriesSaved = 0;
+        table.queries = 0;
+    }
+}
+
+ConfigCache::~ConfigCache()
+{
+    for( size_t i = 0; i < KindCount; ++i )
+    {
+        _Clear( mTables[ i ] );
+        PyDecRef( mTables[ i ].header );
+    }
+}
+
+PyRep* ConfigCache::GetMultiOwnersEx( const std::vector<int32>& ids )
+{
+    std::vector<PyList*> lines;
+    if( !_Lookup( KindOwners, ids, lines ) )
+        return NULL;
+
+    return _BuildTupleSet( KindOwners, lines );
+}
+
+PyRep* ConfigCache::GetMultiLocationsEx( const std::vector<int32>& ids )
+{
+    std::vector<PyList*> lines;
+    if( !_Lookup( KindLocations, ids, lines ) )
+        return NULL;
+
+    return _BuildTupleSet( KindLocations, lines );
+}
+
+PyRep* ConfigCache::GetMultiAllianceShortNamesEx( const std::vector<int32>& ids )
+{
+    std::vector<PyList*> lines;
+    if( !_Lookup( KindAllianceShortNames, ids, lines ) )
+        return NULL;
+
+    return _BuildTupleSet( KindAllianceShortNames, lines );
+}
+
+PyRep* ConfigCache::GetMultiCorpTickerNamesEx( const std::vector<int32>& ids )
+{
+    std::vector<PyList*> lines;
+    if( !_Lookup( KindCorpTickerNames, ids, lines ) )
+        return NULL;
+
+    return _BuildRowList( KindCorpTickerNames, lines );
+}
+
+void ConfigCache::Invalidate( uint32 itemID )
+{
+    MutexLock lock( mMutex );
+
+    for( size_t i = 0; i < KindCount; ++i )
+        _Erase( mTables[ i ], (int32)itemID );
+}
+
+void ConfigCache::Rename( uint32 itemID, const std::string& name )
+{
+    MutexLock lock( mMutex );
+
+    // the name is the second column of both; lines handed out may still be in use, so replace them
+    static const Kind renamed[] = { KindOwners, KindLocations };
+    for( size_t i = 0; i < sizeof( renamed ) / sizeof( Kind ); ++i )
+    {
+        Table& table = mTables[ renamed[ i ] ];
+
+        EntryMap::iterator res = table.entries.find( (int32)itemID );
+        if( res == table.entries.end() || NULL == res->second.line )
+            continue;
+
+        PyList* old = res->second.line;
+        PyList* line = new PyList( old->size() );
+        for( size_t c = 0; c < old->size(); ++c )
+        {
+            if( 1 == c )
+                line->SetItem( c, new PyString( name ) );
+            else
+            {
+                PyIncRef( old->GetItem( c ) );
+                line->SetItem( c, old->GetItem( c ) );
+            }
+        }
+
+        res->second.line = line;
+        PyDecRef( old );
+    }
+
+    _Erase( mTables[ KindAllianceShortNames ], (int32)itemID );
+    _Erase( mTables[ KindCorpTickerNames ], (int32)itemID );
+}
+
+void ConfigCache::InvalidateCorporation( uint32 corpID )
+{
+    MutexLock lock( mMutex );
+
+    _Erase( mTables[ KindOwners ], (int32)corpID );
+    _Erase( mTables[ KindCorpTickerNames ], (int32)corpID );
+}
+
+size_t ConfigCache::TableChanged( const char* table )
+{
+    std::string name( table );
+    for( size_t i = 0; i < name.size(); ++i )
+        name[ i ] = tolower( name[ i ] );
+
+    MutexLock lock( mMutex );
+
+    size_t flushed = 0;
+    for( size_t i = 0; i < KindCount; ++i )
+    {
+        Table& t = mTables[ i ];
+
+        for( size_t j = 0; j < 4 && NULL != t.tables[ j ]; ++j )
+        {
+            if( name == t.tables[ j ] )
+            {
+                _Clear( t );
+                ++flushed;
+                break;
+            }
+        }
+    }
+
+    return flushed;
+}
+
+void ConfigCache::Clear()
+{
+    MutexLock lock( mMutex );
+
+    for( size_t i = 0; i < KindCount; ++i )
+        _Clear( mTables[ i ] );
+}
+
+void ConfigCache::GetStats( Kind kind, Stats& into ) const
+{
+    MutexLock lock( mMutex );
+
+    const Table& table = mTables[ kind ];
+
+    into.entries = (uint32)table.entries.size() - table.negativeEntries;
+    into.negativeEntries = table.negativeEntries;
+    into.hits = table.hits;
+    into.misses = table.misses;
+    into.queriesSaved = table.queriesSaved;
+    into.queries = table.queries;
+}
+
+const char* ConfigCache::GetKindName( Kind kind )
+{
+    switch( kind )
+    {
+        case KindOwners:             return "owners";
+        case KindLocations:          return "locations";
+        case KindAllianceShortNames: return "alliance short names";
+        case KindCorpTickerNames:    return "corp tickers";
+        default:                     return "unknown";
+    }
+}
+
+bool ConfigCache::_Lookup( Kind kind, const std::vector<int32>& ids, std::vector<PyList*>& lines )
+{
+    MutexLock lock( mMutex );
+
+    Table& table = mTables[ kind ];
+    const uint64 now = Win32TimeNow();
+
+    std::vector<int32> missing;
+    std::set<int32> seen;
+
+    std::vector<int32>::const_iterator cur, end;
+    cur = ids.begin();
+    end = ids.end();
+    for(; cur != end; ++cur )
+    {
+        if( !seen.insert( *cur ).second )
+            continue;
+
+        EntryMap::iterator res = table.entries.find( *cur );
+        if( res != table.entries.end() )
+        {
+            Entry& entry = res->second;
+
+            if( now < entry.expires )
+            {
+                if( NULL != entry.line )
+                {
+                    PyIncRef( entry.line );
+                    lines.push_back( entry.line );
+                }
+
+                ++table.hits;
+                continue;
+            }
+
+            _Erase( table, *cur );
+        }
+
+        missing.push_back( *cur );
+        ++table.misses;
+    }
+
+    if( missing.empty() )
+    {
+        ++table.queriesSaved;
+        return true;
+    }
+
+    // one batch for all misses of this call
+    std::map<int32, PyList*> found;
+    ++table.queries;
+    if( !( mDB.*table.fetch )( missing, found ) )
+    {
+        std::map<int32, PyList*>::iterator fcur, fend;
+        fcur = found.begin();
+        fend = found.end();
+        for(; fcur != fend; ++fcur )
+            PyDecRef( fcur->second );
+
+        return false;
+    }
+
+    cur = missing.begin();
+    end = missing.end();
+    for(; cur != end; ++cur )
+    {
+        std::map<int32, PyList*>::iterator res = found.find( *cur );
+        PyList* line = ( res != found.end() ? res->second : NULL );
+
+        if( NULL != line )
+            lines.push_back( line );
+
+        if( !_IsCachable( kind, *cur ) )
+            continue;
+
+        Entry& entry = table.entries[ *cur ];
+        entry.line = line;
+
+        if( NULL != line )
+        {
+            entry.expires = now + CONFIG_CACHE_TTL;
+            PyIncRef( line );
+        }
+        else
+        {
+            entry.expires = now + CONFIG_CACHE_NEGATIVE_TTL;
+            ++table.negativeEntries;
+        }
+    }
+
+    if( CONFIG_CACHE_MAX_ENTRIES < table.entries.size() )
+        _Trim( table, now );
+
+    return true;
+}
+
+bool ConfigCache::_IsCachable( Kind kind, int32 id )
+{
+    // positions of non-static items change all the time
+    if( KindLocations == kind )
+        return IsStaticMapItem( id );
+
+    return true;
+}
+
+void ConfigCache::_Erase( Table& table, int32 id )
+{
+    EntryMap::iterator res = table.entries.find( id );
+    if( res == table.entries.end() )
+        return;
+
+    if( NULL == res->second.line )
+        --table.negativeEntries;
+    else
+        PyDecRef( res->second.line );
+
+    table.entries.erase( res );
+}
+
+void ConfigCache::_Trim( Table& table, uint64 now )
+{
+    EntryMap::iterator cur = table.entries.begin();
+    while( cur != table.entries.end() )
+    {
+        if( now < cur->second.expires )
+        {
+            ++cur;
+            continue;
+        }
+
+        if( NULL == cur->second.line )
+            --table.negativeEntries;
+        else
+            PyDecRef( cur->second.line );
+
+        table.entries.erase( cur++ );
+    }
+
+    // still full of live rows; make room for a while by dropping the lowest IDs
+    while( CONFIG_CACHE_MAX_ENTRIES * 3 / 4 < table.entries.size() )
+        _Erase( table, table.entries.begin()->first );
+}
+
+void ConfigCache::_Clear( Table& table )
+{
+    EntryMap::iterator cur, end;
+    cur = table.entries.begin();
+    end = table.entries.end();
+    for(; cur != end; ++cur )
+        PySafeDecRef( cur->second.line );
+
+    table.entries.clear();
+    table.negativeEntries = 0;
+}
+
+PyTuple* ConfigCache::_BuildTupleSet( Kind kind, const std::vector<PyList*>& lines )
+{
+    PyList* header = mTables[ kind ].header;
+    PyIncRef( header );
+
+    PyList* rows = new PyList( lines.size() );
+    for( size_t i = 0; i < lines.size(); ++i )
+        rows->SetItem( i, lines[ i ] );
+
+    PyTuple* res = new PyTuple( 2 );
+    res->SetItem( 0, header );
+    res->SetItem( 1, rows );
+
+    return res;
+}
+
+PyTuple* ConfigCache::_BuildRowList( Kind kind, const std::vector<PyList*>& lines )
+{
+    PyList* header = mTables[ kind ].header;
+
+    PyList* rows = new PyList( lines.size() );
+    for( size_t i = 0; i < lines.size(); ++i )
+    {
+        PyDict* args = new PyDict();
+
+        PyIncRef( header );
+        args->SetItemString( "header", header );
+        args->SetItemString( "line", lines[ i ] );
+
+        rows->SetItem( i, new PyObject( new PyString( "util.Row" ), args ) );
+    }
+
+    PyIncRef( header );
+
+    PyTuple* res = new PyTuple( 2 );
+    res->SetItem( 0, header );
+    res->SetItem( 1, rows );
+
+    return res;
+}
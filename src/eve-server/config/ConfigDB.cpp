@@ -25,12 +25,10 @@
 
 #include "EVEServerPCH.h"
 
-PyRep *ConfigDB::GetMultiOwnersEx(const std::vector<int32> &entityIDs) {
+bool ConfigDB::GetOwnerLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into) {
 #ifndef WIN32
 #warning we need to deal with corporations!
 #endif
-    //im not sure how this query is supposed to work, as far as what table
-    //we use to get the fields from.
     //we only get called for items which are not already sent in the
     // eveStaticOwners cachable object.
 
@@ -38,7 +36,6 @@ PyRep *ConfigDB::GetMultiOwnersEx(const std::vector<int32> &entityIDs) {
     ListToINString(entityIDs, ids, "-1");
 
     DBQueryResult res;
-    DBResultRow row;
 
     if(!sDatabase.RunQuery(res,
         "SELECT "
@@ -49,46 +46,55 @@ PyRep *ConfigDB::GetMultiOwnersEx(const std::vector<int32> &entityIDs) {
         " WHERE itemID in (%s)", ids.c_str()))
     {
         codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        return false;
     }
+    _AddLines(res, into);
 
-    //this is pretty hackish... will NOT work if they mix things...
-    //this was only put in to deal with "new" statics, like corporations.
-    if(!res.GetRow(row)) {
-        if(!sDatabase.RunQuery(res,
-            "SELECT "
-            " ownerID,ownerName,typeID"
-            " FROM eveStaticOwners "
-            " WHERE ownerID in (%s)", ids.c_str()))
-        {
-            codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
-        }
-    } else {
-        res.Reset();
+    //"new" statics, like corporations, may not be in entity.
+    std::vector<int32> missing;
+    _GetMissing(entityIDs, into, missing);
+    if(missing.empty())
+        return true;
+
+    ids.clear();
+    ListToINString(missing, ids, "-1");
+
+    if(!sDatabase.RunQuery(res,
+        "SELECT "
+        " ownerID,ownerName,typeID"
+        " FROM eveStaticOwners "
+        " WHERE ownerID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
+        return false;
+    }
+    _AddLines(res, into);
+
+    _GetMissing(entityIDs, into, missing);
+    if(missing.empty())
+        return true;
+
+    ids.clear();
+    ListToINString(missing, ids, "-1");
+
+    if(!sDatabase.RunQuery(res,
+        "SELECT "
+        " characterID as ownerID,"
+        " itemName as ownerName,"
+        " typeID"
+        " FROM character_ "
+        " LEFT JOIN entity ON characterID = itemID"
+        " WHERE characterID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
+        return false;
     }
+    _AddLines(res, into);
 
-	if(!res.GetRow(row)) {
-		if(!sDatabase.RunQuery(res,
-			"SELECT "
-			" characterID as ownerID,"
-			" itemName as ownerName,"
-			" typeID"
-			" FROM character_ "
-			" LEFT JOIN entity ON characterID = itemID"
-			" WHERE characterID in (%s)", ids.c_str()))
-		{
-			codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-			return NULL;
-		}
-	} else {
-		res.Reset();
-	}
-
-    return(DBResultToTupleSet(res));
+    return true;
 }
 
-PyRep *ConfigDB::GetMultiAllianceShortNamesEx(const std::vector<int32> &entityIDs) {
+bool ConfigDB::GetAllianceShortNameLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into) {
 
     //im not sure how this query is supposed to work, as far as what table
     //we use to get the fields from.
@@ -110,32 +116,34 @@ PyRep *ConfigDB::GetMultiAllianceShortNamesEx(const std::vector<int32> &entityID
         ))
     {
         codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        return false;
     }
+    _AddLines(res, into);
 
-    return(DBResultToTupleSet(res));
+    return true;
 }
 
 
-PyRep *ConfigDB::GetMultiLocationsEx(const std::vector<int32> &entityIDs) {
-
-    //im not sure how this query is supposed to work, as far as what table
-    //we use to get the fields from.
+bool ConfigDB::GetLocationLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into) {
 
-    bool use_map = false;
-    if(!entityIDs.empty()) {
-        //this is a big of a hack at this point... basically
-        //we are assuming that they only query locations for map items
-        // and non-map items disjointly....
-        use_map = IsStaticMapItem(entityIDs[0]);
+    //static map items come from mapDenormalize, the rest from entity.
+    std::vector<int32> mapIDs, entityOnlyIDs;
+    std::vector<int32>::const_iterator cur, end;
+    cur = entityIDs.begin();
+    end = entityIDs.end();
+    for(; cur != end; ++cur) {
+        if(IsStaticMapItem(*cur))
+            mapIDs.push_back(*cur);
+        else
+            entityOnlyIDs.push_back(*cur);
     }
 
     std::string ids;
-    ListToINString(entityIDs, ids, "-1");
-
     DBQueryResult res;
 
-    if(use_map) {
+    if(!mapIDs.empty()) {
+        ListToINString(mapIDs, ids, "-1");
+
         if(!sDatabase.RunQuery(res,
             "SELECT "
             " mapDenormalize.itemID AS locationID,"
@@ -147,9 +155,15 @@ PyRep *ConfigDB::GetMultiLocationsEx(const std::vector<int32> &entityIDs) {
             " WHERE itemID in (%s)", ids.c_str()))
         {
             codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
+            return false;
         }
-    } else {
+        _AddLines(res, into);
+    }
+
+    if(!entityOnlyIDs.empty()) {
+        ids.clear();
+        ListToINString(entityOnlyIDs, ids, "-1");
+
         if(!sDatabase.RunQuery(res,
             "SELECT "
             " entity.itemID AS locationID,"
@@ -161,16 +175,16 @@ PyRep *ConfigDB::GetMultiLocationsEx(const std::vector<int32> &entityIDs) {
             " WHERE itemID in (%s)", ids.c_str()))
         {
             codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
+            return false;
         }
+        _AddLines(res, into);
     }
 
-    //return(DBResultToRowset(res));
-    return(DBResultToTupleSet(res));
+    return true;
 }
 
 
-PyRep *ConfigDB::GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs) {
+bool ConfigDB::GetCorpTickerNameLines(const std::vector<int32> &entityIDs, std::map<int32, PyList *> &into) {
 
     std::string ids;
     ListToINString(entityIDs, ids, "-1");
@@ -186,10 +200,38 @@ PyRep *ConfigDB::GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs)
         " WHERE corporationID in (%s)", ids.c_str()))
     {
         codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        return false;
     }
+    _AddLines(res, into);
 
-    return(DBResultToRowList(res));
+    return true;
+}
+
+void ConfigDB::_AddLines(DBQueryResult &res, std::map<int32, PyList *> &into) {
+    const uint32 cc = res.ColumnCount();
+
+    DBResultRow row;
+    while(res.GetRow(row)) {
+        PyList *&line = into[row.GetInt(0)];
+        if(line != NULL)
+            continue;   //first source wins
+
+        line = new PyList(cc);
+        for(uint32 r = 0; r < cc; r++)
+            line->SetItem(r, DBColumnToPyRep(row, r));
+    }
+}
+
+void ConfigDB::_GetMissing(const std::vector<int32> &entityIDs, const std::map<int32, PyList *> &lines, std::vector<int32> &into) {
+    into.clear();
+
+    std::vector<int32>::const_iterator cur, end;
+    cur = entityIDs.begin();
+    end = entityIDs.end();
+    for(; cur != end; ++cur) {
+        if(lines.find(*cur) == lines.end())
+            into.push_back(*cur);
+    }
 }
 
 
@@ -59,7 +59,7 @@ PyResult ConfigService::Handle_GetMultiOwnersEx(PyCallArgs &call) {
 		return NULL;
 	}
 
-	return(m_db.GetMultiOwnersEx(arg.ints));
+	return(sConfigCache.GetMultiOwnersEx(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiAllianceShortNamesEx(PyCallArgs &call) {
@@ -70,7 +70,7 @@ PyResult ConfigService::Handle_GetMultiAllianceShortNamesEx(PyCallArgs &call) {
 		return NULL;
 	}
 
-	return(m_db.GetMultiAllianceShortNamesEx(arg.ints));
+	return(sConfigCache.GetMultiAllianceShortNamesEx(arg.ints));
 }
 
 
@@ -82,7 +82,7 @@ PyResult ConfigService::Handle_GetMultiLocationsEx(PyCallArgs &call) {
 		return NULL;
 	}
 
-	return(m_db.GetMultiLocationsEx(arg.ints));
+	return(sConfigCache.GetMultiLocationsEx(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiCorpTickerNamesEx(PyCallArgs &call) {
@@ -93,7 +93,7 @@ PyResult ConfigService::Handle_GetMultiCorpTickerNamesEx(PyCallArgs &call) {
 		return NULL;
 	}
 
-	return(m_db.GetMultiCorpTickerNamesEx(arg.ints));
+	return(sConfigCache.GetMultiCorpTickerNamesEx(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiGraphicsEx(PyCallArgs &call) {
@@ -238,6 +238,10 @@ PyResult CorpRegistryBound::Handle_AddCorporation(PyCallArgs &call) {
     PyString* cache_name = new PyString( "config.StaticOwners" );
     m_manager->cache_service->InvalidateCache( cache_name );
     PySafeDecRef( cache_name );
+    //... and the ticker names are built from the corporation table
+    m_manager->cache_service->TableChanged( "corporation" );
+    //... and the owner lookups may have cached the new ID as unknown
+    sConfigCache.InvalidateCorporation( corpID );
 
     //take the money out of their wallet (sends wallet blink event)
     // The amount has to be double!!!
@@ -952,6 +956,8 @@ PyResult CorpRegistryBound::Handle_UpdateLogo(PyCallArgs &call) {
         PyDecRef( notif.data );
         return new PyNone;
     }
+    // the ticker lookups carry the logo shapes and colors
+    sConfigCache.InvalidateCorporation( notif.key );
 
     //take the money out of their wallet (sends wallet blink event)
     // The amount has to be double!!!
@@ -344,43 +344,99 @@ void ItemAttributeMgr::_SendAttributeChange(Attr attr, PyRep *oldValue, PyRep *n
 /************************************************************************/
 /* Start of new attribute system                                        */
 /************************************************************************/
+AttributeMap::SaveStats AttributeMap::sSaveStats = { 0, 0, 0, 0 };
+AttributeMap::MemoryStats AttributeMap::sMemoryStats = { 0, 0, 0 };
+
+AttributeMap::AttrMapItr::AttrMapItr( DgmTypeAttributeSet::AttrSetItr def, DgmTypeAttributeSet::AttrSetItr defEnd,
+                                      OverrideConstItr over, OverrideConstItr overEnd )
+: mDef(def), mDefEnd(defEnd), mOver(over), mOverEnd(overEnd)
+{
+    _Update();
+}
+
+AttributeMap::AttrMapItr& AttributeMap::AttrMapItr::operator++()
+{
+    /* advance whichever side(s) the current value came from */
+    if (mOver != mOverEnd && mOver->attributeID == mCurrent.first)
+        ++mOver;
+    if (mDef != mDefEnd && mDef->attributeID == mCurrent.first)
+        ++mDef;
+
+    _Update();
+    return *this;
+}
+
+void AttributeMap::AttrMapItr::_Update()
+{
+    /* the override wins if both have the attribute */
+    if (mOver != mOverEnd && (mDef == mDefEnd || mOver->attributeID <= mDef->attributeID))
+        mCurrent = value_type(mOver->attributeID, mOver->value);
+    else if (mDef != mDefEnd)
+        mCurrent = value_type(mDef->attributeID, mDef->number);
+}
+
 AttributeMap::AttributeMap( InventoryItem & item ) : mItem(item), mChanged(false)
 {
     // load the initial attributes for this item
     //Load();
+    ++sMemoryStats.maps;
+}
+
+AttributeMap::~AttributeMap()
+{
+    _AccountMemory(false);
+    --sMemoryStats.maps;
 }
 
 bool AttributeMap::SetAttribute( uint32 attributeId, EvilNumber &num, bool nofity /*= true*/ )
 {
-    AttrMapItr itr = mAttributes.find(attributeId);
+    OverrideItr itr = _FindOverride(attributeId);
+    if (itr != mOverrides.end() && itr->attributeID == attributeId) {
+        // I dono if this should happen... in short... if nothing changes... do nothing
+        if (itr->value == num)
+            return false;
 
-    /* most attribute have default value's which are related to the item type */
-    if (itr == mAttributes.end()) {
-        mAttributes.insert(std::make_pair(attributeId, num));
+        // notify dogma to change the attribute, if we are unable to queue the change
+        // event. Don't change the value.
         if (nofity == true)
-            return Add(attributeId, num);
+            if (!Change(attributeId, itr->value, num))
+                return false;
+
+        itr->value = num;
+        itr->dirty = true;
+        mChanged = true;
         return true;
     }
 
-    // I dono if this should happen... in short... if nothing changes... do nothing
-    if (itr->second == num)
-        return false;
-
-    // notify dogma to change the attribute, if we are unable to queue the change
-    // event. Don't change the value.
-    if (nofity == true)
-        if (!Change(attributeId, itr->second, num))
+    /* most attribute have default value's which are related to the item type */
+    const DmgTypeAttribute* def = mDefaults.Find(attributeId);
+    if (def != NULL) {
+        if (num == def->number)
             return false;
 
-    itr->second = num;
+        if (nofity == true) {
+            EvilNumber old_val = def->number;
+            if (!Change(attributeId, old_val, num))
+                return false;
+        }
+    }
+
+    /* the shared defaults are never written; the value goes into our own overrides */
+    _AccountMemory(false);
+    mOverrides.insert(itr, Override(attributeId, num, true));
+    _AccountMemory(true);
+    mChanged = true;
+
+    if (def == NULL && nofity == true)
+        return Add(attributeId, num);
     return true;
 }
 
 EvilNumber AttributeMap::GetAttribute( uint32 attributeId )
 {
-    AttrMapItr itr = mAttributes.find(attributeId);
-    if (itr != mAttributes.end()) {
-        return itr->second;
+    EvilNumber value;
+    if (_GetAttribute(attributeId, value)) {
+        return value;
     }
     else
     {
@@ -391,9 +447,9 @@ EvilNumber AttributeMap::GetAttribute( uint32 attributeId )
 
 EvilNumber AttributeMap::GetAttribute( const uint32 attributeId ) const
 {
-    AttrMapConstItr itr = mAttributes.find(attributeId);
-    if (itr != mAttributes.end()) {
-        return itr->second;
+    EvilNumber value;
+    if (_GetAttribute(attributeId, value)) {
+        return value;
     }
     else
     {
@@ -404,16 +460,15 @@ EvilNumber AttributeMap::GetAttribute( const uint32 attributeId ) const
 
 bool AttributeMap::HasAttribute(uint32 attributeID)
 {
-    AttrMapConstItr itr = mAttributes.find(attributeID);
-    if (itr != mAttributes.end())
+    OverrideConstItr itr = _FindOverride(attributeID);
+    if (itr != mOverrides.end() && itr->attributeID == attributeID)
         return true;
     else
-        return false;
+        return (mDefaults.Find(attributeID) != NULL);
 }
 
 bool AttributeMap::Change( uint32 attributeID, EvilNumber& old_val, EvilNumber& new_val )
 {
-    mChanged = true;
     PyTuple* AttrChange = new PyTuple(7);
     AttrChange->SetItem(0, new PyString("OnModuleAttributeChange"));
     AttrChange->SetItem(1, new PyInt(mItem.ownerID()));
@@ -428,7 +483,6 @@ bool AttributeMap::Change( uint32 attributeID, EvilNumber& old_val, EvilNumber&
 
 bool AttributeMap::Add( uint32 attributeID, EvilNumber& num )
 {
-    mChanged = true;
     PyTuple* AttrChange = new PyTuple(7);
     AttrChange->SetItem(0, new PyString( "OnModuleAttributeChange" ));
     AttrChange->SetItem(1, new PyInt( mItem.ownerID() ));
@@ -484,39 +538,37 @@ bool AttributeMap::SendAttributeChanges( PyTuple* attrChange )
 
 bool AttributeMap::Load()
 {
-    /* then we possibly overwrite the attributes value's with the default's.. */
-    DgmTypeAttributeSet *attr_set = sDgmTypeAttrMgr.GetDmgTypeAttributeSet( mItem.typeID() );
-    if (attr_set == NULL)
-        return false;
-
-    DgmTypeAttributeSet::AttrSetItr itr = attr_set->attributeset.begin();
+    _AccountMemory(false);
+    mDefaults = DgmTypeAttributeSet();
+    OverrideVector().swap(mOverrides);
+    mChanged = false;
 
-    for (; itr != attr_set->attributeset.end(); itr++)
-        SetAttribute((*itr)->attributeID, (*itr)->number, false);
+    /* the default values of the item type are shared, not copied; they are never saved */
+    if (!sDgmTypeAttrMgr.GetDmgTypeAttributeSet( mItem.typeID(), mDefaults ))
+        return false;
 
-    /* first we load the saved attributes from the db */
-    DBQueryResult res;
+    /* the saved attributes become our overrides, unless they have been loaded in bulk */
+    std::map<uint32, EvilNumber> saved;
+    if (!mItem.GetItemFactory()->TakePrefetchedAttributes(mItem.itemID(), saved))
+    {
+        std::map<uint32, std::map<uint32, EvilNumber> > rows;
+        if (!mItem.GetItemFactory()->db().GetItemAttributes(std::vector<uint32>(1, mItem.itemID()), rows))
+        {
+            sLog.Error("AttributeMap", "Error in db load query for item %u", mItem.itemID());
+            return false;
+        }
 
-    if(!sDatabase.RunQuery(res, "SELECT * FROM entity_attributes WHERE itemID='%u'", mItem.itemID())) {
-        sLog.Error("AttributeMap", "Error in db load query: %s", res.error.c_str());
-        return false;
+        saved.swap(rows[mItem.itemID()]);
     }
 
-    DBResultRow row;
+    /* the map is sorted by attributeID, so the overrides come out sorted too */
+    mOverrides.reserve(saved.size());
 
-    int amount = res.GetRowCount();
-    for (int i = 0; i < amount; i++)
-    {
-        EvilNumber attr_value;
-        res.GetRow(row);
-        uint32 attributeID = row.GetUInt(1);
-        if (!row.IsNull(2))
-            attr_value = row.GetInt64(2);
-        else
-            attr_value = row.GetDouble(3);
-        SetAttribute(attributeID, attr_value, false);
-    }
+    std::map<uint32, EvilNumber>::const_iterator cur = saved.begin();
+    for (; cur != saved.end(); cur++)
+        mOverrides.push_back(Override(cur->first, cur->second, false));
 
+    _AccountMemory(true);
     return true;
 
 /*
@@ -583,37 +635,13 @@ bool AttributeMap::Load()
 bool AttributeMap::SaveIntAttribute(uint32 attributeID, int64 value)
 {
     // SAVE INTEGER ATTRIBUTE
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, %d, NULL)",
-        mItem.itemID(), attributeID, value)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, mItem.itemID(), err.c_str());
-        return false;
-    }
-
-    return true;
+    return mItem.GetItemFactory()->db().UpdateAttribute_int(mItem.itemID(), attributeID, value);
 }
 
 bool AttributeMap::SaveFloatAttribute(uint32 attributeID, double value)
 {
     // SAVE FLOAT ATTRIBUTE
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, NULL, %f)",
-        mItem.itemID(), attributeID, value)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, mItem.itemID(), err.c_str());
-        return false;
-    }
-
-    return true;
+    return mItem.GetItemFactory()->db().UpdateAttribute_double(mItem.itemID(), attributeID, value);
 }
 
 /* hmmm only save 'state' related attributes... and calculate the rest on the fly....*/
@@ -624,35 +652,37 @@ bool AttributeMap::Save()
     if (mChanged == false)
         return true;
 
-    AttrMapItr itr = mAttributes.begin();
-    AttrMapItr itr_end = mAttributes.end();
+    /* only the overrides which changed since the last load/save; defaults come from the type */
+    std::map<uint32, EvilNumber> dirty;
+
+    OverrideItr itr = mOverrides.begin();
+    OverrideItr itr_end = mOverrides.end();
     for (; itr != itr_end; itr++)
     {
-        if ( itr->second.get_type() == evil_number_int ) {
+        if (!itr->dirty)
+            continue;
 
-            DBerror err;
-            bool success = sDatabase.RunQuery(err,
-                "REPLACE INTO entity_attributes (itemID, attributeID, valueInt, valueFloat) VALUES (%u, %u, "I64d", NULL)",
-                mItem.itemID(), itr->first, itr->second.get_int());
+        itr->dirty = false;
+        if (itr->value.get_type() != evil_number_nan)
+            dirty.insert(std::make_pair(itr->attributeID, itr->value));
+    }
 
-            if (!success)
-                sLog.Error("AttributeMap", "unable to save attribute");
+    mChanged = false;
 
-        } else if (itr->second.get_type() == evil_number_float ) {
+    if (dirty.empty())
+        return true;
 
-            DBerror err;
-            bool success = sDatabase.RunQuery(err,
-                "REPLACE INTO entity_attributes (itemID, attributeID, valueInt, valueFloat) VALUES (%u, %u, NULL, %f)",
-                mItem.itemID(), itr->first, itr->second.get_float());
+    const uint32 rows = (uint32)dirty.size();
+    _log(ITEM__TRACE, "Saving %u of %lu overridden attributes of item %u.", rows, mOverrides.size(), mItem.itemID());
 
-            if (!success)
-                sLog.Error("AttributeMap", "unable to save attribute");
-        }
-    }
+    ++sSaveStats.saves;
+    sSaveStats.rowsWritten += rows;
+    sSaveStats.lastRows = rows;
+    if (rows > sSaveStats.maxRows)
+        sSaveStats.maxRows = rows;
 
-    mChanged = false;
-
-    return true;
+    /* the rows go out as a single statement, coalesced with other pending rows by the write-behind queue */
+    return mItem.GetItemFactory()->db().UpdateAttributes(mItem.itemID(), dirty);
 }
 
 
@@ -664,28 +694,72 @@ bool AttributeMap::SaveAttributes()
 bool AttributeMap::Delete()
 {
     // Remove all attributes from the entity_attributes table for this item:
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "DELETE"
-        " FROM entity_attributes"
-        " WHERE itemID=%u",
-        mItem.itemID()
-    ))
-    {
-        sLog.Error( "", "Failed to delete item %u: %s", mItem.itemID(), err.c_str());
-        return false;
+    return mItem.GetItemFactory()->db().EraseAttributes(mItem.itemID());
+}
+
+AttributeMap::AttrMapItr AttributeMap::begin() const
+{
+    return AttrMapItr(mDefaults.begin(), mDefaults.end(), mOverrides.begin(), mOverrides.end());
+}
+
+AttributeMap::AttrMapItr AttributeMap::end() const
+{
+    return AttrMapItr(mDefaults.end(), mDefaults.end(), mOverrides.end(), mOverrides.end());
+}
+
+void AttributeMap::GetSaveStats( SaveStats &into )
+{
+    into = sSaveStats;
+}
+
+void AttributeMap::GetMemoryStats( MemoryStats &into )
+{
+    into = sMemoryStats;
+}
+
+AttributeMap::OverrideItr AttributeMap::_FindOverride( uint32 attributeID )
+{
+    return std::lower_bound(mOverrides.begin(), mOverrides.end(), attributeID, _OverrideLess);
+}
+
+AttributeMap::OverrideConstItr AttributeMap::_FindOverride( uint32 attributeID ) const
+{
+    return std::lower_bound(mOverrides.begin(), mOverrides.end(), attributeID, _OverrideLess);
+}
+
+bool AttributeMap::_GetAttribute( uint32 attributeID, EvilNumber &into ) const
+{
+    OverrideConstItr itr = _FindOverride(attributeID);
+    if (itr != mOverrides.end() && itr->attributeID == attributeID) {
+        into = itr->value;
+        return true;
     }
+
+    const DmgTypeAttribute* def = mDefaults.Find(attributeID);
+    if (def == NULL)
+        return false;
+
+    into = def->number;
     return true;
 }
 
-AttributeMap::AttrMapItr AttributeMap::begin()
+bool AttributeMap::_OverrideLess( const Override &a, uint32 attributeID )
 {
-    return mAttributes.begin();
+    return a.attributeID < attributeID;
 }
 
-AttributeMap::AttrMapItr AttributeMap::end()
+void AttributeMap::_AccountMemory( bool add )
 {
-    return mAttributes.end();
+    const uint64 overrides = mOverrides.capacity();
+    const uint64 defaults = mDefaults.size();
+
+    if (add) {
+        sMemoryStats.overrides += overrides;
+        sMemoryStats.defaults += defaults;
+    } else {
+        sMemoryStats.overrides -= overrides;
+        sMemoryStats.defaults -= defaults;
+    }
 }
 /************************************************************************/
 /* End of new attribute system                                          */
@@ -216,6 +216,10 @@ PyResult InvBrokerBound::Handle_SetLabel(PyCallArgs &call) {
 	
     item->Rename( args.itemName.c_str() );
 
+    //do not let the bubble have the slim of our ship from before the rename.
+    if( item->itemID() == call.client->GetShipID() )
+        call.client->InvalidateCache();
+
 
 	// This call as-is is NOT correct for any item category other than ships,
     // so until we can get the right string argument for other kinds of session updates,
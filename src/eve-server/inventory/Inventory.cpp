@@ -25,6 +25,9 @@
 
 #include "EVEServerPCH.h"
 
+/// Least number of released items to reload with a prefetch rather than one by one.
+static const size_t INVENTORY_RELEASED_PREFETCH_MIN = 16;
+
 /*
  * Inventory
  */
@@ -92,6 +95,10 @@ bool Inventory::LoadContents(ItemFactory &factory)
     // check if the contents has already been loaded...
     if( ContentsLoaded() )
     {
+        // ...except for what the item cache has taken since
+        if( !mReleasedItems.empty() )
+            _LoadReleasedItems( factory );
+
         return true;
     }
 
@@ -105,11 +112,26 @@ bool Inventory::LoadContents(ItemFactory &factory)
         return false;
     }
 
+    const uint32 start = GetTickCount();
+
+    uint32 characterID = 0;
+    uint32 corporationID = 0;
+    uint32 locationID = 0;
+    if( factory.GetUsingClient() != NULL )
+    {
+        characterID = factory.GetUsingClient()->GetCharacterID();
+        corporationID = factory.GetUsingClient()->GetCorporationID();
+        locationID = factory.GetUsingClient()->GetLocationID();
+    }
+    else
+        sLog.Error( "Inventory::LoadContents()", "Failed to resolve pointer to Client object currently using the ItemFactory." );
+
+    // pull the rows of all of them (and of their contents) in bulk rather than one by one;
+    // only those which pass the owner check below are read
+    const bool prefetched = factory.BeginPrefetch( inventoryID(), characterID, corporationID, locationID );
+
     //Now get each one from the factory (possibly recursing)
     ItemData into;
-    uint32 characterID;
-    uint32 corporationID;
-    uint32 locationID;
     std::vector<uint32>::iterator cur, end;
     cur = items.begin();
     end = items.end();
@@ -118,15 +140,21 @@ bool Inventory::LoadContents(ItemFactory &factory)
         // Each "cur" item should be checked to see if they are "owned" by the character connected to this client,
         // and if not, then do not "get" the entire contents of this for() loop for that item, except in the case that
         // this item is located in space or belongs to this character's corporation:
-        factory.db().GetItem( *cur, into );
-        if( factory.GetUsingClient() != NULL )
+        InventoryItemRef cached = factory.PeekItem( *cur );
+        if( cached )
         {
-            characterID = factory.GetUsingClient()->GetCharacterID();
-            corporationID = factory.GetUsingClient()->GetCorporationID();
-            locationID = factory.GetUsingClient()->GetLocationID();
+            into.ownerID = cached->ownerID();
+            into.locationID = cached->locationID();
         }
-        else
-            sLog.Error( "Inventory::LoadContents()", "Failed to resolve pointer to Client object currently using the ItemFactory." );
+        else if( !factory.GetPrefetchedItem( *cur, into ) )
+        {
+            // the prefetch has just read every row which passes the check
+            if( prefetched )
+                continue;
+
+            factory.db().GetItem( *cur, into );
+        }
+
         if( (into.ownerID == characterID) || (characterID == 0) || (into.ownerID == corporationID) || (into.locationID == locationID) )
         {
             // Continue to GetItem() if the client calling this is owned by the character that owns this item
@@ -144,6 +172,9 @@ bool Inventory::LoadContents(ItemFactory &factory)
         }
     }
 
+    factory.EndPrefetch();
+    sLog.Debug("Inventory", "Loaded %lu items of inventory %u in %u ms.", items.size(), inventoryID(), GetTickCount() - start );
+
     mContentsLoaded = true;
     return true;
 }
@@ -169,6 +200,52 @@ void Inventory::DeleteContents(ItemFactory &factory)
     mContents.clear();
 }
 
+void Inventory::ReleaseItem(uint32 itemID)
+{
+    if( 0 < mContents.erase( itemID ) && ContentsLoaded() )
+        mReleasedItems.insert( itemID );
+}
+
+void Inventory::_LoadReleasedItems(ItemFactory &factory)
+{
+    std::vector<uint32> items( mReleasedItems.begin(), mReleasedItems.end() );
+    mReleasedItems.clear();
+
+    // many of them are read faster in bulk; limited to the requesting owner, as LoadContents() does,
+    // while items of other owners are read one by one
+    const bool prefetch = ( INVENTORY_RELEASED_PREFETCH_MIN <= items.size() );
+    if( prefetch )
+    {
+        Client *client = factory.GetUsingClient();
+        if( client != NULL )
+            factory.BeginPrefetch( inventoryID(), client->GetCharacterID(), client->GetCorporationID(), client->GetLocationID() );
+        else
+            factory.BeginPrefetch( inventoryID() );
+    }
+
+    std::vector<uint32>::iterator cur, end;
+    cur = items.begin();
+    end = items.end();
+    for(; cur != end; cur++)
+    {
+        // loading puts the item back into its location, which may not be us anymore
+        InventoryItemRef i = factory.GetItem( *cur );
+        if( !i )
+        {
+            sLog.Error("Inventory::LoadContents()", "Failed to reload item %u released by %u. Skipping.", *cur, inventoryID() );
+            continue;
+        }
+
+        if( i->locationID() == inventoryID() )
+            AddItem( i );
+    }
+
+    if( prefetch )
+        factory.EndPrefetch();
+
+    sLog.Debug("Inventory", "Reloaded %u released items of inventory %u.", (uint32)items.size(), inventoryID() );
+}
+
 CRowSet* Inventory::List( EVEItemFlags _flag, uint32 forOwner ) const
 {
 	DBRowDescriptor* header = new DBRowDescriptor;
@@ -344,6 +421,8 @@ uint32 Inventory::FindByFlagSet(std::set<EVEItemFlags> flags, std::vector<Invent
 
 void Inventory::AddItem(InventoryItemRef item)
 {
+    mReleasedItems.erase( item->itemID() );
+
     std::map<uint32, InventoryItemRef>::iterator res = mContents.find( item->itemID() );
     if( res == mContents.end() )
     {
@@ -357,6 +436,8 @@ void Inventory::AddItem(InventoryItemRef item)
 
 void Inventory::RemoveItem(uint32 itemID)
 {
+    mReleasedItems.erase( itemID );
+
     std::map<uint32, InventoryItemRef>::iterator res = mContents.find( itemID );
     if( res != mContents.end() )
     {
@@ -54,6 +54,11 @@ InventoryBound::~InventoryBound()
 
 PyResult InventoryBound::Handle_List(PyCallArgs &call) {
     //TODO: check to make sure we are allowed to list this inventory
+
+    // the item cache may have released part of a station hangar since the bind
+    m_manager->item_factory.SetUsingClient( call.client );
+    mInventory.LoadContents( m_manager->item_factory );
+
     return mInventory.List( mFlag, call.client->GetCharacterID() );
 }
 
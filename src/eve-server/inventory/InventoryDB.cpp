@@ -25,17 +25,49 @@
 
 #include "EVEServerPCH.h"
 
+/*
+ * Tables written through the write-behind queue; the rows of entity and
+ * character_ are created elsewhere, so they are only ever updated.
+ */
+static DBWriteQueue::TableID _EntityTable()
+{
+    static const DBWriteQueue::TableID table = sDBWriteQueue.AddTable( "entity", "itemID",
+        "itemName, typeID, ownerID, locationID, flag, contraband, singleton, quantity, x, y, z, customInfo", true );
+    return table;
+}
+
+/// Number of IDs put into a single "IN (...)" list; keeps bulk queries below the DBcore query buffer.
+static const size_t INVENTORYDB_MAX_IN_LIST = 1000;
+
+static DBWriteQueue::TableID _EntityAttributesTable()
+{
+    static const DBWriteQueue::TableID table = sDBWriteQueue.AddTable( "entity_attributes", "itemID, attributeID",
+        "valueInt, valueFloat" );
+    return table;
+}
+
+static DBWriteQueue::TableID _CharacterTable()
+{
+    static const DBWriteQueue::TableID table = sDBWriteQueue.AddTable( "character_", "characterID",
+        "accountID, title, description, gender, bounty, balance, securityRating, logonMinutes, corporationID,"
+        " stationID, solarSystemID, constellationID, regionID, ancestryID, careerID, schoolID, careerSpecialityID,"
+        " startDateTime, createDateTime, corporationDateTime", true );
+    return table;
+}
+
+static DBWriteQueue::TableID _CorpMemberInfoTable()
+{
+    static const DBWriteQueue::TableID table = sDBWriteQueue.AddTable( "character_", "characterID",
+        "corpRole, rolesAtAll, rolesAtBase, rolesAtHQ, rolesAtOther", true );
+    return table;
+}
+
 
 bool InventoryDB::GetCategory(EVEItemCategories category, CategoryData &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " categoryName,"
-        " description,"
-        " published"
-        " FROM invCategories"
-        " WHERE categoryID=%u",
+        STATIC_QUERY_CATEGORY,
         uint32(category)))
     {
         _log(DATABASE__ERROR, "Error in query: %s.", res.error.c_str());
@@ -59,19 +91,7 @@ bool InventoryDB::GetGroup(uint32 groupID, GroupData &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " categoryID,"
-        " groupName,"
-        " description,"
-        " useBasePrice,"
-        " allowManufacture,"
-        " allowRecycler,"
-        " anchored,"
-        " anchorable,"
-        " fittableNonSingleton,"
-        " published"
-        " FROM invGroups"
-        " WHERE groupID=%u",
+        STATIC_QUERY_GROUP,
         groupID))
     {
         _log(DATABASE__ERROR, "Failed to query group %u: %s.", groupID, res.error.c_str());
@@ -102,22 +122,7 @@ bool InventoryDB::GetType(uint32 typeID, TypeData &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " groupID,"
-        " typeName,"
-        " description,"
-        " radius,"
-        " mass,"
-        " volume,"
-        " capacity,"
-        " portionSize,"
-        " raceID,"
-        " basePrice,"
-        " published,"
-        " marketGroupID,"
-        " chanceOfDuplicating"
-        " FROM invTypes"
-        " WHERE typeID=%u",
+        STATIC_QUERY_TYPE,
         typeID))
     {
         _log(DATABASE__ERROR, "Failed to query type %u: %s.", typeID, res.error.c_str());
@@ -151,22 +156,7 @@ bool InventoryDB::GetBlueprintType(uint32 blueprintTypeID, BlueprintTypeData &in
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " parentBlueprintTypeID,"
-        " productTypeID,"
-        " productionTime,"
-        " techLevel,"
-        " researchProductivityTime,"
-        " researchMaterialTime,"
-        " researchCopyTime,"
-        " researchTechTime,"
-        " productivityModifier,"
-        " materialModifier,"
-        " wasteFactor / 100,"   // we have it in db as percentage ...
-        " chanceOfReverseEngineering,"
-        " maxProductionLimit"
-        " FROM invBlueprintTypes"
-        " WHERE blueprintTypeID=%u",
+        STATIC_QUERY_BLUEPRINT_TYPE,
         blueprintTypeID))
     {
         _log(DATABASE__ERROR, "Error in query: %s.", res.error.c_str());
@@ -315,10 +305,7 @@ bool InventoryDB::GetShipType(uint32 shipTypeID, ShipTypeData &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " weaponTypeID, miningTypeID, skillTypeID"
-        " FROM shipTypes"
-        " WHERE shipTypeID = %u",
+        STATIC_QUERY_SHIP_TYPE,
         shipTypeID))
     {
         _log(DATABASE__ERROR, "Failed to query ship type %u: %s.", shipTypeID, res.error.c_str());
@@ -342,13 +329,7 @@ bool InventoryDB::GetStationType(uint32 stationTypeID, StationTypeData &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " 0 as dockingBayGraphicID, 0 as hangarGraphicID,"
-        " dockEntryX, dockEntryY, dockEntryZ,"
-        " dockOrientationX, dockOrientationY, dockOrientationZ,"
-        " operationID, officeSlots, reprocessingEfficiency, conquerable"
-        " FROM staStationTypes"
-        " WHERE stationTypeID = %u",
+        STATIC_QUERY_STATION_TYPE,
         stationTypeID))
     {
         _log(DATABASE__ERROR, "Failed to query station type %u: %s.", stationTypeID, res.error.c_str());
@@ -376,6 +357,10 @@ bool InventoryDB::GetStationType(uint32 stationTypeID, StationTypeData &into) {
 }
 
 bool InventoryDB::GetItem(uint32 itemID, ItemData &into) {
+    // static map items are kept in memory
+    if(sStaticUniverse.GetItem(itemID, into))
+        return true;
+
     DBQueryResult res;
 
     // For certain ranges of itemID-s we use specialized tables:
@@ -472,20 +457,82 @@ bool InventoryDB::GetItem(uint32 itemID, ItemData &into) {
         return false;
     }
 
-    into.name = row.GetText(0);
-    into.typeID = row.GetUInt(1);
-    into.ownerID = (row.IsNull(2) ? 1 : row.GetUInt(2));
-    into.locationID = (row.IsNull(3) ? 1 : row.GetUInt(3));
-    into.flag = (EVEItemFlags)row.GetUInt(4);
-    into.contraband = (row.GetInt(5) ? true : false);
-    into.singleton = (row.GetInt(6) ? true : false);
-    into.quantity = row.GetUInt(7);
+    _ReadItemData(row, 0, into);
+    return true;
+}
+
+bool InventoryDB::GetItemsByLocation(const std::vector<uint32> &locationIDs, std::map<uint32, ItemData> &into,
+    uint32 characterID, uint32 corporationID, uint32 clientLocationID)
+{
+    std::string inList, filter;
+    _OwnerFilter(characterID, corporationID, clientLocationID, filter);
+
+    size_t offset = 0;
+    while(_NextINChunk(locationIDs, offset, inList)) {
+        DBQueryResult res;
+
+        if(!sDatabase.RunQuery(res,
+            "SELECT"
+            " itemID, itemName, typeID, ownerID, locationID, flag, contraband,"
+            " singleton, quantity, x, y, z, customInfo"
+            " FROM entity WHERE locationID IN (%s)%s", inList.c_str(), filter.c_str()))
+        {
+            codelog(SERVICE__ERROR, "Error in bulk item query: %s", res.error.c_str());
+            return false;
+        }
+
+        DBResultRow row;
+        while(res.GetRow(row))
+            _ReadItemData(row, 1, into[row.GetUInt(0)]);
+    }
+
+    return true;
+}
+
+void InventoryDB::_OwnerFilter(uint32 characterID, uint32 corporationID, uint32 clientLocationID, std::string &into) {
+    into.clear();
 
-    into.position.x = row.GetDouble(8);
-    into.position.y = row.GetDouble(9);
-    into.position.z = row.GetDouble(10);
+    // the same test Inventory::LoadContents() does on each item
+    if(characterID != 0) {
+        char buf[128];
+        snprintf(buf, sizeof(buf), " AND (entity.ownerID IN (%u, %u) OR entity.locationID = %u)",
+            characterID, corporationID, clientLocationID);
+        into = buf;
+    }
+}
 
-    into.customInfo = (row.IsNull(11) ? "" : row.GetText(11));
+void InventoryDB::_ReadItemData(DBResultRow &row, uint32 first, ItemData &into) {
+    into.name = row.GetText(first + 0);
+    into.typeID = row.GetUInt(first + 1);
+    into.ownerID = (row.IsNull(first + 2) ? 1 : row.GetUInt(first + 2));
+    into.locationID = (row.IsNull(first + 3) ? 1 : row.GetUInt(first + 3));
+    into.flag = (EVEItemFlags)row.GetUInt(first + 4);
+    into.contraband = (row.GetInt(first + 5) ? true : false);
+    into.singleton = (row.GetInt(first + 6) ? true : false);
+    into.quantity = row.GetUInt(first + 7);
+
+    into.position.x = row.GetDouble(first + 8);
+    into.position.y = row.GetDouble(first + 9);
+    into.position.z = row.GetDouble(first + 10);
+
+    into.customInfo = (row.IsNull(first + 11) ? "" : row.GetText(first + 11));
+}
+
+bool InventoryDB::_NextINChunk(const std::vector<uint32> &ids, size_t &offset, std::string &into) {
+    if(offset >= ids.size())
+        return false;
+
+    const size_t end = std::min(ids.size(), offset + INVENTORYDB_MAX_IN_LIST);
+
+    into.clear();
+    for(; offset < end; offset++) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u", ids[offset]);
+
+        if(!into.empty())
+            into += ",";
+        into += buf;
+    }
 
     return true;
 }
@@ -526,26 +573,14 @@ bool InventoryDB::SaveItem(uint32 itemID, const ItemData &data) {
         return false;
     }
 
-    DBerror err;
-
     std::string nameEsc, customInfoEsc;
     sDatabase.DoEscapeString(nameEsc, data.name);
     sDatabase.DoEscapeString(customInfoEsc, data.customInfo);
 
-    if(!sDatabase.RunQuery(err,
-        "UPDATE entity"
-        " SET"
-        " itemName = '%s',"
-        " typeID = %u,"
-        " ownerID = %u,"
-        " locationID = %u,"
-        " flag = %u,"
-        " contraband = %u,"
-        " singleton = %u,"
-        " quantity = %u,"
-        " x = %f, y = %f, z = %f,"
-        " customInfo = '%s'"
-        " WHERE itemID = %u",
+    std::string key, values;
+    sprintf(key, "%u", itemID);
+    sprintf(values,
+        "'%s', %u, %u, %u, %u, %u, %u, %u, %f, %f, %f, '%s'",
         nameEsc.c_str(),
         data.typeID,
         data.ownerID,
@@ -555,14 +590,10 @@ bool InventoryDB::SaveItem(uint32 itemID, const ItemData &data) {
         uint32(data.singleton),
         data.quantity,
         data.position.x, data.position.y, data.position.z,
-        customInfoEsc.c_str(),
-        itemID))
-    {
-        _log(DATABASE__ERROR, "Error in query: %s.", err.c_str());
-        return false;
-    }
+        customInfoEsc.c_str());
 
-    return true;
+    // written by the write-behind queue; false only if written through and that failed
+    return sDBWriteQueue.Queue(_EntityTable(), key, values);
 }
 
 bool InventoryDB::DeleteItem(uint32 itemID) {
@@ -572,6 +603,12 @@ bool InventoryDB::DeleteItem(uint32 itemID) {
         return false;
     }
 
+    // drop pending writes so they cannot resurrect the row
+    std::string key;
+    sprintf(key, "%u", itemID);
+    sDBWriteQueue.Discard(_EntityTable(), key);
+    sDBWriteQueue.Discard(_EntityAttributesTable(), key);
+
     DBerror err;
 
     //NOTE: all child entities should be deleted by the caller first.
@@ -589,6 +626,14 @@ bool InventoryDB::DeleteItem(uint32 itemID) {
     return true;
 }
 
+bool InventoryDB::IsSavePending(uint32 itemID) {
+    std::string key;
+    sprintf(key, "%u", itemID);
+
+    return sDBWriteQueue.IsPending(_EntityTable(), key)
+        || sDBWriteQueue.IsPending(_EntityAttributesTable(), key);
+}
+
 //this could be optimized to load the full row of each
 //item which is to be loaded (and used to be), but it made
 //for some overly complex knowledge in the DB side which
@@ -701,19 +746,19 @@ bool InventoryDB::LoadTypeAttributes(uint32 typeID, EVEAttributeMgr &into) {
     }
 #else
 
-    DgmTypeAttributeSet *attrset = sDgmTypeAttrMgr.GetDmgTypeAttributeSet(typeID);
+    DgmTypeAttributeSet attrset;
     
     // if not found return true because there can be items without attributes I guess
-    if (attrset == NULL)
+    if (!sDgmTypeAttrMgr.GetDmgTypeAttributeSet(typeID, attrset))
         return true;
 
-    DgmTypeAttributeSet::AttrSetItr itr = attrset->begin();
+    DgmTypeAttributeSet::AttrSetItr itr = attrset.begin();
     
-    for (; itr != attrset->end(); itr++) {
-        if ((*itr)->number.get_type() == evil_number_int)
-            into.SetInt((EVEAttributeMgr::Attr)(*itr)->attributeID, (*itr)->number.get_int());
+    for (; itr != attrset.end(); itr++) {
+        if (itr->number.get_type() == evil_number_int)
+            into.SetInt((EVEAttributeMgr::Attr)itr->attributeID, itr->number.get_int());
         else
-            into.SetReal((EVEAttributeMgr::Attr)(*itr)->attributeID, (*itr)->number.get_float());
+            into.SetReal((EVEAttributeMgr::Attr)itr->attributeID, itr->number.get_float());
     }
 #endif
     return true;
@@ -759,36 +804,104 @@ bool InventoryDB::LoadItemAttributes(uint32 itemID, EVEAttributeMgr &into) {
     return true;
 }
 
-bool InventoryDB::UpdateAttribute_int(uint32 itemID, uint32 attributeID, int v) {
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, %d, NULL)",
-        itemID, attributeID, v)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, itemID, err.c_str());
-        return false;
-    }
-    return true;
+bool InventoryDB::UpdateAttribute_int(uint32 itemID, uint32 attributeID, int64 v) {
+    std::string key, values;
+    sprintf(key, "%u,%u", itemID, attributeID);
+    sprintf(values, I64d ", NULL", v);
+
+    return sDBWriteQueue.Queue(_EntityAttributesTable(), key, values);
 }
 
 bool InventoryDB::UpdateAttribute_double(uint32 itemID, uint32 attributeID, double v) {
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, NULL, %f)",
-        itemID, attributeID, v)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, itemID, err.c_str());
-        return false;
+    std::string key, values;
+    sprintf(key, "%u,%u", itemID, attributeID);
+    sprintf(values, "NULL, %f", v);
+
+    return sDBWriteQueue.Queue(_EntityAttributesTable(), key, values);
+}
+
+bool InventoryDB::GetItemAttributes(const std::vector<uint32> &itemIDs, std::map<uint32, std::map<uint32, EvilNumber> > &into) {
+    return _GetItemAttributes(false, itemIDs, into);
+}
+
+bool InventoryDB::GetItemAttributesByLocation(const std::vector<uint32> &locationIDs, std::map<uint32, std::map<uint32, EvilNumber> > &into,
+    uint32 characterID, uint32 corporationID, uint32 clientLocationID)
+{
+    std::string filter;
+    _OwnerFilter(characterID, corporationID, clientLocationID, filter);
+
+    return _GetItemAttributes(true, locationIDs, into, filter);
+}
+
+bool InventoryDB::_GetItemAttributes(bool byLocation, const std::vector<uint32> &ids, std::map<uint32, std::map<uint32, EvilNumber> > &into,
+    const std::string &filter)
+{
+    std::string inList;
+
+    size_t offset = 0;
+    while(_NextINChunk(ids, offset, inList)) {
+        DBQueryResult res;
+
+        bool success;
+        if(byLocation)
+            success = sDatabase.RunQuery(res,
+                "SELECT"
+                " entity_attributes.itemID, attributeID, valueInt, valueFloat"
+                " FROM entity_attributes"
+                " JOIN entity USING (itemID)"
+                " WHERE entity.locationID IN (%s)%s", inList.c_str(), filter.c_str());
+        else
+            success = sDatabase.RunQuery(res,
+                "SELECT"
+                " itemID, attributeID, valueInt, valueFloat"
+                " FROM entity_attributes"
+                " WHERE itemID IN (%s)", inList.c_str());
+
+        if(!success)
+        {
+            codelog(SERVICE__ERROR, "Error in bulk attribute query: %s", res.error.c_str());
+            return false;
+        }
+
+        DBResultRow row;
+        while(res.GetRow(row)) {
+            EvilNumber &value = into[row.GetUInt(0)][row.GetUInt(1)];
+            if(!row.IsNull(2))
+                value = row.GetInt64(2);
+            else
+                value = row.GetDouble(3);
+        }
     }
+
     return true;
 }
+
+bool InventoryDB::UpdateAttributes(uint32 itemID, const std::map<uint32, EvilNumber> &attributes) {
+    DBWriteQueue::RowMap rows;
+
+    std::map<uint32, EvilNumber>::const_iterator cur, end;
+    cur = attributes.begin();
+    end = attributes.end();
+    for(; cur != end; cur++) {
+        std::string key;
+        sprintf(key, "%u,%u", itemID, cur->first);
+
+        EvilNumber value = cur->second;
+        std::string &values = rows[key];
+        if(value.get_type() == evil_number_int)
+            sprintf(values, I64d ", NULL", value.get_int());
+        else
+            sprintf(values, "NULL, %f", value.get_float());
+    }
+
+    return sDBWriteQueue.Queue(_EntityAttributesTable(), rows);
+}
+
 bool InventoryDB::EraseAttribute(uint32 itemID, uint32 attributeID) {
+    std::string key;
+    sprintf(key, "%u,%u", itemID, attributeID);
+    sDBWriteQueue.Discard(_EntityAttributesTable(), key);
+
     DBerror err;
     if(!sDatabase.RunQuery(err,
         "DELETE FROM entity_attributes"
@@ -802,6 +915,10 @@ bool InventoryDB::EraseAttribute(uint32 itemID, uint32 attributeID) {
 }
 
 bool InventoryDB::EraseAttributes(uint32 itemID) {
+    std::string key;
+    sprintf(key, "%u", itemID);
+    sDBWriteQueue.Discard(_EntityAttributesTable(), key);
+
     DBerror err;
     if(!sDatabase.RunQuery(err,
         "DELETE"
@@ -1228,38 +1345,16 @@ bool InventoryDB::NewCharacter(uint32 characterID, const CharacterData &data, co
 }
 
 bool InventoryDB::SaveCharacter(uint32 characterID, const CharacterData &data) {
-    DBerror err;
-
     std::string titleEsc;
     sDatabase.DoEscapeString(titleEsc, data.title);
 
     std::string descriptionEsc;
     sDatabase.DoEscapeString(descriptionEsc, data.description);
 
-    if(!sDatabase.RunQuery(err,
-        "UPDATE character_"
-        " SET"
-        "  accountID = %u,"
-        "  title = '%s',"
-        "  description = '%s',"
-        "  gender = %u,"
-        "  bounty = %f,"
-        "  balance = %f,"
-        "  securityRating = %f,"
-        "  logonMinutes = %u,"
-        "  corporationID = %u,"
-        "  stationID = %u,"
-        "  solarSystemID = %u,"
-        "  constellationID = %u,"
-        "  regionID = %u,"
-        "  ancestryID = %u,"
-        "  careerID = %u,"
-        "  schoolID = %u,"
-        "  careerSpecialityID = %u,"
-        "  startDateTime = " I64u ","
-        "  createDateTime = " I64u ","
-        "  corporationDateTime = " I64u
-        " WHERE characterID = %u",
+    std::string key, values;
+    sprintf(key, "%u", characterID);
+    sprintf(values,
+        "%u, '%s', '%s', %u, %f, %f, %f, %u, %u, %u, %u, %u, %u, %u, %u, %u, %u, " I64u ", " I64u ", " I64u,
         data.accountID,
         titleEsc.c_str(),
         descriptionEsc.c_str(),
@@ -1279,14 +1374,10 @@ bool InventoryDB::SaveCharacter(uint32 characterID, const CharacterData &data) {
         data.careerSpecialityID,
         data.startDateTime,
         data.createDateTime,
-        data.corporationDateTime,
-        characterID))
-    {
-        _log(DATABASE__ERROR, "Failed to save character %u: %s.", characterID, err.c_str());
-        return false;
-    }
+        data.corporationDateTime);
 
-    return true;
+    // written by the write-behind queue; false only if written through and that failed
+    return sDBWriteQueue.Queue(_CharacterTable(), key, values);
 }
 
 bool InventoryDB::SaveCharacterAppearance(uint32 characterID, const CharacterAppearance &data) {
@@ -1344,35 +1435,30 @@ bool InventoryDB::SaveCharacterAppearance(uint32 characterID, const CharacterApp
 }
 
 bool InventoryDB::SaveCorpMemberInfo(uint32 characterID, const CorpMemberInfo &data) {
-    DBerror err;
-
-    if(!sDatabase.RunQuery(err,
-        "UPDATE character_"
-        " SET"
-        "  corpRole = " I64u ","
-        "  rolesAtAll = " I64u ","
-        "  rolesAtBase = " I64u ","
-        "  rolesAtHQ = " I64u ","
-        "  rolesAtOther = " I64u
-        " WHERE characterID = %u",
+    std::string key, values;
+    sprintf(key, "%u", characterID);
+    sprintf(values,
+        I64u ", " I64u ", " I64u ", " I64u ", " I64u,
         data.corpRole,
         data.rolesAtAll,
         data.rolesAtBase,
         data.rolesAtHQ,
-        data.rolesAtOther,
-        characterID))
-    {
-        _log(DATABASE__ERROR, "Failed to update corp member info of character %u: %s.", characterID, err.c_str());
-        return false;
-    }
+        data.rolesAtOther);
 
-    return true;
+    // written by the write-behind queue; false only if written through and that failed
+    return sDBWriteQueue.Queue(_CorpMemberInfoTable(), key, values);
 }
 
 // Undefine the macro used only in NewCharacter and SaveCharacterAppearance.
 #undef _VoN
 
 bool InventoryDB::DeleteCharacter(uint32 characterID) {
+    // drop pending writes so they cannot resurrect the row
+    std::string key;
+    sprintf(key, "%u", characterID);
+    sDBWriteQueue.Discard(_CharacterTable(), key);
+    sDBWriteQueue.Discard(_CorpMemberInfoTable(), key);
+
     DBerror err;
 
     // eveMailDetails
@@ -1503,6 +1589,9 @@ bool InventoryDB::DeleteCharacter(uint32 characterID) {
 }
 
 bool InventoryDB::GetCelestialObject(uint32 celestialID, CelestialObjectData &into) {
+    if(sStaticUniverse.GetCelestialObject(celestialID, into))
+        return true;
+
     DBQueryResult res;
 
     if( IsUniverseCelestial( celestialID )
@@ -1570,6 +1659,9 @@ bool InventoryDB::GetCelestialObject(uint32 celestialID, CelestialObjectData &in
 }
 
 bool InventoryDB::GetSolarSystem(uint32 solarSystemID, SolarSystemData &into) {
+    if(sStaticUniverse.GetSolarSystem(solarSystemID, into))
+        return true;
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -1614,6 +1706,9 @@ bool InventoryDB::GetSolarSystem(uint32 solarSystemID, SolarSystemData &into) {
 }
 
 bool InventoryDB::GetStation(uint32 stationID, StationData &into) {
+    if(sStaticUniverse.GetStation(stationID, into))
+        return true;
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -249,9 +249,6 @@ bool InventoryItem::_Load()
     // load attributes
     mAttributeMap.Load();
 
-    // load attributes
-    mAttributeMap.Load();
-
     // update inventory
     Inventory *inventory = m_factory.GetInventory( locationID(), false );
     if( inventory != NULL )
@@ -646,7 +643,8 @@ bool InventoryItem::Populate( Rsp_CommonGetInfo_Entry& result )
     AttributeMap::AttrMapItr itr = mAttributeMap.begin();
     AttributeMap::AttrMapItr itr_end = mAttributeMap.end();
     for (; itr != itr_end; itr++) {
-        result.attributes[(*itr).first] = (*itr).second.GetPyObject();
+        EvilNumber value = (*itr).second;
+        result.attributes[(*itr).first] = value.GetPyObject();
     }
 
     //no idea what time this is supposed to be
@@ -669,6 +667,9 @@ void InventoryItem::Rename(const char *to) {
     
 	m_itemName = to;
     SaveItem();
+
+    // names of owners and locations are cached for ConfigService
+    sConfigCache.Rename( itemID(), m_itemName );
 }
 
 void InventoryItem::MoveInto(Inventory &new_home, EVEItemFlags _flag, bool notify) {
@@ -25,12 +25,27 @@
 
 #include "EVEServerPCH.h"
 
-ItemFactory::ItemFactory(EntityList& el) : entity_list(el) {}
+/// How deep BeginPrefetch() descends into nested containers.
+static const uint32 ITEMFACTORY_MAX_PREFETCH_DEPTH = 8;
+/// How often Process() checks the item cache budget, in ms.
+static const uint32 ITEMFACTORY_CACHE_CHECK_INTERVAL = 5000;
+
+ItemFactory::ItemFactory(EntityList& el)
+: entity_list(el),
+  m_cacheMaxItems(0),
+  m_cacheMaxMemory(0),
+  m_clockHand(0),
+  m_cacheTimer(ITEMFACTORY_CACHE_CHECK_INTERVAL),
+  m_prefetchDepth(0),
+  m_queuedPrefetches(0)
+{
+    memset(&m_cacheStats, 0, sizeof(m_cacheStats));
+}
 
 ItemFactory::~ItemFactory() {
     // items
     {
-        std::map<uint32, InventoryItemRef>::const_iterator cur, end;
+        ItemMap::const_iterator cur, end;
         cur = m_items.begin();
         end = m_items.end();
         for(; cur != end; cur++) {
@@ -144,19 +159,26 @@ const StationType *ItemFactory::GetStationType(uint32 stationTypeID) {
 template<class _Ty>
 RefPtr<_Ty> ItemFactory::_GetItem(uint32 itemID)
 {
-    std::map<uint32, InventoryItemRef>::iterator res = m_items.find( itemID );
+    ItemMap::iterator res = m_items.find( itemID );
     if( res == m_items.end() )
     {
+        ++m_cacheStats.misses;
+
         // load the item
         RefPtr<_Ty> item = _Ty::Load( *this, itemID );
         if( !item )
             return RefPtr<_Ty>();
 
         //we keep the original ref.
-        res = m_items.insert( std::make_pair( itemID, item ) ).first;
+        _CacheItem( item );
+        return item;
     }
+
+    ++m_cacheStats.hits;
+    res->second.referenced = true;
+
     // return to the user.
-    return RefPtr<_Ty>::StaticCast( res->second );
+    return RefPtr<_Ty>::StaticCast( res->second.item );
 }
 
 InventoryItemRef ItemFactory::GetItem(uint32 itemID)
@@ -164,6 +186,15 @@ InventoryItemRef ItemFactory::GetItem(uint32 itemID)
     return _GetItem<InventoryItem>( itemID );
 }
 
+InventoryItemRef ItemFactory::PeekItem(uint32 itemID) const
+{
+    ItemMap::const_iterator res = m_items.find( itemID );
+    if( res == m_items.end() )
+        return InventoryItemRef();
+
+    return res->second.item;
+}
+
 BlueprintRef ItemFactory::GetBlueprint(uint32 blueprintID)
 {
     return _GetItem<Blueprint>( blueprintID );
@@ -220,7 +251,7 @@ InventoryItemRef ItemFactory::SpawnItem(ItemData &data) {
         return InventoryItemRef();
 
     // spawn successful; store the ref
-    m_items.insert( std::make_pair( i->itemID(), i ) );
+    _CacheItem( i );
     return i;
 }
 
@@ -229,7 +260,7 @@ BlueprintRef ItemFactory::SpawnBlueprint(ItemData &data, BlueprintData &bpData)
     if( !bi )
         return BlueprintRef();
 
-    m_items.insert( std::make_pair( bi->itemID(), bi ) );
+    _CacheItem( bi );
     return bi;
 }
 
@@ -238,7 +269,7 @@ CharacterRef ItemFactory::SpawnCharacter(ItemData &data, CharacterData &charData
     if( !c )
         return CharacterRef();
 
-    m_items.insert( std::make_pair( c->itemID(), c ) );
+    _CacheItem( c );
     return c;
 }
 
@@ -247,7 +278,7 @@ ShipRef ItemFactory::SpawnShip(ItemData &data) {
     if( !s )
         return ShipRef();
 
-    m_items.insert( std::make_pair( s->itemID(), s ) );
+    _CacheItem( s );
     return s;
 }
 
@@ -257,7 +288,7 @@ SkillRef ItemFactory::SpawnSkill(ItemData &data)
     if( !s )
         return SkillRef();
 
-    m_items.insert( std::make_pair( s->itemID(), s ) );
+    _CacheItem( s );
     return s;
 }
 
@@ -267,7 +298,7 @@ OwnerRef ItemFactory::SpawnOwner(ItemData &data)
     if( !o )
         return OwnerRef();
 
-    m_items.insert( std::make_pair( o->itemID(), o ) );
+    _CacheItem( o );
     return o;
 }
 
@@ -277,7 +308,7 @@ StructureRef ItemFactory::SpawnStructure(ItemData &data)
     if( !o )
         return StructureRef();
 
-    m_items.insert( std::make_pair( o->itemID(), o ) );
+    _CacheItem( o );
     return o;
 }
 
@@ -287,7 +318,7 @@ CargoContainerRef ItemFactory::SpawnCargoContainer(ItemData &data)
     if( !o )
         return CargoContainerRef();
 
-    m_items.insert( std::make_pair( o->itemID(), o ) );
+    _CacheItem( o );
     return o;
 }
 
@@ -299,27 +330,338 @@ Inventory *ItemFactory::GetInventory(uint32 inventoryID, bool load)
         item = GetItem( inventoryID );
     else
     {
-        std::map<uint32, InventoryItemRef>::iterator res = m_items.find( inventoryID );
+        ItemMap::iterator res = m_items.find( inventoryID );
         if( res != m_items.end() )
-            item = res->second;
+            item = res->second.item;
+    }
+
+    Inventory *inventory = Inventory::Cast( item );
+
+    // EvictItems() may have released part of a station hangar
+    if( load && inventory != NULL && EVEDB::invCategories::Station == item->categoryID() )
+        inventory->LoadContents( *this );
+
+    return inventory;
+}
+
+bool ItemFactory::BeginPrefetch(uint32 locationID, uint32 characterID, uint32 corporationID, uint32 clientLocationID)
+{
+    ++m_prefetchDepth;
+
+    // already covered by an enclosing prefetch?
+    if( !m_prefetchedLocations.insert( locationID ).second )
+        return false;
+
+    _LoadPrefetch( std::vector<uint32>( 1, locationID ), m_prefetchedLocations, m_prefetchedItems, m_prefetchedAttributes,
+                   characterID, corporationID, clientLocationID );
+
+    // a failed first level leaves the location out
+    return ( 0 < m_prefetchedLocations.count( locationID ) );
+}
+
+void ItemFactory::BeginPrefetch(PrefetchData &data)
+{
+    ++m_prefetchDepth;
+
+    if( 0 < m_queuedPrefetches )
+    {
+        std::set<uint32>::const_iterator cur, end;
+        cur = m_unloadedItems.begin();
+        end = m_unloadedItems.end();
+        for(; cur != end; cur++)
+        {
+            // the cached item may have been saved or deleted after the rows were read
+            data.items.erase( *cur );
+            data.attributes.erase( *cur );
+        }
+
+        CancelPrefetch();
+    }
+
+    // rows prefetched by an enclosing prefetch are as fresh, keep them
+    m_prefetchedLocations.insert( data.locations.begin(), data.locations.end() );
+    m_prefetchedItems.insert( data.items.begin(), data.items.end() );
+    m_prefetchedAttributes.insert( data.attributes.begin(), data.attributes.end() );
+
+    data = PrefetchData();
+}
+
+void ItemFactory::EndPrefetch()
+{
+    if( 0 < m_prefetchDepth && 0 == --m_prefetchDepth )
+    {
+        m_prefetchedLocations.clear();
+        m_prefetchedItems.clear();
+        m_prefetchedAttributes.clear();
+    }
+}
+
+bool ItemFactory::GetPrefetchedItem(uint32 itemID, ItemData &into) const
+{
+    std::map<uint32, ItemData>::const_iterator res = m_prefetchedItems.find( itemID );
+    if( res == m_prefetchedItems.end() )
+        return false;
+
+    into = res->second;
+    return true;
+}
+
+bool ItemFactory::TakePrefetchedAttributes(uint32 itemID, std::map<uint32, EvilNumber> &into)
+{
+    // the item is being built now; a later reload must hit the DB again
+    const bool prefetched = ( 0 < m_prefetchedItems.erase( itemID ) );
+
+    std::map<uint32, std::map<uint32, EvilNumber> >::iterator res = m_prefetchedAttributes.find( itemID );
+    if( res != m_prefetchedAttributes.end() )
+    {
+        into.swap( res->second );
+        m_prefetchedAttributes.erase( res );
+        return true;
+    }
+
+    return prefetched;
+}
+
+void ItemFactory::QueuePrefetch()
+{
+    ++m_queuedPrefetches;
+}
+
+void ItemFactory::CancelPrefetch()
+{
+    if( 0 < m_queuedPrefetches && 0 == --m_queuedPrefetches )
+        m_unloadedItems.clear();
+}
+
+bool ItemFactory::LoadPrefetch(const std::vector<uint32> &locationIDs, PrefetchData &into)
+{
+    std::vector<uint32> parents;
+
+    std::vector<uint32>::const_iterator cur, end;
+    cur = locationIDs.begin();
+    end = locationIDs.end();
+    for(; cur != end; cur++)
+    {
+        if( into.locations.insert( *cur ).second )
+            parents.push_back( *cur );
+    }
+
+    return _LoadPrefetch( parents, into.locations, into.items, into.attributes );
+}
+
+bool ItemFactory::LoadPrefetchAttributes(const std::vector<uint32> &itemIDs, PrefetchData &into)
+{
+    std::map<uint32, std::map<uint32, EvilNumber> > attributes;
+    if( !db().GetItemAttributes( itemIDs, attributes ) )
+        return false;
+
+    // those without any saved are known now too
+    std::vector<uint32>::const_iterator cur, end;
+    cur = itemIDs.begin();
+    end = itemIDs.end();
+    for(; cur != end; cur++)
+        into.attributes[ *cur ].swap( attributes[ *cur ] );
+
+    return true;
+}
+
+bool ItemFactory::_LoadPrefetch(std::vector<uint32> parents, std::set<uint32> &locations,
+    std::map<uint32, ItemData> &items, std::map<uint32, std::map<uint32, EvilNumber> > &attributes,
+    uint32 characterID, uint32 corporationID, uint32 clientLocationID)
+{
+    bool success = true;
+    for( uint32 depth = 0; !parents.empty() && depth < ITEMFACTORY_MAX_PREFETCH_DEPTH; ++depth )
+    {
+        // a level is taken as a whole or not at all, so that no item looks like it has no attributes
+        std::map<uint32, ItemData> level;
+        std::map<uint32, std::map<uint32, EvilNumber> > levelAttributes;
+        if( !db().GetItemsByLocation( parents, level, characterID, corporationID, clientLocationID )
+            || !db().GetItemAttributesByLocation( parents, levelAttributes, characterID, corporationID, clientLocationID ) )
+        {
+            success = false;
+            break;
+        }
+
+        std::map<uint32, std::map<uint32, EvilNumber> >::iterator curAttr, endAttr;
+        curAttr = levelAttributes.begin();
+        endAttr = levelAttributes.end();
+        for(; curAttr != endAttr; curAttr++)
+            attributes[ curAttr->first ].swap( curAttr->second );
+
+        // only singletons may contain anything, so only they make up the next level;
+        // items filtered out are not loaded, neither is what is inside them
+        parents.clear();
+
+        std::map<uint32, ItemData>::const_iterator cur, end;
+        cur = level.begin();
+        end = level.end();
+        for(; cur != end; cur++)
+        {
+            items.insert( *cur );
+
+            if( cur->second.singleton && locations.insert( cur->first ).second )
+                parents.push_back( cur->first );
+        }
+    }
+
+    // whatever is left over was not walked; let nested loads query it themselves
+    std::vector<uint32>::const_iterator cur, end;
+    cur = parents.begin();
+    end = parents.end();
+    for(; cur != end; cur++)
+        locations.erase( *cur );
+
+    return success;
+}
+
+void ItemFactory::SetCacheLimits(uint32 maxItems, uint64 maxMemory)
+{
+    m_cacheMaxItems = maxItems;
+    m_cacheMaxMemory = maxMemory;
+}
+
+void ItemFactory::Process()
+{
+    if( !m_cacheTimer.Check() )
+        return;
+
+    if( _OverBudget() )
+        EvictItems();
+}
+
+uint32 ItemFactory::EvictItems(bool all)
+{
+    ++m_cacheStats.sweeps;
+
+    /*
+     * CLOCK: the hand walks the cache in itemID order. Items referenced outside
+     * the cache, with unsaved changes or with saved rows DBWriteQueue has not
+     * written yet are skipped, recently accessed ones get their bit cleared
+     * and a second chance, the rest are dropped. Two turns at most, so each
+     * sweep is bounded even if nothing can go.
+     *
+     * A loaded station holds every item of its hangar, so the hangars of
+     * players who logged off would stay for as long as the system does;
+     * a ref held by nobody but the station is given up along with the item.
+     */
+    size_t steps = ( all ? 1 : 2 ) * m_items.size();
+    uint32 evicted = 0;
+
+    ItemMap::iterator cur = m_items.lower_bound( m_clockHand );
+    for(; 0 < steps && !m_items.empty() && ( all || _OverBudget() ); --steps)
+    {
+        if( cur == m_items.end() )
+            cur = m_items.begin();
+
+        CachedItem &entry = cur->second;
+        if( entry.item->IsDirty() )
+        {
+            ++cur;
+            continue;
+        }
+
+        Inventory *hangar = NULL;
+        if( 1 < entry.item->GetRefCount()
+            && NULL == ( hangar = _HangarHolding( *entry.item ) ) )
+        {
+            ++cur;
+            continue;
+        }
+
+        if( entry.referenced && !all )
+        {
+            entry.referenced = false;
+            ++cur;
+            continue;
+        }
+
+        // saved, but not written yet; a reload must not race the write
+        if( db().IsSavePending( cur->first ) )
+        {
+            ++cur;
+            continue;
+        }
+
+        if( hangar != NULL )
+            hangar->ReleaseItem( cur->first );
+
+        // dropping our ref destroys the item; a container releases its contents, which may go next
+        m_cacheStats.residentBytes -= entry.bytes;
+        _ItemUnloaded( cur->first );
+        m_items.erase( cur++ );
+        ++evicted;
     }
 
-    return Inventory::Cast( item );
+    m_clockHand = ( cur == m_items.end() ? 0 : cur->first );
+
+    m_cacheStats.evictions += evicted;
+    if( 0 < evicted )
+        sLog.Debug( "Item Factory", "Evicted %u items; %lu items (~" I64u " KB) cached.",
+                    evicted, m_items.size(), m_cacheStats.residentBytes / 1024 );
+
+    return evicted;
+}
+
+Inventory *ItemFactory::_HangarHolding(const InventoryItem &item)
+{
+    if( 2 != item.GetRefCount() )
+        return NULL;
+
+    ItemMap::const_iterator res = m_items.find( item.locationID() );
+    if( res == m_items.end() || EVEDB::invCategories::Station != res->second.item->categoryID() )
+        return NULL;
+
+    Inventory *hangar = Inventory::Cast( res->second.item );
+    if( hangar == NULL || !hangar->Contains( item.itemID() ) )
+        return NULL;
+
+    return hangar;
+}
+
+void ItemFactory::GetCacheStats(CacheStats &into) const
+{
+    into = m_cacheStats;
+    into.resident = (uint32)m_items.size();
+}
+
+void ItemFactory::_CacheItem(InventoryItemRef item)
+{
+    CachedItem entry;
+    entry.item = item;
+    entry.bytes = item->GetMemoryUsage();
+    entry.referenced = true;
+
+    if( m_items.insert( std::make_pair( item->itemID(), entry ) ).second )
+        m_cacheStats.residentBytes += entry.bytes;
 }
 
 void ItemFactory::_DeleteItem(uint32 itemID)
 {
-    std::map<uint32, InventoryItemRef>::iterator res = m_items.find( itemID );
+    ItemMap::iterator res = m_items.find( itemID );
     if( res == m_items.end() )
     {
         sLog.Error("Item Factory", "Item ID %u not found when requesting deletion!", itemID );
     }
     else
     {
+        m_cacheStats.residentBytes -= res->second.bytes;
+        _ItemUnloaded( itemID );
         m_items.erase( res );
     }
 }
 
+void ItemFactory::_ItemUnloaded(uint32 itemID)
+{
+    if( 0 < m_queuedPrefetches )
+        m_unloadedItems.insert( itemID );
+}
+
+bool ItemFactory::_OverBudget() const
+{
+    return ( 0 < m_cacheMaxItems && m_items.size() > m_cacheMaxItems )
+        || ( 0 < m_cacheMaxMemory && m_cacheStats.residentBytes > m_cacheMaxMemory );
+}
+
 void ItemFactory::SetUsingClient(Client *pClient)
 {
     m_pClient = pClient;
@@ -0,0 +1,482 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+StaticUniverse::StaticUniverse()
+: mLoaded( false ),
+  mLoadTime( 0 ),
+  mHits( 0 ),
+  mMisses( 0 )
+{
+}
+
+bool StaticUniverse::Load()
+{
+    Clear();
+
+    const uint32 start = GetTickCount();
+
+    std::vector<Entry> entries;
+    if( !_LoadDenormalize( entries )
+        || !_LoadRegions( entries )
+        || !_LoadConstellations( entries )
+        || !_LoadSolarSystems( entries )
+        || !_LoadStations( entries ) )
+    {
+        Clear();
+        return false;
+    }
+
+    _Merge( entries );
+
+    // drop the slack left by growing
+    std::string( mNames ).swap( mNames );
+    SolarSystemVector( mSolarSystems ).swap( mSolarSystems );
+    StationVector( mStations ).swap( mStations );
+
+    mLoaded = true;
+    mLoadTime = GetTickCount() - start;
+
+    sLog.Log( "StaticUniverse", "Loaded %lu map items, %lu solar systems and %lu stations in %u ms; using %lu KiB.",
+              mEntries.size(), mSolarSystems.size(), mStations.size(), mLoadTime, _GetMemoryUsage() / 1024 );
+
+    return true;
+}
+
+void StaticUniverse::Clear()
+{
+    mLoaded = false;
+
+    std::vector<Entry>().swap( mEntries );
+    std::string().swap( mNames );
+    SolarSystemVector().swap( mSolarSystems );
+    StationVector().swap( mStations );
+}
+
+bool StaticUniverse::GetItem( uint32 itemID, ItemData& into ) const
+{
+    if( !mLoaded || !IsStaticMapItem( itemID ) )
+        return false;
+
+    const Entry* e = _Find( itemID );
+    if( NULL == e || 0 == ( e->flags & ENTRY_ITEM ) )
+    {
+        ++mMisses;
+        return false;
+    }
+
+    into.name = &mNames[ e->name ];
+    into.typeID = e->typeID;
+    into.ownerID = e->ownerID;
+    into.locationID = e->locationID;
+    into.flag = flagAutoFit;
+    into.contraband = false;
+    into.singleton = true;
+    into.quantity = 1;
+    into.position = GPoint( e->x, e->y, e->z );
+    into.customInfo = "";
+
+    ++mHits;
+    return true;
+}
+
+bool StaticUniverse::GetCelestialObject( uint32 celestialID, CelestialObjectData& into ) const
+{
+    if( !mLoaded || !IsStaticMapItem( celestialID ) )
+        return false;
+
+    const Entry* e = _Find( celestialID );
+    if( NULL == e || 0 == ( e->flags & ENTRY_CELESTIAL ) )
+    {
+        ++mMisses;
+        return false;
+    }
+
+    into.security = e->security;
+    into.radius = e->radius;
+    into.celestialIndex = e->celestialIndex;
+    into.orbitIndex = e->orbitIndex;
+
+    ++mHits;
+    return true;
+}
+
+bool StaticUniverse::GetSolarSystem( uint32 solarSystemID, SolarSystemData& into ) const
+{
+    if( !mLoaded )
+        return false;
+
+    SolarSystemVector::const_iterator res = std::lower_bound( mSolarSystems.begin(), mSolarSystems.end(),
+                                                              std::make_pair( solarSystemID, SolarSystemData() ),
+                                                              StaticUniverse::_CompareFirst<SolarSystemData> );
+    if( res == mSolarSystems.end() || res->first != solarSystemID )
+    {
+        ++mMisses;
+        return false;
+    }
+
+    into = res->second;
+
+    ++mHits;
+    return true;
+}
+
+bool StaticUniverse::GetStation( uint32 stationID, StationData& into ) const
+{
+    if( !mLoaded )
+        return false;
+
+    StationVector::const_iterator res = std::lower_bound( mStations.begin(), mStations.end(),
+                                                          std::make_pair( stationID, StationData() ),
+                                                          StaticUniverse::_CompareFirst<StationData> );
+    if( res == mStations.end() || res->first != stationID )
+    {
+        ++mMisses;
+        return false;
+    }
+
+    into = res->second;
+
+    ++mHits;
+    return true;
+}
+
+void StaticUniverse::GetStats( Stats& into ) const
+{
+    into.items = (uint32)mEntries.size();
+    into.solarSystems = (uint32)mSolarSystems.size();
+    into.stations = (uint32)mStations.size();
+    into.memory = _GetMemoryUsage();
+    into.loadTime = mLoadTime;
+    into.hits = mHits;
+    into.misses = mMisses;
+}
+
+bool StaticUniverse::_LoadDenormalize( std::vector<Entry>& into )
+{
+    DBQueryResult res;
+
+    // ~500k rows, don't buffer them all in the client
+    if( !sDatabase.RunQueryStream( res,
+        STATIC_QUERY_UNIVERSE_ITEMS ) )
+    {
+        _log( DATABASE__ERROR, "Failed to load mapDenormalize: %s.", res.error.c_str() );
+        return false;
+    }
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        Entry e;
+        memset( &e, 0, sizeof( e ) );
+
+        e.itemID = row.GetUInt( 0 );
+        e.flags = ENTRY_CELESTIAL;
+        e.security = ( row.IsNull( 7 ) ? 0 : row.GetDouble( 7 ) );
+        e.radius = ( row.IsNull( 8 ) ? 0 : row.GetDouble( 8 ) );
+        e.celestialIndex = ( row.IsNull( 9 ) ? 0 : row.GetUInt( 9 ) );
+        e.orbitIndex = ( row.IsNull( 10 ) ? 0 : row.GetUInt( 10 ) );
+
+        // item data of celestials and stargates comes from mapDenormalize as well,
+        // the rest is overridden by their own tables in _Merge()
+        if( IsUniverseCelestial( e.itemID ) || IsStargate( e.itemID ) )
+        {
+            e.flags |= ENTRY_ITEM;
+            e.name = _AddName( row.GetText( 1 ) );
+            e.typeID = row.GetUInt( 2 );
+            e.locationID = ( row.IsNull( 3 ) ? 1 : row.GetUInt( 3 ) );
+            e.x = row.GetDouble( 4 );
+            e.y = row.GetDouble( 5 );
+            e.z = row.GetDouble( 6 );
+
+            // stargates are owned by the faction of their system
+            if( IsStargate( e.itemID ) )
+                e.ownerID = ( row.IsNull( 11 ) ? 1 : row.GetUInt( 11 ) );
+            else
+                e.ownerID = 1;
+        }
+
+        into.push_back( e );
+    }
+
+    return true;
+}
+
+bool StaticUniverse::_LoadRegions( std::vector<Entry>& into )
+{
+    DBQueryResult res;
+
+    if( !sDatabase.RunQuery( res,
+        STATIC_QUERY_REGIONS ) )
+    {
+        _log( DATABASE__ERROR, "Failed to load mapRegions: %s.", res.error.c_str() );
+        return false;
+    }
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        Entry e;
+        memset( &e, 0, sizeof( e ) );
+
+        e.itemID = row.GetUInt( 0 );
+        e.flags = ENTRY_ITEM;
+        e.name = _AddName( row.GetText( 1 ) );
+        e.typeID = 3;
+        e.ownerID = ( row.IsNull( 2 ) ? 1 : row.GetUInt( 2 ) );
+        e.locationID = 1;
+        e.x = row.GetDouble( 3 );
+        e.y = row.GetDouble( 4 );
+        e.z = row.GetDouble( 5 );
+
+        into.push_back( e );
+    }
+
+    return true;
+}
+
+bool StaticUniverse::_LoadConstellations( std::vector<Entry>& into )
+{
+    DBQueryResult res;
+
+    if( !sDatabase.RunQuery( res,
+        STATIC_QUERY_CONSTELLATIONS ) )
+    {
+        _log( DATABASE__ERROR, "Failed to load mapConstellations: %s.", res.error.c_str() );
+        return false;
+    }
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        Entry e;
+        memset( &e, 0, sizeof( e ) );
+
+        e.itemID = row.GetUInt( 0 );
+        e.flags = ENTRY_ITEM;
+        e.name = _AddName( row.GetText( 1 ) );
+        e.typeID = 4;
+        e.ownerID = ( row.IsNull( 2 ) ? 1 : row.GetUInt( 2 ) );
+        e.locationID = ( row.IsNull( 3 ) ? 1 : row.GetUInt( 3 ) );
+        e.x = row.GetDouble( 4 );
+        e.y = row.GetDouble( 5 );
+        e.z = row.GetDouble( 6 );
+
+        into.push_back( e );
+    }
+
+    return true;
+}
+
+bool StaticUniverse::_LoadSolarSystems( std::vector<Entry>& into )
+{
+    DBQueryResult res;
+
+    if( !sDatabase.RunQuery( res,
+        STATIC_QUERY_SOLAR_SYSTEMS ) )
+    {
+        _log( DATABASE__ERROR, "Failed to load mapSolarSystems: %s.", res.error.c_str() );
+        return false;
+    }
+
+    mSolarSystems.reserve( res.GetRowCount() );
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        Entry e;
+        memset( &e, 0, sizeof( e ) );
+
+        e.itemID = row.GetUInt( 0 );
+        e.flags = ENTRY_ITEM;
+        e.name = _AddName( row.GetText( 1 ) );
+        e.typeID = 5;
+        e.ownerID = ( row.IsNull( 2 ) ? 1 : row.GetUInt( 2 ) );
+        e.locationID = ( row.IsNull( 3 ) ? 1 : row.GetUInt( 3 ) );
+        e.x = row.GetDouble( 4 );
+        e.y = row.GetDouble( 5 );
+        e.z = row.GetDouble( 6 );
+
+        into.push_back( e );
+
+        SolarSystemData data(
+            GPoint( row.GetDouble( 7 ), row.GetDouble( 8 ), row.GetDouble( 9 ) ),
+            GPoint( row.GetDouble( 10 ), row.GetDouble( 11 ), row.GetDouble( 12 ) ),
+            row.GetDouble( 13 ),
+            row.GetInt( 14 ) ? true : false,
+            row.GetInt( 15 ) ? true : false,
+            row.GetInt( 16 ) ? true : false,
+            row.GetInt( 17 ) ? true : false,
+            row.GetInt( 18 ) ? true : false,
+            row.GetInt( 19 ) ? true : false,
+            row.GetInt( 20 ) ? true : false,
+            row.GetDouble( 21 ),
+            ( row.IsNull( 2 ) ? 0 : row.GetUInt( 2 ) ),
+            row.GetDouble( 22 ),
+            row.GetUInt( 23 ),
+            ( row.IsNull( 24 ) ? "" : row.GetText( 24 ) )
+        );
+
+        mSolarSystems.push_back( std::make_pair( e.itemID, data ) );
+    }
+
+    return true;
+}
+
+bool StaticUniverse::_LoadStations( std::vector<Entry>& into )
+{
+    DBQueryResult res;
+
+    if( !sDatabase.RunQuery( res,
+        STATIC_QUERY_STATIONS ) )
+    {
+        _log( DATABASE__ERROR, "Failed to load staStations: %s.", res.error.c_str() );
+        return false;
+    }
+
+    mStations.reserve( res.GetRowCount() );
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        Entry e;
+        memset( &e, 0, sizeof( e ) );
+
+        e.itemID = row.GetUInt( 0 );
+        e.flags = ENTRY_ITEM;
+        e.name = _AddName( row.GetText( 1 ) );
+        e.typeID = row.GetUInt( 2 );
+        e.ownerID = ( row.IsNull( 3 ) ? 1 : row.GetUInt( 3 ) );
+        e.locationID = ( row.IsNull( 4 ) ? 1 : row.GetUInt( 4 ) );
+        e.x = row.GetDouble( 5 );
+        e.y = row.GetDouble( 6 );
+        e.z = row.GetDouble( 7 );
+
+        into.push_back( e );
+
+        StationData data(
+            row.GetUInt( 8 ),
+            row.GetDouble( 9 ),
+            row.GetDouble( 10 ),
+            row.GetUInt( 11 ),
+            row.GetUInt( 12 ),
+            row.GetDouble( 13 ),
+            row.GetDouble( 14 ),
+            (EVEItemFlags)row.GetInt( 15 )
+        );
+
+        mStations.push_back( std::make_pair( e.itemID, data ) );
+    }
+
+    return true;
+}
+
+void StaticUniverse::_Merge( std::vector<Entry>& entries )
+{
+    // stable, so for each ID the mapDenormalize half comes first
+    std::stable_sort( entries.begin(), entries.end() );
+
+    mEntries.clear();
+    mEntries.reserve( entries.size() );
+
+    std::vector<Entry>::const_iterator cur, end;
+    cur = entries.begin();
+    end = entries.end();
+    for(; cur != end; ++cur )
+    {
+        if( mEntries.empty() || mEntries.back().itemID != cur->itemID )
+        {
+            mEntries.push_back( *cur );
+            continue;
+        }
+
+        Entry& e = mEntries.back();
+
+        if( 0 != ( cur->flags & ENTRY_ITEM ) )
+        {
+            e.typeID = cur->typeID;
+            e.ownerID = cur->ownerID;
+            e.locationID = cur->locationID;
+            e.name = cur->name;
+            e.x = cur->x;
+            e.y = cur->y;
+            e.z = cur->z;
+        }
+
+        if( 0 != ( cur->flags & ENTRY_CELESTIAL ) )
+        {
+            e.security = cur->security;
+            e.radius = cur->radius;
+            e.celestialIndex = cur->celestialIndex;
+            e.orbitIndex = cur->orbitIndex;
+        }
+
+        e.flags |= cur->flags;
+    }
+
+    // the array never grows again
+    std::vector<Entry>().swap( entries );
+    std::vector<Entry>( mEntries ).swap( mEntries );
+}
+
+uint32 StaticUniverse::_AddName( const char* name )
+{
+    const uint32 offset = (uint32)mNames.size();
+
+    if( NULL != name )
+        mNames += name;
+    mNames += '\0';
+
+    return offset;
+}
+
+const StaticUniverse::Entry* StaticUniverse::_Find( uint32 itemID ) const
+{
+    Entry key;
+    key.itemID = itemID;
+
+    std::vector<Entry>::const_iterator res = std::lower_bound( mEntries.begin(), mEntries.end(), key );
+    if( res == mEntries.end() || res->itemID != itemID )
+        return NULL;
+
+    return &*res;
+}
+
+size_t StaticUniverse::_GetMemoryUsage() const
+{
+    size_t memory = mEntries.capacity() * sizeof( Entry ) + mNames.capacity();
+    memory += mSolarSystems.capacity() * sizeof( SolarSystemVector::value_type );
+    memory += mStations.capacity() * sizeof( StationVector::value_type );
+
+    // security class strings of the solar systems
+    SolarSystemVector::const_iterator cur, end;
+    cur = mSolarSystems.begin();
+    end = mSolarSystems.end();
+    for(; cur != end; ++cur )
+        memory += cur->second.securityClass.capacity();
+
+    return memory;
+}
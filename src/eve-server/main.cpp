@@ -93,6 +93,13 @@ int main( int argc, char* argv[] )
             sLog.Warning( "server init", "Unable to open log file '%s', only logging to the screen now.", sConfig.files.log.c_str() );
     }
 
+    // per-statement statistics and slow-query log
+    sDatabase.profiler().SetEnabled( sConfig.database.profileQueries );
+    sDatabase.profiler().SetSlowQueryThreshold( sConfig.database.slowQueryThreshold );
+
+    if( !sDatabase.SetBackend( sConfig.database.backend.c_str() ) )
+        return 1;
+
     //connect to the database...
     DBerror err;
     if( !sDatabase.Open( err,
@@ -105,10 +112,41 @@ int main( int argc, char* argv[] )
         sLog.Error( "server init", "Unable to connect to the database: %s", err.c_str() );
         return 1;
     }
-    _sDgmTypeAttrMgr = new dgmtypeattributemgr(); // needs to be after db init as its using it
 
+    // fill an embedded database
+    std::string::size_type dumpStart = 0;
+    while( dumpStart < sConfig.database.dumps.size() )
+    {
+        std::string::size_type dumpEnd = sConfig.database.dumps.find( ';', dumpStart );
+        if( std::string::npos == dumpEnd )
+            dumpEnd = sConfig.database.dumps.size();
+
+        const std::string dump = sConfig.database.dumps.substr( dumpStart, dumpEnd - dumpStart );
+        if( !dump.empty() && !sDatabase.LoadDump( err, dump.c_str() ) )
+        {
+            sLog.Error( "server init", "Unable to load dump %s: %s", dump.c_str(), err.c_str() );
+            return 1;
+        }
+
+        dumpStart = dumpEnd + 1;
+    }
+
+    // map the static data snapshot, if any, before the static caches below load
+    if( !sConfig.files.staticSnapshot.empty() )
+    {
+        std::string snapshotErr;
+        if( !sDatabase.snapshot().Open( snapshotErr, sConfig.files.staticSnapshot.c_str() ) )
+            sLog.Error( "server init", "Unable to open static data snapshot, querying the database instead: %s", snapshotErr.c_str() );
+    }
+
+    // start the write-behind queue for item and character saves
+    sDBWriteQueue.Start( sConfig.database.flushInterval, sConfig.database.flushBatchSize );
     _sDgmTypeAttrMgr = new dgmtypeattributemgr(); // needs to be after db init as its using it
 
+    // keep the static universe in memory; lookups fall back to the DB if this fails
+    if( sConfig.database.cacheStaticUniverse && !sStaticUniverse.Load() )
+        sLog.Error( "server init", "Unable to load static universe, it will be read from the database." );
+
     //Start up the TCP server
     EVETCPServer tcps;
 
@@ -124,10 +162,15 @@ int main( int argc, char* argv[] )
     }
 	//make the item factory
     ItemFactory item_factory( sEntityList );
+    item_factory.SetCacheLimits( sConfig.database.itemCacheMaxItems, (uint64)sConfig.database.itemCacheMaxMemory * 1024 * 1024 );
+    sEntityList.SetSystemIdleTimeout( sConfig.world.systemIdleTimeout );
 
     //now, the service manager...
     PyServiceMgr services( 888444, sEntityList, item_factory );
 
+    //boots the destinations of jumps ahead of time
+    sEntityList.StartLoader();
+
     //setup the command dispatcher
     CommandDispatcher command_dispatcher( services );
     RegisterAllCommands( command_dispatcher );
@@ -195,7 +238,8 @@ int main( int argc, char* argv[] )
 	services.RegisterService(new AggressionMgrService(&services));
 
     sLog.Log("server init", "Priming cached objects.");
-    services.cache_service->PrimeCache();
+    services.cache_service->PrimeCache( sConfig.database.cachePrimeThreads, sConfig.database.cachePrimeInBackground );
+    services.cache_service->SetRefreshInterval( sConfig.database.cacheRefreshInterval );
     sLog.Log("server init", "finished priming");
 
 	// start up the image server
@@ -236,6 +280,7 @@ int main( int argc, char* argv[] )
 
         sEntityList.Process();
         services.Process();
+        item_factory.Process();
 
         /* UPDATE */
         last_time = GetTickCount();
@@ -254,6 +299,36 @@ int main( int argc, char* argv[] )
 
     services.serviceDB().SetServerOnlineStatus(false);
 
+    sLog.Log("server shutdown", "Removing NPCs" );
+    sEntityList.DepopNPCs();
+
+    sLog.Log("server shutdown", "Flushing write-behind queue" );
+    sEntityList.StopLoader();
+    sDBWriteQueue.Stop();
+
+    sDatabase.profiler().Dump( DBProfiler::SortTotal, 0 );
+    sDatabase.snapshot().Dump();
+
+    StaticUniverse::Stats universeStats;
+    sStaticUniverse.GetStats( universeStats );
+    if( sStaticUniverse.IsLoaded() )
+        sLog.Log("server shutdown", "Static universe: " I64u " hits, " I64u " misses.", universeStats.hits, universeStats.misses );
+
+    ItemFactory::CacheStats itemStats;
+    item_factory.GetCacheStats( itemStats );
+    sLog.Log("server shutdown", "Item cache: " I64u " hits, " I64u " misses, " I64u " evictions; %u items (~" I64u " KB) resident.",
+             itemStats.hits, itemStats.misses, itemStats.evictions, itemStats.resident, itemStats.residentBytes / 1024 );
+
+    EntityList::SystemStats systemStats;
+    sEntityList.GetSystemStats( systemStats );
+    sLog.Log("server shutdown", "Solar systems: %u boots (%u prefetched, avg %u ms, max %u ms; loader avg %u ms, max %u ms), %u hibernations; %u live (~" I64u " KB).",
+             systemStats.boots, systemStats.prefetches,
+             ( 0 < systemStats.boots ? (uint32)( systemStats.totalBootTime / systemStats.boots / 1000 ) : 0 ),
+             (uint32)( systemStats.maxBootTime / 1000 ),
+             ( 0 < systemStats.prefetches ? (uint32)( systemStats.totalLoadTime / systemStats.prefetches / 1000 ) : 0 ),
+             (uint32)( systemStats.maxLoadTime / 1000 ), systemStats.hibernations,
+             systemStats.live, systemStats.liveBytes / 1024 );
+
     sLog.Log("server shutdown", "Cleanup db cache" );
     delete _sDgmTypeAttrMgr;
 
@@ -238,7 +238,7 @@ PyRep *MarketDB::GetOldPriceHistory(uint32 regionID, uint32 typeID) {
 	ordering.push_back("volume");
 	ordering.push_back("orders");*/
 	
-	if(!sDatabase.RunQuery(res,
+	if(!sDatabase.RunQueryStream(res,
 		"SELECT"
 		"	historyDate, lowPrice, highPrice, avgPrice,"
 		"	volume, orders "
@@ -276,7 +276,7 @@ PyRep *MarketDB::GetNewPriceHistory(uint32 regionID, uint32 typeID) {
 	//NOTE: it may be a good idea to cache the historyDate column in each
 	//record when they are inserted instead of re-calculating it each query.
 	// this would also allow us to put together an index as well...
-	if(!sDatabase.RunQuery(res,
+	if(!sDatabase.RunQueryStream(res,
 		"SELECT"
 		"	transactionDateTime-(transactionDateTime%%" I64d ") AS historyDate,"
 		"	MIN(price) AS lowPrice,"
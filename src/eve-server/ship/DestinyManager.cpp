@@ -327,6 +327,14 @@ void DestinyManager::_Follow() {
 
 void DestinyManager::_Move() {
 	
+    // Check to see if we have a pending docking operation and attempt to dock if so:
+    Client *client = m_self->CastToClient();
+    if( client != NULL && client->GetPendingDockOperation() )
+    {
+        AttemptDockOperation();
+        return;
+    }
+	
 	//CalcAcceleration:
 	GVector vector_to_goal(m_position, m_targetPoint); //m
 	Ga::GaFloat distance_to_goal2 = vector_to_goal.lengthSquared(); //m^2
@@ -342,11 +350,7 @@ void DestinyManager::_Move() {
 	_log(PHYSICS__TRACEPOS, "Accel Magnitude = %.13f", m_accelerationFactor);
 	GVector calc_acceleration = vector_to_goal * m_accelerationFactor;	//fric*m/(s*agi*kg) = m/s^2
 	
-    // Check to see if we have a pending docking operation and attempt to dock if so:
-    if( m_self->CastToClient()->GetPendingDockOperation() )
-        AttemptDockOperation();
-    else
-        _MoveAccel(calc_acceleration);
+	_MoveAccel(calc_acceleration);
 }
 
 void DestinyManager::_MoveAccel(const GVector &calc_acceleration) {
@@ -467,10 +471,11 @@ void DestinyManager::_InitWarp() {
 
 	//double warp_speed = m_system->GetWarpSpeed();
     double warp_speed = 0.0;
-    if( m_self->CastToClient()->GetShip() )
+    Client *client = m_self->CastToClient();
+    if( client != NULL && client->GetShip() )
     {
-        double baseWarpSpeed = m_self->CastToClient()->GetShip()->GetAttribute(AttrBaseWarpSpeed).get_float();
-        double warpSpeedMultiplier = m_self->CastToClient()->GetShip()->GetAttribute(AttrWarpSpeedMultiplier).get_float();
+        double baseWarpSpeed = client->GetShip()->GetAttribute(AttrBaseWarpSpeed).get_float();
+        double warpSpeedMultiplier = client->GetShip()->GetAttribute(AttrWarpSpeedMultiplier).get_float();
         
         //warp_speed = (double)(m_self->CastToClient()->GetShip()->GetAttribute(AttrWarpSpeedMultiplier).get_float()) * ONE_AU_IN_METERS;
         warp_speed = baseWarpSpeed * ((double)BASE_WARP_SPEED) * warpSpeedMultiplier * ((double)ONE_AU_IN_METERS);
@@ -798,12 +803,13 @@ void DestinyManager::EntityRemoved(SystemEntity *who) {
 //Global Actions:
 void DestinyManager::Stop(bool update) {
     // THIS IS A HACK AS WE DONT KNOW WHY THE CLIENT CALLS STOP AT UNDOCK
-    if( m_self->CastToClient()->GetJustUndocking() )
+    Client *client = m_self->CastToClient();
+    if( client != NULL && client->GetJustUndocking() )
     {
         // Client just undocked from a station so DO NOT STOP:
-        m_self->CastToClient()->SetJustUndocking( false );
+        client->SetJustUndocking( false );
         GPoint dest;
-        m_self->CastToClient()->GetUndockAlignToPoint( dest );
+        client->GetUndockAlignToPoint( dest );
         AlignTo( dest, true );
         SetSpeedFraction( 1.0, true );
     }
@@ -25,87 +25,106 @@
 
 #include "EVEServerPCH.h"
 
+/// Orders the attributes of a type.
+static bool DmgTypeAttributeLess(const DmgTypeAttribute &a, const DmgTypeAttribute &b)
+{
+    return a.attributeID < b.attributeID;
+}
+
+const DmgTypeAttribute* DgmTypeAttributeSet::Find(uint32 attributeID) const
+{
+    DmgTypeAttribute key;
+    key.attributeID = attributeID;
+
+    AttrSetItr itr = std::lower_bound(mBegin, mEnd, key, DmgTypeAttributeLess);
+    if (itr == mEnd || itr->attributeID != attributeID)
+        return NULL;
+
+    return itr;
+}
+
 dgmtypeattributemgr::dgmtypeattributemgr()
 {
-    // load shit from db
+    const uint32 start = GetTickCount();
+
+    // load shit from db; streamed, as it is one of the biggest tables we have
     DBQueryResult res;
 
-    if( !sDatabase.RunQuery( res,
-        "SELECT * FROM dgmTypeAttributes ORDER BY typeID" ) )
+    if( !sDatabase.RunQueryStream( res,
+        STATIC_QUERY_TYPE_ATTRIBUTES ) )
     {
         sLog.Error("DgmTypeAttrMgr", "Error in db load query: %s", res.error.c_str());
         return;
     }
-    
-    uint32 currentID = 0;
-    DgmTypeAttributeSet * entry = NULL;
+
     DBResultRow row;
-    
-    int amount = res.GetRowCount();
-    for (int i = 0; i < amount; i++)
+    while (res.GetRow(row))
     {
-        res.GetRow(row);
         uint32 typeID = row.GetUInt(0);
 
-        // need a better solution for this
-        if (currentID == 0) {
-            currentID = typeID;
-            entry = new DgmTypeAttributeSet;
+        // a new type starts here, and so do all the types in between which have no attributes
+        if (typeID >= mTypeIndex.size())
+            mTypeIndex.resize(typeID + 1, (uint32)mAttributes.size());
+        else if (typeID + 1 != mTypeIndex.size())
+        {
+            sLog.Error("DgmTypeAttrMgr", "rows of typeID %u are not in order, skipping", typeID);
+            continue;
         }
 
-        if (currentID != typeID) {
-            mDgmTypeAttrInfo.insert(std::make_pair(currentID, entry));
-            currentID = typeID;
-            entry = new DgmTypeAttributeSet;
-        }
-
-        DmgTypeAttribute * attr_entry = new DmgTypeAttribute();
-        attr_entry->attributeID = row.GetUInt(1);
+        DmgTypeAttribute attr_entry;
+        attr_entry.attributeID = row.GetUInt(1);
         if (row.IsNull(2) == true) {
-            attr_entry->number = EvilNumber(row.GetFloat(3));
+            attr_entry.number = EvilNumber(row.GetFloat(3));
         } else {
-            attr_entry->number = EvilNumber(row.GetInt(2));
+            attr_entry.number = EvilNumber(row.GetInt(2));
         }
 
-        entry->attributeset.push_back(attr_entry);
+        mAttributes.push_back(attr_entry);
     }
-}
 
-dgmtypeattributemgr::~dgmtypeattributemgr()
-{
-    DgmTypeAttributeMapItr itr = mDgmTypeAttrInfo.begin();
-    for (; itr != mDgmTypeAttrInfo.end(); itr++)
+    // end of the last type
+    mTypeIndex.push_back((uint32)mAttributes.size());
+
+    // sort the attributes of each type, so single ones can be looked up
+    for (size_t i = 0; i + 1 < mTypeIndex.size(); i++)
     {
-        delete itr->second;
+        std::vector<DmgTypeAttribute>::iterator first = mAttributes.begin() + mTypeIndex[i];
+        std::vector<DmgTypeAttribute>::iterator last = mAttributes.begin() + mTypeIndex[i + 1];
+
+        std::sort(first, last, DmgTypeAttributeLess);
     }
+
+    std::vector<DmgTypeAttribute>(mAttributes).swap(mAttributes);
+
+    const size_t memory = mAttributes.capacity() * sizeof(DmgTypeAttribute) + mTypeIndex.capacity() * sizeof(uint32);
+    sLog.Log("DgmTypeAttrMgr", "Loaded %lu attributes of types up to %lu in %u ms, using %lu KiB.",
+             mAttributes.size(), mTypeIndex.size() - 1, GetTickCount() - start, memory / 1024);
 }
 
-DgmTypeAttributeSet* dgmtypeattributemgr::GetDmgTypeAttributeSet( uint32 typeID )
+bool dgmtypeattributemgr::GetDmgTypeAttributeSet( uint32 typeID, DgmTypeAttributeSet &into ) const
 {
-    DgmTypeAttributeMapItr itr;
-    itr = mDgmTypeAttrInfo.find(typeID);
-    if (itr == mDgmTypeAttrInfo.end())
+    if (mTypeIndex.empty() || typeID >= mTypeIndex.size() - 1 || mTypeIndex[typeID] == mTypeIndex[typeID + 1])
     {
         sLog.Error("DgmTypeAttrMgr", "unable to find typeID: %u", typeID);
-        return NULL;
-    }
-
-    if (!itr->second)
-    {
-        sLog.Error("DgmTypeAttrMgr", "something went wrong with typeID: %u, db problem.... maybe", typeID);
-        return NULL;
+        return false;
     }
 
     // whooo we found it :D
-    return itr->second;
+    const DmgTypeAttribute* first = &mAttributes[0];
+    into = DgmTypeAttributeSet(first + mTypeIndex[typeID], first + mTypeIndex[typeID + 1]);
+    return true;
 }
 
-
-DgmTypeAttributeSet::~DgmTypeAttributeSet()
+bool dgmtypeattributemgr::GetDmgTypeAttribute( uint32 typeID, uint32 attributeID, EvilNumber &into ) const
 {
-    AttrSetItr itr = attributeset.begin();
-    for (; itr != attributeset.end(); itr++)
-    {
-        delete (*itr);
-    }
-}
\ No newline at end of file
+    if (mTypeIndex.empty() || typeID >= mTypeIndex.size() - 1)
+        return false;
+
+    const DmgTypeAttribute* first = &mAttributes[0];
+    const DmgTypeAttribute* attr = DgmTypeAttributeSet(first + mTypeIndex[typeID], first + mTypeIndex[typeID + 1]).Find(attributeID);
+    if (attr == NULL)
+        return false;
+
+    into = attr->number;
+    return true;
+}
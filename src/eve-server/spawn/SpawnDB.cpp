@@ -281,3 +281,25 @@ bool SpawnDB::LoadSpawnEntries(uint32 solarSystemID, const std::map<uint32, Spaw
 
 
 
+
+bool SpawnDB::SaveSpawnTimes(const std::map<uint32, uint32> &spawnTimes) {
+    DBerror err;
+    bool success = true;
+
+    std::map<uint32, uint32>::const_iterator cur, end;
+    cur = spawnTimes.begin();
+    end = spawnTimes.end();
+    for(; cur != end; cur++) {
+        if(!sDatabase.RunQuery(err,
+            "UPDATE spawns"
+            " SET spawnTimer=%u"
+            " WHERE spawnID=%u",
+                cur->second, cur->first))
+        {
+            codelog(SPAWN__ERROR, "Error saving timer of spawn %u: %s", cur->first, err.c_str());
+            success = false;
+        }
+    }
+
+    return success;
+}
@@ -224,6 +224,15 @@ void SpawnEntry::SpawnDepoped(uint32 npcID) {
 	}
 }
 
+uint32 SpawnEntry::GetSpawnTime() const {
+	const uint32 now = Timer::GetTimeSeconds();
+
+	//timer is disabled while the spawn is up.
+	if(!m_timer.Enabled())
+		return now;
+	return now + m_timer.GetRemainingTime() / 1000;
+}
+
 bool SpawnEntry::CheckBounds() const {
 	switch(m_boundsType) {
 	
@@ -276,6 +285,19 @@ bool SpawnManager::Load() {
 	return true;
 }
 
+bool SpawnManager::Save() {
+	std::map<uint32, uint32> spawnTimes;
+
+	std::map<uint32, SpawnEntry *>::const_iterator cur, end;
+	cur = m_spawns.begin();
+	end = m_spawns.end();
+	for(; cur != end; cur++) {
+		spawnTimes[cur->first] = cur->second->GetSpawnTime();
+	}
+
+	return m_db.SaveSpawnTimes(spawnTimes);
+}
+
 bool SpawnManager::DoInitialSpawn() {
 	//right now, just running through Process will spawn what needs to be spawned.
 	Process();
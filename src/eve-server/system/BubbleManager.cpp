@@ -27,10 +27,16 @@
 
 //upon this interval, check for entities which may have wandered out of their bubble without a major event happening.
 static const uint32 BubbleWanderTimer_S = 30;
+//empty bubbles are kept around this long, in case somebody warps back to them.
+static const uint32 BubbleEmptyGrace_S = 120;
 static const double BubbleRadius_m = 500000;    // EVE retail uses 250km and allows grid manipulation, for simplicity we dont and have our grid much larger
 
 BubbleManager::BubbleManager()
-: m_wanderTimer(BubbleWanderTimer_S *1000)
+: m_wanderTimer(BubbleWanderTimer_S *1000),
+  m_peak(0),
+  m_created(0),
+  m_reclaimed(0),
+  m_merged(0)
 {
 	m_wanderTimer.Start();
 }
@@ -47,37 +53,55 @@ void BubbleManager::clear() {
 		delete *cur;
 	}
 	m_bubbles.clear();
+	m_cells.clear();
+	m_emptySince.clear();
+}
+
+void BubbleManager::GetStats(Stats &into) const {
+	into.live = (uint32)m_bubbles.size();
+	into.empty = (uint32)m_emptySince.size();
+	into.peak = m_peak;
+	into.created = m_created;
+	into.reclaimed = m_reclaimed;
+	into.merged = m_merged;
 }
 
 void BubbleManager::Process() {
 	if(m_wanderTimer.Check()) {
-		std::vector<SystemEntity *> wanderers;
-		
-		{
-			std::vector<SystemBubble *>::const_iterator cur, end;
-			cur = m_bubbles.begin();
-			end = m_bubbles.end();
-			for(; cur != end; ++cur) {
-				if((*cur)->IsEmpty()) {
-					// Remove this bubble now that it is empty of ALL system entities
-                    //delete *cur;
-				}
-				//if wanderers are found, they are 
-				(*cur)->ProcessWander(wanderers);
-			}
+		ProcessAt(Timer::GetCurrentTime());
+	}
+}
+
+void BubbleManager::ProcessAt(int32 now) {
+	TIC_PHASE( PHASE_BUBBLES );
+
+	std::vector<SystemEntity *> wanderers;
+	
+	{
+		std::vector<SystemBubble *>::const_iterator cur, end;
+		cur = m_bubbles.begin();
+		end = m_bubbles.end();
+		for(; cur != end; ++cur) {
+			//if wanderers are found, they are 
+			(*cur)->ProcessWander(wanderers);
 		}
-		if(!wanderers.empty()) {
-			std::vector<SystemEntity *>::const_iterator cur, end;
-			cur = wanderers.begin();
-			end = wanderers.end();
-			for(; cur != end; cur++) {
-				Add(*cur, true);
-			}
+	}
+	if(!wanderers.empty()) {
+		std::vector<SystemEntity *>::const_iterator cur, end;
+		cur = wanderers.begin();
+		end = wanderers.end();
+		for(; cur != end; cur++) {
+			Add(*cur, true);
 		}
 	}
+	
+	_MergeBubbles();
+	_ReclaimBubbles(now);
 }
 
 void BubbleManager::UpdateBubble(SystemEntity *ent, bool notify) {
+	TIC_PHASE( PHASE_BUBBLES );
+
 	SystemBubble *b = ent->Bubble();
 	if(b != NULL) {
 		if(b->InBubble(ent->GetPosition())) {
@@ -93,32 +117,28 @@ void BubbleManager::UpdateBubble(SystemEntity *ent, bool notify) {
 }
 
 void BubbleManager::Add(SystemEntity *ent, bool notify) {
+	TIC_PHASE( PHASE_BUBBLES );
 
 	SystemBubble *in_bubble = _FindBubble(ent->GetPosition());
 	if(in_bubble != NULL) {
+		if(in_bubble->IsEmpty())
+			m_emptySince.erase(in_bubble);
 		in_bubble->Add(ent, notify);
         sLog.Debug( "BubbleManager::Add()", "SystemEntity '%s' being added to existing Bubble %u", ent->GetName(), in_bubble->GetBubbleID() );
 		return;
 	}
 	// this System Entity is not in any existing bubble, so let's make a new bubble
     // using the current position of this System Entity, however, we want to create this
-    // new bubble's center 99.2% of the bubble radius further along the direction
-    // of travel from the position of this System Entity
-    GPoint newBubbleCenter(ent->GetPosition());
-    GVector shipVelocity(ent->GetVelocity());
-    shipVelocity.normalize();
-    newBubbleCenter.x += shipVelocity.x * (0.96 * BubbleRadius_m);
-    newBubbleCenter.y += shipVelocity.y * (0.96 * BubbleRadius_m);
-    newBubbleCenter.z += shipVelocity.z * (0.96 * BubbleRadius_m);
-
-	in_bubble = new SystemBubble(newBubbleCenter, BubbleRadius_m);
+    // new bubble's center 96% of the bubble radius further along the direction
+    // of travel from the position of this System Entity, unless that overlaps other bubbles.
+	in_bubble = _CreateBubble(ent->GetPosition(), ent->GetVelocity());
     sLog.Debug( "BubbleManager::Add()", "SystemEntity '%s' being added to NEW Bubble %u", ent->GetName(), in_bubble->GetBubbleID() );
-	//TODO: think about bubble colission. should we merge them?
-	m_bubbles.push_back(in_bubble);
 	in_bubble->Add(ent, notify);
 }
 
 void BubbleManager::Remove(SystemEntity *ent, bool notify) {
+	TIC_PHASE( PHASE_BUBBLES );
+
 	SystemBubble *b = ent->Bubble();
 	if(b == NULL) {
 		//not in any bubble.
@@ -127,31 +147,241 @@ void BubbleManager::Remove(SystemEntity *ent, bool notify) {
 	}
 	b->Remove(ent, notify);
     sLog.Debug( "BubbleManager::Remove()", "SystemEntity '%s' being removed from Bubble %u", ent->GetName(), b->GetBubbleID() );
+	
+	//empty bubbles are reclaimed by Process() after a grace period.
+	if(b->IsEmpty())
+        sLog.Debug( "BubbleManager::Remove()", "Bubble %u is empty.", b->GetBubbleID() );
+}
 
-	std::vector<SystemBubble *>::iterator cur, end;
+void BubbleManager::_MergeBubbles() {
+	//bubbles are oldest first, so entities drain towards the oldest of overlapping bubbles.
+	std::vector<SystemBubble *>::const_iterator cur, end;
 	cur = m_bubbles.begin();
 	end = m_bubbles.end();
 	for(; cur != end; ++cur) {
 		SystemBubble *b = *cur;
-        if(b->IsEmpty()) {
-            sLog.Debug( "BubbleManager::Remove()", "Bubble %u is empty and is therefore being deleted from the system right now.", b->GetBubbleID() );
-			m_bubbles.erase(cur,cur);
+		if(b->IsEmpty())
+			continue;
+		
+		//the bubble overlaps itself.
+		const SystemBubble *nearest;
+		if(_CountOverlaps(b->m_center, &nearest) <= 1)
+			continue;
+		
+		std::set<SystemEntity *> entities;
+		b->GetEntities(entities);
+		
+		std::set<SystemEntity *>::const_iterator cur_ent, end_ent;
+		cur_ent = entities.begin();
+		end_ent = entities.end();
+		for(; cur_ent != end_ent; ++cur_ent) {
+			SystemEntity *ent = *cur_ent;
+			
+			SystemBubble *into = _FindBubble(ent->GetPosition());
+			if(into == NULL || into->GetBubbleID() >= b->GetBubbleID())
+				continue;
+			
+			_log(DESTINY__BUBBLE_DEBUG, "Merging entity %u from bubble %u into overlapping bubble %u", ent->GetID(), b->GetBubbleID(), into->GetBubbleID());
+			if(into->IsEmpty())
+				m_emptySince.erase(into);
+			
+			//the usual remove/add notifications tell everybody involved about the change.
+			b->Remove(ent, true);
+			into->Add(ent, true);
+			m_merged++;
 		}
 	}
 }
 
-//NOTE: this should probably eventually be optimized to use a
-//spacial partitioning scheme to speed up this search.
-SystemBubble * BubbleManager::_FindBubble(const GPoint &pos) const {
-	std::vector<SystemBubble *>::const_iterator cur, end;
-	cur = m_bubbles.begin();
+void BubbleManager::_ReclaimBubbles(int32 now) {
+	const int32 grace = BubbleEmptyGrace_S * 1000;
+	
+	//compact the vector in place, so that the bubbles stay oldest first.
+	std::vector<SystemBubble *>::iterator cur, end, out;
+	cur = out = m_bubbles.begin();
 	end = m_bubbles.end();
 	for(; cur != end; ++cur) {
 		SystemBubble *b = *cur;
-		if(b->InBubble(pos)) {
-			return(b);
+		
+		if(!b->IsEmpty()) {
+			m_emptySince.erase(b);
+			*out++ = b;
+			continue;
 		}
+		
+		std::map<SystemBubble *, int32>::iterator res = m_emptySince.find(b);
+		if(res == m_emptySince.end()) {
+			m_emptySince.insert(std::make_pair(b, now));
+			*out++ = b;
+			continue;
+		}
+		if(now - res->second < grace) {
+			*out++ = b;
+			continue;
+		}
+		
+        sLog.Debug( "BubbleManager::_ReclaimBubbles()", "Bubble %u has been empty for %d s, deleting it.", b->GetBubbleID(), (now - res->second) / 1000 );
+		m_emptySince.erase(res);
+		_DeleteBubble(b);
+		m_reclaimed++;
+	}
+	m_bubbles.erase(out, end);
+}
+
+uint32 BubbleManager::GetWanderInterval() {
+	return BubbleWanderTimer_S * 1000;
+}
+
+double BubbleManager::GetBubbleRadius() {
+	return BubbleRadius_m;
+}
+
+BubbleManager::CellKey BubbleManager::_GetCell(const GPoint &pos) {
+	// clamp so that positions far outside of any system cannot overflow the cell coordinates
+	static const double limit = 1.0e9;
+	
+	CellKey key;
+	key.x = (int32)floor(std::max(-limit, std::min(limit, pos.x / BubbleRadius_m)));
+	key.y = (int32)floor(std::max(-limit, std::min(limit, pos.y / BubbleRadius_m)));
+	key.z = (int32)floor(std::max(-limit, std::min(limit, pos.z / BubbleRadius_m)));
+	return key;
+}
+
+SystemBubble * BubbleManager::_FindBubble(const GPoint &pos) const {
+	// only centers closer than one radius on every axis can contain pos; that's 3x3x3 = 27 cells at most.
+	const GVector reach(BubbleRadius_m, BubbleRadius_m, BubbleRadius_m);
+	const CellKey lo = _GetCell(pos - reach);
+	const CellKey hi = _GetCell(pos + reach);
+	
+	// bubbles may overlap; pick the oldest one, as the linear search used to.
+	SystemBubble *found = NULL;
+	
+	CellKey key;
+	for(key.x = lo.x; key.x <= hi.x; key.x++) {
+		for(key.y = lo.y; key.y <= hi.y; key.y++) {
+			for(key.z = lo.z; key.z <= hi.z; key.z++) {
+				CellMap::const_iterator res = m_cells.find(key);
+				if(res == m_cells.end())
+					continue;
+				
+				std::vector<SystemBubble *>::const_iterator cur, end;
+				cur = res->second.begin();
+				end = res->second.end();
+				for(; cur != end; ++cur) {
+					SystemBubble *b = *cur;
+					if(b->InBubble(pos) && (found == NULL || b->GetBubbleID() < found->GetBubbleID()))
+						found = b;
+				}
+			}
+		}
+	}
+	
+	return found;
+}
+
+uint32 BubbleManager::_CountOverlaps(const GPoint &center, const SystemBubble **nearest) const {
+	// bubbles overlap if their centers are closer than two radii; 5x5x5 = 125 cells at most.
+	const GVector reach(2 * BubbleRadius_m, 2 * BubbleRadius_m, 2 * BubbleRadius_m);
+	const CellKey lo = _GetCell(center - reach);
+	const CellKey hi = _GetCell(center + reach);
+	const double minDistance2 = (2 * BubbleRadius_m) * (2 * BubbleRadius_m);
+	
+	uint32 count = 0;
+	double nearestDistance2 = minDistance2;
+	*nearest = NULL;
+	
+	CellKey key;
+	for(key.x = lo.x; key.x <= hi.x; key.x++) {
+		for(key.y = lo.y; key.y <= hi.y; key.y++) {
+			for(key.z = lo.z; key.z <= hi.z; key.z++) {
+				CellMap::const_iterator res = m_cells.find(key);
+				if(res == m_cells.end())
+					continue;
+				
+				std::vector<SystemBubble *>::const_iterator cur, end;
+				cur = res->second.begin();
+				end = res->second.end();
+				for(; cur != end; ++cur) {
+					const double distance2 = GVector(center, (*cur)->m_center).lengthSquared();
+					if(distance2 >= minDistance2)
+						continue;
+					
+					count++;
+					if(distance2 < nearestDistance2) {
+						nearestDistance2 = distance2;
+						*nearest = *cur;
+					}
+				}
+			}
+		}
+	}
+	
+	return count;
+}
+
+GPoint BubbleManager::_PlaceBubble(const GPoint &pos, const GVector &heading) const {
+	GVector direction(heading);
+	direction.normalize();
+	
+	GPoint best(pos + direction * (0.96 * BubbleRadius_m));
+	const SystemBubble *nearest;
+	uint32 bestOverlaps = _CountOverlaps(best, &nearest);
+	if(bestOverlaps == 0)
+		return best;
+	
+	// push the center straight away from the closest bubble, just far enough
+	// to clear it, but keep the entity well inside the new bubble.
+	GVector away(nearest->m_center, pos);
+	const double distance = away.normalize();
+	if(distance > 0) {
+		const double shift = std::max(0.0, std::min(2 * BubbleRadius_m - distance + 1.0, 0.96 * BubbleRadius_m));
+		
+		const GPoint pushed(pos + away * shift);
+		const uint32 overlaps = _CountOverlaps(pushed, &nearest);
+		if(overlaps < bestOverlaps) {
+			best = pushed;
+			bestOverlaps = overlaps;
+		}
+	}
+	
+	// centering the bubble on the entity overlaps the least space of all centers containing it.
+	if(bestOverlaps > 0) {
+		const uint32 overlaps = _CountOverlaps(pos, &nearest);
+		if(overlaps < bestOverlaps) {
+			best = pos;
+			bestOverlaps = overlaps;
+		}
+	}
+	
+	if(bestOverlaps > 0)
+		_log(DESTINY__BUBBLE_TRACE, "New bubble at (%.0f, %.0f, %.0f) overlaps %u existing bubbles.", best.x, best.y, best.z, bestOverlaps);
+	
+	return best;
+}
+
+SystemBubble * BubbleManager::_CreateBubble(const GPoint &pos, const GVector &heading) {
+	SystemBubble *b = new SystemBubble(_PlaceBubble(pos, heading), BubbleRadius_m);
+	_AddBubble(b);
+	return b;
+}
+
+void BubbleManager::_AddBubble(SystemBubble *b) {
+	m_bubbles.push_back(b);
+	m_cells[_GetCell(b->m_center)].push_back(b);
+	
+	m_created++;
+	m_peak = std::max(m_peak, (uint32)m_bubbles.size());
+}
+
+void BubbleManager::_DeleteBubble(SystemBubble *b) {
+	//the caller takes care of m_bubbles.
+	CellMap::iterator res = m_cells.find(_GetCell(b->m_center));
+	if(res != m_cells.end()) {
+		std::vector<SystemBubble *> &cell = res->second;
+		cell.erase(std::remove(cell.begin(), cell.end(), b), cell.end());
+		if(cell.empty())
+			m_cells.erase(res);
 	}
-	//not in any existing bubble.
-	return NULL;
+	
+	delete b;
 }
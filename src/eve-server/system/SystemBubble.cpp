@@ -66,25 +66,27 @@ void SystemBubble::BubblecastDestiny(std::vector<PyTuple *> &updates, std::vecto
 //assume that static entities are also not interested in destiny updates.
 void SystemBubble::BubblecastDestinyUpdate( PyTuple** payload, const char* desc ) const
 {
+	TIC_PHASE( PHASE_BUBBLECAST );
+
 	PyTuple* up = *payload;
-	*payload = NULL;	//could optimize out one of the Clones in here...
-	
-	PyTuple* up_dup = NULL;
+	*payload = NULL;
 
     std::set<SystemEntity*>::const_iterator cur, end, tmp;
 	cur = m_dynamicEntities.begin();
 	end = m_dynamicEntities.end();
 	for(; cur != end; ++cur)
     {
-		if( NULL == up_dup )
-			up_dup = new PyTuple( *up );
+		//everybody gets a reference to the same tuple; nobody modifies queued updates.
+		//(copying a PyTuple does not reference its items, so copies freed them twice.)
+		PyTuple* up_ref = up;
+		PyIncRef( up_ref );
 
 		_log( DESTINY__BUBBLE_TRACE, "Bubblecast %s update to %s (%u)", desc, (*cur)->GetName(), (*cur)->GetID() );
-		(*cur)->QueueDestinyUpdate( &up_dup );
-		//they may not have consumed it (NPCs for example), so dont re-dup it in that case.
+		(*cur)->QueueDestinyUpdate( &up_ref );
+		//they may not have consumed it (NPCs for example).
+		PySafeDecRef( up_ref );
 	}
 
-    PySafeDecRef( up_dup );
     PyDecRef( up );
 }
 
@@ -92,25 +94,26 @@ void SystemBubble::BubblecastDestinyUpdate( PyTuple** payload, const char* desc
 //assume that static entities are also not interested in destiny updates.
 void SystemBubble::BubblecastDestinyEvent( PyTuple** payload, const char* desc ) const
 {
+	TIC_PHASE( PHASE_BUBBLECAST );
+
 	PyTuple* up = *payload;
-	*payload = NULL;	//could optimize out one of the Clones in here...
-	
-	PyTuple* up_dup = NULL;
+	*payload = NULL;
 
     std::set<SystemEntity *>::const_iterator cur, end, tmp;
 	cur = m_dynamicEntities.begin();
 	end = m_dynamicEntities.end();
 	for(; cur != end; ++cur)
     {
-		if( NULL == up_dup )
-			up_dup = new PyTuple( *up );
+		//see BubblecastDestinyUpdate().
+		PyTuple* up_ref = up;
+		PyIncRef( up_ref );
 
 		_log( DESTINY__BUBBLE_TRACE, "Bubblecast %s event to %s (%u)", desc, (*cur)->GetName(), (*cur)->GetID() );
-		(*cur)->QueueDestinyEvent( &up_dup );
-		//they may not have consumed it (NPCs for example), so dont re-dup it in that case.
+		(*cur)->QueueDestinyEvent( &up_ref );
+		//they may not have consumed it (NPCs for example).
+		PySafeDecRef( up_ref );
 	}
 
-    PySafeDecRef( up_dup );
     PyDecRef( up );
 }
 
@@ -250,7 +253,7 @@ void SystemBubble::_SendAddBalls( SystemEntity* to_who )
         //damageState
 		addballs.damages[ cur->second->GetID() ] = cur->second->MakeDamageState();
 		//slim item
-		addballs.slims->AddItem( new PyObject( new PyString( "foo.SlimItem" ), cur->second->MakeSlimItem() ) );
+		addballs.slims->AddItem( cur->second->GetSlimItem() );
 		//append the destiny binary data...
 		cur->second->EncodeDestiny( *destinyBuffer );
 	}
@@ -258,15 +261,19 @@ void SystemBubble::_SendAddBalls( SystemEntity* to_who )
     addballs.destiny_binary = new PyBuffer( &destinyBuffer );
     SafeDelete( destinyBuffer );
 
-    _log( DESTINY__TRACE, "Add Balls:" );
-    addballs.Dump( DESTINY__TRACE, "    " );
-    _log( DESTINY__TRACE, "    Ball Binary:" );
-    _hex( DESTINY__TRACE, &( addballs.destiny_binary->content() )[0],
-                          addballs.destiny_binary->content().size() );
+    //walking the whole update is not cheap; only do it if it is going to be printed.
+    if( is_log_enabled( DESTINY__TRACE ) )
+    {
+        _log( DESTINY__TRACE, "Add Balls:" );
+        addballs.Dump( DESTINY__TRACE, "    " );
+        _log( DESTINY__TRACE, "    Ball Binary:" );
+        _hex( DESTINY__TRACE, &( addballs.destiny_binary->content() )[0],
+                              addballs.destiny_binary->content().size() );
 
-    _log( DESTINY__TRACE, "    Ball Decoded:" );
-    Destiny::DumpUpdate( DESTINY__TRACE, &( addballs.destiny_binary->content() )[0],
-                                         addballs.destiny_binary->content().size() );
+        _log( DESTINY__TRACE, "    Ball Decoded:" );
+        Destiny::DumpUpdate( DESTINY__TRACE, &( addballs.destiny_binary->content() )[0],
+                                             addballs.destiny_binary->content().size() );
+    }
 
     PyTuple* t = addballs.Encode();
 	to_who->QueueDestinyUpdate( &t );	//may consume, but may not.
@@ -329,7 +336,7 @@ void SystemBubble::_BubblecastAddBall( SystemEntity* about_who )
     //encode damage state
 	addballs.damages[ about_who->GetID() ] = about_who->MakeDamageState();
 	//encode SlimItem
-	addballs.slims->AddItem( new PyObject( new PyString( "foo.SlimItem" ), about_who->MakeSlimItem() ) );
+	addballs.slims->AddItem( about_who->GetSlimItem() );
 
     //bubblecast the update
 	PyTuple* t = addballs.Encode();
@@ -119,6 +119,35 @@ bool SystemDB::LoadSystemDynamicEntities(uint32 systemID, std::vector<DBSystemDy
 	return true;
 }
 
+bool SystemDB::LoadSystemJumps(uint32 systemID, std::map<uint32, std::vector<DBSystemJump> > &into) {
+	DBQueryResult res;
+	
+	if(!sDatabase.RunQuery(res,
+		"SELECT "
+		" stargateID,"
+		" celestialID AS toCelestialID,"
+		" destination.solarSystemID AS locationID"
+		" FROM mapJumps"
+		"	JOIN mapDenormalize AS gate ON stargateID=gate.itemID"
+		"	LEFT JOIN mapDenormalize AS destination ON celestialID=destination.itemID"
+		" WHERE gate.solarSystemID=%u", systemID))
+	{
+		codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
+		return false;
+	}
+	
+	DBResultRow row;
+	DBSystemJump entry;
+	while(res.GetRow(row)) {
+		entry.stargateID = row.GetUInt(0);
+		entry.toCelestialID = row.GetUInt(1);
+		entry.locationID = (row.IsNull(2) ? 0 : row.GetUInt(2));
+		into[entry.stargateID].push_back(entry);
+	}
+
+	return true;
+}
+
 
 PyObject *SystemDB::ListFactions() {
 	DBQueryResult res;
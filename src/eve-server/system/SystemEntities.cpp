@@ -58,7 +58,7 @@ SimpleSystemEntity::SimpleSystemEntity( SystemManager* system, const DBSystemEnt
 {
 }
 
-bool SimpleSystemEntity::LoadExtras(SystemDB *db) {
+bool SimpleSystemEntity::LoadExtras(const SystemBootData &data) {
 	return true;
 }
 
@@ -180,13 +180,39 @@ SystemStargateEntity::~SystemStargateEntity() {
 	PySafeDecRef( m_jumps );
 }
 	
-bool SystemStargateEntity::LoadExtras(SystemDB *db) {
-	if(!SystemStationEntity::LoadExtras(db))
+bool SystemStargateEntity::LoadExtras(const SystemBootData &data) {
+	if(!SystemStationEntity::LoadExtras(data))
 		return false;
 
-	m_jumps = db->ListJumps(GetID());
-	if(m_jumps == NULL)
-		return false;
+	//the rowset SystemDB::ListJumps() would return.
+	PyDict *args = new PyDict();
+	m_jumps = new PyObject(new PyString("util.Rowset"), args);
+
+	PyList *header = new PyList(2);
+	header->SetItemString(0, "toCelestialID");
+	header->SetItemString(1, "locationID");
+	args->SetItemString("header", header);
+	args->SetItemString("RowClass", new PyToken("util.Row"));
+
+	PyList *lines = new PyList();
+	args->SetItemString("lines", lines);
+
+	std::map<uint32, std::vector<DBSystemJump> >::const_iterator res = data.jumps.find(GetID());
+	if(res != data.jumps.end()) {
+		std::vector<DBSystemJump>::const_iterator cur, end;
+		cur = res->second.begin();
+		end = res->second.end();
+		for(; cur != end; cur++) {
+			PyList *line = new PyList(2);
+			line->SetItem(0, new PyInt(cur->toCelestialID));
+			if(cur->locationID != 0)
+				line->SetItem(1, new PyInt(cur->locationID));
+			else
+				line->SetItem(1, new PyNone());
+			lines->AddItem(line);
+		}
+	}
+
 	return true;
 }
 
@@ -239,8 +265,8 @@ void SystemAsteroidBeltEntity::EncodeDestiny( Buffer& into ) const
     utf8::utf8to16( data.itemName.begin(), data.itemName.end(), name );
 }
 
-bool SystemAsteroidBeltEntity::LoadExtras(SystemDB *db) {
-	if(!SimpleSystemEntity::LoadExtras(db))
+bool SystemAsteroidBeltEntity::LoadExtras(const SystemBootData &data) {
+	if(!SimpleSystemEntity::LoadExtras(data))
 		return false;
 	
 	//TODO: fire up the belt manager.
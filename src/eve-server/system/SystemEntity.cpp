@@ -29,10 +29,16 @@ using namespace Destiny;
 
 SystemEntity::SystemEntity()
 : targets(this),
-  m_bubble(NULL)
+  m_bubble(NULL),
+  m_slimItem(NULL),
+  m_slimItemStamp(0)
 {
 }
 
+SystemEntity::~SystemEntity() {
+	PySafeDecRef( m_slimItem );
+}
+
 void SystemEntity::Process() {
 	targets.Process();
 }
@@ -55,6 +61,34 @@ PyTuple *SystemEntity::MakeDamageState() const {
 	return(ddds.Encode());
 }
 
+PyObject *SystemEntity::GetSlimItem() const {
+	//everybody in a bubble gets the same slims, and a whole fleet may arrive within one tic.
+	//the slim of a ship may change any time though; the setters involved (fitting, corporation, rename)
+	//call InvalidateCache(), and it is not kept past the tic anyway.
+	if( m_slimItem == NULL
+		|| ( !IsVisibleSystemWide() && m_slimItemStamp != DestinyManager::GetStamp() ) )
+	{
+		PySafeDecRef( m_slimItem );
+		m_slimItem = new PyObject( new PyString( "foo.SlimItem" ), MakeSlimItem() );
+		m_slimItemStamp = DestinyManager::GetStamp();
+	}
+
+	PyIncRef( m_slimItem );
+	return(m_slimItem);
+}
+
+void SystemEntity::InvalidateCache() {
+	if( m_slimItem == NULL )
+		return;	//nothing kept; this is the case while we are constructed as well.
+
+	PyDecRef( m_slimItem );
+	m_slimItem = NULL;
+
+	//the system keeps our slim (and ball) in the destiny state of everybody.
+	if( IsVisibleSystemWide() && System() != NULL )
+		System()->InvalidateSystemWideState();
+}
+
 ItemSystemEntity::ItemSystemEntity(InventoryItemRef self)
 : SystemEntity(),
   m_self()
@@ -75,6 +109,7 @@ void ItemSystemEntity::_SetSelf(InventoryItemRef self) {
 	}
 
 	m_self = self;
+	InvalidateCache();
 
     // DEPRECATED NOW WITH THE USE OF NEW ATTRIBUTE SYSTEM AND SAVING OF THOSE ATTRIBUTES TO THE DB -- Aknor Jaden
 	//I am not sure where the right place to do this is, but until
@@ -147,6 +182,10 @@ void DynamicSystemEntity::ProcessDestiny() {
 		m_destiny->Process();
 }
 
+size_t DynamicSystemEntity::GetMemoryUsage() const {
+	return(sizeof(DynamicSystemEntity) + (m_destiny == NULL ? 0 : sizeof(DestinyManager)));
+}
+
 const GPoint &DynamicSystemEntity::GetPosition() const {
 	if(m_destiny == NULL)
 		return(ItemSystemEntity::GetPosition());
@@ -33,28 +33,27 @@ SystemManager::SystemManager(uint32 systemID, PyServiceMgr &svc)//, ItemData ida
   m_systemName(""),
   m_services(svc),
   m_spawnManager(new SpawnManager(*this, m_services)),
-  m_entityChanged(false)//,
+  m_clientCount(0),
+  m_idleSince(Timer::GetTimeSeconds()),
+  m_inPass(false),
+  m_systemWideValid(false),
+  m_solItem(NULL),
+  m_droneState(NULL)//,
 //  InventoryItem( svc.item_factory, systemID, *(svc.item_factory.GetType( 5 )), idata )
 {
-	m_db.GetSystemInfo(GetID(), NULL, NULL, &m_systemName, &m_systemSecurity);
-
-    m_solarSystemRef = svc.item_factory.GetSolarSystem( systemID );
-    uint32 inventoryID = m_solarSystemRef->itemID();
-
-    //create our chat channel
-	m_services.lsc_service->CreateSystemChannel(m_systemID);
+	//everything which touches the database is done by BootSystem(),
+	//so that an empty system may be built without one (eve-bench).
 }
 
 SystemManager::~SystemManager() {
 	//we mustn't delete clients because they are owned by the entity list.
-	std::map<uint32, SystemEntity *>::iterator cur, end, tmp;
-	cur = m_entities.begin();
-	end = m_entities.end();
-	while(cur != end) {
-		SystemEntity *se = cur->second;
-		cur++;
+	//NPCs remove themselves as they are deleted, so this is a pass too.
+	//their items are gone already, see DepopNPCs(); the factory may be gone by now as well.
+	m_inPass = true;
+	for(size_t i = 0; i < m_entities.size(); i++) {
+		SystemEntity *se = m_entities[i];
 
-		if(!se->IsClient())
+		if(se != NULL && !se->IsClient())
 			delete se;
 	}
 
@@ -63,6 +62,9 @@ SystemManager::~SystemManager() {
 	delete m_spawnManager;
 
 	bubbles.clear();
+
+	PySafeDecRef( m_solItem );
+	PySafeDecRef( m_droneState );
 }
 
 static const int num_hack_sentry_locs = 8;
@@ -77,24 +79,20 @@ GPoint hack_sentry_locs[num_hack_sentry_locs] = {
 	GPoint(35000.0f, 35000.0f, 35000.0f)
 };
 
-bool SystemManager::_LoadSystemCelestials() {
-	std::vector<DBSystemEntity> entities;
-	if(!m_db.LoadSystemEntities(m_systemID, entities)) {
-		_log(SERVICE__ERROR, "Unable to load celestial entities during boot of system %u.", m_systemID);
-		return false;
-    }
-
+void SystemManager::_LoadSystemCelestials(const SystemBootData &data) {
 	//uint32 next_hack_entity_ID = m_systemID + 900000000;
 	
-	std::vector<DBSystemEntity>::iterator cur, end;
-	cur = entities.begin();
-	end = entities.end();
+	std::vector<DBSystemEntity>::const_iterator cur, end;
+	cur = data.celestials.begin();
+	end = data.celestials.end();
 	for(; cur != end; ++cur) {
-        if( itemFactory().GetItem( cur->itemID ) )
+        InventoryItemRef item = itemFactory().GetItem( cur->itemID );
+        if( item )
         {
-            if( itemFactory().GetItem( cur->itemID )->categoryID() == EVEDB::invCategories::Station )
+            if( item->categoryID() == EVEDB::invCategories::Station )
             {
-                StationRef station = Station::Load( itemFactory(), cur->itemID );
+                //the very item just cached; Station::Load() would build (and fill) a second one.
+                StationRef station = itemFactory().GetStation( cur->itemID );
                 StationEntity *stationEntity = new StationEntity( station, this, *(GetServiceMgr()), cur->position );
 		        if(stationEntity == NULL) {
 			        codelog(SERVICE__ERROR, "Failed to create entity for item %u (type %u)", cur->itemID, cur->typeID);
@@ -113,9 +111,8 @@ bool SystemManager::_LoadSystemCelestials() {
                 stationRef->SetAttribute(AttrRadius,        stationRef->type().attributes.radius());     // Radius
                 stationRef->SetAttribute(AttrVolume,        stationRef->type().attributes.volume());     // Volume
 
-                m_entities[stationEntity->GetStationObject()->itemID()] = stationEntity;
+                _InsertEntity(stationEntity);
 		        bubbles.Add(stationEntity, true);
-		        m_entityChanged = true;
             }
             else
             {
@@ -124,19 +121,16 @@ bool SystemManager::_LoadSystemCelestials() {
 			        codelog(SERVICE__ERROR, "Failed to create entity for item %u (type %u)", cur->itemID, cur->typeID);
 			        continue;
 		        }
-		        if(!se->LoadExtras(&m_db)) {
+		        if(!se->LoadExtras(data)) {
 			        _log(SERVICE__ERROR, "Failed to load additional data for entity %u. Skipping.", se->GetID());
 			        delete se;
 			        continue;
 		        }
-		        m_entities[se->GetID()] = se;
+		        _InsertEntity(se);
 		        bubbles.Add(se, false);
-		        m_entityChanged = true;
             }
         }
 	}
-	
-	return true;
 }
 
 class DynamicEntityFactory {
@@ -462,43 +456,117 @@ public:
 	}
 };
 
-bool SystemManager::_LoadSystemDynamics() {
-	std::vector<DBSystemDynamicEntity> entities;
-	if(!m_db.LoadSystemDynamicEntities(m_systemID, entities)) {
-		_log(SERVICE__ERROR, "Unable to load dynamic entities during boot of system %u.", m_systemID);
-		return false;
-    }
-
+void SystemManager::_LoadSystemDynamics(const SystemBootData &data) {
 	//uint32 next_hack_entity_ID = m_systemID + 900000000;
 	
-	std::vector<DBSystemDynamicEntity>::iterator cur, end;
-	cur = entities.begin();
-	end = entities.end();
+	std::vector<DBSystemDynamicEntity>::const_iterator cur, end;
+	cur = data.dynamics.begin();
+	end = data.dynamics.end();
 	for(; cur != end; cur++) {
-		SystemEntity *se = DynamicEntityFactory::BuildEntity(*this, m_services.item_factory, *cur);
+		//the rows may be older than the item, if read by the loader; one which left us meanwhile is cached with its new location.
+		InventoryItemRef item = itemFactory().PeekItem(cur->itemID);
+		if(item && item->locationID() != m_systemID)
+			continue;
+		
+		SystemEntity *se = NULL;
+		try {
+			se = DynamicEntityFactory::BuildEntity(*this, m_services.item_factory, *cur);
+		} catch(PyException &) {
+			//not booting because of a single broken item.
+		}
 		if(se == NULL) {
 			codelog(SERVICE__ERROR, "Failed to create entity for item %u (type %u)", cur->itemID, cur->typeID);
 			continue;
 		}
 		//TODO: use proper log type.
 		_log(SPAWN__MESSAGE, "Loaded dynamic entity %u of type %u for system %u", cur->itemID, cur->typeID, m_systemID);
-		m_entities[se->GetID()] = se;
+		_InsertEntity(se);
 		bubbles.Add(se, false);
-		m_entityChanged = true;
+	}
+}
+
+bool SystemManager::LoadSystem(ItemFactory &factory, SystemBootData &into) {
+	SystemDB db;
+
+	db.GetSystemInfo(into.systemID, NULL, NULL, &into.systemName, &into.systemSecurity);
+
+	//the static system stuff...
+	if(!db.LoadSystemEntities(into.systemID, into.celestials)) {
+		_log(SERVICE__ERROR, "Unable to load celestial entities during boot of system %u.", into.systemID);
+		return false;
+	}
+	if(!db.LoadSystemJumps(into.systemID, into.jumps)) {
+		_log(SERVICE__ERROR, "Unable to load stargate jumps during boot of system %u.", into.systemID);
+		return false;
 	}
 	
+	//the dynamic system stuff (items, roids, etc...)
+	if(!db.LoadSystemDynamicEntities(into.systemID, into.dynamics)) {
+		_log(SERVICE__ERROR, "Unable to load dynamic entities during boot of system %u.", into.systemID);
+		return false;
+	}
+
+	//the rows of the items we are going to load: whatever lies in space or in our stations,
+	//and the saved attributes of the celestials, whose own rows are static.
+	std::vector<uint32> locations(1, into.systemID), celestials;
+	std::vector<DBSystemEntity>::const_iterator cur, end;
+	cur = into.celestials.begin();
+	end = into.celestials.end();
+	for(; cur != end; ++cur) {
+		celestials.push_back(cur->itemID);
+		if(cur->groupID == EVEDB::invGroups::Station)
+			locations.push_back(cur->itemID);
+	}
+
+	if(!factory.LoadPrefetch(locations, into.items)
+	   || !factory.LoadPrefetchAttributes(celestials, into.items)) {
+		_log(SERVICE__ERROR, "Unable to prefetch the items of system %u; they are going to be loaded one by one.", into.systemID);
+		into.items = ItemFactory::PrefetchData();
+	}
+
 	return true;
 }
 
 bool SystemManager::BootSystem() {
+	SystemBootData data;
+	data.systemID = m_systemID;
+
+	itemFactory().QueuePrefetch();
+	if(!LoadSystem(itemFactory(), data)) {
+		itemFactory().CancelPrefetch();
+		return false;
+	}
+
+	return BootSystem(data);
+}
+
+bool SystemManager::BootSystem(SystemBootData &data) {
+	m_systemName.swap(data.systemName);
+	m_systemSecurity.swap(data.systemSecurity);
+
+	//our items are built from the rows read by LoadSystem().
+	ItemFactory &factory = itemFactory();
+	factory.BeginPrefetch(data.items);
+
+    m_solarSystemRef = factory.GetSolarSystem( m_systemID );
+    if( !m_solarSystemRef )
+    {
+        _log(SERVICE__ERROR, "Unable to load solar system item during boot of system %u.", m_systemID);
+        factory.EndPrefetch();
+        return false;
+    }
+
+    //create our chat channel
+    if( m_services.lsc_service != NULL )
+	    m_services.lsc_service->CreateSystemChannel(m_systemID);
 	
 	//load the static system stuff...
-	if(!_LoadSystemCelestials())
-		return false;
+	_LoadSystemCelestials(data);
 	
 	//load the dynamic system stuff (items, roids, etc...)
-	if(!_LoadSystemDynamics())
-		return false;
+	_LoadSystemDynamics(data);
+
+	factory.EndPrefetch();
 	
 	/* temporarily commented out until we find out why they
 	 * make client angry ...
@@ -517,27 +585,70 @@ bool SystemManager::BootSystem() {
 	return true;
 }
 
-//called many times a second
-bool SystemManager::Process() {
-	m_entityChanged = false;
-	
-	std::map<uint32, SystemEntity *>::const_iterator cur, end;
+void SystemManager::Hibernate() {
+	//NPCs are not kept; their spawns are saved as due, so that they pop again once we wake up.
+	//everything else in space is loaded from the DB by BootSystem() again.
+	if(!m_spawnManager->Save())
+		_log(SERVICE__ERROR, "Unable to save spawns during hibernation of system %u.", m_systemID);
+
+	DepopNPCs();
+}
+
+void SystemManager::DepopNPCs() {
+	//NPCs remove themselves as they are deleted.
+	m_inPass = true;
+
+	for(size_t i = 0; i < m_entities.size(); i++) {
+		SystemEntity *se = m_entities[i];
+		if(se == NULL || !se->IsNPC())
+			continue;
+
+		//otherwise the row stays and the next boot loads it as a hull, next to what the spawn pops.
+		InventoryItemRef item = se->Item();
+		delete se;
+		if(item)
+			item->Delete();
+	}
+
+	_EndPass();
+}
+
+void SystemManager::KeepAwake() {
+	if(m_clientCount == 0)
+		m_idleSince = Timer::GetTimeSeconds();
+}
+
+size_t SystemManager::GetMemoryUsage() const {
+	size_t size = sizeof(SystemManager)
+		+ m_entities.capacity() * sizeof(SystemEntity *)
+		+ m_entityIndex.size() * (sizeof(EntityIndex::value_type) + 2 * sizeof(void *))
+		+ m_systemWideBalls.size()
+		+ bubbles.GetBubbleCount() * sizeof(SystemBubble);
+
+	std::vector<SystemEntity *>::const_iterator cur, end;
 	cur = m_entities.begin();
 	end = m_entities.end();
-	while(cur != end) {
-		cur->second->Process();
-
-		if(m_entityChanged) {
-			//somebody changed the entity list, need to start over or bail...
-			m_entityChanged = false;
+	for(; cur != end; ++cur) {
+		if(*cur != NULL)
+			size += (*cur)->GetMemoryUsage();
+	}
+	
+	return size;
+}
 
-			cur = m_entities.begin();
-			end = m_entities.end();
-		} else {
-			cur++;
-		}
+//called many times a second
+bool SystemManager::Process() {
+	//entities which spawn, die or jump meanwhile are dealt with by _EndPass().
+	m_inPass = true;
+	
+	for(size_t i = 0; i < m_entities.size(); i++) {
+		SystemEntity *se = m_entities[i];
+		if(se != NULL)
+			se->Process();
 	}
 	
+	_EndPass();
+	
 	bubbles.Process();
 	
 	return true;
@@ -545,27 +656,21 @@ bool SystemManager::Process() {
 
 //called once per second.
 void SystemManager::ProcessDestiny() {
+	TIC_PHASE( PHASE_PHYSICS );
+
 	//this is here so it isnt called so frequently.
 	m_spawnManager->Process();
 
-	m_entityChanged = false;
-
-	std::map<uint32, SystemEntity *>::const_iterator cur, end;
-	cur = m_entities.begin();
-	end = m_entities.end();
-	while(cur != end) {
-		cur->second->ProcessDestiny();
-
-		if(m_entityChanged) {
-			//somebody changed the entity list, need to start over or bail...
-			m_entityChanged = false;
+	//see Process().
+	m_inPass = true;
 
-			cur = m_entities.begin();
-			end = m_entities.end();
-		} else {
-			cur++;
-		}
+	for(size_t i = 0; i < m_entities.size(); i++) {
+		SystemEntity *se = m_entities[i];
+		if(se != NULL)
+			se->ProcessDestiny();
 	}
+	
+	_EndPass();
 }
 
 bool SystemManager::BuildDynamicEntity(Client *who, const DBSystemDynamicEntity &entity)
@@ -578,15 +683,15 @@ bool SystemManager::BuildDynamicEntity(Client *who, const DBSystemDynamicEntity
 	}
 	
     sLog.Debug( "SystemManager::BuildDynamicEntity()", "Loaded dynamic entity %u of type %u for system %u", entity.itemID, entity.typeID, m_systemID );
-	m_entities[se->GetID()] = se;
+	_InsertEntity(se);
 	bubbles.Add(se, false);
-	m_entityChanged = true;
 
     return true;
 }
 
 void SystemManager::AddClient(Client *who) {
     AddEntity( who );
+	m_clientCount++;
 	//m_entities[who->GetID()] = who;
 	//m_entityChanged = true;
 	//this is actually handled in SetPosition via UpdateBubble.
@@ -601,6 +706,8 @@ void SystemManager::AddClient(Client *who) {
 
 void SystemManager::RemoveClient(Client *who) {
 	RemoveEntity(who);
+	if(m_clientCount > 0 && --m_clientCount == 0)
+		m_idleSince = Timer::GetTimeSeconds();
 	_log(CLIENT__TRACE, "%s: Removed from system manager for %u", who->GetName(), m_systemID);
 
     // Remove character's Ship Item Ref from Solar System dynamic inventory:
@@ -624,34 +731,120 @@ void SystemManager::RemoveNPC(NPC *who) {
 }
 
 void SystemManager::AddEntity(SystemEntity *who) {
-	m_entities[who->GetID()] = who;
-	m_entityChanged = true;
+	_InsertEntity(who);
 	bubbles.Add(who, false);
 
-    // Add Entity's Item Ref to Solar System Dynamic Inventory:
-    AddItemToInventory( this->itemFactory().GetItem( who->GetID() ) );
+    // Add Entity's Item Ref to Solar System Dynamic Inventory (there is none unless booted):
+    if( m_solarSystemRef )
+        AddItemToInventory( this->itemFactory().GetItem( who->GetID() ) );
 }
 
 void SystemManager::RemoveEntity(SystemEntity *who) {
-	std::map<uint32, SystemEntity *>::iterator itr = m_entities.find(who->GetID());
-	if(itr != m_entities.end()) {
-		m_entities.erase(itr);
-		m_entityChanged = true;
-	} else
+	if(!_EraseEntity(who))
 		_log(SERVICE__ERROR, "Entity %u not found is system %u to be deleted.", who->GetID(), GetID());
 
 	bubbles.Remove(who, false);
 
-    // Remove Entity's Item Ref from Solar System Dynamic Inventory:
-    RemoveItemFromInventory( this->itemFactory().GetItem( who->GetID() ) );
+    // Remove Entity's Item Ref from Solar System Dynamic Inventory (there is none unless booted):
+    if( m_solarSystemRef )
+        RemoveItemFromInventory( this->itemFactory().GetItem( who->GetID() ) );
 }
 
 SystemEntity *SystemManager::get(uint32 entityID) const {
-	std::map<uint32, SystemEntity *>::const_iterator res;
-	res = m_entities.find(entityID);
-	if(res == m_entities.end())
+	//an entity may have been replaced during the pass.
+	if(!m_pendingAdds.empty()) {
+		EntityMap::const_iterator pending = m_pendingAdds.find(entityID);
+		if(pending != m_pendingAdds.end())
+			return(pending->second);
+	}
+	
+	EntityIndex::const_iterator res = m_entityIndex.find(entityID);
+	if(res == m_entityIndex.end())
 		return NULL;
-	return(res->second);
+	return(m_entities[res->second]);
+}
+
+void SystemManager::_InsertEntity(SystemEntity *who) {
+	if(who->IsVisibleSystemWide())
+		InvalidateSystemWideState();
+	
+	if(m_inPass) {
+		//joins after the pass.
+		m_pendingAdds[who->GetID()] = who;
+		return;
+	}
+	
+	EntityIndex::iterator res = m_entityIndex.find(who->GetID());
+	if(res != m_entityIndex.end()) {
+		m_entities[res->second] = who;
+		return;
+	}
+	
+	m_entityIndex[who->GetID()] = m_entities.size();
+	m_entities.push_back(who);
+}
+
+bool SystemManager::_EraseEntity(SystemEntity *who) {
+	const uint32 entityID = who->GetID();
+	
+	if(who->IsVisibleSystemWide())
+		InvalidateSystemWideState();
+	
+	//it might not have joined yet.
+	const bool found = (m_pendingAdds.erase(entityID) > 0);
+	
+	EntityIndex::iterator res = m_entityIndex.find(entityID);
+	if(res == m_entityIndex.end())
+		return found;
+	
+	const size_t index = res->second;
+	m_entityIndex.erase(res);
+	
+	if(m_inPass) {
+		//the pass may or may not be past this slot; keep the others where they are.
+		m_entities[index] = NULL;
+		m_pendingRemoves.push_back(index);
+	} else
+		_EraseSlot(index);
+	
+	return true;
+}
+
+void SystemManager::_EraseSlot(size_t index) {
+	SystemEntity *last = m_entities.back();
+	m_entities.pop_back();
+	
+	if(index < m_entities.size()) {
+		m_entities[index] = last;
+		m_entityIndex[last->GetID()] = index;
+	}
+}
+
+void SystemManager::_EndPass() {
+	m_inPass = false;
+	
+	if(!m_pendingRemoves.empty()) {
+		//highest slot first, so that the last slot is never an empty one other than the erased.
+		std::sort(m_pendingRemoves.begin(), m_pendingRemoves.end(), std::greater<size_t>());
+		
+		std::vector<size_t>::const_iterator cur, end;
+		cur = m_pendingRemoves.begin();
+		end = m_pendingRemoves.end();
+		for(; cur != end; ++cur)
+			_EraseSlot(*cur);
+		
+		m_pendingRemoves.clear();
+	}
+	
+	if(!m_pendingAdds.empty()) {
+		EntityMap::const_iterator cur, end;
+		cur = m_pendingAdds.begin();
+		end = m_pendingAdds.end();
+		for(; cur != end; ++cur)
+			_InsertEntity(cur->second);
+		
+		m_pendingAdds.clear();
+	}
 }
 
 /* maybe this is the reason why warping sucks... */
@@ -662,59 +855,101 @@ double SystemManager::GetWarpSpeed() const {
 	return(3.0f * ONE_AU_IN_METERS);
 }
 
+void SystemManager::InvalidateSystemWideState() {
+	m_systemWideValid = false;
+	m_systemWide.clear();
+	m_systemWideBalls.Resize<uint8>( 0 );
+}
+
+void SystemManager::_BuildSystemWideState() const
+{
+	m_systemWide.clear();
+	m_systemWideBalls.Resize<uint8>( 0 );
+
+	//we may be in the middle of a pass, so there may be empty slots and pending entities.
+	std::vector<SystemEntity*>::const_iterator cur, end;
+	cur = m_entities.begin();
+	end = m_entities.end();
+	for(; cur != end; ++cur)
+	{
+		if( *cur != NULL && (*cur)->IsVisibleSystemWide() )
+			m_systemWide.push_back( *cur );
+	}
+
+	EntityMap::const_iterator cur_pending, end_pending;
+	cur_pending = m_pendingAdds.begin();
+	end_pending = m_pendingAdds.end();
+	for(; cur_pending != end_pending; ++cur_pending)
+	{
+		if( cur_pending->second->IsVisibleSystemWide() )
+			m_systemWide.push_back( cur_pending->second );
+	}
+
+	//these do not move, so their balls are good until one of them changes.
+	cur = m_systemWide.begin();
+	end = m_systemWide.end();
+	for(; cur != end; ++cur)
+		(*cur)->EncodeDestiny( m_systemWideBalls );
+
+	m_systemWideValid = true;
+}
+
 void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState &ss) const
 {
+	if( !m_systemWideValid )
+		_BuildSystemWideState();
+
     Buffer* stateBuffer = new Buffer;
+	stateBuffer->Reserve<uint8>( sizeof( AddBall_header ) + m_systemWideBalls.size() );
 
     AddBall_header head;
 	head.more = 0;
 	head.sequence = ss.stamp;
     stateBuffer->Append( head );
-	
-	//I am not thrilled with this mechanism, but I cant think of a better
-	//way to deal with it right now. The issue is that we need to send out
-	// info for all system-wide entities (celestials, etc), as well as all
-	// entities in our current bubble. Well, it is likely that some things
-	// in our bubble are system-wide, and we would be sending out duplciates.
-	// so, we use a set to enforce uniqueness.
-	std::set<SystemEntity*> visibleEntities;
-	{
-		std::map<uint32, SystemEntity*>::const_iterator cur, end;
-		cur = m_entities.begin();
-		end = m_entities.end();
-		for(; cur != end; ++cur)
-        {
-			if( !cur->second->IsVisibleSystemWide() )
-            {
-                //_log(COMMON__WARNING, "%u is not visible!", cur->first);
-				continue;
-			}
 
-            //_log(COMMON__WARNING, "%u is system wide visible!", cur->first);
-			visibleEntities.insert( cur->second );
-		}
+    PySafeDecRef( ss.slims );
+    ss.slims = new PyList;
+
+	//we need to send out info for all system-wide entities (celestials, etc),
+	//as well as all entities in our current bubble. The system-wide ones
+	//are the same for everybody, so their balls are encoded just once.
+    stateBuffer->AppendSeq( m_systemWideBalls.begin<uint8>(), m_systemWideBalls.end<uint8>() );
+
+	std::vector<SystemEntity*>::const_iterator cur_wide, end_wide;
+	cur_wide = m_systemWide.begin();
+	end_wide = m_systemWide.end();
+	for(; cur_wide != end_wide; ++cur_wide)
+    {
+		SystemEntity* ent = *cur_wide;
+
+		//ss.damageState
+		ss.damageState[ ent->GetID() ] = ent->MakeDamageState();
+
+		//ss.slims
+		ss.slims->AddItem( ent->GetSlimItem() );
 	}
 
+	//some things in our bubble are system-wide, and we would be sending out duplicates.
+	std::set<SystemEntity*> bubbleEntities;
     //bubble is null??? why???
-	bubble->GetEntities( visibleEntities );
-
-    PySafeDecRef( ss.slims );
-    ss.slims = new PyList;
+	bubble->GetEntities( bubbleEntities );
 
 	//go through all entities and gather the info we need...
 	std::set<SystemEntity*>::const_iterator cur, end;
-	cur = visibleEntities.begin();
-	end = visibleEntities.end();
+	cur = bubbleEntities.begin();
+	end = bubbleEntities.end();
 	for(; cur != end; ++cur)
     {
 		SystemEntity* ent = *cur;
+		if( ent->IsVisibleSystemWide() )
+			continue;	//already in there
         //_log(COMMON__WARNING, "Encoding entity %u", ent->GetID());
 
 		//ss.damageState
 		ss.damageState[ ent->GetID() ] = ent->MakeDamageState();
 
 		//ss.slims
-		ss.slims->AddItem( new PyObject( new PyString( "foo.SlimItem" ), ent->MakeSlimItem() ) );
+		ss.slims->AddItem( ent->GetSlimItem() );
 
 		//append the destiny binary data...
 		ent->EncodeDestiny( *stateBuffer );
@@ -729,20 +964,32 @@ void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState
 	//ss.aggressors
 
 	//ss.droneState
-	ss.droneState = m_db.GetSolDroneState( m_systemID );
-	if( NULL == ss.droneState )
+	if( NULL == m_droneState )
+		m_droneState = m_db.GetSolDroneState( m_systemID );
+	if( NULL == m_droneState )
     {
 		_log( SERVICE__ERROR, "Unable to query dronestate entity for destiny update in system %u!", m_systemID );
 		ss.droneState = new PyNone;
 	}
+	else
+	{
+		PyIncRef( m_droneState );
+		ss.droneState = m_droneState;
+	}
 
 	//ss.solItem
-	ss.solItem = m_db.GetSolRow( m_systemID );
-	if( NULL == ss.solItem )
+	if( NULL == m_solItem )
+		m_solItem = m_db.GetSolRow( m_systemID );
+	if( NULL == m_solItem )
     {
 		_log( CLIENT__ERROR, "Unable to query solarsystem entity for destiny update in system %u!", m_systemID );
 		ss.solItem = new PyNone;
 	}
+	else
+	{
+		PyIncRef( m_solItem );
+		ss.solItem = m_solItem;
+	}
 
 	//ss.effectStates
     ss.effectStates = new PyList;
@@ -750,15 +997,19 @@ void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState
 	//ss.allianceBridges
     ss.allianceBridges = new PyList;
 
-    _log( DESTINY__TRACE, "Set State:" );
-    ss.Dump( DESTINY__TRACE, "    " );
-    _log( DESTINY__TRACE, "    Buffer:" );
-    _hex( DESTINY__TRACE, &( ss.destiny_state->content() )[0],
-                          ss.destiny_state->content().size() );
-
-    _log( DESTINY__TRACE, "    Decoded:" );
-    Destiny::DumpUpdate( DESTINY__TRACE, &( ss.destiny_state->content() )[0],
-                                         ss.destiny_state->content().size() );
+	//walking the whole state is not cheap; only do it if it is going to be printed.
+	if( is_log_enabled( DESTINY__TRACE ) )
+	{
+		_log( DESTINY__TRACE, "Set State:" );
+		ss.Dump( DESTINY__TRACE, "    " );
+		_log( DESTINY__TRACE, "    Buffer:" );
+		_hex( DESTINY__TRACE, &( ss.destiny_state->content() )[0],
+		                      ss.destiny_state->content().size() );
+
+		_log( DESTINY__TRACE, "    Decoded:" );
+		Destiny::DumpUpdate( DESTINY__TRACE, &( ss.destiny_state->content() )[0],
+		                                     ss.destiny_state->content().size() );
+	}
 }
 
 ItemFactory& SystemManager::itemFactory() const
@@ -0,0 +1,94 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+*/
+
+
+#include "EVEServerPCH.h"
+
+static const char *const TicPhaseNames[TicProfiler::PHASE_COUNT] = {
+	"physics",
+	"bubbles",
+	"bubblecast",
+	"encode"
+};
+
+TicProfiler::TicProfiler()
+: m_depth(0),
+  m_last(0)
+{
+	Reset();
+}
+
+void TicProfiler::Enter(Phase phase) {
+	_Charge(GetNanoTime());
+	
+	//deeper nesting is charged to the deepest phase we keep.
+	if(m_depth < MAX_DEPTH)
+		m_stack[m_depth] = phase;
+	++m_depth;
+	
+	++m_count[phase];
+}
+
+void TicProfiler::Leave() {
+	_Charge(GetNanoTime());
+	
+	if(m_depth > 0)
+		--m_depth;
+}
+
+void TicProfiler::Reset() {
+	memset(m_time, 0, sizeof(m_time));
+	memset(m_count, 0, sizeof(m_count));
+}
+
+const char *TicProfiler::GetPhaseName(Phase phase) {
+	return(TicPhaseNames[phase]);
+}
+
+uint64 TicProfiler::GetNanoTime() {
+#ifdef WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	if(frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	
+	//split up so that the multiplication does not overflow.
+	const uint64 seconds = now.QuadPart / frequency.QuadPart;
+	const uint64 rest = now.QuadPart % frequency.QuadPart;
+	return(seconds * 1000000000 + rest * 1000000000 / frequency.QuadPart);
+#else /* !WIN32 */
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	
+	return((uint64)ts.tv_sec * 1000000000 + ts.tv_nsec);
+#endif /* !WIN32 */
+}
+
+void TicProfiler::_Charge(uint64 now) {
+	if(m_depth > 0)
+		m_time[m_stack[(m_depth < MAX_DEPTH ? m_depth : MAX_DEPTH) - 1]] += now - m_last;
+	m_last = now;
+}
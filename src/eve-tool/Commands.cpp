@@ -33,12 +33,14 @@
 /************************************************************************/
 void DestinyDumpLogText( const Seperator& cmd );
 void CRC32Text( const Seperator& cmd );
+void EvilNumberBenchmark( const Seperator& cmd );
 void ExitProgram( const Seperator& cmd );
 void PrintHelp( const Seperator& cmd );
 void ObjectToSQL( const Seperator& cmd );
 void TestMarshal( const Seperator& cmd );
 void PrintTimeNow( const Seperator& cmd );
 void LoadScript( const Seperator& cmd );
+void BuildSnapshot( const Seperator& cmd );
 void TimeToString( const Seperator& cmd );
 void TriToOBJ( const Seperator& cmd );
 void UnmarshalLogText( const Seperator& cmd );
@@ -51,12 +53,14 @@ const EVEToolCommand EVETOOL_COMMANDS[] =
 {
     { "destiny",   &DestinyDumpLogText, "Converts given string to binary and dumps it as destiny binary." },
     { "crc32",     &CRC32Text,          "Computes CRC-32 checksum of given arguments."                    },
+    { "evilbench", &EvilNumberBenchmark, "Runs EvilNumber micro-benchmarks."                              },
     { "exit",      &ExitProgram,        "Quits current session."                                          },
     { "help",      &PrintHelp,          "Lists available commands or prints help about specified one."    },
     { "mtest",     &TestMarshal,        "Performs marshal test."                                          },
     { "now",       &PrintTimeNow,       "Prints current time in Win32 time format."                       },
     { "obj2sql",   &ObjectToSQL,        "Converts specified cache object into an SQL update."             },
     { "script",    &LoadScript,         "Loads input from specified file(s)."                             },
+    { "snapshot",  &BuildSnapshot,      "Compiles static tables into a snapshot file for the server."     },
     { "time",      &TimeToString,       "Interprets given integer as Win32 time."                         },
     { "tri2obj",   &TriToOBJ,           "Dumps specified TRI file."                                       },
     { "unmarshal", &UnmarshalLogText,   "Converts given string to binary and unmarshals it."              },
@@ -139,6 +143,109 @@ void CRC32Text( const Seperator& cmd )
     }
 }
 
+/// Sink for benchmark results, so the compiler cannot drop the loops.
+static volatile double EvilNumberBenchmarkSink = 0;
+
+/// Logs time per iteration of a benchmark which started at @a start.
+static void EvilNumberBenchmarkResult( const char* cmdName, const char* name, uint64 start, uint32 iterations, const EvilNumber& result )
+{
+    // Win32 time is in units of 100 ns
+    const double elapsed = double( Win32TimeNow() - start ) * 100.0;
+
+    EvilNumberBenchmarkSink = result.get_type() == evil_number_int ? double( result.get_int() ) : result.get_float();
+    sLog.Log( cmdName, "%-24s %8.2f ns/op", name, elapsed / iterations );
+}
+
+void EvilNumberBenchmark( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    uint32 iterations = 10000000;
+    if( 2 <= cmd.argCount() )
+        iterations = strtoul( cmd.arg( 1 ).c_str(), NULL, 0 );
+    if( 0 == iterations )
+    {
+        sLog.Error( cmdName, "Usage: %s [iterations]", cmdName );
+        return;
+    }
+
+    sLog.Log( cmdName, "sizeof(EvilNumber) = %lu, %u iterations", sizeof( EvilNumber ), iterations );
+
+    // operands are read from volatiles so the loops are not folded away
+    volatile int64 i1 = 3, i2 = 7;
+    volatile double f1 = 1.5, f2 = 0.75;
+
+    const EvilNumber ia( (int64)i1 ), ib( (int64)i2 );
+    const EvilNumber fa( (double)f1 ), fb( (double)f2 );
+
+    uint64 start;
+    EvilNumber r;
+
+#define EVIL_BENCH( name, expr ) \
+    r = EvilNumber( 0 ); \
+    start = Win32TimeNow(); \
+    for( uint32 i = 0; i < iterations; ++i ) \
+        r += ( expr ); \
+    EvilNumberBenchmarkResult( cmdName, name, start, iterations, r );
+
+    EVIL_BENCH( "int * int",     ia * ib );
+    EVIL_BENCH( "int + int",     ia + ib );
+    EVIL_BENCH( "int / int",     ib / ia );
+    EVIL_BENCH( "float * float", fa * fb );
+    EVIL_BENCH( "float + float", fa + fb );
+    EVIL_BENCH( "float / float", fa / fb );
+    EVIL_BENCH( "int * float",   ia * fb );
+    EVIL_BENCH( "float - int",   fa - ib );
+    EVIL_BENCH( "int == float",  EvilNumber( ia == fa ? 1 : 0 ) );
+    EVIL_BENCH( "float < float", EvilNumber( fa < fb ? 1 : 0 ) );
+    EVIL_BENCH( "int > 0",       EvilNumber( ia > 0 ? 1 : 0 ) );
+    EVIL_BENCH( "get_float",     fa.get_float() );
+
+#undef EVIL_BENCH
+
+    /* The resistance part of ItemSystemEntity::ApplyDamage: four damage
+     * types, each multiplied by the matching resonance attribute. */
+    // shield em/explosive/kinetic/thermal resonance attribute IDs (see AttributeEnum.h)
+    const uint32 resonances[] = { 273, 274, 271, 272 };
+
+    std::map<uint32, EvilNumber> attributes;
+    attributes[ 271 ] = EvilNumber( 1.0 );
+    attributes[ 272 ] = EvilNumber( 0.5 );
+    attributes[ 273 ] = EvilNumber( 0.6 );
+    attributes[ 274 ] = EvilNumber( 0.8 );
+
+    double total = 0;
+    start = Win32TimeNow();
+    for( uint32 i = 0; i < iterations; ++i )
+    {
+        for( size_t j = 0; j < 4; ++j )
+            total += f1 * attributes[ resonances[ j ] ].get_float();
+    }
+    EvilNumberBenchmarkResult( cmdName, "resistance (map)", start, iterations, EvilNumber( total ) );
+
+    double factors[ 4 ];
+    for( size_t j = 0; j < 4; ++j )
+        factors[ j ] = attributes[ resonances[ j ] ].get_float();
+
+    EvilNumber damage[ 4 ];
+    start = Win32TimeNow();
+    for( uint32 i = 0; i < iterations; ++i )
+    {
+        for( size_t j = 0; j < 4; ++j )
+            damage[ j ] = EvilNumber( (double)f1 );
+
+        EvilNumber::MultiplyEach( damage, factors, 4 );
+    }
+    EvilNumberBenchmarkResult( cmdName, "resistance (bulk)", start, iterations, damage[ 0 ] + damage[ 3 ] );
+
+    std::vector<EvilNumber> values( 1024, EvilNumber( (double)f1 ) );
+    const uint32 passes = std::max<uint32>( iterations / 1024, 1 );
+    start = Win32TimeNow();
+    for( uint32 i = 0; i < passes; ++i )
+        EvilNumber::MultiplyAll( &values[ 0 ], values.size(), f2 + 0.25 );
+    EvilNumberBenchmarkResult( cmdName, "MultiplyAll (per value)", start, passes * 1024, values[ 0 ] );
+}
+
 void ExitProgram( const Seperator& cmd )
 {
     // just close standart input
@@ -304,6 +411,42 @@ void LoadScript( const Seperator& cmd )
         ProcessFile( cmd.arg( i ) );
 }
 
+void BuildSnapshot( const Seperator& cmd )
+{
+    const char* cmdName = cmd.arg( 0 ).c_str();
+
+    if( 7 != cmd.argCount() && 8 != cmd.argCount() )
+    {
+        sLog.Error( cmdName, "Usage: %s [file] [host] [user] [password] [database] [backend] [port]", cmdName );
+        return;
+    }
+    const std::string& file = cmd.arg( 1 );
+    const std::string& host = cmd.arg( 2 );
+    const std::string& user = cmd.arg( 3 );
+    const std::string& password = cmd.arg( 4 );
+    const std::string& database = cmd.arg( 5 );
+    const std::string& backend = cmd.arg( 6 );
+    const int16 port = ( 8 == cmd.argCount() ? atoi( cmd.arg( 7 ).c_str() ) : 3306 );
+
+    if( !sDatabase.SetBackend( backend.c_str() ) )
+        return;
+
+    DBerror dbErr;
+    if( !sDatabase.Open( dbErr, host.c_str(), user.c_str(), password.c_str(), database.c_str(), port ) )
+    {
+        sLog.Error( cmdName, "Unable to connect to the database: %s", dbErr.c_str() );
+        return;
+    }
+
+    const uint32 start = GetTickCount();
+
+    std::string err;
+    if( DBSnapshot::Build( err, file.c_str(), STATIC_SNAPSHOT_QUERIES, STATIC_SNAPSHOT_QUERY_COUNT ) )
+        sLog.Success( cmdName, "Snapshot %s built in %u ms.", file.c_str(), GetTickCount() - start );
+    else
+        sLog.Error( cmdName, "Failed to build snapshot %s: %s", file.c_str(), err.c_str() );
+}
+
 void TimeToString( const Seperator& cmd )
 {
     const char* cmdName = cmd.arg( 0 ).c_str();